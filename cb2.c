@@ -11,6 +11,7 @@ Cmd cmd = {0};
 #define shift(array, size) (assert(0 < (size)), (size)--, *(array)++)
 // #define CC "gcc"
 #define CC "gcc"
+#define C_STD "-std=gnu23"
 #define BUILD_PATH "build/"
 #define ASSETS_PATH "assets/"
 #define RAYLIB_PATH_LINUX "external/raylib-6.0_linux_amd64/"
@@ -118,7 +119,9 @@ typedef struct {
 
 #define cflags(cmd, ...) cflags_opt(cmd, ((Cflags_Opts){__VA_ARGS__}))
 void cflags_opt(Cmd *cmd, Cflags_Opts opts) {
-    CFLAGS(cmd, "-fPIC", "-O0", "-Wall", "-Wextra", "-g", "-std=gnu23");
+    CFLAGS(cmd, "-fPIC", "-O0", "-Wall", "-Wextra", "-g", C_STD);
+    // Script plugins are compiled at runtime with the same compiler and standard.
+    CFLAGS(cmd, "-DTKBC_PLUGIN_CC=\"" CC "\"", "-DTKBC_PLUGIN_STD=\"" C_STD "\"");
     if (opts.WINDOWS) {
         CFLAGS(cmd, "-static");
         CFLAGS(cmd, "-mwindows");
@@ -148,6 +151,7 @@ void include_opt(Cmd *cmd, Include_Opts opts) {
         if (0) {
         } else if (opts.LINUX) {
             INCLUDE(cmd, "-I", RAYLIB_PATH_LINUX "include/");
+            CFLAGS(cmd, "-DTKBC_PLUGIN_RAYLIB_INCLUDE=\"" RAYLIB_PATH_LINUX "include/\"");
         } else if (opts.WINDOWS) {
             INCLUDE(cmd, "-I", RAYLIB_PATH_WINDOWS "include/");
         } else {
@@ -161,6 +165,8 @@ typedef struct {
     bool raylib;
     bool raylib_memory;
     bool X11;
+    bool pthread;
+    bool dynamic;
 
     bool LINUX;
     bool WINDOWS;
@@ -186,6 +192,14 @@ void libs_opt(Cmd *cmd, Libs_Opts opts) {
         if (opts.X11) {
             LIBS(cmd, "-lX11");
         }
+        if (opts.pthread) {
+            LIBS(cmd, "-lpthread");
+        }
+        if (opts.dynamic) {
+            // Script plugins resolve the tkbc functions against the executable.
+            LDFLAGS(cmd, "-rdynamic");
+            LIBS(cmd, "-ldl");
+        }
     } else if (opts.WINDOWS) {
         if (opts.raylib) {
             LDFLAGS(cmd, "-L", RAYLIB_PATH_WINDOWS "lib/");
@@ -193,6 +207,9 @@ void libs_opt(Cmd *cmd, Libs_Opts opts) {
             LIBS(cmd, "-l:libraylib.a");
         }
         LIBS(cmd, "-lwinmm");
+        if (opts.pthread) {
+            LIBS(cmd, "-lpthread");
+        }
         LIBS(cmd, "-lgdi32");
 
         if (opts.network) {
@@ -211,7 +228,16 @@ void files_for_test(Cmd *cmd) {
     cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-keymaps.c");
     cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-asset-handler.c");
     cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-parser.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-parser-parallel.c");
     cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-script-converter.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-script-baker.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-script-optimizer.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-script-store.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-script-kiteb.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-script-plugin.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-script-reload.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-collision.c");
+    cb_cmd_push(cmd, NETWORK_PATH "tkbc-local-transport.c");
 }
 
 void files_for_choreographer(Cmd *cmd) {
@@ -222,7 +248,15 @@ void files_for_choreographer(Cmd *cmd) {
     cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-keymaps.c");
     cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-script-handler.c");
     cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-parser.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-parser-parallel.c");
     cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-script-converter.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-script-baker.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-script-optimizer.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-script-store.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-script-kiteb.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-script-plugin.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-script-reload.c");
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-collision.c");
 }
 
 void files_for_tkbc(Cmd *cmd) {
@@ -248,6 +282,7 @@ void files_for_client(Cmd *cmd) {
 
     cb_cmd_push(cmd, GLOBAL_PATH "tkbc-popup.c");
     cb_cmd_push(cmd, NETWORK_PATH "tkbc-network-common.c");
+    cb_cmd_push(cmd, NETWORK_PATH "tkbc-local-transport.c");
 
     cb_cmd_push(cmd, MESSAGES_PATH "tkbc-messages-hello-verification.c");
     cb_cmd_push(cmd, MESSAGES_PATH "tkbc-messages-send-texture.c");
@@ -264,6 +299,7 @@ void files_for_server(Cmd *cmd) {
     files_for_choreographer(cmd);
 
     cb_cmd_push(cmd, NETWORK_PATH "tkbc-network-common.c");
+    cb_cmd_push(cmd, NETWORK_PATH "tkbc-local-transport.c");
 
     cb_cmd_push(cmd, MESSAGES_PATH "tkbc-messages-hello-verification.c");
     cb_cmd_push(cmd, MESSAGES_PATH "tkbc-messages-send-texture.c");
@@ -273,6 +309,20 @@ void files_for_server(Cmd *cmd) {
     cb_cmd_push(cmd, MESSAGES_PATH "tkbc-messages-script-scrub.c");
     cb_cmd_push(cmd, MESSAGES_PATH "tkbc-messages-script-next.c");
     cb_cmd_push(cmd, MESSAGES_PATH "tkbc-messages-script.c");
+    cb_cmd_push(cmd, MESSAGES_PATH "tkbc-messages-script-local.c");
+    cb_cmd_push(cmd, MESSAGES_PATH "tkbc-messages-local-transport.c");
+}
+
+void files_for_sim(Cmd *cmd) {
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-sim.c");
+
+    files_for_choreographer(cmd);
+}
+
+void files_for_bench(Cmd *cmd) {
+    cb_cmd_push(cmd, CHOREOGRAPHER_PATH "tkbc-bench.c");
+
+    files_for_choreographer(cmd);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -360,9 +410,9 @@ void tkbc_opt(Cmd *cmd, OS_Opts os) {
 
     if (0) {
     } else if (os.LINUX) {
-        libs(cmd, .raylib = true, .X11 = true, .math = true, .LINUX = true);
+        libs(cmd, .raylib = true, .X11 = true, .math = true, .pthread = true, .dynamic = true, .LINUX = true);
     } else if (os.WINDOWS) {
-        libs(cmd, .raylib = true, .WINDOWS = true);
+        libs(cmd, .raylib = true, .WINDOWS = true, .pthread = true);
     } else {
         exit(EXIT_FAILURE);
     }
@@ -399,9 +449,9 @@ void client_opt(Cmd *cmd, OS_Opts os) {
 
     if (0) {
     } else if (os.LINUX) {
-        libs(cmd, .raylib = true, .X11 = true, .math = true, .LINUX = true);
+        libs(cmd, .raylib = true, .X11 = true, .math = true, .pthread = true, .dynamic = true, .LINUX = true);
     } else if (os.WINDOWS) {
-        libs(cmd, .raylib = true, .WINDOWS = true, .network = true);
+        libs(cmd, .raylib = true, .WINDOWS = true, .network = true, .pthread = true);
     } else {
         exit(EXIT_FAILURE);
     }
@@ -437,9 +487,47 @@ void server_opt(Cmd *cmd, OS_Opts os) {
     if (0) {
     } else if (os.LINUX) {
         // TODO: Strip raylib dependency for the server completely.
-        libs(cmd, .raylib = true, .raylib_memory = true, .math = true, .LINUX = true);
+        libs(cmd, .raylib = true, .raylib_memory = true, .math = true, .pthread = true, .dynamic = true, .LINUX = true);
+    } else if (os.WINDOWS) {
+        libs(cmd, .raylib = true, .WINDOWS = true, .network = true, .pthread = true);
+    } else {
+        exit(EXIT_FAILURE);
+    }
+
+    if (!cb_run_sync(cmd)) exit(EXIT_FAILURE);
+}
+
+#define sim(cmd, ...) sim_opt(cmd, ((OS_Opts){__VA_ARGS__}))
+void sim_opt(Cmd *cmd, OS_Opts os) {
+    if (0) {
+    } else if (os.LINUX) {
+        cb_cmd_push(cmd, CC);
+        include(cmd, .raylib = true, .LINUX = true);
+        cflags(cmd);
+        define(cmd, .include_raylib = true, .tkbc_server = true);
+        define(cmd, .space_decl = true, .space_def = true, .space_alloc_method_mmap = true,
+               .space_memory_layout_method_da = true);
+        cb_cmd_push(cmd, "-o", BUILD_PATH "tkbc-sim");
+    } else if (os.WINDOWS) {
+        cb_cmd_push(cmd, "x86_64-w64-mingw32-gcc");
+        include(cmd, .raylib = true, .WINDOWS = true);
+        cflags(cmd, .WINDOWS = true);
+        define(cmd, .include_raylib = true, .tkbc_server = true, .release = true);
+        define(cmd, .space_decl = true, .space_def = true, .space_alloc_method_virtual_alloc = true,
+               .space_memory_layout_method_da = true);
+        cb_cmd_push(cmd, "-o", BUILD_PATH "tkbc-sim-win64");
+    } else {
+        exit(EXIT_FAILURE);
+    }
+
+    files_for_sim(cmd);
+
+    if (0) {
+    } else if (os.LINUX) {
+        // The simulator is headless and does not need a window system.
+        libs(cmd, .raylib = true, .raylib_memory = true, .math = true, .pthread = true, .dynamic = true, .LINUX = true);
     } else if (os.WINDOWS) {
-        libs(cmd, .raylib = true, .WINDOWS = true, .network = true);
+        libs(cmd, .raylib = true, .WINDOWS = true, .pthread = true);
     } else {
         exit(EXIT_FAILURE);
     }
@@ -447,6 +535,26 @@ void server_opt(Cmd *cmd, OS_Opts os) {
     if (!cb_run_sync(cmd)) exit(EXIT_FAILURE);
 }
 
+void bench(Cmd *cmd) {
+    cb_cmd_push(cmd, CC);
+    include(cmd, .raylib = true, .LINUX = true);
+    cflags(cmd);
+    // The later -O2 replaces the -O0 of the cflags, so the measured parser is
+    // built like a release.
+    CFLAGS(cmd, "-O2");
+    define(cmd, .include_raylib = true, .tkbc_server = true, .release = true);
+    define(cmd, .space_decl = true, .space_def = true, .space_alloc_method_mmap = true,
+           .space_memory_layout_method_da = true);
+    cb_cmd_push(cmd, "-o", BUILD_PATH "tkbc-bench");
+
+    files_for_bench(cmd);
+
+    // The benchmark is headless like the simulator.
+    libs(cmd, .raylib = true, .raylib_memory = true, .math = true, .pthread = true, .dynamic = true, .LINUX = true);
+
+    if (!cb_run_sync(cmd)) exit(EXIT_FAILURE);
+}
+
 typedef struct {
     bool normal;
     bool verbose;
@@ -473,7 +581,7 @@ void tests_opt(Cmd *cmd, Tests_Opts opts) {
     cb_cmd_push(cmd, "-o", BUILD_PATH "tests");
     cb_cmd_push(cmd, TESTS_PATH "tkbc_tests.c");
     files_for_test(cmd);
-    libs(cmd, .raylib = true, .raylib_memory = true, .math = true, .LINUX = true);
+    libs(cmd, .raylib = true, .raylib_memory = true, .math = true, .pthread = true, .dynamic = true, .LINUX = true);
 
     if (!cb_run_sync(cmd)) exit(EXIT_FAILURE);
 
@@ -499,6 +607,8 @@ typedef struct {
     bool tkbc;
     bool client;
     bool server;
+    bool sim;
+    bool bench;
 } Usage_Opts;
 
 #define FLAG_HELP "help"
@@ -512,6 +622,8 @@ typedef struct {
 #define FLAG_TKBC "tkbc"
 #define FLAG_CLIENT "client"
 #define FLAG_SERVER "server"
+#define FLAG_SIM "tkbc-sim"
+#define FLAG_BENCH "tkbc-bench"
 #define FLAG_LINUX "linux"
 #define FLAG_WINDOWS "windows"
 
@@ -542,6 +654,12 @@ void usage_opt(Usage_Opts opts) {
     if (opts.server || opts.all) {
         fprintf(stderr, "       <%s> <%s>\n", opts.prog_name, FLAG_SERVER);
     }
+    if (opts.sim || opts.all) {
+        fprintf(stderr, "       <%s> <%s>\n", opts.prog_name, FLAG_SIM);
+    }
+    if (opts.bench || opts.all) {
+        fprintf(stderr, "       <%s> <%s>\n", opts.prog_name, FLAG_BENCH);
+    }
     exit(EXIT_FAILURE);
 }
 
@@ -585,6 +703,14 @@ int main(int argc, char *argv[]) {
         make_build_dir(&cmd);
         void flag_server(char *flag, char ***argv, int *argc);
         flag_server(flag, &argv, &argc);
+    } else if (str_compare(FLAG_SIM, flag)) {
+        make_build_dir(&cmd);
+        void flag_sim(char *flag, char ***argv, int *argc);
+        flag_sim(flag, &argv, &argc);
+    } else if (str_compare(FLAG_BENCH, flag)) {
+        make_build_dir(&cmd);
+        void flag_bench(char *flag, char ***argv, int *argc);
+        flag_bench(flag, &argv, &argc);
     } else {
         usage(.prog_name = prog_name, .all = true);
     }
@@ -821,3 +947,52 @@ void flag_server(char *flag, char ***argv, int *argc) {
         }
     }
 }
+
+void flag_sim(char *flag, char ***argv, int *argc) {
+    char *prev_flag = flag;
+    flag = get_next_or_last(argv, argc);
+    if (str_compare(flag, prev_flag)) {
+        // defaults to linux when no other argument is specified.
+        sim(&cmd, .LINUX = true);
+    } else {
+        char ***saved_argv = argv;
+        int saved_argc = *argc;
+        bool first = true;
+    second:
+        for (;;) {
+            prev_flag = flag;
+            if (0) {
+            } else if (str_compare(FLAG_LINUX, flag)) {
+                if (!first) {
+                    sim(&cmd, .LINUX = true);
+                }
+            } else if (str_compare(FLAG_WINDOWS, flag)) {
+                if (!first) {
+                    sim(&cmd, .WINDOWS = true);
+                }
+            } else {
+                usage(.prog_name = prog_name, .sim = true);
+            }
+
+            flag = get_next_or_last(argv, argc);
+            if (prev_flag == flag) {
+                if (first) {
+                    first = false;
+                    argv = saved_argv;
+                    *argc = saved_argc;
+                    goto second;
+                }
+                break;
+            }
+        }
+    }
+}
+
+void flag_bench(char *flag, char ***argv, int *argc) {
+    bench(&cmd);
+    char *prev_flag = flag;
+    flag = get_next_or_last(argv, argc);
+    if (prev_flag != flag) {
+        usage(.prog_name = prog_name, .bench = true);
+    }
+}
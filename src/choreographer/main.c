@@ -27,6 +27,7 @@
 #undef TKBC_UTILS_IMPLEMENTATION
 
 #include "tkbc-asset-handler.h"
+#include "tkbc-collision.h"
 #include "tkbc-ffmpeg.h"
 #include "tkbc-input-handler.h"
 #include "tkbc-keymaps.h"
@@ -92,7 +93,11 @@ int main(void) {
         }
 
         tkbc_update_kites_for_resize_window(env);
+        tkbc_kite_array_materialize_geometry(&env->kite_array);
         tkbc_draw_kite_array(env->kite_array);
+        if (env->collision_overlay) {
+            tkbc_draw_collision_overlay(env);
+        }
         tkbc_draw_ui(env);
         EndDrawing();
         tkbc_ui_post_handler(env);
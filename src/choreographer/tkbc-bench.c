@@ -0,0 +1,314 @@
+#define SPACE_IMPLEMENTATION
+#include "../../external/space/space.h"
+#undef SPACE_IMPLEMENTATION
+
+#define TKBC_UTILS_IMPLEMENTATION
+#include "../global/tkbc-utils.h"
+#undef TKBC_UTILS_IMPLEMENTATION
+
+#include "tkbc-asset-handler.h"
+#include "tkbc-parser.h"
+#include "tkbc.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// The parser benchmark generates .kite files from 1 KB up to 100 MB that use
+// every team figure and the frame keywords and measures how fast they are
+// parsed. The files are generated once and reused by later runs, so the
+// throughput of different versions of the parser can be compared.
+
+#define TKBC_BENCH_DEFAULT_DIR "build/bench"
+#define TKBC_BENCH_DEFAULT_REPEATS 3
+#define TKBC_BENCH_DEFAULT_MAX_SIZE (100 * 1024 * 1024)
+
+typedef struct {
+    const char *label;  // The label of the size in the file name.
+    size_t size;        // The minimum size of the file in bytes.
+} Bench_Size;           // A size of the generated benchmark corpus.
+
+static const Bench_Size tkbc_bench_sizes[] = {
+    {"1KB", 1024},
+    {"10KB", 10 * 1024},
+    {"100KB", 100 * 1024},
+    {"1MB", 1024 * 1024},
+    {"10MB", 10 * 1024 * 1024},
+    {"100MB", 100 * 1024 * 1024},
+};
+
+// One section of the corpus with every team figure and the frame keywords. The
+// section is split into scripts that start from the initial kite positions and
+// stay in the window without contacts, so every script passes tkbc-sim.
+static const char *tkbc_bench_section = //
+    "BEGIN\n"
+    "EXTERN TEAM_LINE KITES 900 500 0 0 150 1\n"
+    "EXTERN TEAM_GRID KITES 900 500 0 0 150 150 2 2 1\n"
+    "EXTERN TEAM_LINE KITES 900 500 0 0 150 1\n"
+    "EXTERN TEAM_MOUNTAIN KITES 900 500 0 0 150 150 1 1\n"
+    "EXTERN TEAM_VALLEY KITES 900 500 0 0 150 150 1 1\n"
+    "EXTERN TEAM_ARC KITES 900 500 0 0 150 150 30 1 1\n"
+    "EXTERN TEAM_MOUTH KITES 900 500 0 0 150 150 30 1 1\n"
+    "END\n"
+    "BEGIN\n"
+    "EXTERN TEAM_BOX KITES RIGHT 90 100 1 1\n"
+    "EXTERN TEAM_BOX_LEFT KITES 100 1 1\n"
+    "EXTERN TEAM_BOX_RIGHT KITES 100 1 1\n"
+    "EXTERN TEAM_DIAMOND KITES LEFT 45 100 1 1\n"
+    "EXTERN TEAM_DIAMOND_LEFT KITES 100 1 1\n"
+    "EXTERN TEAM_DIAMOND_RIGHT KITES 100 1 1\n"
+    "END\n"
+    "BEGIN\n"
+    "EXTERN TEAM_LINE KITES 760 540 0 0 100 1\n"
+    "EXTERN TEAM_BALL KITES 900 500 0 0 250 1 1\n"
+    "END\n"
+    "BEGIN\n"
+    "EXTERN TEAM_LINE KITES 760 540 0 0 100 1\n"
+    "EXTERN TEAM_SPLIT_BOX_UP KITES EVEN 100 1 1\n"
+    "END\n"
+    "BEGIN\n"
+    "EXTERN TEAM_LINE KITES 500 540 0 0 100 1\n"
+    "EXTERN TEAM_ROLL_SPLIT_UP KITES ODD 1 0 90 1\n"
+    "EXTERN TEAM_ROLL_SPLIT_DOWN KITES EVEN 1 0 90 1\n"
+    "END\n"
+    "BEGIN\n"
+    "EXTERN TEAM_LINE KITES 700 540 0 0 200 1\n"
+    "EXTERN TEAM_ROLL_UP_ANTI_CLOCKWISE KITES 2 0 90 1\n"
+    "EXTERN TEAM_ROLL_UP_CLOCKWISE KITES 2 0 90 1\n"
+    "EXTERN TEAM_ROLL_DOWN_ANTI_CLOCKWISE KITES 2 0 90 1\n"
+    "EXTERN TEAM_ROLL_DOWN_CLOCKWISE KITES 2 0 90 1\n"
+    "END\n"
+    "BEGIN\n"
+    "MOVE (0) 900 500 1\n"
+    "{ MOVE_ADD (0 1) 10 -10 0.5 ROTATION_ADD (2 3) 45 0.5 }\n"
+    "ROTATION (0) 90 1\n"
+    "TIP_ROTATION (1) 45 LEFT 1\n"
+    "WAIT 0.5\n"
+    "END\n";
+
+Assets assets = {0};
+Env *env = {0};
+
+/**
+ * @brief The function prints the usage of the benchmark.
+ *
+ * @param stream The stream where the usage should be printed to.
+ * @param program_name The name of the executable.
+ */
+static void tkbc_bench_usage(FILE *stream, const char *program_name) {
+    fprintf(stream, "Usage:\n");
+    fprintf(stream, "       %s [options] [file.kite]...\n", program_name);
+    fprintf(stream, "Options:\n");
+    fprintf(stream, "       -d <dir>        The dir of the generated corpus, the default is %s.\n",
+            TKBC_BENCH_DEFAULT_DIR);
+    fprintf(stream, "       -j <workers>    The amount of parse workers, 0 uses the processor count.\n");
+    fprintf(stream, "       -r <repeats>    The amount of parses per file, the fastest is reported.\n");
+    fprintf(stream, "       -m <bytes>      The largest file of the corpus, the default is 100 MB.\n");
+    fprintf(stream, "       The given files are measured instead of the generated corpus.\n");
+}
+
+/**
+ * @brief The function parses a positive number of a command line option.
+ *
+ * @param option The option the number belongs to.
+ * @param arg The argument that should hold the number.
+ * @param number The place where the number is stored.
+ * @return True if the argument is a valid number, otherwise false.
+ */
+static bool tkbc_bench_parse_number(const char *option, const char *arg, long *number) {
+    if (arg == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "The option %s needs a value.\n", option);
+        return false;
+    }
+    char *end = NULL;
+    errno = 0;
+    *number = strtol(arg, &end, 10);
+    if (errno != 0 || end == arg || *end != '\0' || *number < 0) {
+        tkbc_fprintf(stderr, "ERROR", "The value %s of the option %s is not a valid number.\n", arg, option);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief The function generates a corpus file that is at least as large as
+ * the given size. A file that already has the size is kept.
+ *
+ * @param path The path of the file.
+ * @param size The minimum size of the file in bytes.
+ * @return True if the file exists afterwards, otherwise false.
+ */
+static bool tkbc_bench_generate(const char *path, size_t size) {
+    struct stat st;
+    if (stat(path, &st) == 0 && (size_t)st.st_size >= size) {
+        return true;
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "The file %s could not be opened: %s\n", path, strerror(errno));
+        return false;
+    }
+    size_t written = fprintf(file, "KITES 4\n");
+    size_t section_size = strlen(tkbc_bench_section);
+    while (written < size) {
+        if (fwrite(tkbc_bench_section, 1, section_size, file) != section_size) {
+            tkbc_fprintf(stderr, "ERROR", "The file %s could not be written: %s\n", path, strerror(errno));
+            fclose(file);
+            return false;
+        }
+        written += section_size;
+    }
+    fclose(file);
+    return true;
+}
+
+/**
+ * @brief The function parses the file the given amount of times into a new
+ * env and prints the throughput of the fastest parse.
+ *
+ * @param path The .kite file that is measured.
+ * @param workers The amount of parse workers, 0 uses the processor count.
+ * @param repeats The amount of parses.
+ * @return True if every parse has worked without errors, otherwise false.
+ */
+static bool tkbc_bench_file(const char *path, size_t workers, size_t repeats) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        tkbc_fprintf(stderr, "ERROR", "The file %s could not be found: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    double best = -1;
+    size_t frames = 0;
+    size_t scripts = 0;
+    for (size_t i = 0; i < repeats; ++i) {
+        env = tkbc_init_env();
+        if (!env) {
+            return false;
+        }
+        env->window_width = 1920;
+        env->window_height = 1080;
+        // The scripts stay in memory, so the spilling to disk is not measured.
+        env->scripts_memory_budget = SIZE_MAX;
+        double start = tkbc_get_time();
+        bool ok = tkbc_script_parser_file(env, path, workers);
+        double seconds = tkbc_get_time() - start;
+        ok = ok && env->kite_diagnostics.count == 0;
+        // The frames are counted as they are parsed, before the optimization.
+        frames = env->script_optimization.frames_before;
+        scripts = env->scripts.count;
+        tkbc_destroy_env(env);
+        env = NULL;
+        if (!ok) {
+            tkbc_fprintf(stderr, "ERROR", "The file %s could not be parsed without errors.\n", path);
+            return false;
+        }
+        if (best < 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+
+    double megabytes = (double)st.st_size / (1024.0 * 1024.0);
+    printf("%-32s %12lld %8zu %10zu %10.4f %10.2f %12.0f\n", path, (long long)st.st_size, scripts, frames, best,
+           megabytes / best, frames / best);
+    return true;
+}
+
+/**
+ * @brief The entry point of the parser benchmark.
+ *
+ * @return 0 if every file could be parsed without errors, otherwise 1.
+ */
+int main(int argc, char *argv[]) {
+    char *program_name = tkbc_shift_args(&argc, &argv);
+    const char *dir = TKBC_BENCH_DEFAULT_DIR;
+    long workers = 0;
+    long repeats = TKBC_BENCH_DEFAULT_REPEATS;
+    long max_size = TKBC_BENCH_DEFAULT_MAX_SIZE;
+
+    char **files = calloc(argc + 1, sizeof(*files));
+    if (files == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+        return 1;
+    }
+    size_t files_count = 0;
+    bool ok = true;
+    while (argc > 0 && ok) {
+        char *arg = tkbc_shift_args(&argc, &argv);
+        bool is_option = arg[0] == '-' && arg[1] != '\0' && arg[2] == '\0';
+        char *value = is_option && argc > 0 ? tkbc_shift_args(&argc, &argv) : NULL;
+        if (strcmp(arg, "-d") == 0) {
+            dir = value;
+            ok = dir != NULL;
+            if (!ok) {
+                tkbc_fprintf(stderr, "ERROR", "The option %s needs a value.\n", arg);
+            }
+        } else if (strcmp(arg, "-j") == 0) {
+            ok = tkbc_bench_parse_number(arg, value, &workers);
+        } else if (strcmp(arg, "-r") == 0) {
+            ok = tkbc_bench_parse_number(arg, value, &repeats) && repeats > 0;
+        } else if (strcmp(arg, "-m") == 0) {
+            ok = tkbc_bench_parse_number(arg, value, &max_size);
+        } else if (arg[0] == '-') {
+            tkbc_fprintf(stderr, "ERROR", "The option %s is unknown.\n", arg);
+            ok = false;
+        } else {
+            files[files_count++] = arg;
+        }
+    }
+    if (!ok) {
+        tkbc_bench_usage(stderr, program_name);
+        free(files);
+        return 1;
+    }
+
+    // The team figures read the dimensions of the default kite.
+    append_assets();
+
+    char **paths = files;
+    size_t paths_count = files_count;
+    char *corpus[ARRAY_LENGTH(tkbc_bench_sizes)] = {0};
+    if (files_count == 0) {
+        if (!tkbc_make_dir_recursive_if_not_existis(dir)) {
+            tkbc_fprintf(stderr, "ERROR", "The dir %s could not be created.\n", dir);
+            ok = false;
+        }
+        for (size_t i = 0; ok && i < ARRAY_LENGTH(tkbc_bench_sizes); ++i) {
+            if (tkbc_bench_sizes[i].size > (size_t)max_size) {
+                break;
+            }
+            size_t size = strlen(dir) + strlen(tkbc_bench_sizes[i].label) + 16;
+            corpus[i] = malloc(size);
+            if (corpus[i] == NULL) {
+                tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+                ok = false;
+                break;
+            }
+            snprintf(corpus[i], size, "%s/bench-%s.kite", dir, tkbc_bench_sizes[i].label);
+            ok = tkbc_bench_generate(corpus[i], tkbc_bench_sizes[i].size);
+            paths_count = i + 1;
+        }
+        paths = corpus;
+    }
+
+    if (ok) {
+        printf("%-32s %12s %8s %10s %10s %10s %12s\n", "file", "bytes", "scripts", "frames", "seconds", "MB/s",
+               "frames/s");
+    }
+    for (size_t i = 0; ok && i < paths_count; ++i) {
+        ok = tkbc_bench_file(paths[i], workers, repeats);
+    }
+
+    for (size_t i = 0; i < ARRAY_LENGTH(corpus); ++i) {
+        free(corpus[i]);
+    }
+    tkbc_assets_destroy();
+    space_free_tspace();
+    free(files);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,369 @@
+#include "tkbc-collision.h"
+#include "../global/tkbc-types.h"
+#include "../global/tkbc-utils.h"
+#include "tkbc-script-handler.h"
+#include "tkbc.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+
+// Every kite is hashed into the grid cell of its center. The cell size covers
+// the reach of two kites from their centers plus the near distance, so two
+// kites that can be closer than the near distance are always in the same or in
+// neighboring cells. A check is O(n) for kites that are spread over the window
+// instead of testing all n^2 pairs.
+
+/**
+ * @brief The function computes the collision geometry of the given kite. The
+ * leading edge is rotated around its top left corner in the same way it is
+ * drawn.
+ *
+ * @param kite The kite whose geometry is materialized.
+ * @param shape The shape that is filled.
+ */
+void tkbc_kite_shape(Kite *kite, Kite_Shape *shape) {
+    tkbc_kite_materialize_geometry(kite);
+    shape->left = kite->left;
+    shape->right = kite->right;
+
+    float phi = PI * kite->angle / 180;
+    float cosphi = cosf(phi);
+    float sinphi = sinf(phi);
+    Vector2 u = {.x = kite->rec.width * cosphi, .y = -kite->rec.width * sinphi};
+    Vector2 v = {.x = kite->rec.height * sinphi, .y = kite->rec.height * cosphi};
+    Vector2 p = {.x = kite->rec.x, .y = kite->rec.y};
+    shape->leading_edge[0] = p;
+    shape->leading_edge[1] = (Vector2){.x = p.x + u.x, .y = p.y + u.y};
+    shape->leading_edge[2] = (Vector2){.x = p.x + u.x + v.x, .y = p.y + u.y + v.y};
+    shape->leading_edge[3] = (Vector2){.x = p.x + v.x, .y = p.y + v.y};
+
+    Vector2 points[] = {
+        shape->left.v1,         shape->left.v2,         shape->left.v3,
+        shape->right.v1,        shape->right.v2,        shape->right.v3,
+        shape->leading_edge[0], shape->leading_edge[1], shape->leading_edge[2],
+        shape->leading_edge[3],
+    };
+    float min_x = points[0].x, max_x = points[0].x;
+    float min_y = points[0].y, max_y = points[0].y;
+    for (size_t i = 1; i < sizeof(points) / sizeof(*points); ++i) {
+        min_x = fminf(min_x, points[i].x);
+        max_x = fmaxf(max_x, points[i].x);
+        min_y = fminf(min_y, points[i].y);
+        max_y = fmaxf(max_y, points[i].y);
+    }
+    shape->bounds = (Rectangle){.x = min_x, .y = min_y, .width = max_x - min_x, .height = max_y - min_y};
+}
+
+/**
+ * @brief The function checks if the given edge separates the two convex
+ * polygons.
+ *
+ * @param a The first point of the edge.
+ * @param b The second point of the edge.
+ * @param p The points of the first polygon.
+ * @param p_count The amount of points of the first polygon.
+ * @param q The points of the second polygon.
+ * @param q_count The amount of points of the second polygon.
+ * @return True if the projections on the normal of the edge do not overlap.
+ */
+static bool tkbc_is_separating_axis(Vector2 a, Vector2 b, const Vector2 *p, size_t p_count, const Vector2 *q,
+                                    size_t q_count) {
+    Vector2 normal = {.x = a.y - b.y, .y = b.x - a.x};
+    if (normal.x == 0 && normal.y == 0) {
+        return false;
+    }
+    float p_min = INFINITY, p_max = -INFINITY;
+    for (size_t i = 0; i < p_count; ++i) {
+        float d = p[i].x * normal.x + p[i].y * normal.y;
+        p_min = fminf(p_min, d);
+        p_max = fmaxf(p_max, d);
+    }
+    float q_min = INFINITY, q_max = -INFINITY;
+    for (size_t i = 0; i < q_count; ++i) {
+        float d = q[i].x * normal.x + q[i].y * normal.y;
+        q_min = fminf(q_min, d);
+        q_max = fmaxf(q_max, d);
+    }
+    return p_max < q_min || q_max < p_min;
+}
+
+/**
+ * @brief The function computes the distance between a point and a segment.
+ *
+ * @param p The point.
+ * @param a The first point of the segment.
+ * @param b The second point of the segment.
+ * @return The distance in pixels.
+ */
+static float tkbc_point_segment_distance(Vector2 p, Vector2 a, Vector2 b) {
+    Vector2 ab = {.x = b.x - a.x, .y = b.y - a.y};
+    Vector2 ap = {.x = p.x - a.x, .y = p.y - a.y};
+    float length = ab.x * ab.x + ab.y * ab.y;
+    float t = length > 0 ? (ap.x * ab.x + ap.y * ab.y) / length : 0;
+    t = fminf(fmaxf(t, 0), 1);
+    float dx = ap.x - t * ab.x;
+    float dy = ap.y - t * ab.y;
+    return sqrtf(dx * dx + dy * dy);
+}
+
+/**
+ * @brief The function computes the distance between two convex polygons with
+ * the separating axis theorem.
+ *
+ * @param p The points of the first polygon.
+ * @param p_count The amount of points of the first polygon.
+ * @param q The points of the second polygon.
+ * @param q_count The amount of points of the second polygon.
+ * @return The smallest distance between the polygons or 0 if they overlap.
+ */
+static float tkbc_polygon_separation(const Vector2 *p, size_t p_count, const Vector2 *q, size_t q_count) {
+    bool separated = false;
+    for (size_t i = 0; i < p_count && !separated; ++i) {
+        separated = tkbc_is_separating_axis(p[i], p[(i + 1) % p_count], p, p_count, q, q_count);
+    }
+    for (size_t i = 0; i < q_count && !separated; ++i) {
+        separated = tkbc_is_separating_axis(q[i], q[(i + 1) % q_count], p, p_count, q, q_count);
+    }
+    if (!separated) {
+        return 0;
+    }
+
+    // The closest points of two separated convex polygons are always a vertex
+    // of one polygon and an edge of the other.
+    float distance = INFINITY;
+    for (size_t i = 0; i < p_count; ++i) {
+        for (size_t j = 0; j < q_count; ++j) {
+            distance = fminf(distance, tkbc_point_segment_distance(p[i], q[j], q[(j + 1) % q_count]));
+            distance = fminf(distance, tkbc_point_segment_distance(q[j], p[i], p[(i + 1) % p_count]));
+        }
+    }
+    return distance;
+}
+
+/**
+ * @brief The function computes the smallest distance between the bodies and
+ * leading edges of two kites.
+ *
+ * @param a The shape of the first kite.
+ * @param b The shape of the second kite.
+ * @return The distance in pixels or 0 if the kites touch.
+ */
+float tkbc_kite_shape_separation(Kite_Shape *a, Kite_Shape *b) {
+    Vector2 a_left[] = {a->left.v1, a->left.v2, a->left.v3};
+    Vector2 a_right[] = {a->right.v1, a->right.v2, a->right.v3};
+    Vector2 b_left[] = {b->left.v1, b->left.v2, b->left.v3};
+    Vector2 b_right[] = {b->right.v1, b->right.v2, b->right.v3};
+    const Vector2 *a_parts[] = {a_left, a_right, a->leading_edge};
+    const Vector2 *b_parts[] = {b_left, b_right, b->leading_edge};
+    const size_t counts[] = {3, 3, 4};
+
+    float separation = INFINITY;
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            separation = fminf(separation, tkbc_polygon_separation(a_parts[i], counts[i], b_parts[j], counts[j]));
+            if (separation == 0) {
+                return 0;
+            }
+        }
+    }
+    return separation;
+}
+
+/**
+ * @brief The function computes the hash bucket of a grid cell.
+ *
+ * @param grid The grid the bucket belongs to.
+ * @param x The cell on the x-axis.
+ * @param y The cell on the y-axis.
+ * @return The index of the bucket in the heads.
+ */
+static size_t tkbc_collision_bucket(Collision_Grid *grid, int x, int y) {
+    uint32_t hash = ((uint32_t) x * 73856093u) ^ ((uint32_t) y * 19349663u);
+    return hash & (grid->heads_count - 1);
+}
+
+/**
+ * @brief The function grows the per kite arrays and the hash buckets of the
+ * grid for the given amount of kites. The memory is reused between checks.
+ *
+ * @param grid The grid that is prepared.
+ * @param count The amount of kites.
+ */
+static void tkbc_collision_grid_reserve(Collision_Grid *grid, size_t count) {
+    if (count > grid->capacity) {
+        size_t capacity = grid->capacity ? grid->capacity : 64;
+        while (capacity < count) {
+            capacity *= 2;
+        }
+        grid->next = realloc(grid->next, capacity * sizeof(*grid->next));
+        grid->shapes = realloc(grid->shapes, capacity * sizeof(*grid->shapes));
+        if (grid->next == NULL || grid->shapes == NULL) {
+            tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+            abort();
+        }
+        grid->capacity = capacity;
+    }
+
+    size_t heads_count = 16;
+    while (heads_count < 2 * count) {
+        heads_count *= 2;
+    }
+    if (heads_count > grid->heads_count) {
+        grid->heads = realloc(grid->heads, heads_count * sizeof(*grid->heads));
+        if (grid->heads == NULL) {
+            tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+            abort();
+        }
+        grid->heads_count = heads_count;
+    }
+}
+
+/**
+ * @brief The function checks the body and the leading edge of all active kites
+ * against each other. The kites are sorted into a spatial hash first, so just
+ * the kites in neighboring cells are compared.
+ *
+ * @param grid The spatial hash that is reused between the checks.
+ * @param kite_states The kites that are checked.
+ * @param near_distance The distance in pixels up to which a pair of kites is
+ * reported.
+ * @param proximities The pairs that are closer than the near distance, the
+ * previous content is cleared.
+ */
+void tkbc_collision_check(Collision_Grid *grid, Kite_States *kite_states, float near_distance,
+                          Kite_Proximities *proximities) {
+    proximities->count = 0;
+    size_t count = kite_states->count;
+    if (count < 2) {
+        return;
+    }
+    tkbc_collision_grid_reserve(grid, count);
+
+    float diameter = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!kite_states->elements[i].is_active) {
+            continue;
+        }
+        Kite_Shape *shape = &grid->shapes[i];
+        tkbc_kite_shape(kite_states->elements[i].kite, shape);
+        diameter = fmaxf(diameter, fmaxf(shape->bounds.width, shape->bounds.height));
+    }
+    // The kite center lies on the leading edge, so the farthest point of a kite
+    // is at most one bounding box diagonal away from it.
+    grid->cell_size = fmaxf(2 * sqrtf(2) * diameter + near_distance, 1);
+
+    for (size_t i = 0; i < grid->heads_count; ++i) {
+        grid->heads[i] = SIZE_MAX;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (!kite_states->elements[i].is_active) {
+            continue;
+        }
+        Kite_Shape *shape = &grid->shapes[i];
+        Vector2 center = kite_states->elements[i].kite->center;
+        shape->cell_x = (int) floorf(center.x / grid->cell_size);
+        shape->cell_y = (int) floorf(center.y / grid->cell_size);
+        size_t bucket = tkbc_collision_bucket(grid, shape->cell_x, shape->cell_y);
+        grid->next[i] = grid->heads[bucket];
+        grid->heads[bucket] = i;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!kite_states->elements[i].is_active) {
+            continue;
+        }
+        Kite_Shape *a = &grid->shapes[i];
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int x = a->cell_x + dx;
+                int y = a->cell_y + dy;
+                for (size_t j = grid->heads[tkbc_collision_bucket(grid, x, y)]; j != SIZE_MAX; j = grid->next[j]) {
+                    Kite_Shape *b = &grid->shapes[j];
+                    // Different cells can share a bucket, every pair is just
+                    // compared from its lower index.
+                    if (j <= i || b->cell_x != x || b->cell_y != y) {
+                        continue;
+                    }
+                    if (a->bounds.x > b->bounds.x + b->bounds.width + near_distance ||
+                        b->bounds.x > a->bounds.x + a->bounds.width + near_distance ||
+                        a->bounds.y > b->bounds.y + b->bounds.height + near_distance ||
+                        b->bounds.y > a->bounds.y + a->bounds.height + near_distance) {
+                        continue;
+                    }
+
+                    float separation = tkbc_kite_shape_separation(a, b);
+                    if (separation <= near_distance) {
+                        Kite_Proximity proximity = {
+                            .kite_id_a = kite_states->elements[i].kite_id,
+                            .kite_id_b = kite_states->elements[j].kite_id,
+                            .separation = separation,
+                        };
+                        tkbc_dap(proximities, proximity);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief The function frees the memory of the given grid.
+ *
+ * @param grid The grid that should be destroyed.
+ */
+void tkbc_collision_grid_destroy(Collision_Grid *grid) {
+    free(grid->heads);
+    free(grid->next);
+    free(grid->shapes);
+    memset(grid, 0, sizeof(*grid));
+}
+
+/**
+ * @brief The function checks the current kites and draws the spacing of the
+ * close kites over them. Touching kites are outlined in red and close kites are
+ * connected with a line that is labeled with their distance.
+ *
+ * @param env The global state of the application.
+ */
+void tkbc_draw_collision_overlay(Env *env) {
+    tkbc_collision_check(&env->collision_grid, &env->kite_array, TKBC_COLLISION_NEAR_DISTANCE,
+                         &env->collision_proximities);
+
+    size_t contacts = 0;
+    for (size_t i = 0; i < env->collision_proximities.count; ++i) {
+        Kite_Proximity *proximity = &env->collision_proximities.elements[i];
+        Kite *a = tkbc_get_kite_by_id(env, proximity->kite_id_a);
+        Kite *b = tkbc_get_kite_by_id(env, proximity->kite_id_b);
+        if (a == NULL || b == NULL) {
+            continue;
+        }
+
+        if (proximity->separation == 0) {
+            contacts++;
+            Kite *kites[] = {a, b};
+            for (size_t k = 0; k < 2; ++k) {
+                Kite_Shape shape = {0};
+                tkbc_kite_shape(kites[k], &shape);
+                DrawTriangleLines(shape.left.v1, shape.left.v2, shape.left.v3, RED);
+                DrawTriangleLines(shape.right.v1, shape.right.v2, shape.right.v3, RED);
+                for (size_t e = 0; e < 4; ++e) {
+                    DrawLineEx(shape.leading_edge[e], shape.leading_edge[(e + 1) % 4], 2, RED);
+                }
+            }
+            DrawLineEx(a->center, b->center, 3, RED);
+        } else {
+            DrawLineEx(a->center, b->center, 2, ORANGE);
+            Vector2 middle = {.x = (a->center.x + b->center.x) / 2, .y = (a->center.y + b->center.y) / 2};
+            DrawText(TextFormat("%.0fpx", proximity->separation), middle.x, middle.y, 20, ORANGE);
+        }
+    }
+
+    const char *text = TextFormat("Contacts: %zu  Close pairs: %zu", contacts,
+                                  env->collision_proximities.count - contacts);
+    DrawText(text, 10, env->window_height - 30, 20, contacts ? RED : BLACK);
+}
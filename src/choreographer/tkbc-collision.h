@@ -0,0 +1,21 @@
+#ifndef TKBC_COLLISION_H_
+#define TKBC_COLLISION_H_
+
+#include "../global/tkbc-types.h"
+
+// ===========================================================================
+// ========================== Kite Collisions ================================
+// ===========================================================================
+
+// Kites that come closer than this distance in pixels are reported with their
+// separation, touching kites have a separation of 0.
+#define TKBC_COLLISION_NEAR_DISTANCE 40.0f
+
+void tkbc_kite_shape(Kite *kite, Kite_Shape *shape);
+float tkbc_kite_shape_separation(Kite_Shape *a, Kite_Shape *b);
+void tkbc_collision_check(Collision_Grid *grid, Kite_States *kite_states, float near_distance,
+                          Kite_Proximities *proximities);
+void tkbc_collision_grid_destroy(Collision_Grid *grid);
+void tkbc_draw_collision_overlay(Env *env);
+
+#endif  // TKBC_COLLISION_H_
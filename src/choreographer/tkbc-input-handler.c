@@ -576,6 +576,7 @@ void tkbc_input_check_tip_rotation_mouse_control(Key_Maps keymaps, Kite_State *s
 void tkbc_calculate_new_kite_position(Key_Maps keymaps, Kite_State *state) {
     // Movement corresponding to the mouse position.
     Kite *kite = state->kite;
+    tkbc_kite_materialize_geometry(kite);
     Vector2 mouse_pos = GetMousePosition();
     Vector2 face = {
         .x = kite->right.v3.x - kite->left.v1.x,
@@ -850,6 +851,7 @@ void tkbc_calcluate_and_update_face_mouse_angle(Kite_State *state) {
     }
 
     Kite *kite = state->kite;
+    tkbc_kite_materialize_geometry(kite);
     Vector2 face = {
         .x = kite->right.v3.x - kite->left.v1.x,
         .y = kite->right.v3.y - kite->left.v1.y,
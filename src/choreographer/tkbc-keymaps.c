@@ -31,25 +31,25 @@ int tkbc_load_keymaps_from_file(Key_Maps *keymaps, const char *filename) {
     Lexer *lexer = lexer_new(filename, content.elements, content.count, 0);
     Token t = lexer_next(lexer);
     while (t.kind != EOF_TOKEN && t.kind != INVALID) {
-        if (t.kind != NUMBER) {
+        int hash = 0;
+        if (t.kind != NUMBER || !tkbc_span_to_int(t.content, t.size, &hash)) {
             check_return(1);
         }
-        int hash = atoi(lexer_token_to_cstr(lexer, &t));
         t = lexer_next(lexer);
-        if (t.kind != NUMBER) {
+        int mod_key = 0;
+        if (t.kind != NUMBER || !tkbc_span_to_int(t.content, t.size, &mod_key)) {
             check_return(1);
         }
-        int mod_key = atoi(lexer_token_to_cstr(lexer, &t));
         t = lexer_next(lexer);
-        if (t.kind != NUMBER) {
+        int selection_key = 0;
+        if (t.kind != NUMBER || !tkbc_span_to_int(t.content, t.size, &selection_key)) {
             check_return(1);
         }
-        int selection_key = atoi(lexer_token_to_cstr(lexer, &t));
         t = lexer_next(lexer);
-        if (t.kind != NUMBER) {
+        int key = 0;
+        if (t.kind != NUMBER || !tkbc_span_to_int(t.content, t.size, &key)) {
             check_return(1);
         }
-        int key = atoi(lexer_token_to_cstr(lexer, &t));
         t = lexer_next(lexer);
 
         for (size_t i = 0; i < keymaps->count; ++i) {
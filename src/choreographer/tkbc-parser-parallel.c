@@ -0,0 +1,230 @@
+#include "tkbc-parser-parallel.h"
+#include "../global/tkbc-types.h"
+#include "../global/tkbc-utils.h"
+#include "tkbc-parser.h"
+#include "tkbc-script-api.h"
+#include "tkbc-script-baker.h"
+#include "tkbc-script-handler.h"
+#include "tkbc.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The sections of a .kite file only share the kites of the KITES declaration,
+// that are generated before the first section, and the macros that are defined
+// outside of the sections. The parsing of a section just reads them, so every
+// worker parses into its own env with a copy of the kites and the scripts are
+// merged in file order afterwards.
+
+typedef struct {
+    Env *env;                   // The env with the kites of the file.
+    Kite_Ids ki;                // The kites of the KITES declaration.
+    Kite_Macros macros;         // The macros that are defined before the sections.
+    const char *file_name;      // The name of the file that is used in the error messages.
+    Kite_Batch *batch;          // The sections that are parsed.
+    Id script_id_counter;       // The script id counter before the first section.
+    atomic_bool *script_kites;  // The kites that are used by a script, one per kite of the env.
+    atomic_size_t next;         // The index of the next section to parse.
+    pthread_mutex_t lock;       // The lock of the optimization counts of the env.
+} Kite_Batch_Job;               // The shared state of all parse workers.
+
+/**
+ * @brief The function copies the given section to the end of the batch.
+ *
+ * @param batch The batch where the section is added.
+ * @param section The content of the section from BEGIN to END.
+ * @param size The size of the section.
+ * @param line The line of the BEGIN in the file.
+ */
+void tkbc_kite_batch_add(Kite_Batch *batch, const char *section, size_t size, unsigned long long line) {
+    Kite_Batch_Section batch_section = {
+        .offset = batch->content.count,
+        .size = size,
+        .line = line,
+    };
+    tkbc_dapc(&batch->content, section, size);
+    tkbc_dap(&batch->sections, batch_section);
+}
+
+/**
+ * @brief The function frees the memory of the batch.
+ *
+ * @param batch The batch that is destroyed.
+ */
+void tkbc_kite_batch_destroy(Kite_Batch *batch) {
+    free(batch->content.elements);
+    free(batch->sections.elements);
+    memset(batch, 0, sizeof(*batch));
+}
+
+/**
+ * @brief The function is the entry point of a parse worker thread. It creates
+ * its own env with a copy of the kites and takes sections from the shared job
+ * until every section is parsed. The script id counter is set before every
+ * section, so the ids and default names are the same as in a sequential parse.
+ *
+ * @param arg The shared Kite_Batch_Job.
+ * @return Always NULL.
+ */
+static void *tkbc_kite_batch_worker(void *arg) {
+    Kite_Batch_Job *job = arg;
+    Env worker_env = {0};
+    worker_env.window_width = job->env->window_width;
+    worker_env.window_height = job->env->window_height;
+    worker_env.fps = job->env->fps;
+    // The team figures just read the dimensions of the default kite.
+    worker_env.vanilla_kite = job->env->vanilla_kite;
+
+    for (size_t i = 0; i < job->env->kite_array.count; ++i) {
+        Kite_State kite_state = job->env->kite_array.elements[i];
+        kite_state.kite = malloc(sizeof(*kite_state.kite));
+        if (kite_state.kite == NULL) {
+            tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+            abort();
+        }
+        memcpy(kite_state.kite, job->env->kite_array.elements[i].kite, sizeof(*kite_state.kite));
+        tkbc_dap(&worker_env.kite_array, kite_state);
+    }
+
+    for (;;) {
+        size_t i = atomic_fetch_add(&job->next, 1);
+        if (i >= job->batch->sections.count) {
+            break;
+        }
+        Kite_Batch_Section *section = &job->batch->sections.elements[i];
+        worker_env.script_id_counter = job->script_id_counter + i;
+
+        Kite_Parser parser = {.ki = job->ki, .line = section->line, .macros = job->macros};
+        tkbc_kite_parser_feed(&worker_env, &parser, job->file_name, job->batch->content.elements + section->offset,
+                              section->size, NULL, 0);
+        // The kites and the macros are owned by the parser of the file.
+        parser.ki = (Kite_Ids){0};
+        parser.macros = (Kite_Macros){0};
+        tkbc_kite_parser_finish(&worker_env, &parser);
+
+        if (worker_env.scripts.count > 0) {
+            section->script = worker_env.scripts.elements[--worker_env.scripts.count];
+            section->has_script = true;
+        }
+        for (size_t j = 0; j < worker_env.kite_diagnostics.count; ++j) {
+            tkbc_dap(&section->diagnostics, worker_env.kite_diagnostics.elements[j]);
+        }
+        worker_env.kite_diagnostics.count = 0;
+    }
+
+    pthread_mutex_lock(&job->lock);
+    Script_Optimization *optimization = &job->env->script_optimization;
+    optimization->scripts += worker_env.script_optimization.scripts;
+    optimization->blocks_before += worker_env.script_optimization.blocks_before;
+    optimization->blocks_after += worker_env.script_optimization.blocks_after;
+    optimization->frames_before += worker_env.script_optimization.frames_before;
+    optimization->frames_after += worker_env.script_optimization.frames_after;
+    pthread_mutex_unlock(&job->lock);
+
+    for (size_t i = 0; i < worker_env.kite_array.count; ++i) {
+        if (worker_env.kite_array.elements[i].is_script_kite) {
+            atomic_store(&job->script_kites[i], true);
+        }
+    }
+
+    tkbc_destroy_kite_array(&worker_env.kite_array);
+    free(worker_env.kite_diagnostics.elements);
+    free(worker_env.kite_id_map.slots);
+    space_free_space(&worker_env._id_space);
+    space_free_space(&worker_env.scratch_buf_script.space);
+    space_free_space(&worker_env._scripts_space);
+    return NULL;
+}
+
+/**
+ * @brief The function parses the sections of the batch on a pool of worker
+ * threads and adds their scripts to the env in file order. The result is the
+ * same as feeding the sections one after another to the parser, but the load
+ * time of large files scales with the amount of processors. The sections must
+ * not depend on each other, so the kites have to be generated before and
+ * there must be no tokens between the sections. The errors of the sections are
+ * added to the env in file order as well. The batch is empty afterwards and
+ * can be reused.
+ *
+ * @param env The global state of the application.
+ * @param parser The state of the parser of the file.
+ * @param file_name The name of the file that is used in the error messages.
+ * @param batch The sections that should be parsed.
+ * @param workers The amount of worker threads, 0 uses the processor count.
+ */
+void tkbc_kite_batch_parse(Env *env, Kite_Parser *parser, const char *file_name, Kite_Batch *batch,
+                           size_t workers) {
+    if (batch->sections.count == 0) {
+        return;
+    }
+    if (workers == 0) {
+        workers = tkbc_bake_default_workers();
+    }
+    if (workers > batch->sections.count) {
+        workers = batch->sections.count;
+    }
+
+    Kite_Batch_Job job = {
+        .env = env,
+        .ki = parser->ki,
+        .macros = parser->macros,
+        .file_name = file_name,
+        .batch = batch,
+        .script_id_counter = env->script_id_counter,
+        .script_kites = calloc(env->kite_array.count + 1, sizeof(*job.script_kites)),
+    };
+    atomic_init(&job.next, 0);
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_t *threads = calloc(workers, sizeof(*threads));
+    if (job.script_kites == NULL || threads == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+        abort();
+    }
+
+    size_t started = 0;
+    for (; started < workers && workers > 1; ++started) {
+        if (pthread_create(&threads[started], NULL, tkbc_kite_batch_worker, &job) != 0) {
+            tkbc_fprintf(stderr, "WARNING", "Could only start %zu parse workers.\n", started);
+            break;
+        }
+    }
+
+    // If no thread could be started the work is done on the calling thread.
+    if (started == 0) {
+        tkbc_kite_batch_worker(&job);
+    }
+    for (size_t i = 0; i < started; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&job.lock);
+
+    for (size_t i = 0; i < env->kite_array.count; ++i) {
+        if (atomic_load(&job.script_kites[i])) {
+            Kite_State *state = &env->kite_array.elements[i];
+            state->kite->old_angle = state->kite->angle;
+            state->kite->old_center = state->kite->center;
+            state->is_script_kite = true;
+        }
+    }
+    free(job.script_kites);
+
+    for (size_t i = 0; i < batch->sections.count; ++i) {
+        Kite_Batch_Section *section = &batch->sections.elements[i];
+        if (section->has_script) {
+            // The timeline was built when the worker added the script.
+            tkbc_add_built_script(env, section->script);
+            env->script_id_counter = section->script.script_id;
+        }
+        for (size_t j = 0; j < section->diagnostics.count; ++j) {
+            tkbc_dap(&env->kite_diagnostics, section->diagnostics.elements[j]);
+        }
+        free(section->diagnostics.elements);
+    }
+    parser->section_count += batch->sections.count;
+    batch->content.count = 0;
+    batch->sections.count = 0;
+}
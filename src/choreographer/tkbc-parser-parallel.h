@@ -0,0 +1,42 @@
+#ifndef TKBC_PARSER_PARALLEL_H_
+#define TKBC_PARSER_PARALLEL_H_
+
+#include "../global/tkbc-types.h"
+#include "../global/tkbc-utils.h"
+#include "tkbc-parser.h"
+
+// ===========================================================================
+// ========================== Parallel Parser ================================
+// ===========================================================================
+
+// The amount of section bytes that are collected before they are parsed on
+// the worker threads.
+#define TKBC_KITE_BATCH_SIZE (4 * 1024 * 1024)
+
+typedef struct {
+    size_t offset;                 // The start of the section in the content of the batch.
+    size_t size;                   // The size of the section.
+    unsigned long long line;       // The line of the BEGIN of the section in the file.
+    Script script;                 // The script that is parsed from the section.
+    bool has_script;               // True if the section has ended in a script.
+    Kite_Diagnostics diagnostics;  // The errors of the section.
+} Kite_Batch_Section;              // A BEGIN/END section that is parsed on a worker thread.
+
+typedef struct {
+    Kite_Batch_Section *elements;  // The dynamic array collection for Kite_Batch_Sections.
+    size_t count;                  // The amount of elements in the array.
+    size_t capacity;               // The complete allocated space for the array represented as
+                                   // the number of collection elements of the array type.
+} Kite_Batch_Sections;             // A dynamic array collection of the sections of a batch.
+
+typedef struct {
+    Content content;               // The copied sections of the batch.
+    Kite_Batch_Sections sections;  // The sections in file order.
+} Kite_Batch;                      // Independent sections of a .kite file that are parsed together.
+
+void tkbc_kite_batch_add(Kite_Batch *batch, const char *section, size_t size, unsigned long long line);
+void tkbc_kite_batch_parse(Env *env, Kite_Parser *parser, const char *file_name, Kite_Batch *batch,
+                           size_t workers);
+void tkbc_kite_batch_destroy(Kite_Batch *batch);
+
+#endif  // TKBC_PARSER_PARALLEL_H_
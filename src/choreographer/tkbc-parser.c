@@ -1,6 +1,9 @@
 #include "tkbc-parser.h"
+#include "tkbc-parser-parallel.h"
 #include "tkbc-script-api.h"
 #include "tkbc-team-figures-api.h"
+#include <pthread.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -12,36 +15,429 @@
 #include "../global/tkbc-types.h"
 #include "../global/tkbc-utils.h"
 
+/**
+ * @brief The function checks if the token is exactly the given keyword.
+ *
+ * @param t The token that is checked.
+ * @param keyword The keyword the token is compared to.
+ * @return True if the token is the keyword, otherwise false.
+ */
+static bool tkbc_token_is_keyword(Token *t, const char *keyword) {
+    return t->kind == IDENTIFIER && strlen(keyword) == t->size && strncmp(keyword, t->content, t->size) == 0;
+}
+
+/**
+ * @brief The function hashes a name with the given seed.
+ *
+ * @param seed The seed of the hash.
+ * @param name The name that is hashed.
+ * @param size The length of the name.
+ * @return The hash of the name.
+ */
+static uint32_t tkbc_perfect_hash_name(uint32_t seed, const char *name, size_t size) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= (unsigned char) name[i];
+        hash *= 16777619u;
+    }
+    // The upper bits are better mixed than the lower ones.
+    return hash ^ (hash >> 16);
+}
+
+/**
+ * @brief The function generates a perfect hash for the given names. The table
+ * is at least twice as large as the amount of names and the seeds are tried
+ * until every name lands in its own slot, so a lookup is one hash and one
+ * compare.
+ *
+ * @param hash The perfect hash that is generated.
+ * @param names The names that should be found, the index of a name is the
+ * result of the lookup.
+ * @param count The amount of names.
+ */
+void tkbc_perfect_hash_build(Perfect_Hash *hash, const char **names, size_t count) {
+    size_t slots = 16;
+    while (slots < 2 * count) {
+        slots *= 2;
+    }
+    assert(slots <= TKBC_PERFECT_HASH_SLOTS_MAX && count < UINT8_MAX);
+
+    for (uint32_t seed = 0;; ++seed) {
+        memset(hash->slots, 0, sizeof(hash->slots));
+        hash->seed = seed;
+        hash->mask = slots - 1;
+        size_t i = 0;
+        for (; i < count; ++i) {
+            size_t slot = tkbc_perfect_hash_name(seed, names[i], strlen(names[i])) & hash->mask;
+            if (hash->slots[slot] != 0) {
+                break;
+            }
+            hash->slots[slot] = i + 1;
+        }
+        if (i == count) {
+            return;
+        }
+        // A larger table is found faster if the names are hard to separate.
+        if (seed % 64 == 63 && slots < TKBC_PERFECT_HASH_SLOTS_MAX) {
+            slots *= 2;
+        }
+    }
+}
+
+/**
+ * @brief The function finds the index of the name that can be at the slot of
+ * the given name. The caller has to compare the name, because every other
+ * string maps to a slot as well.
+ *
+ * @param hash The perfect hash of the names.
+ * @param name The name that is looked up.
+ * @param size The length of the name.
+ * @return The index of the name that can match or SIZE_MAX if the slot is
+ * empty.
+ */
+size_t tkbc_perfect_hash_find(const Perfect_Hash *hash, const char *name, size_t size) {
+    uint8_t slot = hash->slots[tkbc_perfect_hash_name(hash->seed, name, size) & hash->mask];
+    if (slot == 0) {
+        return SIZE_MAX;
+    }
+    return slot - 1;
+}
+
+static const char *tkbc_kite_keyword_names[KITE_KEYWORD_COUNT] = {
+    [KITE_KEYWORD_NONE] = "",
+    [KITE_KEYWORD_EXTERN] = "EXTERN",
+    [KITE_KEYWORD_BEGIN] = "BEGIN",
+    [KITE_KEYWORD_END] = "END",
+    [KITE_KEYWORD_KITES] = "KITES",
+    [KITE_KEYWORD_MOVE] = "MOVE",
+    [KITE_KEYWORD_MOVE_ADD] = "MOVE_ADD",
+    [KITE_KEYWORD_ROTATION] = "ROTATION",
+    [KITE_KEYWORD_ROTATION_ADD] = "ROTATION_ADD",
+    [KITE_KEYWORD_TIP_ROTATION] = "TIP_ROTATION",
+    [KITE_KEYWORD_TIP_ROTATION_ADD] = "TIP_ROTATION_ADD",
+    [KITE_KEYWORD_ARC] = "ARC",
+    [KITE_KEYWORD_BEZIER] = "BEZIER",
+    [KITE_KEYWORD_CATMULL_ROM] = "CATMULL_ROM",
+    [KITE_KEYWORD_WAIT] = "WAIT",
+    [KITE_KEYWORD_QUIT] = "QUIT",
+    [KITE_KEYWORD_REPEAT] = "REPEAT",
+    [KITE_KEYWORD_FOR] = "FOR",
+    [KITE_KEYWORD_IN] = "IN",
+    [KITE_KEYWORD_DEFINE] = "DEFINE",
+};
+
+static Perfect_Hash tkbc_kite_keyword_hash;
+static pthread_once_t tkbc_kite_keyword_hash_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief The function generates the perfect hash of the .kite keywords.
+ */
+static void tkbc_kite_keyword_hash_init(void) {
+    tkbc_perfect_hash_build(&tkbc_kite_keyword_hash, tkbc_kite_keyword_names, KITE_KEYWORD_COUNT);
+}
+
+/**
+ * @brief The function maps the content of an identifier to its keyword.
+ *
+ * @param content The content of the identifier.
+ * @param size The length of the content.
+ * @return The keyword or KITE_KEYWORD_NONE if the identifier is no keyword.
+ */
+Kite_Keyword tkbc_kite_keyword(const char *content, size_t size) {
+    pthread_once(&tkbc_kite_keyword_hash_once, tkbc_kite_keyword_hash_init);
+    size_t index = tkbc_perfect_hash_find(&tkbc_kite_keyword_hash, content, size);
+    if (index >= KITE_KEYWORD_COUNT || size == 0) {
+        return KITE_KEYWORD_NONE;
+    }
+    const char *name = tkbc_kite_keyword_names[index];
+    if (strlen(name) != size || strncmp(name, content, size) != 0) {
+        return KITE_KEYWORD_NONE;
+    }
+    return (Kite_Keyword) index;
+}
+
+/**
+ * @brief The function reports an error in a .kite file. The error is printed
+ * and collected in the env, so the parser can continue with the next statement
+ * and every error of the file is known after the parsing.
+ *
+ * @param env The env that represents the global state of the application.
+ * @param file_name The name of the file with the error.
+ * @param line The line of the error.
+ * @param column The column of the error or 0 if the column is not known.
+ * @param fmt The format of the message.
+ */
+void tkbc_kite_diagnostic(Env *env, const char *file_name, unsigned long long line, unsigned long long column,
+                          const char *fmt, ...) {
+    char location[64];
+    if (column > 0) {
+        snprintf(location, sizeof(location), ":%llu:%llu: ", line, column);
+    } else {
+        snprintf(location, sizeof(location), ":%llu: ", line);
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    int size = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+    size_t prefix = strlen(file_name) + strlen(location);
+    char *message = malloc(prefix + size + 1);
+    if (size < 0 || message == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+        abort();
+    }
+    snprintf(message, prefix + 1, "%s%s", file_name, location);
+    va_start(args, fmt);
+    vsnprintf(message + prefix, size + 1, fmt, args);
+    va_end(args);
+
+    tkbc_fprintf(stderr, "ERROR", "%s\n", message);
+    Kite_Diagnostic diagnostic = {.message = message, .line = line, .column = column};
+    tkbc_dap(&env->kite_diagnostics, diagnostic);
+}
+
+/**
+ * @brief The function removes the collected errors, the memory of the array
+ * is kept for the next file.
+ *
+ * @param diagnostics The errors that are removed.
+ */
+void tkbc_kite_diagnostics_clear(Kite_Diagnostics *diagnostics) {
+    for (size_t i = 0; i < diagnostics->count; ++i) {
+        free(diagnostics->elements[i].message);
+    }
+    diagnostics->count = 0;
+}
+
+/**
+ * @brief The function frees the memory of the collected errors.
+ *
+ * @param diagnostics The errors that are destroyed.
+ */
+void tkbc_kite_diagnostics_destroy(Kite_Diagnostics *diagnostics) {
+    tkbc_kite_diagnostics_clear(diagnostics);
+    free(diagnostics->elements);
+    memset(diagnostics, 0, sizeof(*diagnostics));
+}
+
+/**
+ * @brief The function checks if a statement can start at the token. After an
+ * error the parser skips the tokens up to the next statement.
+ *
+ * @param parser The state of the parser with the defined macros.
+ * @param t The token that is checked.
+ * @return True if the token is a keyword that starts a statement, a macro call
+ * or a brace, otherwise false.
+ */
+static bool tkbc_kite_token_starts_statement(Kite_Parser *parser, Token *t) {
+    if (t->kind == PUNCT_LBRACE || t->kind == PUNCT_RBRACE) {
+        return true;
+    }
+    if (t->kind != IDENTIFIER) {
+        return false;
+    }
+    switch (tkbc_kite_keyword(t->content, t->size)) {
+    case KITE_KEYWORD_NONE: return tkbc_find_macro(parser, t->content, t->size) != NULL;
+    case KITE_KEYWORD_KITES:
+    case KITE_KEYWORD_IN: return false;
+    default: return true;
+    }
+}
+
+/**
+ * @brief The function checks if the token can not be part of any statement,
+ * so it is an error even in the tokens that are skipped after an error.
+ *
+ * @param t The token that is checked.
+ * @return True if the lexer could not read the token or the token is a
+ * character that has no meaning in a .kite file, otherwise false.
+ */
+static bool tkbc_kite_token_is_broken(Token *t) {
+    switch (t->kind) {
+    case ERROR:
+    case INVALID:
+    case ASCII_LOW:
+    case ANSI_HIGH:
+    case ASCII_DOLLAR:
+    case ASCII_AT:
+    case ASCII_BACKTICK:
+    case ASCII_DEL: return true;
+    default: return false;
+    }
+}
+
+/**
+ * @brief The function reads the last token of the lexer again, so the token
+ * that broke a statement can be reported. The position of the lexer is kept.
+ *
+ * @param l The lexer that holds the content.
+ * @return The last token that was read by the lexer.
+ */
+static Token tkbc_kite_last_token(Lexer *l) {
+    size_t position = l->position;
+    size_t line_count = l->line_count;
+    size_t column_count = l->column_count;
+    unsigned char *line_start = l->line_start;
+
+    l->position = l->next_start_position;
+    Token t = lexer_next(l);
+
+    l->position = position;
+    l->line_count = line_count;
+    l->column_count = column_count;
+    l->line_start = line_start;
+    return t;
+}
+
 /**
  * @brief The function parses the script that is currently represented by the
  * filename in env->script_file_name.
  *
  * @param env The env that represents the global state of the application.
  */
-void tkbc_script_parser(Env *env) {
-    Content tmp_buffer = {0};
-    Content script_file_content = {0};
-    long err = tkbc_read_entire_file(env->script_file_name, &script_file_content);
-    if (err == -1) {
-        // This is needed because reading can allocate some of the memory of the
-        // content and then fail.
-        free(script_file_content.elements);
+void tkbc_script_parser(Env *env) { tkbc_script_parser_file(env, env->script_file_name, 0); }
+
+/**
+ * @brief The function counts the lines breaks in the given content.
+ *
+ * @param content The content that is counted.
+ * @param size The size of the content.
+ * @return The amount of line breaks.
+ */
+static unsigned long long tkbc_count_lines(const char *content, size_t size) {
+    unsigned long long lines = 0;
+    for (const char *p = content; (p = memchr(p, '\n', content + size - p)) != NULL; ++p) {
+        lines++;
+    }
+    return lines;
+}
+
+/**
+ * @brief The function parses the given .kite file while it is read in chunks.
+ * Every BEGIN/END section is parsed and added as a script as soon as its END
+ * is read, so just the largest section has to fit into memory and not the
+ * whole file. The sections after the KITES declaration that have no tokens in
+ * between are independent of each other, they are collected into batches that
+ * are parsed on worker threads. The parser continues after an error and the
+ * errors of the file are collected in env->kite_diagnostics in file order.
+ *
+ * @param env The env that represents the global state of the application.
+ * @param file_name The path of the .kite file.
+ * @param workers The amount of parse worker threads, 0 uses the processor
+ * count and 1 parses everything on the calling thread.
+ * @return True if the file could be opened, otherwise false.
+ */
+bool tkbc_script_parser_file(Env *env, const char *file_name, size_t workers) {
+    Kite_Stream stream = {0};
+    if (!tkbc_kite_stream_open(&stream, file_name, TKBC_KITE_STREAM_CHUNK)) {
+        return false;
+    }
+    tkbc_kite_diagnostics_clear(&env->kite_diagnostics);
+
+    Kite_Parser parser = {0};
+    Kite_Batch batch = {0};
+    unsigned long long line = 1;
+    char *piece = NULL;
+    size_t size = 0;
+    while (tkbc_kite_stream_next(&stream, &piece, &size)) {
+        bool independent = workers != 1 && stream.section_ended && !stream.has_prelude && parser.ki.count > 0 &&
+                           !parser.script_begin && !parser.brace;
+        if (independent) {
+            char *section = piece + stream.section_start;
+            tkbc_kite_batch_add(&batch, section, size - stream.section_start,
+                                line + tkbc_count_lines(piece, stream.section_start));
+            if (batch.content.count >= TKBC_KITE_BATCH_SIZE) {
+                tkbc_kite_batch_parse(env, &parser, file_name, &batch, workers);
+            }
+        } else {
+            tkbc_kite_batch_parse(env, &parser, file_name, &batch, workers);
+            parser.line = line;
+            tkbc_kite_parser_feed(env, &parser, file_name, piece, size, NULL, 0);
+        }
+        line += tkbc_count_lines(piece, size);
+    }
+    tkbc_kite_batch_parse(env, &parser, file_name, &batch, workers);
+    tkbc_kite_batch_destroy(&batch);
+    tkbc_kite_parser_finish(env, &parser);
+    tkbc_kite_stream_close(&stream);
+    return true;
+}
+
+/**
+ * @brief The function parses the given content of a .kite file. The BEGIN/END
+ * sections can be selected by their order in the file, the other sections are
+ * skipped without generating their frames. Everything outside of the sections
+ * is always parsed, so the kites are known to every section. The errors of
+ * the content are collected in env->kite_diagnostics.
+ *
+ * @param env The env that represents the global state of the application.
+ * @param file_name The name of the file that is used in the error messages.
+ * @param content The content of the .kite file.
+ * @param size The size of the content.
+ * @param selected The sections that should be parsed or NULL for all.
+ * @param selected_count The amount of entries in selected.
+ */
+void tkbc_script_parser_content(Env *env, const char *file_name, char *content, size_t size, const bool *selected,
+                                size_t selected_count) {
+    tkbc_kite_diagnostics_clear(&env->kite_diagnostics);
+    Kite_Parser parser = {0};
+    tkbc_kite_parser_feed(env, &parser, file_name, content, size, selected, selected_count);
+    tkbc_kite_parser_finish(env, &parser);
+}
+
+/**
+ * @brief The function parses the next piece of a .kite file. The state that
+ * reaches over the pieces, like the generated kites and the open script, is
+ * kept in the parser, so a file can be parsed piece by piece as long as no
+ * token is split between two pieces. The sections are selected in the same
+ * way as in tkbc_script_parser_content().
+ *
+ * @param env The env that represents the global state of the application.
+ * @param parser The state of the parser from the previous pieces.
+ * @param file_name The name of the file that is used in the error messages.
+ * @param content The next piece of the .kite file.
+ * @param size The size of the piece.
+ * @param selected The sections that should be parsed or NULL for all.
+ * @param selected_count The amount of entries in selected.
+ */
+void tkbc_kite_parser_feed(Env *env, Kite_Parser *parser, const char *file_name, char *content, size_t size,
+                           const bool *selected, size_t selected_count) {
+    if (size == 0) {
         return;
     }
-    Lexer *l = lexer_new(env->script_file_name, script_file_content.elements, script_file_content.count, 0);
+    Lexer *l = lexer_new(file_name, content, size, 0);
+    if (parser->line > 0) {
+        l->line_count = parser->line;
+    }
+    parser->file_name = file_name;
 
-    bool script_begin = false;
-    bool brace = false;
-    Kite_Ids ki = {0};
+    Kite_Ids ki = parser->ki;
+    size_t section_count = parser->section_count;
+    bool script_begin = parser->script_begin;
+    bool brace = parser->brace;
     Frames *frames = &env->scratch_buf_frames;
     Frame *frame = NULL;
+    // After an error the tokens up to the next statement are skipped.
+    bool recovering = false;
 
     for (Token t = lexer_next(l); t.kind != EOF_TOKEN; t = lexer_next(l)) {
+        if (recovering && !tkbc_kite_token_starts_statement(parser, &t)) {
+            // A broken token is reported even if it is skipped.
+            if (tkbc_kite_token_is_broken(&t)) {
+                tkbc_kite_diagnostic(env, l->file_name, l->line_count, l->column_count, "invalid token: %s",
+                                     lexer_token_to_cstr(l, &t));
+            }
+            continue;
+        }
+        recovering = false;
+        size_t reported = env->kite_diagnostics.count;
+        Token statement = t;
         switch (t.kind) {
         case PREPROCESSING:
         case COMMENT: break;
         case IDENTIFIER: {
-            if (strncmp("EXTERN", t.content, t.size) == 0) {
+            switch (tkbc_kite_keyword(t.content, t.size)) {
+            case KITE_KEYWORD_EXTERN: {
                 bool ok = true;
                 t = lexer_next(l);
                 if (t.kind != IDENTIFIER) {
@@ -54,7 +450,7 @@ void tkbc_script_parser(Env *env) {
                 if (!tkbc_parse_kis_after_generation(env, l, &kis, ki)) {
                     check_return(false);
                 }
-                if (!tkbc_parse_team_figures(env, kis, l, function_name, &tmp_buffer)) {
+                if (!tkbc_parse_team_figures(env, kis, l, function_name)) {
                     check_return(false);
                 }
 
@@ -70,23 +466,53 @@ void tkbc_script_parser(Env *env) {
                     goto err;
                 }
                 break;
-            } else if (strncmp("BEGIN", t.content, t.size) == 0) {
+            }
+            case KITE_KEYWORD_BEGIN: {
+                if (script_begin) {
+                    tkbc_kite_diagnostic(env, l->file_name, l->line_count, l->column_count,
+                                         "the section before has no END");
+                    if (brace) {
+                        tkbc_register_frames_array(env, frames);
+                        brace = false;
+                    }
+                    tkbc__script_end(env);
+                    script_begin = false;
+                }
+                size_t section = section_count++;
+                if (selected && (section >= selected_count || !selected[section])) {
+                    do {
+                        t = lexer_next(l);
+                    } while (t.kind != EOF_TOKEN && !tkbc_token_is_keyword(&t, "END"));
+                    break;
+                }
                 script_begin = true;
                 tkbc_script_begin();
 
                 break;
-            } else if (strncmp("END", t.content, t.size) == 0) {
+            }
+            case KITE_KEYWORD_END: {
+                if (!script_begin) {
+                    tkbc_kite_diagnostic(env, l->file_name, l->line_count, l->column_count, "END without a BEGIN");
+                    break;
+                }
+                if (brace) {
+                    tkbc_kite_diagnostic(env, l->file_name, l->line_count, l->column_count,
+                                         "the frame block before END is not closed");
+                    tkbc_register_frames_array(env, frames);
+                    brace = false;
+                }
                 tkbc__script_end(env);
                 script_begin = false;
                 break;
-            } else if (strncmp("KITES", t.content, t.size) == 0) {
+            }
+            case KITE_KEYWORD_KITES: {
                 if (ki.count > 0) {
                     break;
                 }
 
                 t = lexer_next(l);
-                if (t.kind == NUMBER) {
-                    size_t kite_number = strtoul(lexer_token_to_cstr(l, &t), NULL, 10);
+                size_t kite_number = 0;
+                if (t.kind == NUMBER && tkbc_span_to_size_t(t.content, t.size, &kite_number)) {
                     if (env->kite_array.count >= kite_number) {
                         ki = tkbc_indexs_generate(kite_number);
                         for (size_t i = 0; i < ki.count; ++i) {
@@ -98,39 +524,67 @@ void tkbc_script_parser(Env *env) {
                     ki = tkbc_kite_array_generate(env, kite_number);
                 }
                 break;
-            } else if (strncmp("MOVE", t.content, t.size) == 0) {
-                if (!tkbc_parse_move(env, l, ACTION_KITE_MOVE, ki, brace, &tmp_buffer)) {
+            }
+            case KITE_KEYWORD_MOVE: {
+                if (!tkbc_parse_move(env, l, ACTION_KITE_MOVE, ki, brace)) {
+                    goto err;
+                }
+                break;
+            }
+            case KITE_KEYWORD_MOVE_ADD: {
+                if (!tkbc_parse_move(env, l, ACTION_KITE_MOVE_ADD, ki, brace)) {
+                    goto err;
+                }
+                break;
+            }
+            case KITE_KEYWORD_ROTATION: {
+                if (!tkbc_parse_rotation(env, l, ACTION_KITE_ROTATION, ki, brace)) {
+                    goto err;
+                }
+                break;
+            }
+            case KITE_KEYWORD_ROTATION_ADD: {
+                if (!tkbc_parse_rotation(env, l, ACTION_KITE_ROTATION_ADD, ki, brace)) {
                     goto err;
                 }
                 break;
-            } else if (strncmp("MOVE_ADD", t.content, t.size) == 0) {
-                if (!tkbc_parse_move(env, l, ACTION_KITE_MOVE_ADD, ki, brace, &tmp_buffer)) {
+            }
+            case KITE_KEYWORD_TIP_ROTATION: {
+                if (!tkbc_parse_tip_rotation(env, l, ACTION_KITE_TIP_ROTATION, ki, brace)) {
                     goto err;
                 }
                 break;
-            } else if (strncmp("ROTATION", t.content, t.size) == 0) {
-                if (!tkbc_parse_rotation(env, l, ACTION_KITE_ROTATION, ki, brace, &tmp_buffer)) {
+            }
+            case KITE_KEYWORD_TIP_ROTATION_ADD: {
+                if (!tkbc_parse_tip_rotation(env, l, ACTION_KITE_TIP_ROTATION_ADD, ki, brace)) {
                     goto err;
                 }
                 break;
-            } else if (strncmp("ROTATION_ADD", t.content, t.size) == 0) {
-                if (!tkbc_parse_rotation(env, l, ACTION_KITE_ROTATION_ADD, ki, brace, &tmp_buffer)) {
+            }
+            case KITE_KEYWORD_ARC: {
+                if (!tkbc_parse_arc(env, l, ki, brace)) {
                     goto err;
                 }
                 break;
-            } else if (strncmp("TIP_ROTATION", t.content, t.size) == 0) {
-                if (!tkbc_parse_tip_rotation(env, l, ACTION_KITE_TIP_ROTATION, ki, brace, &tmp_buffer)) {
+            }
+            case KITE_KEYWORD_BEZIER: {
+                if (!tkbc_parse_spline(env, l, ACTION_KITE_BEZIER, ki, brace)) {
                     goto err;
                 }
                 break;
-            } else if (strncmp("TIP_ROTATION_ADD", t.content, t.size) == 0) {
-                if (!tkbc_parse_tip_rotation(env, l, ACTION_KITE_TIP_ROTATION_ADD, ki, brace, &tmp_buffer)) {
+            }
+            case KITE_KEYWORD_CATMULL_ROM: {
+                if (!tkbc_parse_spline(env, l, ACTION_KITE_CATMULL_ROM, ki, brace)) {
                     goto err;
                 }
                 break;
-            } else if (strncmp("WAIT", t.content, t.size) == 0) {
+            }
+            case KITE_KEYWORD_WAIT: {
                 t = lexer_next(l);
-                float duration = atof(lexer_token_to_cstr(l, &t));
+                float duration = 0;
+                if (t.kind != NUMBER || !tkbc_span_to_float(t.content, t.size, &duration)) {
+                    goto err;
+                }
 
                 if (brace) {
                     frame = KITE_WAIT(duration);
@@ -139,9 +593,13 @@ void tkbc_script_parser(Env *env) {
                     SET(KITE_WAIT(duration));
                 }
                 break;
-            } else if (strncmp("QUIT", t.content, t.size) == 0) {
+            }
+            case KITE_KEYWORD_QUIT: {
                 t = lexer_next(l);
-                float duration = atof(lexer_token_to_cstr(l, &t));
+                float duration = 0;
+                if (t.kind != NUMBER || !tkbc_span_to_float(t.content, t.size, &duration)) {
+                    goto err;
+                }
                 if (brace) {
                     frame = KITE_QUIT(duration);
                     space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
@@ -150,8 +608,28 @@ void tkbc_script_parser(Env *env) {
                 }
                 break;
             }
-
-            goto err;
+            case KITE_KEYWORD_REPEAT:
+            case KITE_KEYWORD_FOR:
+            case KITE_KEYWORD_DEFINE:
+            case KITE_KEYWORD_NONE: {
+                // The expansions are parsed by nested feeds that work on the
+                // state of the parser and not on the local copies.
+                parser->ki = ki;
+                parser->section_count = section_count;
+                parser->script_begin = script_begin;
+                parser->brace = brace;
+                bool ok = tkbc_parse_expansion(env, parser, l, &t);
+                ki = parser->ki;
+                section_count = parser->section_count;
+                script_begin = parser->script_begin;
+                brace = parser->brace;
+                if (!ok) {
+                    goto err;
+                }
+                break;
+            }
+            default: goto err;
+            }
         } break;
 
         case PUNCT_LBRACE: {
@@ -172,86 +650,755 @@ void tkbc_script_parser(Env *env) {
         err:
         case ERROR:
         case INVALID:
-        default:
-            tkbc_fprintf(stderr, "ERROR", "%s:%llu:%llu: invalid token: %s\n", l->file_name, l->line_count,
-                         l->column_count, lexer_token_to_cstr(l, &t));
+        default: {
+            // The last token that was read is the one that broke the statement.
+            Token last = tkbc_kite_last_token(l);
+            bool inside = last.kind != EOF_TOKEN && last.content != statement.content;
+            // The error can already be reported by the statement itself.
+            if (env->kite_diagnostics.count == reported) {
+                if (last.kind == EOF_TOKEN) {
+                    tkbc_kite_diagnostic(env, l->file_name, l->line_count, l->column_count,
+                                         "the statement %.*s is not complete", (int)statement.size,
+                                         statement.content);
+                } else if (inside) {
+                    tkbc_kite_diagnostic(env, l->file_name, l->line_count, l->column_count,
+                                         "invalid token in %.*s: %s", (int)statement.size, statement.content,
+                                         lexer_token_to_cstr(l, &last));
+                } else {
+                    tkbc_kite_diagnostic(env, l->file_name, l->line_count, l->column_count, "invalid token: %s",
+                                         lexer_token_to_cstr(l, &last));
+                }
+            }
+            // A statement that starts in the broken one is parsed again, so its
+            // errors are reported as well.
+            if (inside && tkbc_kite_token_starts_statement(parser, &last)) {
+                l->position = l->next_start_position;
+            } else {
+                recovering = true;
+            }
+        } break;
         }
     }
 
-    if (script_begin) {
-        tkbc_fprintf(stderr, "ERROR", "Script END is not defined.");
-        tkbc__script_end(env);
-    }
+    parser->ki = ki;
+    parser->section_count = section_count;
+    parser->script_begin = script_begin;
+    parser->brace = brace;
+    parser->line = l->line_count;
 
+    // The content is owned by the caller and not by the lexer.
+    l->content = NULL;
     lexer_del(l);
-    if (tmp_buffer.elements) free(tmp_buffer.elements);
-    tmp_buffer.elements = NULL;
-    if (ki.elements) free(ki.elements);
+}
+
+/**
+ * @brief The function ends the parsing of a .kite file after the last piece
+ * and releases the state of the parser. An open frame block or section is
+ * reported and closed, so the parsed frames are kept.
+ *
+ * @param env The env that represents the global state of the application.
+ * @param parser The state of the parser that is reset.
+ */
+void tkbc_kite_parser_finish(Env *env, Kite_Parser *parser) {
+    if (parser->brace) {
+        tkbc_kite_diagnostic(env, parser->file_name, parser->line, 0, "the frame block is not closed");
+        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+    }
+    if (parser->script_begin) {
+        tkbc_kite_diagnostic(env, parser->file_name, parser->line, 0, "the section has no END");
+        tkbc__script_end(env);
+    }
 
     // TODO: use maybe a space allocation in here
-    ki.elements = NULL;
+    if (parser->ki.elements) free(parser->ki.elements);
+    tkbc_kite_macros_destroy(&parser->macros);
+    memset(parser, 0, sizeof(*parser));
 }
 
 /**
- * @brief The function can be used to check if every element in the given
- * kite indies is part of the current registered kites.
+ * @brief The function parses the given body at the current state of the
+ * parser, like it would be written at the place of the expansion.
  *
- * @param env The global state of the application.
- * @param kis The kite indies that should be check against the existing kites.
- * @return True if the given kite indies are valid, otherwise false.
+ * @param env The env that represents the global state of the application.
+ * @param parser The state of the parser.
+ * @param file_name The name of the file that is used in the error messages.
+ * @param body The content that is parsed.
+ * @param size The size of the body.
+ * @param line The line of the body in the file.
+ * @return True if the body could be expanded, false if the expansions are
+ * nested too deep.
  */
-bool tkbc_parsed_kis_is_in_env(Env *env, Index index) {
-    for (size_t i = 0; i < env->kite_array.count; ++i) {
-        if (env->kite_array.elements[i].kite_id == index) {
-            return true;
-        }
+static bool tkbc_kite_parser_expand(Env *env, Kite_Parser *parser, const char *file_name, char *body, size_t size,
+                                    unsigned long long line) {
+    if (parser->depth >= TKBC_KITE_EXPANSION_DEPTH_MAX) {
+        tkbc_kite_diagnostic(env, file_name, line, 0, "the expansions are nested deeper than %d levels",
+                             TKBC_KITE_EXPANSION_DEPTH_MAX);
+        return false;
     }
-    return false;
+    parser->line = line;
+    parser->depth++;
+    tkbc_kite_parser_feed(env, parser, file_name, body, size, NULL, 0);
+    parser->depth--;
+    return true;
 }
 
 /**
- * @brief The function parses the kite ids and unions them with the given
- * orig_kis that are then placed into dest_kis.
+ * @brief The function copies the body into the expansion and replaces every
+ * identifier that is one of the names with the value at the same index.
+ * Everything else, including the line breaks, is kept, so the lines in the
+ * error messages stay the same.
  *
- * @param env The global state of the application.
- * @param lexer The data to parse should be located in her.
- * @param dest_kis The out parameter contains the union of the parsed and
- * already existing kis.
- * @param orig_kis The already generated and existing kis.
- * @return True if the merging has worked, false if there are no kites
- * generated yet but the KITES keyword is used or if a to high id was
- * specified in the script that is not generated, or if an parser error
- * occurred.
+ * @param expansion The content that is overwritten with the expanded body.
+ * @param file_name The name of the file that is used in the error messages.
+ * @param body The body that is expanded.
+ * @param names The names that are replaced.
+ * @param values The values of the names in the same order.
  */
-bool tkbc_parse_kis_after_generation(Env *env, Lexer *lexer, Kite_Ids *dest_kis, Kite_Ids orig_kis) {
-
-    Token t = lexer_next(lexer);
-    if (strncmp("KITES", t.content, t.size) == 0) {
-        if (orig_kis.count == 0) {
-            return false;
-        }
-        for (size_t i = 0; i < orig_kis.count; ++i) {
-            tkbc_dap(dest_kis, orig_kis.elements[i]);
+static void tkbc_kite_substitute(Content *expansion, const char *file_name, const Token *body,
+                                 const Kite_Tokens *names, const Token *values) {
+    expansion->count = 0;
+    Lexer *l = lexer_new(file_name, (char *)body->content, body->size, 0);
+    const char *copied = body->content;
+    for (Token t = lexer_next(l); t.kind != EOF_TOKEN; t = lexer_next(l)) {
+        if (t.kind != IDENTIFIER) {
+            continue;
+        }
+        for (size_t i = 0; i < names->count; ++i) {
+            Token *name = &names->elements[i];
+            if (name->size == t.size && strncmp(name->content, t.content, t.size) == 0) {
+                size_t size = t.content - copied;
+                tkbc_dapc(expansion, copied, size);
+                tkbc_dapc(expansion, values[i].content, values[i].size);
+                copied = t.content + t.size;
+                break;
+            }
         }
+    }
+    size_t size = body->content + body->size - copied;
+    tkbc_dapc(expansion, copied, size);
+    l->content = NULL;
+    lexer_del(l);
+}
 
-    } else if (t.kind == PUNCT_LPAREN) {
-        t = lexer_next(lexer);
-        while (t.kind == NUMBER) {
-            int number = atoi(lexer_token_to_cstr(lexer, &t));
-            tkbc_dap(dest_kis, number);
-            if (!tkbc_parsed_kis_is_in_env(env, number)) {
-                tkbc_fprintf(stderr, NULL, "%s:%llu:%llu: the given kites in the listing are invalid\n",
-                             lexer->file_name, lexer->line_count, lexer->column_count);
+/**
+ * @brief The function parses a list of arguments in parentheses. An argument
+ * is a number with an optional sign or an identifier, like LEFT or a name.
+ *
+ * @param lexer The parsing state of the .kite script.
+ * @param args The arguments that are appended, a signed number is one token.
+ * @return True if the list could be parsed, otherwise false.
+ */
+static bool tkbc_parse_macro_args(Lexer *lexer, Kite_Tokens *args) {
+    Token t = lexer_next(lexer);
+    if (t.kind != PUNCT_LPAREN) {
+        return false;
+    }
+    for (t = lexer_next(lexer); t.kind != PUNCT_RPAREN; t = lexer_next(lexer)) {
+        Token arg = t;
+        if (t.kind == PUNCT_SUB || t.kind == PUNCT_ADD) {
+            t = lexer_next(lexer);
+            if (t.kind != NUMBER) {
                 return false;
             }
-            t = lexer_next(lexer);
+            arg.kind = NUMBER;
+            arg.size = t.content + t.size - arg.content;
+        } else if (t.kind != NUMBER && t.kind != IDENTIFIER) {
+            return false;
         }
+        tkbc_dap(args, arg);
+    }
+    return true;
+}
 
-        if (t.kind != PUNCT_RPAREN) {
+/**
+ * @brief The function parses a block in braces, the braces inside of the block
+ * are frame blocks or nested expansions. A block can not start or end a
+ * section.
+ *
+ * @param lexer The parsing state of the .kite script.
+ * @param body The content between the outer braces.
+ * @param line The line the body starts at.
+ * @return True if the block could be parsed, otherwise false.
+ */
+static bool tkbc_parse_block_body(Lexer *lexer, Token *body, unsigned long long *line) {
+    Token t = lexer_next(lexer);
+    if (t.kind != PUNCT_LBRACE) {
+        return false;
+    }
+    *line = lexer->line_count;
+    body->content = (char *)lexer->content + lexer->position;
+
+    size_t depth = 1;
+    for (t = lexer_next(lexer); t.kind != EOF_TOKEN; t = lexer_next(lexer)) {
+        Kite_Keyword keyword = t.kind == IDENTIFIER ? tkbc_kite_keyword(t.content, t.size) : KITE_KEYWORD_NONE;
+        if (keyword == KITE_KEYWORD_BEGIN || keyword == KITE_KEYWORD_END || keyword == KITE_KEYWORD_DEFINE) {
             return false;
         }
+        if (t.kind == PUNCT_LBRACE) {
+            depth++;
+        }
+        if (t.kind == PUNCT_RBRACE && --depth == 0) {
+            body->size = t.content - body->content;
+            return true;
+        }
+    }
+    return false;
+}
 
-    } else {
+/**
+ * @brief The function parses a REPEAT block and expands its body the given
+ * amount of times.
+ *
+ * @param env The global state of the application.
+ * @param parser The state of the parser.
+ * @param lexer The parsing state of the .kite script after the REPEAT.
+ * @return True if the block could be parsed, otherwise false.
+ */
+bool tkbc_parse_repeat(Env *env, Kite_Parser *parser, Lexer *lexer) {
+    Token t = lexer_next(lexer);
+    size_t count = 0;
+    if (t.kind != NUMBER || !tkbc_span_to_size_t(t.content, t.size, &count)) {
+        return false;
+    }
+    Token body = {0};
+    unsigned long long line = 0;
+    if (!tkbc_parse_block_body(lexer, &body, &line)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!tkbc_kite_parser_expand(env, parser, lexer->file_name, (char *)body.content, body.size, line)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief The function parses a FOR block and expands its body once for every
+ * value in the list, the name is replaced by the value.
+ *
+ * @param env The global state of the application.
+ * @param parser The state of the parser.
+ * @param lexer The parsing state of the .kite script after the FOR.
+ * @return True if the block could be parsed, otherwise false.
+ */
+bool tkbc_parse_for(Env *env, Kite_Parser *parser, Lexer *lexer) {
+    Token name = lexer_next(lexer);
+    if (name.kind != IDENTIFIER || tkbc_kite_keyword(name.content, name.size) != KITE_KEYWORD_NONE) {
+        return false;
+    }
+    Token t = lexer_next(lexer);
+    if (tkbc_kite_keyword(t.content, t.size) != KITE_KEYWORD_IN) {
+        return false;
+    }
+
+    bool ok = true;
+    Kite_Tokens values = {0};
+    Content expansion = {0};
+    Token body = {0};
+    unsigned long long line = 0;
+    if (!tkbc_parse_macro_args(lexer, &values) || !tkbc_parse_block_body(lexer, &body, &line)) {
+        check_return(false);
+    }
+
+    Kite_Tokens names = {.elements = &name, .count = 1, .capacity = 1};
+    for (size_t i = 0; i < values.count; ++i) {
+        tkbc_kite_substitute(&expansion, lexer->file_name, &body, &names, &values.elements[i]);
+        if (!tkbc_kite_parser_expand(env, parser, lexer->file_name, expansion.elements, expansion.count, line)) {
+            check_return(false);
+        }
+    }
+
+check:
+    free(values.elements);
+    free(expansion.elements);
+    return ok;
+}
+
+/**
+ * @brief The function parses a DEFINE block and keeps it in the parser, until
+ * the parsing of the file is finished. The body reaches up to the END and is
+ * expanded at every call of the name with its arguments in parentheses.
+ *
+ * @param env The global state of the application.
+ * @param parser The state of the parser.
+ * @param lexer The parsing state of the .kite script after the DEFINE.
+ * @return True if the block could be parsed, otherwise false.
+ */
+bool tkbc_parse_define(Env *env, Kite_Parser *parser, Lexer *lexer) {
+    bool ok = true;
+    Kite_Macro macro = {0};
+    macro.name = lexer_next(lexer);
+    if (macro.name.kind != IDENTIFIER || tkbc_kite_keyword(macro.name.content, macro.name.size) != KITE_KEYWORD_NONE ||
+        tkbc_find_macro(parser, macro.name.content, macro.name.size) != NULL) {
+        tkbc_kite_diagnostic(env, lexer->file_name, lexer->line_count, lexer->column_count,
+                             "the macro name is a keyword or already defined");
+        check_return(false);
+    }
+    if (!tkbc_parse_macro_args(lexer, &macro.params)) {
+        check_return(false);
+    }
+    for (size_t i = 0; i < macro.params.count; ++i) {
+        Token *param = &macro.params.elements[i];
+        if (param->kind != IDENTIFIER || tkbc_kite_keyword(param->content, param->size) != KITE_KEYWORD_NONE) {
+            check_return(false);
+        }
+    }
+
+    macro.line = lexer->line_count;
+    macro.body.content = (char *)lexer->content + lexer->position;
+    Token t = lexer_next(lexer);
+    for (; t.kind != EOF_TOKEN; t = lexer_next(lexer)) {
+        Kite_Keyword keyword = t.kind == IDENTIFIER ? tkbc_kite_keyword(t.content, t.size) : KITE_KEYWORD_NONE;
+        if (keyword == KITE_KEYWORD_BEGIN || keyword == KITE_KEYWORD_DEFINE) {
+            check_return(false);
+        }
+        if (keyword == KITE_KEYWORD_END) {
+            break;
+        }
+    }
+    if (t.kind == EOF_TOKEN) {
+        check_return(false);
+    }
+    macro.body.size = t.content - macro.body.content;
+
+    // The piece of the file is dropped after the parsing, so the macro keeps a
+    // copy and the tokens are moved into it.
+    const char *start = macro.name.content;
+    size_t size = t.content - start;
+    macro.source = malloc(size);
+    if (macro.source == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+        abort();
+    }
+    memcpy(macro.source, start, size);
+    macro.name.content = macro.source + (macro.name.content - start);
+    macro.body.content = macro.source + (macro.body.content - start);
+    for (size_t i = 0; i < macro.params.count; ++i) {
+        Token *param = &macro.params.elements[i];
+        param->content = macro.source + (param->content - start);
+    }
+    tkbc_dap(&parser->macros, macro);
+    return true;
+
+check:
+    free(macro.params.elements);
+    return ok;
+}
+
+/**
+ * @brief The function parses the arguments of a macro call and expands the
+ * body of the macro with them.
+ *
+ * @param env The global state of the application.
+ * @param parser The state of the parser.
+ * @param lexer The parsing state of the .kite script after the name.
+ * @param macro The macro that is called.
+ * @return True if the call could be parsed, otherwise false.
+ */
+bool tkbc_parse_macro_call(Env *env, Kite_Parser *parser, Lexer *lexer, Kite_Macro *macro) {
+    bool ok = true;
+    Kite_Tokens args = {0};
+    Content expansion = {0};
+    if (!tkbc_parse_macro_args(lexer, &args)) {
+        check_return(false);
+    }
+    if (args.count != macro->params.count) {
+        tkbc_kite_diagnostic(env, lexer->file_name, lexer->line_count, lexer->column_count,
+                             "the macro %.*s expects %zu arguments", (int)macro->name.size, macro->name.content,
+                             macro->params.count);
+        check_return(false);
+    }
+
+    tkbc_kite_substitute(&expansion, lexer->file_name, &macro->body, &macro->params, args.elements);
+    if (!tkbc_kite_parser_expand(env, parser, lexer->file_name, expansion.elements, expansion.count, macro->line)) {
+        check_return(false);
+    }
+
+check:
+    free(args.elements);
+    free(expansion.elements);
+    return ok;
+}
+
+/**
+ * @brief The function dispatches the keywords that expand a body and the calls
+ * of the defined macros.
+ *
+ * @param env The global state of the application.
+ * @param parser The state of the parser.
+ * @param lexer The parsing state of the .kite script after the identifier.
+ * @param t The identifier that starts the expansion.
+ * @return True if the expansion could be parsed, otherwise false.
+ */
+bool tkbc_parse_expansion(Env *env, Kite_Parser *parser, Lexer *lexer, Token *t) {
+    switch (tkbc_kite_keyword(t->content, t->size)) {
+    case KITE_KEYWORD_REPEAT: return tkbc_parse_repeat(env, parser, lexer);
+    case KITE_KEYWORD_FOR: return tkbc_parse_for(env, parser, lexer);
+    case KITE_KEYWORD_DEFINE: {
+        // The END of a DEFINE would split a section, so macros are defined
+        // outside of the sections.
+        if (parser->script_begin) {
+            return false;
+        }
+        return tkbc_parse_define(env, parser, lexer);
+    }
+    default: {
+        Kite_Macro *macro = tkbc_find_macro(parser, t->content, t->size);
+        if (macro == NULL) {
+            return false;
+        }
+        return tkbc_parse_macro_call(env, parser, lexer, macro);
+    }
+    }
+}
+
+/**
+ * @brief The function looks up a macro by its name.
+ *
+ * @param parser The state of the parser with the defined macros.
+ * @param name The name of the macro.
+ * @param size The length of the name.
+ * @return The macro or NULL if no macro with the name is defined.
+ */
+Kite_Macro *tkbc_find_macro(Kite_Parser *parser, const char *name, size_t size) {
+    for (size_t i = 0; i < parser->macros.count; ++i) {
+        Kite_Macro *macro = &parser->macros.elements[i];
+        if (macro->name.size == size && strncmp(macro->name.content, name, size) == 0) {
+            return macro;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief The function frees the memory of the macros.
+ *
+ * @param macros The macros that are destroyed.
+ */
+void tkbc_kite_macros_destroy(Kite_Macros *macros) {
+    for (size_t i = 0; i < macros->count; ++i) {
+        free(macros->elements[i].source);
+        free(macros->elements[i].params.elements);
+    }
+    free(macros->elements);
+    memset(macros, 0, sizeof(*macros));
+}
+
+/**
+ * @brief The function hashes the kind and the content of a token into the
+ * given FNV-1a hash.
+ *
+ * @param hash The current hash.
+ * @param t The token that is added to the hash.
+ * @return The new hash.
+ */
+static uint64_t tkbc_hash_token(uint64_t hash, Token *t) {
+    hash ^= (unsigned char) t->kind;
+    hash *= 1099511628211ULL;
+    for (size_t i = 0; i < t->size; ++i) {
+        hash ^= (unsigned char) t->content[i];
+        hash *= 1099511628211ULL;
+    }
+    // The separator keeps "AB C" and "A BC" apart.
+    hash ^= 0xff;
+    hash *= 1099511628211ULL;
+    return hash;
+}
+
+/**
+ * @brief The function splits the content of a .kite file into its BEGIN/END
+ * sections and hashes the tokens of every section. Comments and whitespace are
+ * not part of the hashes, so editing them is not a change of the script. The
+ * tokens outside of the sections, like KITES, are hashed into the prelude hash.
+ *
+ * @param file_name The name of the file that is used in the error messages.
+ * @param content The content of the .kite file.
+ * @param size The size of the content.
+ * @param sections The sections in file order, the script ids are set to 0.
+ * @return The hash of the tokens outside of the sections.
+ */
+uint64_t tkbc_scan_kite_sections(const char *file_name, char *content, size_t size, Kite_Sections *sections) {
+    const uint64_t offset_basis = 14695981039346656037ULL;
+    uint64_t prelude_hash = offset_basis;
+    sections->count = 0;
+
+    Lexer *l = lexer_new(file_name, content, size, 0);
+    Kite_Section *section = NULL;
+    for (Token t = lexer_next(l); t.kind != EOF_TOKEN; t = lexer_next(l)) {
+        if (t.kind == COMMENT || t.kind == PREPROCESSING) {
+            continue;
+        }
+        if (tkbc_token_is_keyword(&t, "BEGIN")) {
+            tkbc_dap(sections, ((Kite_Section){.hash = offset_basis}));
+            section = &sections->elements[sections->count - 1];
+        }
+        if (section) {
+            section->hash = tkbc_hash_token(section->hash, &t);
+        } else {
+            prelude_hash = tkbc_hash_token(prelude_hash, &t);
+        }
+        if (tkbc_token_is_keyword(&t, "END")) {
+            section = NULL;
+        }
+    }
+    l->content = NULL;
+    lexer_del(l);
+    return prelude_hash;
+}
+
+/**
+ * @brief The function opens a .kite file for the chunked reading.
+ *
+ * @param stream The stream that is initialized.
+ * @param file_name The path of the .kite file.
+ * @param chunk_size The amount of bytes that is read at once.
+ * @return True if the file could be opened, otherwise false.
+ */
+bool tkbc_kite_stream_open(Kite_Stream *stream, const char *file_name, size_t chunk_size) {
+    memset(stream, 0, sizeof(*stream));
+    stream->file = fopen(file_name, "rb");
+    if (stream->file == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "%s:%s\n", file_name, strerror(errno));
+        return false;
+    }
+    stream->file_name = file_name;
+    stream->chunk_size = chunk_size > 0 ? chunk_size : TKBC_KITE_STREAM_CHUNK;
+    stream->prelude_hash = 14695981039346656037ULL;
+    return true;
+}
+
+/**
+ * @brief The function closes the file of the stream and frees its buffer.
+ *
+ * @param stream The stream that is closed.
+ */
+void tkbc_kite_stream_close(Kite_Stream *stream) {
+    if (stream->file) {
+        fclose(stream->file);
+    }
+    free(stream->buffer.elements);
+    memset(stream, 0, sizeof(*stream));
+}
+
+/**
+ * @brief The function appends the next chunk of the file to the buffer of the
+ * stream. A failed read is handled like the end of the file.
+ *
+ * @param stream The stream that is read.
+ */
+static void tkbc_kite_stream_read(Kite_Stream *stream) {
+    Content *buffer = &stream->buffer;
+    if (buffer->count + stream->chunk_size > buffer->capacity) {
+        size_t capacity = buffer->capacity > 0 ? buffer->capacity : stream->chunk_size;
+        while (capacity < buffer->count + stream->chunk_size) {
+            capacity *= 2;
+        }
+        char *elements = realloc(buffer->elements, capacity);
+        if (elements == NULL) {
+            tkbc_fprintf(stderr, "ERROR", "%s:%d:allocation has failed for file %s\n", __FILE__, __LINE__,
+                         stream->file_name);
+            stream->eof = true;
+            return;
+        }
+        buffer->elements = elements;
+        buffer->capacity = capacity;
+    }
+
+    size_t read_count = fread(buffer->elements + buffer->count, 1, stream->chunk_size, stream->file);
+    buffer->count += read_count;
+    if (read_count < stream->chunk_size) {
+        if (ferror(stream->file) != 0) {
+            tkbc_fprintf(stderr, "ERROR", "%s:%d:reading %s has failed!\n", __FILE__, __LINE__, stream->file_name);
+        }
+        stream->eof = true;
+    }
+}
+
+/**
+ * @brief The function scans the tokens of the buffer from the last scanned
+ * position up to the next END. A token that reaches the end of the buffer can
+ * be cut by the chunk, so it is scanned again after the next read. The tokens
+ * are hashed in the same way as by tkbc_scan_kite_sections().
+ *
+ * @param stream The stream that is scanned.
+ * @param end The end of the END token in the buffer if one is found.
+ * @return True if an END is found, otherwise false.
+ */
+static bool tkbc_kite_stream_scan(Kite_Stream *stream, size_t *end) {
+    const uint64_t offset_basis = 14695981039346656037ULL;
+    Content *buffer = &stream->buffer;
+    Lexer *l = lexer_new(stream->file_name, buffer->elements, buffer->count, stream->scan_position);
+    bool found = false;
+    for (Token t = lexer_next(l); t.kind != EOF_TOKEN; t = lexer_next(l)) {
+        if (!stream->eof && l->position >= buffer->count) {
+            break;
+        }
+        stream->scan_position = l->position;
+        if (t.kind == COMMENT || t.kind == PREPROCESSING) {
+            continue;
+        }
+
+        stream->has_tokens = true;
+        bool is_begin = tkbc_token_is_keyword(&t, "BEGIN");
+        if (is_begin && !stream->in_section) {
+            stream->section_start = t.content - buffer->elements;
+        }
+        if (is_begin == stream->in_section) {
+            // A token outside of the section or a BEGIN inside of it.
+            stream->has_prelude = true;
+        }
+        if (is_begin) {
+            stream->in_section = true;
+            stream->section_hash = offset_basis;
+        }
+        if (stream->in_section) {
+            stream->section_hash = tkbc_hash_token(stream->section_hash, &t);
+        } else {
+            stream->prelude_hash = tkbc_hash_token(stream->prelude_hash, &t);
+        }
+        if (tkbc_token_is_keyword(&t, "END")) {
+            stream->section_ended = stream->in_section;
+            stream->in_section = false;
+            *end = l->position;
+            found = true;
+            break;
+        }
+    }
+    l->content = NULL;
+    lexer_del(l);
+    return found;
+}
+
+/**
+ * @brief The function returns the next piece of the .kite file. Every piece
+ * ends after an END, just the last piece holds the rest of the file. The piece
+ * stays valid until the next call, then it is dropped from the buffer. So the
+ * memory that is used is proportional to the largest section and not to the
+ * whole file.
+ *
+ * @param stream The stream that is read.
+ * @param piece The start of the piece.
+ * @param size The size of the piece.
+ * @return True if a piece is returned, false if the file is completely read.
+ */
+bool tkbc_kite_stream_next(Kite_Stream *stream, char **piece, size_t *size) {
+    Content *buffer = &stream->buffer;
+    if (stream->piece_size > 0) {
+        buffer->count -= stream->piece_size;
+        memmove(buffer->elements, buffer->elements + stream->piece_size, buffer->count);
+        stream->scan_position -= stream->piece_size;
+        stream->piece_size = 0;
+    }
+    stream->section_ended = false;
+    stream->section_start = 0;
+    stream->has_prelude = false;
+
+    size_t end = 0;
+    while (!tkbc_kite_stream_scan(stream, &end)) {
+        if (!stream->eof) {
+            tkbc_kite_stream_read(stream);
+            continue;
+        }
+        // Whitespace and comments after the last END are not a piece.
+        if (!stream->has_tokens) {
+            return false;
+        }
+        // A section without an END is still a section.
+        stream->section_ended = stream->in_section;
+        stream->in_section = false;
+        end = buffer->count;
+        break;
+    }
+
+    *piece = buffer->elements;
+    *size = end;
+    stream->piece_size = end;
+    stream->has_tokens = false;
+    return true;
+}
+
+/**
+ * @brief The function can be used to check if every element in the given
+ * kite indies is part of the current registered kites.
+ *
+ * @param env The global state of the application.
+ * @param kis The kite indies that should be check against the existing kites.
+ * @return True if the given kite indies are valid, otherwise false.
+ */
+bool tkbc_parsed_kis_is_in_env(Env *env, Index index) {
+    // The generated kites have their index as id, unless kites were removed.
+    if (index < env->kite_array.count && env->kite_array.elements[index].kite_id == index) {
+        return true;
+    }
+    for (size_t i = 0; i < env->kite_array.count; ++i) {
+        if (env->kite_array.elements[i].kite_id == index) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief The function parses the kite ids and unions them with the given
+ * orig_kis that are then placed into dest_kis.
+ *
+ * @param env The global state of the application.
+ * @param lexer The data to parse should be located in her.
+ * @param dest_kis The out parameter contains the union of the parsed and
+ * already existing kis.
+ * @param orig_kis The already generated and existing kis.
+ * @return True if the merging has worked, false if there are no kites
+ * generated yet but the KITES keyword is used or if a to high id was
+ * specified in the script that is not generated, or if an parser error
+ * occurred.
+ */
+bool tkbc_parse_kis_after_generation(Env *env, Lexer *lexer, Kite_Ids *dest_kis, Kite_Ids orig_kis) {
+
+    Token t = lexer_next(lexer);
+    if (tkbc_kite_keyword(t.content, t.size) == KITE_KEYWORD_KITES) {
+        if (orig_kis.count == 0) {
+            return false;
+        }
+        for (size_t i = 0; i < orig_kis.count; ++i) {
+            tkbc_dap(dest_kis, orig_kis.elements[i]);
+        }
+
+    } else if (t.kind == PUNCT_LPAREN) {
+        t = lexer_next(lexer);
+        while (t.kind == NUMBER) {
+            int number = 0;
+            if (!tkbc_span_to_int(t.content, t.size, &number)) {
+                return false;
+            }
+            tkbc_dap(dest_kis, number);
+            t = lexer_next(lexer);
+        }
+
+        if (t.kind != PUNCT_RPAREN) {
+            return false;
+        }
+
+        // The whole listing is checked up front, so one error names every
+        // kite that is not generated.
+        Content invalid = {0};
+        for (size_t i = 0; i < dest_kis->count; ++i) {
+            if (!tkbc_parsed_kis_is_in_env(env, dest_kis->elements[i])) {
+                char id[32];
+                size_t size = snprintf(id, sizeof(id), " %zu", dest_kis->elements[i]);
+                tkbc_dapc(&invalid, id, size);
+            }
+        }
+        if (invalid.count > 0) {
+            tkbc_kite_diagnostic(env, lexer->file_name, lexer->line_count, lexer->column_count,
+                                 "the kites%.*s in the listing are not generated", (int)invalid.count,
+                                 invalid.elements);
+            free(invalid.elements);
+            return false;
+        }
+
+    } else {
         return false;
     }
 
@@ -271,12 +1418,10 @@ bool tkbc_parse_kis_after_generation(Env *env, Lexer *lexer, Kite_Ids *dest_kis,
  * @param brace Represents if the parsing has happened inside a frame block.
  * These for these blocks the frame has to be generated for parallel
  * visualisation.
- * @param tmp_buffer A scratch buffer for number sign constructing after
- * parsing.
  * @return True if the parsing and frame construction has worked, otherwise
  * false.
  */
-bool tkbc_parse_move(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki, bool brace, Content *tmp_buffer) {
+bool tkbc_parse_move(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki, bool brace) {
     bool ok = true;
     Kite_Ids kis = {0};
     float x, y, duration;
@@ -286,14 +1431,14 @@ bool tkbc_parse_move(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki, bool
         check_return(false);
     }
 
-    if (!tkbc_parse_float(&x, lexer, tmp_buffer)) {
-        return false;
+    if (!tkbc_parse_float(&x, lexer)) {
+        check_return(false);
     }
-    if (!tkbc_parse_float(&y, lexer, tmp_buffer)) {
-        return false;
+    if (!tkbc_parse_float(&y, lexer)) {
+        check_return(false);
     }
-    if (!tkbc_parse_float(&duration, lexer, tmp_buffer)) {
-        return false;
+    if (!tkbc_parse_float(&duration, lexer)) {
+        check_return(false);
     }
 
     if (kind == ACTION_KITE_MOVE_ADD) {
@@ -333,12 +1478,10 @@ check:
  * @param brace Represents if the parsing has happened inside a frame block.
  * These for these blocks the frame has to be generated for parallel
  * visualisation.
- * @param tmp_buffer A scratch buffer for number sign constructing after
- * parsing.
  * @return True if the parsing and frame construction has worked, otherwise
  * false.
  */
-bool tkbc_parse_rotation(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki, bool brace, Content *tmp_buffer) {
+bool tkbc_parse_rotation(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki, bool brace) {
     bool ok = true;
     Kite_Ids kis = {0};
     float angle, duration;
@@ -348,11 +1491,11 @@ bool tkbc_parse_rotation(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki,
         check_return(false);
     }
 
-    if (!tkbc_parse_float(&angle, lexer, tmp_buffer)) {
-        return false;
+    if (!tkbc_parse_float(&angle, lexer)) {
+        check_return(false);
     }
-    if (!tkbc_parse_float(&duration, lexer, tmp_buffer)) {
-        return false;
+    if (!tkbc_parse_float(&duration, lexer)) {
+        check_return(false);
     }
 
     if (kind == ACTION_KITE_ROTATION_ADD) {
@@ -395,12 +1538,10 @@ check:
  * @param brace Represents if the parsing has happened inside a frame block.
  * These for these blocks the frame has to be generated for parallel
  * visualisation.
- * @param tmp_buffer A scratch buffer for number sign constructing after
- * parsing.
  * @return True if the parsing and frame construction has worked, otherwise
  * false.
  */
-bool tkbc_parse_tip_rotation(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki, bool brace, Content *tmp_buffer) {
+bool tkbc_parse_tip_rotation(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki, bool brace) {
     bool ok = true;
     Kite_Ids kis = {0};
     TIP tip;
@@ -411,8 +1552,8 @@ bool tkbc_parse_tip_rotation(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids
         check_return(false);
     }
 
-    if (!tkbc_parse_float(&angle, lexer, tmp_buffer)) {
-        return false;
+    if (!tkbc_parse_float(&angle, lexer)) {
+        check_return(false);
     }
 
     Token t = lexer_next(lexer);
@@ -424,8 +1565,8 @@ bool tkbc_parse_tip_rotation(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids
         check_return(false);
     }
 
-    if (!tkbc_parse_float(&duration, lexer, tmp_buffer)) {
-        return false;
+    if (!tkbc_parse_float(&duration, lexer)) {
+        check_return(false);
     }
 
     if (kind == ACTION_KITE_TIP_ROTATION_ADD) {
@@ -454,604 +1595,441 @@ check:
 }
 
 /**
- * @brief The function parses the possible additional plus and minus sign in
- * front of a number that is returned by the lexer.
+ * @brief The function parses a possible arc action out of the current lexer
+ * content.
  *
- * @param lexer The parsing state of the .kite script.
- * @param tmp_buffer The dynamic array buffer where the parsed tokens should be
- * appended to.
+ * @param env The global state of the application.
+ * @param lexer The data to parse should be located in her.
+ * @param ki The already generated kite ids to compare to the possible new
+ * parsed kite ids.
+ * @param brace Represents if the parsing has happened inside a frame block.
+ * These for these blocks the frame has to be generated for parallel
+ * visualisation.
+ * @return True if the parsing and frame construction has worked, otherwise
+ * false.
  */
-bool tkbc_parse_number_prolog(Lexer *lexer, Content *tmp_buffer) {
-    // TODO: Make this maybe part of the lexer.
-    Token token = lexer_next(lexer);
-    char sign;
-    bool issign = false;
+bool tkbc_parse_arc(Env *env, Lexer *lexer, Kite_Ids ki, bool brace) {
+    bool ok = true;
+    Kite_Ids kis = {0};
+    float radius, begin_angle, end_angle, rotation, duration;
+    Easing easing;
+    Frame *frame = NULL;
 
-    if (strncmp("-", token.content, token.size) == 0 || strncmp("+", token.content, token.size) == 0) {
-        issign = true;
-        sign = *(char *) token.content;
+    if (!tkbc_parse_kis_after_generation(env, lexer, &kis, ki)) {
+        check_return(false);
     }
 
-    if (token.kind != NUMBER && !issign) {
+    if (!tkbc_parse_float(&radius, lexer)) {
+        check_return(false);
+    }
+    if (!tkbc_parse_float(&begin_angle, lexer)) {
+        check_return(false);
+    }
+    if (!tkbc_parse_float(&end_angle, lexer)) {
+        check_return(false);
+    }
+    if (!tkbc_parse_float(&rotation, lexer)) {
+        check_return(false);
+    }
+    if (!tkbc_parse_easing(&easing, lexer)) {
+        check_return(false);
+    }
+    if (!tkbc_parse_float(&duration, lexer)) {
+        check_return(false);
+    }
+
+    if (brace) {
+        frame = KITE_ARC(kis, radius, begin_angle, end_angle, rotation, easing, duration);
+        space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
+    } else {
+        SET(KITE_ARC(kis, radius, begin_angle, end_angle, rotation, easing, duration));
+    }
+
+check:
+    if (kis.elements) {
+        free(kis.elements);
+        // TODO: use maybe a space allocation in here
+        kis.elements = NULL;
+    }
+    return ok;
+}
+
+/**
+ * @brief The function parses a possible bezier or catmull-rom action out of the
+ * current lexer content.
+ *
+ * @param env The global state of the application.
+ * @param lexer The data to parse should be located in her.
+ * @param kind The kind specifies if the bezier or catmull-rom version is
+ * expected.
+ * @param ki The already generated kite ids to compare to the possible new
+ * parsed kite ids.
+ * @param brace Represents if the parsing has happened inside a frame block.
+ * These for these blocks the frame has to be generated for parallel
+ * visualisation.
+ * @return True if the parsing and frame construction has worked, otherwise
+ * false.
+ */
+bool tkbc_parse_spline(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki, bool brace) {
+    bool ok = true;
+    Kite_Ids kis = {0};
+    Vector2 c1, c2, position;
+    float duration;
+    Easing easing;
+    Frame *frame = NULL;
+
+    if (!tkbc_parse_kis_after_generation(env, lexer, &kis, ki)) {
+        check_return(false);
+    }
+
+    float *values[] = {&c1.x, &c1.y, &c2.x, &c2.y, &position.x, &position.y};
+    for (size_t i = 0; i < ARRAY_LENGTH(values); ++i) {
+        if (!tkbc_parse_float(values[i], lexer)) {
+            check_return(false);
+        }
+    }
+    if (!tkbc_parse_easing(&easing, lexer)) {
+        check_return(false);
+    }
+    if (!tkbc_parse_float(&duration, lexer)) {
+        check_return(false);
+    }
+
+    if (kind == ACTION_KITE_BEZIER) {
+        if (brace) {
+            frame = KITE_BEZIER(kis, c1.x, c1.y, c2.x, c2.y, position.x, position.y, easing, duration);
+            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
+        } else {
+            SET(KITE_BEZIER(kis, c1.x, c1.y, c2.x, c2.y, position.x, position.y, easing, duration));
+        }
+    } else if (kind == ACTION_KITE_CATMULL_ROM) {
+        if (brace) {
+            frame = KITE_CATMULL_ROM(kis, c1.x, c1.y, c2.x, c2.y, position.x, position.y, easing, duration);
+            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
+        } else {
+            SET(KITE_CATMULL_ROM(kis, c1.x, c1.y, c2.x, c2.y, position.x, position.y, easing, duration));
+        }
+    }
+
+check:
+    if (kis.elements) {
+        free(kis.elements);
+        // TODO: use maybe a space allocation in here
+        kis.elements = NULL;
+    }
+    return ok;
+}
+
+/**
+ * @brief The function tries to parse the name of an easing curve out of the
+ * current lexer state.
+ *
+ * @param easing A pointer to the variable that should hold the parsed easing
+ * after the function has succeeded.
+ * @param lexer The parsing state of the .kite script.
+ * @return True if a known easing name was parsed, otherwise false and the
+ * easing stays untouched.
+ */
+bool tkbc_parse_easing(Easing *easing, Lexer *lexer) {
+    Token t = lexer_next(lexer);
+    if (t.kind != IDENTIFIER) {
         return false;
     }
+    return tkbc_easing_from_cstr(t.content, t.size, easing);
+}
+
+/**
+ * @brief The function parses the possible additional plus and minus sign in
+ * front of a number that is returned by the lexer.
+ *
+ * @param lexer The parsing state of the .kite script.
+ * @param number The token of the number without the sign.
+ * @param negative Is set to true if the number has a leading minus sign.
+ * @return True if a number token has been parsed, otherwise false.
+ */
+bool tkbc_parse_number_prolog(Lexer *lexer, Token *number, bool *negative) {
+    // TODO: Make this maybe part of the lexer.
+    Token token = lexer_next(lexer);
+    bool issign = token.kind == PUNCT_SUB || token.kind == PUNCT_ADD;
+    *negative = token.kind == PUNCT_SUB;
+
     if (issign) {
         token = lexer_next(lexer);
     }
     if (token.kind != NUMBER) {
         return false;
     }
-
-    tmp_buffer->count = 0;
-    if (issign) {
-        tkbc_dap(tmp_buffer, sign);
-    }
-    tkbc_dapc(tmp_buffer, token.content, token.size);
-    tkbc_dap(tmp_buffer, 0);
+    *number = token;
     return true;
 }
 
 /**
  * @brief The function tries to parse a floating point number out of the current
- * lexer state and assign it to the number parameter.
+ * lexer state and assign it to the number parameter. The number is converted
+ * directly from the token without a copy.
  *
  * @param number A pointer to the variable that should hold the parsed value
  * after the function has succeeded.
  * @param lexer The parsing state of the .kite script.
- * @param tmp_buffer The dynamic array buffer where the parsed tokens should
- * temporarily be appended to.
  * @return True if the parsing of a floating point number has succeeded,
  * otherwise a parsing error has occurred and false is returned and the number
  * value stays untouched.
  */
-bool tkbc_parse_float(float *number, Lexer *lexer, Content *tmp_buffer) {
-    if (!tkbc_parse_number_prolog(lexer, tmp_buffer)) {
+bool tkbc_parse_float(float *number, Lexer *lexer) {
+    Token token;
+    bool negative;
+    float value;
+    if (!tkbc_parse_number_prolog(lexer, &token, &negative)) {
+        return false;
+    }
+    if (!tkbc_span_to_float(token.content, token.size, &value)) {
         return false;
     }
-    *number = strtof(tmp_buffer->elements, NULL);
+    *number = negative ? -value : value;
     return true;
 }
 
 /**
  * @brief The function tries to parse a number that can be represented by the
  * size_t type out of the current lexer state and assign it to the number
- * parameter.
+ * parameter. The number is converted directly from the token without a copy.
  *
  * @param number A pointer to the variable that should hold the parsed value
  * after the function has succeeded.
  * @param lexer The parsing state of the .kite script.
- * @param tmp_buffer The dynamic array buffer where the parsed tokens should
- * temporarily be appended to.
  * @return True if the parsing of a size_t number has succeeded,
  * otherwise a parsing error has occurred and false is returned and the number
  * value stays untouched.
  */
-bool tkbc_parse_size_t(size_t *number, Lexer *lexer, Content *tmp_buffer) {
-    if (!tkbc_parse_number_prolog(lexer, tmp_buffer)) {
+bool tkbc_parse_size_t(size_t *number, Lexer *lexer) {
+    Token token;
+    bool negative;
+    if (!tkbc_parse_number_prolog(lexer, &token, &negative) || negative) {
+        return false;
+    }
+    return tkbc_span_to_size_t(token.content, token.size, number);
+}
+
+/**
+ * @brief The function parses a DIRECTION argument of a team figure.
+ *
+ * @param direction The parsed direction.
+ * @param lexer The parsing state of the .kite script.
+ * @return True if the next token is LEFT or RIGHT, otherwise false.
+ */
+static bool tkbc_parse_direction(DIRECTION *direction, Lexer *lexer) {
+    Token token = lexer_next(lexer);
+    if (tkbc_token_is_keyword(&token, "LEFT")) {
+        *direction = LEFT;
+    } else if (tkbc_token_is_keyword(&token, "RIGHT")) {
+        *direction = RIGHT;
+    } else {
         return false;
     }
-    *number = (size_t) strtoull(tmp_buffer->elements, NULL, 10);
     return true;
 }
 
+/**
+ * @brief The function parses an ODD_EVEN argument of a team figure.
+ *
+ * @param odd_even The parsed kite group.
+ * @param lexer The parsing state of the .kite script.
+ * @return True if the next token is ODD or EVEN, otherwise false.
+ */
+static bool tkbc_parse_odd_even(ODD_EVEN *odd_even, Lexer *lexer) {
+    Token token = lexer_next(lexer);
+    if (tkbc_token_is_keyword(&token, "ODD")) {
+        *odd_even = ODD;
+    } else if (tkbc_token_is_keyword(&token, "EVEN")) {
+        *odd_even = EVEN;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// The figure calls unpack the parsed arguments in the order of their schema.
+#define ARG_VECTOR2(args, i) ((Vector2){(args)[(i)].as_float, (args)[(i) + 1].as_float})
+
+static void tkbc_figure_team_line(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_line(env, kis, ARG_VECTOR2(a, 0), ARG_VECTOR2(a, 2), a[4].as_float, a[5].as_float);
+}
+static void tkbc_figure_team_grid(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_grid(env, kis, ARG_VECTOR2(a, 0), ARG_VECTOR2(a, 2), a[4].as_float, a[5].as_float,
+                          a[6].as_size_t, a[7].as_size_t, a[8].as_float);
+}
+static void tkbc_figure_team_ball(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_ball(env, kis, ARG_VECTOR2(a, 0), ARG_VECTOR2(a, 2), a[4].as_float, a[5].as_float,
+                          a[6].as_float);
+}
+static void tkbc_figure_team_mountain(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_mountain(env, kis, ARG_VECTOR2(a, 0), ARG_VECTOR2(a, 2), a[4].as_float, a[5].as_float,
+                              a[6].as_float, a[7].as_float);
+}
+static void tkbc_figure_team_valley(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_valley(env, kis, ARG_VECTOR2(a, 0), ARG_VECTOR2(a, 2), a[4].as_float, a[5].as_float,
+                            a[6].as_float, a[7].as_float);
+}
+static void tkbc_figure_team_arc(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_arc(env, kis, ARG_VECTOR2(a, 0), ARG_VECTOR2(a, 2), a[4].as_float, a[5].as_float,
+                         a[6].as_float, a[7].as_float, a[8].as_float);
+}
+static void tkbc_figure_team_mouth(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_mouth(env, kis, ARG_VECTOR2(a, 0), ARG_VECTOR2(a, 2), a[4].as_float, a[5].as_float,
+                           a[6].as_float, a[7].as_float, a[8].as_float);
+}
+static void tkbc_figure_team_box(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_box(env, kis, a[0].as_direction, a[1].as_float, a[2].as_float, a[3].as_float,
+                         a[4].as_float);
+}
+static void tkbc_figure_team_box_left(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_box_left(env, kis, a[0].as_float, a[1].as_float, a[2].as_float);
+}
+static void tkbc_figure_team_box_right(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_box_right(env, kis, a[0].as_float, a[1].as_float, a[2].as_float);
+}
+static void tkbc_figure_team_split_box_up(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_split_box_up(env, kis, a[0].as_odd_even, a[1].as_float, a[2].as_float, a[3].as_float);
+}
+static void tkbc_figure_team_diamond(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_diamond(env, kis, a[0].as_direction, a[1].as_float, a[2].as_float, a[3].as_float,
+                             a[4].as_float);
+}
+static void tkbc_figure_team_diamond_left(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_diamond_left(env, kis, a[0].as_float, a[1].as_float, a[2].as_float);
+}
+static void tkbc_figure_team_diamond_right(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_diamond_right(env, kis, a[0].as_float, a[1].as_float, a[2].as_float);
+}
+static void tkbc_figure_team_roll_split_up(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_roll_split_up(env, kis, a[0].as_odd_even, a[1].as_float, a[2].as_size_t, a[3].as_size_t,
+                                   a[4].as_float);
+}
+static void tkbc_figure_team_roll_split_down(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_roll_split_down(env, kis, a[0].as_odd_even, a[1].as_float, a[2].as_size_t, a[3].as_size_t,
+                                     a[4].as_float);
+}
+static void tkbc_figure_team_roll_up_anti_clockwise(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_roll_up_anti_clockwise(env, kis, a[0].as_float, a[1].as_size_t, a[2].as_size_t, a[3].as_float);
+}
+static void tkbc_figure_team_roll_up_clockwise(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_roll_up_clockwise(env, kis, a[0].as_float, a[1].as_size_t, a[2].as_size_t, a[3].as_float);
+}
+static void tkbc_figure_team_roll_down_anti_clockwise(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_roll_down_anti_clockwise(env, kis, a[0].as_float, a[1].as_size_t, a[2].as_size_t,
+                                              a[3].as_float);
+}
+static void tkbc_figure_team_roll_down_clockwise(Env *env, Kite_Ids kis, const Figure_Arg *a) {
+    tkbc_script_team_roll_down_clockwise(env, kis, a[0].as_float, a[1].as_size_t, a[2].as_size_t, a[3].as_float);
+}
+
+#undef ARG_VECTOR2
+
+#define F FIGURE_ARG_FLOAT
+#define N FIGURE_ARG_SIZE_T
+#define D FIGURE_ARG_DIRECTION
+#define O FIGURE_ARG_ODD_EVEN
+
+// The arguments of every team figure that can be called with EXTERN in a .kite
+// file. A new figure just needs a row in here and the call that unpacks its
+// arguments.
+static const Team_Figure_Schema tkbc_team_figure_schemas[] = {
+    {"TEAM_LINE", 6, {F, F, F, F, F, F}, tkbc_figure_team_line},
+    {"TEAM_GRID", 9, {F, F, F, F, F, F, N, N, F}, tkbc_figure_team_grid},
+    {"TEAM_BALL", 7, {F, F, F, F, F, F, F}, tkbc_figure_team_ball},
+    {"TEAM_MOUNTAIN", 8, {F, F, F, F, F, F, F, F}, tkbc_figure_team_mountain},
+    {"TEAM_VALLEY", 8, {F, F, F, F, F, F, F, F}, tkbc_figure_team_valley},
+    {"TEAM_ARC", 9, {F, F, F, F, F, F, F, F, F}, tkbc_figure_team_arc},
+    {"TEAM_MOUTH", 9, {F, F, F, F, F, F, F, F, F}, tkbc_figure_team_mouth},
+    {"TEAM_BOX", 5, {D, F, F, F, F}, tkbc_figure_team_box},
+    {"TEAM_BOX_LEFT", 3, {F, F, F}, tkbc_figure_team_box_left},
+    {"TEAM_BOX_RIGHT", 3, {F, F, F}, tkbc_figure_team_box_right},
+    {"TEAM_SPLIT_BOX_UP", 4, {O, F, F, F}, tkbc_figure_team_split_box_up},
+    {"TEAM_DIAMOND", 5, {D, F, F, F, F}, tkbc_figure_team_diamond},
+    {"TEAM_DIAMOND_LEFT", 3, {F, F, F}, tkbc_figure_team_diamond_left},
+    {"TEAM_DIAMOND_RIGHT", 3, {F, F, F}, tkbc_figure_team_diamond_right},
+    {"TEAM_ROLL_SPLIT_UP", 5, {O, F, N, N, F}, tkbc_figure_team_roll_split_up},
+    {"TEAM_ROLL_SPLIT_DOWN", 5, {O, F, N, N, F}, tkbc_figure_team_roll_split_down},
+    {"TEAM_ROLL_UP_ANTI_CLOCKWISE", 4, {F, N, N, F}, tkbc_figure_team_roll_up_anti_clockwise},
+    {"TEAM_ROLL_UP_CLOCKWISE", 4, {F, N, N, F}, tkbc_figure_team_roll_up_clockwise},
+    {"TEAM_ROLL_DOWN_ANTI_CLOCKWISE", 4, {F, N, N, F}, tkbc_figure_team_roll_down_anti_clockwise},
+    {"TEAM_ROLL_DOWN_CLOCKWISE", 4, {F, N, N, F}, tkbc_figure_team_roll_down_clockwise},
+};
+
+#undef F
+#undef N
+#undef D
+#undef O
+
+static Perfect_Hash tkbc_team_figure_hash;
+static pthread_once_t tkbc_team_figure_hash_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief The function generates the perfect hash of the team figure names.
+ */
+static void tkbc_team_figure_hash_init(void) {
+    const char *names[ARRAY_LENGTH(tkbc_team_figure_schemas)];
+    for (size_t i = 0; i < ARRAY_LENGTH(tkbc_team_figure_schemas); ++i) {
+        names[i] = tkbc_team_figure_schemas[i].name;
+    }
+    tkbc_perfect_hash_build(&tkbc_team_figure_hash, names, ARRAY_LENGTH(names));
+}
+
+/**
+ * @brief The function looks up the argument schema of a team figure.
+ *
+ * @param name The name of the team figure.
+ * @param size The length of the name.
+ * @return The schema of the team figure or NULL if there is none.
+ */
+const Team_Figure_Schema *tkbc_team_figure_schema(const char *name, size_t size) {
+    pthread_once(&tkbc_team_figure_hash_once, tkbc_team_figure_hash_init);
+    size_t index = tkbc_perfect_hash_find(&tkbc_team_figure_hash, name, size);
+    if (index >= ARRAY_LENGTH(tkbc_team_figure_schemas) ||
+        strlen(tkbc_team_figure_schemas[index].name) != size ||
+        strncmp(tkbc_team_figure_schemas[index].name, name, size) != 0) {
+        return NULL;
+    }
+    return &tkbc_team_figure_schemas[index];
+}
+
 /**
  * @brief The function parses the expected function, provided by the
  * function_name, out of the lexer state and if the parsing was a success the
  * function is also called and sets up the corresponding team figure in the
- * current env script buffer.
+ * current env script buffer. The arguments are parsed by the schema of the
+ * team figure.
  *
  * @param env The global state of the application.
  * @param kis The kite indies that are part of the expected team figure.
  * @param lexer The parsing state of the .kite script.
  * @param function_name The name of the possible team function.
- * @param tmp_buffer The dynamic array buffer where the parsed tokens should
- * temporarily be appended to.
  * @return True if the parsing of the function that corresponds to the given
- * function_name has been parsed out with no errors, false if a parsing error
- * has occurred.
+ * function_name has been parsed out with no errors, false if the function is
+ * unknown or a parsing error has occurred.
  */
-bool tkbc_parse_team_figures(Env *env, Kite_Ids kis, Lexer *lexer, const char *function_name, Content *tmp_buffer) {
-
-    if (strcmp("TEAM_LINE", function_name) == 0) {
-        Vector2 position, offset;
-        float h_padding, move_duration;
-
-        if (!tkbc_parse_float(&position.x, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&position.y, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&offset.x, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&offset.y, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&h_padding, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_line(env, kis, position, offset, h_padding, move_duration);
-    } else if (strcmp("TEAM_GRID", function_name) == 0) {
-        Vector2 position, offset;
-        float v_padding, h_padding;
-        size_t rows, columns;
-        float move_duration;
-
-        if (!tkbc_parse_float(&position.x, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&position.y, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&offset.x, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&offset.y, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&v_padding, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&h_padding, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_size_t(&rows, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_size_t(&columns, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_grid(env, kis, position, offset, v_padding, h_padding, rows, columns, move_duration);
-    } else if (strcmp("TEAM_MOUNTAIN", function_name) == 0) {
-        Vector2 position, offset;
-        float v_padding, h_padding;
-        float move_duration, rotation_duration;
-
-        if (!tkbc_parse_float(&position.x, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&position.y, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&offset.x, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&offset.y, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&v_padding, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&h_padding, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&rotation_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_mountain(env, kis, position, offset, v_padding, h_padding, move_duration, rotation_duration);
-    } else if (strcmp("TEAM_VALLEY", function_name) == 0) {
-        Vector2 position, offset;
-        float v_padding, h_padding;
-        float move_duration, rotation_duration;
-
-        if (!tkbc_parse_float(&position.x, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&position.y, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&offset.x, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&offset.y, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&v_padding, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&h_padding, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&rotation_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_valley(env, kis, position, offset, v_padding, h_padding, move_duration, rotation_duration);
-    } else if (strcmp("TEAM_ARC", function_name) == 0) {
-        Vector2 position, offset;
-        float v_padding, h_padding;
-        float angle;
-        float move_duration, rotation_duration;
-
-        if (!tkbc_parse_float(&position.x, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&position.y, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&offset.x, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&offset.y, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&v_padding, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&h_padding, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&angle, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&rotation_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_arc(env, kis, position, offset, v_padding, h_padding, angle, move_duration, rotation_duration);
-    } else if (strcmp("TEAM_MOUTH", function_name) == 0) {
-        Vector2 position, offset;
-        float v_padding, h_padding;
-        float angle;
-        float move_duration, rotation_duration;
-
-        if (!tkbc_parse_float(&position.x, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&position.y, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&offset.x, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&offset.y, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&v_padding, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&h_padding, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&angle, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&rotation_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_mouth(env, kis, position, offset, v_padding, h_padding, angle, move_duration,
-                               rotation_duration);
-    } else if (strcmp("TEAM_BOX", function_name) == 0) {
-        DIRECTION direction;
-        float angle, box_size;
-        float move_duration, rotation_duration;
-
-        {
-            Token token = lexer_next(lexer);
-            if (token.kind != IDENTIFIER) {
-                return false;
-            }
-            if (strcmp("LEFT", lexer_token_to_cstr(lexer, &token)) == 0) {
-                direction = LEFT;
-            } else if (strcmp("RIGHT", lexer_token_to_cstr(lexer, &token)) == 0) {
-                direction = RIGHT;
-            } else {
-                return false;
-            }
-        }
-
-        if (!tkbc_parse_float(&angle, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&box_size, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&rotation_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_box(env, kis, direction, angle, box_size, move_duration, rotation_duration);
-    } else if (strcmp("TEAM_BOX_LEFT", function_name) == 0) {
-        float box_size;
-        float move_duration, rotation_duration;
-
-        if (!tkbc_parse_float(&box_size, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&rotation_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_box_left(env, kis, box_size, move_duration, rotation_duration);
-    } else if (strcmp("TEAM_BOX_RIGHT", function_name) == 0) {
-        float box_size;
-        float move_duration, rotation_duration;
-
-        if (!tkbc_parse_float(&box_size, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&rotation_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_box_right(env, kis, box_size, move_duration, rotation_duration);
-    } else if (strcmp("TEAM_SPLIT_BOX_UP", function_name) == 0) {
-        ODD_EVEN odd_even;
-        float box_size;
-        float move_duration, rotation_duration;
-
-        {
-            Token token = lexer_next(lexer);
-            if (token.kind != IDENTIFIER) {
-                return false;
-            }
-            if (strcmp("ODD", lexer_token_to_cstr(lexer, &token)) == 0) {
-                odd_even = ODD;
-            } else if (strcmp("EVEN", lexer_token_to_cstr(lexer, &token)) == 0) {
-                odd_even = EVEN;
-            } else {
-                return false;
-            }
-        }
-
-        if (!tkbc_parse_float(&box_size, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&rotation_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_split_box_up(env, kis, odd_even, box_size, move_duration, rotation_duration);
-
-    } else if (strcmp("TEAM_DIAMOND", function_name) == 0) {
-        DIRECTION direction;
-        float angle, box_size;
-        float move_duration, rotation_duration;
-
-        {
-            Token token = lexer_next(lexer);
-            if (token.kind != IDENTIFIER) {
-                return false;
-            }
-            if (strcmp("LEFT", lexer_token_to_cstr(lexer, &token)) == 0) {
-                direction = LEFT;
-            } else if (strcmp("RIGHT", lexer_token_to_cstr(lexer, &token)) == 0) {
-                direction = RIGHT;
-            } else {
-                return false;
-            }
-        }
-
-        if (!tkbc_parse_float(&angle, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&box_size, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&rotation_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_diamond(env, kis, direction, angle, box_size, move_duration, rotation_duration);
-    } else if (strcmp("TEAM_DIAMOND_LEFT", function_name) == 0) {
-        float box_size;
-        float move_duration, rotation_duration;
-
-        if (!tkbc_parse_float(&box_size, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&rotation_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_diamond_left(env, kis, box_size, move_duration, rotation_duration);
-    } else if (strcmp("TEAM_DIAMOND_RIGHT", function_name) == 0) {
-        float box_size;
-        float move_duration, rotation_duration;
-
-        if (!tkbc_parse_float(&box_size, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&rotation_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_diamond_right(env, kis, box_size, move_duration, rotation_duration);
-    } else if (strcmp("TEAM_ROLL_SPLIT_UP", function_name) == 0) {
-        ODD_EVEN odd_even;
-        float radius;
-        size_t begin_angle;
-        size_t end_angle;
-        float move_duration;
-
-        {
-            Token token = lexer_next(lexer);
-            if (token.kind != IDENTIFIER) {
-                return false;
-            }
-            if (strcmp("ODD", lexer_token_to_cstr(lexer, &token)) == 0) {
-                odd_even = ODD;
-            } else if (strcmp("EVEN", lexer_token_to_cstr(lexer, &token)) == 0) {
-                odd_even = EVEN;
-            } else {
-                return false;
-            }
-        }
-
-        if (!tkbc_parse_float(&radius, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_size_t(&begin_angle, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_size_t(&end_angle, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_roll_split_up(env, kis, odd_even, radius, begin_angle, end_angle, move_duration);
-    } else if (strcmp("TEAM_ROLL_SPLIT_DOWN", function_name) == 0) {
-        ODD_EVEN odd_even;
-        float radius;
-        size_t begin_angle;
-        size_t end_angle;
-        float move_duration;
-
-        {
-            Token token = lexer_next(lexer);
-            if (token.kind != IDENTIFIER) {
-                return false;
-            }
-            if (strcmp("ODD", lexer_token_to_cstr(lexer, &token)) == 0) {
-                odd_even = ODD;
-            } else if (strcmp("EVEN", lexer_token_to_cstr(lexer, &token)) == 0) {
-                odd_even = EVEN;
-            } else {
-                return false;
-            }
-        }
-
-        if (!tkbc_parse_float(&radius, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_size_t(&begin_angle, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_size_t(&end_angle, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_roll_split_down(env, kis, odd_even, radius, begin_angle, end_angle, move_duration);
-    } else if (strcmp("TEAM_ROLL_UP_ANTI_CLOCKWISE", function_name) == 0) {
-        float radius;
-        size_t begin_angle;
-        size_t end_angle;
-        float move_duration;
-
-        if (!tkbc_parse_float(&radius, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_size_t(&begin_angle, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_size_t(&end_angle, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_roll_up_anti_clockwise(env, kis, radius, begin_angle, end_angle, move_duration);
-    } else if (strcmp("TEAM_ROLL_UP_CLOCKWISE", function_name) == 0) {
-        float radius;
-        size_t begin_angle;
-        size_t end_angle;
-        float move_duration;
-
-        if (!tkbc_parse_float(&radius, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_size_t(&begin_angle, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_size_t(&end_angle, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_roll_up_clockwise(env, kis, radius, begin_angle, end_angle, move_duration);
-    } else if (strcmp("TEAM_ROLL_DOWN_ANTI_CLOCKWISE", function_name) == 0) {
-        float radius;
-        size_t begin_angle;
-        size_t end_angle;
-        float move_duration;
-
-        if (!tkbc_parse_float(&radius, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_size_t(&begin_angle, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_size_t(&end_angle, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_roll_down_anti_clockwise(env, kis, radius, begin_angle, end_angle, move_duration);
-    } else if (strcmp("TEAM_ROLL_DOWN_CLOCKWISE", function_name) == 0) {
-        float radius;
-        size_t begin_angle;
-        size_t end_angle;
-        float move_duration;
+bool tkbc_parse_team_figures(Env *env, Kite_Ids kis, Lexer *lexer, const char *function_name) {
+    const Team_Figure_Schema *schema = tkbc_team_figure_schema(function_name, strlen(function_name));
+    if (schema == NULL) {
+        tkbc_kite_diagnostic(env, lexer->file_name, lexer->line_count, lexer->column_count,
+                             "the team figure %s is unknown", function_name);
+        return false;
+    }
 
-        if (!tkbc_parse_float(&radius, lexer, tmp_buffer)) {
-            return false;
-        }
-        if (!tkbc_parse_size_t(&begin_angle, lexer, tmp_buffer)) {
-            return false;
+    Figure_Arg args[TKBC_FIGURE_ARGS_MAX];
+    for (size_t i = 0; i < schema->arity; ++i) {
+        bool ok = false;
+        switch (schema->kinds[i]) {
+        case FIGURE_ARG_FLOAT: ok = tkbc_parse_float(&args[i].as_float, lexer); break;
+        case FIGURE_ARG_SIZE_T: ok = tkbc_parse_size_t(&args[i].as_size_t, lexer); break;
+        case FIGURE_ARG_DIRECTION: ok = tkbc_parse_direction(&args[i].as_direction, lexer); break;
+        case FIGURE_ARG_ODD_EVEN: ok = tkbc_parse_odd_even(&args[i].as_odd_even, lexer); break;
         }
-        if (!tkbc_parse_size_t(&end_angle, lexer, tmp_buffer)) {
+        if (!ok) {
             return false;
         }
-        if (!tkbc_parse_float(&move_duration, lexer, tmp_buffer)) {
-            return false;
-        }
-
-        tkbc_script_team_roll_down_clockwise(env, kis, radius, begin_angle, end_angle, move_duration);
     }
 
+    schema->call(env, kis, args);
     return true;
 }
@@ -5,15 +5,157 @@
 #include "../global/tkbc-types.h"
 #include "../global/tkbc-utils.h"
 
+// The amount of bytes the streaming parser reads from a .kite file at once.
+#define TKBC_KITE_STREAM_CHUNK (64 * 1024)
+
+// The most slots a perfect hash can use, so the tables stay static.
+#define TKBC_PERFECT_HASH_SLOTS_MAX 128
+// The most arguments a team figure can have.
+#define TKBC_FIGURE_ARGS_MAX 9
+// The most nested REPEAT, FOR and macro expansions, it stops recursive macros.
+#define TKBC_KITE_EXPANSION_DEPTH_MAX 64
+
+typedef struct {
+    uint32_t seed;                               // The seed that maps every name to its own slot.
+    size_t mask;                                 // The amount of used slots minus one.
+    uint8_t slots[TKBC_PERFECT_HASH_SLOTS_MAX];  // The name index plus one or 0 for an empty slot.
+} Perfect_Hash;                                  // A collision free lookup of a fixed set of names.
+
+typedef enum {
+    KITE_KEYWORD_NONE,
+    KITE_KEYWORD_EXTERN,
+    KITE_KEYWORD_BEGIN,
+    KITE_KEYWORD_END,
+    KITE_KEYWORD_KITES,
+    KITE_KEYWORD_MOVE,
+    KITE_KEYWORD_MOVE_ADD,
+    KITE_KEYWORD_ROTATION,
+    KITE_KEYWORD_ROTATION_ADD,
+    KITE_KEYWORD_TIP_ROTATION,
+    KITE_KEYWORD_TIP_ROTATION_ADD,
+    KITE_KEYWORD_ARC,
+    KITE_KEYWORD_BEZIER,
+    KITE_KEYWORD_CATMULL_ROM,
+    KITE_KEYWORD_WAIT,
+    KITE_KEYWORD_QUIT,
+    KITE_KEYWORD_REPEAT,
+    KITE_KEYWORD_FOR,
+    KITE_KEYWORD_IN,
+    KITE_KEYWORD_DEFINE,
+    KITE_KEYWORD_COUNT,
+} Kite_Keyword;  // The keywords of the .kite files.
+
+typedef enum {
+    FIGURE_ARG_FLOAT,
+    FIGURE_ARG_SIZE_T,
+    FIGURE_ARG_DIRECTION,
+    FIGURE_ARG_ODD_EVEN,
+} Figure_Arg_Kind;  // The types of the arguments of a team figure.
+
+typedef union {
+    float as_float;
+    size_t as_size_t;
+    DIRECTION as_direction;
+    ODD_EVEN as_odd_even;
+} Figure_Arg;  // A parsed argument of a team figure.
+
+typedef void (*Team_Figure_Call)(Env *env, Kite_Ids kis, const Figure_Arg *args);
+
+typedef struct {
+    const char *name;                             // The name that is used after EXTERN.
+    size_t arity;                                 // The amount of arguments after the kites.
+    Figure_Arg_Kind kinds[TKBC_FIGURE_ARGS_MAX];  // The types of the arguments in order.
+    Team_Figure_Call call;                        // The call that unpacks the arguments.
+} Team_Figure_Schema;                             // The argument schema of a team figure in a .kite file.
+
+typedef struct {
+    Token *elements;  // The dynamic array collection for Tokens.
+    size_t count;     // The amount of elements in the array.
+    size_t capacity;  // The complete allocated space for the array represented as
+                      // the number of collection elements of the array type.
+} Kite_Tokens;        // A dynamic array collection of tokens, like the arguments of a macro.
+
+typedef struct {
+    char *source;             // The copy of the definition from the name up to the END.
+    Token name;               // The name of the macro in the source.
+    Kite_Tokens params;       // The parameter names in the source.
+    Token body;               // The body in the source that is expanded at every call.
+    unsigned long long line;  // The line of the body in the file.
+} Kite_Macro;                 // A parameterized DEFINE block of a .kite file.
+
+typedef struct {
+    Kite_Macro *elements;  // The dynamic array collection for Kite_Macros.
+    size_t count;          // The amount of elements in the array.
+    size_t capacity;       // The complete allocated space for the array represented as
+                           // the number of collection elements of the array type.
+} Kite_Macros;             // A dynamic array collection of the macros of a .kite file.
+
+typedef struct {
+    Kite_Ids ki;              // The kites that are generated by the KITES keyword.
+    size_t section_count;     // The amount of BEGIN/END sections that have been seen.
+    bool script_begin;        // True if a BEGIN has been parsed without its END.
+    bool brace;               // True if the parser is inside of a frame block.
+    unsigned long long line;  // The line the next piece starts at or 0 for the first line.
+    Kite_Macros macros;       // The DEFINE blocks that have been parsed.
+    size_t depth;             // The amount of REPEAT, FOR and macro bodies that are expanded.
+    const char *file_name;    // The name of the file that is used in the errors at the end.
+} Kite_Parser;                // The state of the parser that is kept between pieces of a .kite file.
+
+typedef struct {
+    FILE *file;               // The .kite file that is read.
+    const char *file_name;    // The name of the file that is used in the error messages.
+    Content buffer;           // The read content that is not parsed yet.
+    size_t chunk_size;        // The amount of bytes that is read at once.
+    size_t scan_position;     // The position in the buffer up to that the tokens are scanned.
+    size_t piece_size;        // The size of the last returned piece, it is dropped by the next call.
+    bool eof;                 // True if the whole file has been read.
+    bool in_section;          // True if the scan is between a BEGIN and its END.
+    bool section_ended;       // True if the last returned piece ends a BEGIN/END section.
+    bool has_tokens;          // True if the scanned content after the last piece has tokens.
+    bool has_prelude;         // True if the last piece has tokens outside of its section.
+    size_t section_start;     // The position of the BEGIN in the last piece.
+    uint64_t section_hash;    // The hash of the tokens of the current or last section.
+    uint64_t prelude_hash;    // The hash of the tokens outside of the sections.
+} Kite_Stream;                // A chunked reader that splits a .kite file after every END.
+
+void tkbc_perfect_hash_build(Perfect_Hash *hash, const char **names, size_t count);
+size_t tkbc_perfect_hash_find(const Perfect_Hash *hash, const char *name, size_t size);
+Kite_Keyword tkbc_kite_keyword(const char *content, size_t size);
+const Team_Figure_Schema *tkbc_team_figure_schema(const char *name, size_t size);
+
+void tkbc_kite_diagnostic(Env *env, const char *file_name, unsigned long long line, unsigned long long column,
+                          const char *fmt, ...);
+void tkbc_kite_diagnostics_clear(Kite_Diagnostics *diagnostics);
+void tkbc_kite_diagnostics_destroy(Kite_Diagnostics *diagnostics);
 void tkbc_script_parser(Env *env);
+bool tkbc_script_parser_file(Env *env, const char *file_name, size_t workers);
+void tkbc_script_parser_content(Env *env, const char *file_name, char *content, size_t size, const bool *selected,
+                                size_t selected_count);
+void tkbc_kite_parser_feed(Env *env, Kite_Parser *parser, const char *file_name, char *content, size_t size,
+                           const bool *selected, size_t selected_count);
+void tkbc_kite_parser_finish(Env *env, Kite_Parser *parser);
+bool tkbc_kite_stream_open(Kite_Stream *stream, const char *file_name, size_t chunk_size);
+bool tkbc_kite_stream_next(Kite_Stream *stream, char **piece, size_t *size);
+void tkbc_kite_stream_close(Kite_Stream *stream);
+uint64_t tkbc_scan_kite_sections(const char *file_name, char *content, size_t size, Kite_Sections *sections);
+bool tkbc_parse_expansion(Env *env, Kite_Parser *parser, Lexer *lexer, Token *t);
+bool tkbc_parse_repeat(Env *env, Kite_Parser *parser, Lexer *lexer);
+bool tkbc_parse_for(Env *env, Kite_Parser *parser, Lexer *lexer);
+bool tkbc_parse_define(Env *env, Kite_Parser *parser, Lexer *lexer);
+bool tkbc_parse_macro_call(Env *env, Kite_Parser *parser, Lexer *lexer, Kite_Macro *macro);
+Kite_Macro *tkbc_find_macro(Kite_Parser *parser, const char *name, size_t size);
+void tkbc_kite_macros_destroy(Kite_Macros *macros);
 bool tkbc_parse_kis_after_generation(Env *env, Lexer *lexer, Kite_Ids *dest_kis, Kite_Ids orig_kis);
-bool tkbc_parse_move(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki, bool brace, Content *tmp_buffer);
-bool tkbc_parse_rotation(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki, bool brace, Content *tmp_buffer);
-bool tkbc_parse_tip_rotation(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki, bool brace, Content *tmp_buffer);
-
-bool tkbc_parse_number_prolog(Lexer *lexer, Content *tmp_buffer);
-bool tkbc_parse_float(float *number, Lexer *lexer, Content *tmp_buffer);
-bool tkbc_parse_size_t(size_t *number, Lexer *lexer, Content *tmp_buffer);
-bool tkbc_parse_team_figures(Env *env, Kite_Ids kis, Lexer *lexer, const char *function_name, Content *tmp_buffer);
+bool tkbc_parse_move(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki, bool brace);
+bool tkbc_parse_rotation(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki, bool brace);
+bool tkbc_parse_tip_rotation(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki, bool brace);
+bool tkbc_parse_arc(Env *env, Lexer *lexer, Kite_Ids ki, bool brace);
+bool tkbc_parse_spline(Env *env, Lexer *lexer, Action_Kind kind, Kite_Ids ki, bool brace);
+bool tkbc_parse_easing(Easing *easing, Lexer *lexer);
+
+bool tkbc_parse_number_prolog(Lexer *lexer, Token *number, bool *negative);
+bool tkbc_parse_float(float *number, Lexer *lexer);
+bool tkbc_parse_size_t(size_t *number, Lexer *lexer);
+bool tkbc_parse_team_figures(Env *env, Kite_Ids kis, Lexer *lexer, const char *function_name);
 
 #endif  // TKBC_PARSER_H
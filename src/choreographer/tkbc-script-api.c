@@ -6,6 +6,9 @@
 #include "../global/tkbc-utils.h"
 #include "tkbc-script-converter.h"
 #include "tkbc-script-handler.h"
+#include "tkbc-script-kiteb.h"
+#include "tkbc-script-optimizer.h"
+#include "tkbc-script-store.h"
 #include "tkbc.h"
 #include <stdarg.h>
 #include <stdio.h>
@@ -117,6 +120,7 @@ void tkbc__script_end(Env *env) {
     env->script_setup = false;
 
     assert(env->scratch_buf_script.count > 0);
+    tkbc_optimize_script(&env->scratch_buf_script, &env->script_optimization);
     env->scratch_buf_script.script_id = env->script_id_counter++ + 1;
 
     if (!env->scratch_buf_script.name) {
@@ -247,6 +251,121 @@ Frame *tkbc__frame_generate(Env *env, Action_Kind kind, Kite_Ids kite_ids, Actio
     return frame;
 }
 
+/**
+ * @brief The function starts a new block that is generated in bulk by
+ * tkbc_block_frame() and registered by tkbc_block_end(). The frames, the
+ * kite positions and the ids of the single kite frames are allocated once for
+ * the given amount of frames, instead of one allocation and copy per frame. It
+ * is meant for team figures that give every kite its own frame.
+ *
+ * @param env The global state of the application.
+ * @param frames_count The expected amount of frames in the block, more frames
+ * are still possible.
+ * @return True if the block is started, false if the call has happen outside a
+ * script declaration.
+ */
+bool tkbc_block_begin(Env *env, size_t frames_count) {
+    if (!env->script_setup) {
+        return false;
+    }
+
+    Space *space = &env->scratch_buf_script.space;
+    Frames *frames = &env->scratch_buf_frames;
+    tkbc_reset_frames_internal_data(frames);
+    if (frames->capacity < frames_count) {
+        frames->elements = space_realloc(space, frames->elements, frames->capacity * sizeof(*frames->elements),
+                                         frames_count * sizeof(*frames->elements));
+        frames->capacity = frames->elements ? frames_count : 0;
+    }
+    Kite_Positions *positions = &frames->kite_frame_positions;
+    size_t positions_count = frames_count < env->kite_array.count ? frames_count : env->kite_array.count;
+    if (positions->capacity < positions_count) {
+        positions->elements =
+            space_realloc(space, positions->elements, positions->capacity * sizeof(*positions->elements),
+                          positions_count * sizeof(*positions->elements));
+        positions->capacity = positions->elements ? positions_count : 0;
+    }
+
+    Block_Builder *builder = &env->block_builder;
+    builder->ids = frames_count > 0 ? space_malloc(space, frames_count * sizeof(*builder->ids)) : NULL;
+    builder->ids_count = 0;
+    builder->ids_capacity = builder->ids ? frames_count : 0;
+    builder->is_open = frames->capacity >= frames_count && positions->capacity >= positions_count &&
+                       builder->ids_capacity == frames_count;
+    if (!builder->is_open) {
+        tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+    }
+    return builder->is_open;
+}
+
+/**
+ * @brief The function appends a frame for a single kite to the block that is
+ * started by tkbc_block_begin(). The frame is constructed in place in the
+ * block, so no temporary frame or id list is allocated.
+ *
+ * @param env The global state of the application.
+ * @param kind The action kind to identify the given raw_action.
+ * @param kite_id The kite the action should be applied to, it is ignored for
+ * the wait and quit actions.
+ * @param raw_action The action that matches the given kind.
+ * @param duration The duration the action should take.
+ * @return The frame in the block, it stays valid until the next frame is added
+ * or NULL if no block is started.
+ */
+Frame *tkbc__block_frame(Env *env, Action_Kind kind, Id kite_id, Action raw_action, float duration) {
+    Block_Builder *builder = &env->block_builder;
+    if (!env->script_setup || !builder->is_open) {
+        return NULL;
+    }
+
+    Space *space = &env->scratch_buf_script.space;
+    Frame frame = {
+        .duration = duration,
+        .original_duration = duration,
+        .kind = kind,
+        .action = raw_action,
+    };
+    if (kind != ACTION_KITE_QUIT && kind != ACTION_KITE_WAIT) {
+        if (builder->ids_count >= builder->ids_capacity) {
+            // More frames than announced, the next ids are preallocated in the
+            // same amount again.
+            size_t capacity = builder->ids_capacity > 0 ? builder->ids_capacity : SPACE_DAP_CAP;
+            builder->ids = space_malloc(space, capacity * sizeof(*builder->ids));
+            if (builder->ids == NULL) {
+                tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+                builder->ids_capacity = 0;
+                return NULL;
+            }
+            builder->ids_count = 0;
+            builder->ids_capacity = capacity;
+        }
+        Id *id = &builder->ids[builder->ids_count++];
+        *id = kite_id;
+        frame.kite_id_array = (Kite_Ids){.elements = id, .count = 1, .capacity = 1};
+    }
+
+    Frames *frames = &env->scratch_buf_frames;
+    space_dap(space, frames, frame);
+    return &frames->elements[frames->count - 1];
+}
+
+/**
+ * @brief The function registers the block that is generated by
+ * tkbc_block_frame() as a new frame block of the script.
+ *
+ * @param env The global state of the application.
+ * @return True if the block is registered, false if no block is started.
+ */
+bool tkbc_block_end(Env *env) {
+    Block_Builder *builder = &env->block_builder;
+    if (!builder->is_open) {
+        return false;
+    }
+    tkbc_register_frames_array(env, &env->scratch_buf_frames);
+    memset(builder, 0, sizeof(*builder));
+    return true;
+}
+
 /**
  * @brief The function can be used to collect all given frames into one frame
  * list and register them as a new frame block. The provided memory is freed
@@ -261,7 +380,10 @@ void tkbc__register_frames(Env *env, ...) {
     va_start(args, env);
     Frame *frame = va_arg(args, Frame *);
     while (frame != NULL) {
-        Frame f = tkbc_deep_copy_frame(&env->scratch_buf_script.space, frame);
+        // Frames of the script API are generated in the scratch space together
+        // with their ids, so they are taken over without a deep copy.
+        bool is_scratch_frame = space_find_planet_from_ptr(&env->scratch_buf_script.space, frame) != NULL;
+        Frame f = is_scratch_frame ? *frame : tkbc_deep_copy_frame(&env->scratch_buf_script.space, frame);
         space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, f);
 
         if (frame->kite_id_array.script_id_append) {
@@ -270,7 +392,7 @@ void tkbc__register_frames(Env *env, ...) {
         }
         // This allows the user to create a frame ptr manually and pass it and not
         // use the provided script API that uses the space buffer.
-        if (!space_find_planet_from_ptr(&env->scratch_buf_script.space, frame)) {
+        if (!is_scratch_frame) {
             free(frame);
         }
         frame = va_arg(args, Frame *);
@@ -298,6 +420,7 @@ void tkbc_register_frames_array(Env *env, Frames *frames) {
         isscratch = true;
     }
 
+    tkbc_kite_id_map_build(env);
     for (size_t i = 0; i < frames->count; ++i) {
         // Patching frames
         Frame *frame = &frames->elements[i];
@@ -307,20 +430,28 @@ void tkbc_register_frames_array(Env *env, Frames *frames) {
         }
 
         for (size_t j = 0; j < frame->kite_id_array.count; ++j) {
-            Kite_State *state = tkbc_get_kite_state_by_id(env, frame->kite_id_array.elements[j]);
-            assert(state);
-            if (!state) {
+            Kite_Id_Slot *slot = tkbc_kite_id_map_find(env, frame->kite_id_array.elements[j]);
+            assert(slot);
+            if (!slot) {
                 continue;
             }
+            Kite_State *state = &env->kite_array.elements[slot->kite_index];
             state->kite->old_angle = state->kite->angle;
             state->kite->old_center = state->kite->center;
             state->is_script_kite = true;
         }
     }
     tkbc_patch_frames_kite_positions(env, frames, &env->scratch_buf_script.space);
-    Frames copy_frames = tkbc_deep_copy_frames(&env->scratch_buf_script.space, frames);
-    space_dap(&env->scratch_buf_script.space, &env->scratch_buf_script, copy_frames);
-    tkbc_reset_frames_internal_data(frames);
+    if (isscratch) {
+        // The scratch frames already live in the space of the scratch script, so
+        // they are moved into the script and the scratch buffer starts empty.
+        space_dap(&env->scratch_buf_script.space, &env->scratch_buf_script, *frames);
+        memset(frames, 0, sizeof(*frames));
+    } else {
+        Frames copy_frames = tkbc_deep_copy_frames(&env->scratch_buf_script.space, frames);
+        space_dap(&env->scratch_buf_script.space, &env->scratch_buf_script, copy_frames);
+        tkbc_reset_frames_internal_data(frames);
+    }
 
     assert((int) env->scratch_buf_script.count - 1 >= 0);
     env->scratch_buf_script.elements[env->scratch_buf_script.count - 1].frames_index =
@@ -491,6 +622,25 @@ void tkbc_print_script(FILE *stream, Script *script) {
                 fprintf(stream, "        Tip:%s\n", action.tip == LEFT_TIP ? "LEFT_TIP" : "RIGHT_TIP");
             } break;
 
+            case ACTION_KITE_ARC: {
+                fprintf(stream, "      Action-Kind: KITE_ARC\n");
+                Arc_Action action = script->elements[block].elements[frame].action.as_arc;
+                fprintf(stream, "        Radius:%f\n", action.radius);
+                fprintf(stream, "        Angles:(%f,%f)\n", action.begin_angle, action.end_angle);
+                fprintf(stream, "        Rotation:%f\n", action.rotation);
+                fprintf(stream, "        Easing:%s\n", tkbc_easing_to_cstr(action.easing));
+            } break;
+
+            case ACTION_KITE_BEZIER:
+            case ACTION_KITE_CATMULL_ROM: {
+                fprintf(stream, "      Action-Kind: %s\n", kind == ACTION_KITE_BEZIER ? "KITE_BEZIER" : "KITE_CATMULL_ROM");
+                Spline_Action action = script->elements[block].elements[frame].action.as_bezier;
+                fprintf(stream, "        Control-1:(%f,%f)\n", action.control_1.x, action.control_1.y);
+                fprintf(stream, "        Control-2:(%f,%f)\n", action.control_2.x, action.control_2.y);
+                fprintf(stream, "        Position:(%f,%f)\n", action.position.x, action.position.y);
+                fprintf(stream, "        Easing:%s\n", tkbc_easing_to_cstr(action.easing));
+            } break;
+
             default: {
                 assert("UNREACHABLE tkbc_print_scipt");
             }
@@ -528,7 +678,9 @@ void tkbc_print_all_scripts(FILE *stream, Env *env) {
         return;
     }
     for (size_t i = 0; i < env->scripts.count; ++i) {
-        tkbc_print_script(stream, &env->scripts.elements[i]);
+        if (tkbc_script_store_ensure_loaded(env, &env->scripts.elements[i])) {
+            tkbc_print_script(stream, &env->scripts.elements[i]);
+        }
     }
 }
 
@@ -546,11 +698,22 @@ void tkbc_print_all_scripts(FILE *stream, Env *env) {
  */
 void tkbc_debug_print_and_export_all_scripts(FILE *stream, Env *env, const char *path) {
     for (size_t i = 0; i < env->scripts.count; ++i) {
-        if (stream) {
+        if (stream && tkbc_script_store_ensure_loaded(env, &env->scripts.elements[i])) {
             tkbc_print_script(stream, &env->scripts.elements[i]);
         }
+    }
+    if (env->scripts.count > 0) {
         int ret = tkbc_export_all_scripts_to_dot_kite_file_from_mem(env, path);
         assert(ret == 0 && "ERROR: Not all the scripts are correctly exported.");
         (void) ret;
     }
+
+    // The complete show is also stored as one binary file for fast loading.
+    if (env->scripts.count > 0) {
+        const char *kiteb_path = space_tprintf("%sscripts.kiteb", path);
+        int ret = tkbc_export_all_scripts_to_kiteb_file_from_mem(env, kiteb_path);
+        assert(ret == 0 && "ERROR: Not all the scripts are correctly exported.");
+        (void) ret;
+        space_reset_tspace();
+    }
 }
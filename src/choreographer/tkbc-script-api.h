@@ -72,8 +72,57 @@ void tkbc__register_frames(Env *env, ...);
     tkbc_frame_generate(ACTION_KITE_TIP_ROTATION, (kite_ids),                                                          \
                         ((Tip_Rotation_Action){.angle = (new_angle), .tip = (new_tip)}), (duration))
 
+#define KITE_ARC(kite_ids, arc_radius, arc_begin_angle, arc_end_angle, arc_rotation, arc_easing, duration)             \
+    tkbc_frame_generate(ACTION_KITE_ARC, (kite_ids),                                                                   \
+                        ((Arc_Action){.radius = (arc_radius),                                                          \
+                                      .begin_angle = (arc_begin_angle),                                                \
+                                      .end_angle = (arc_end_angle),                                                    \
+                                      .rotation = (arc_rotation),                                                      \
+                                      .easing = (arc_easing)}),                                                        \
+                        (duration))
+
+#define KITE_BEZIER(kite_ids, c1_x, c1_y, c2_x, c2_y, pos_x, pos_y, spline_easing, duration)                           \
+    tkbc_frame_generate(ACTION_KITE_BEZIER, (kite_ids),                                                                \
+                        ((Bezier_Action){.control_1 = {(c1_x), (c1_y)},                                                \
+                                         .control_2 = {(c2_x), (c2_y)},                                                \
+                                         .position = {(pos_x), (pos_y)},                                               \
+                                         .easing = (spline_easing)}),                                                  \
+                        (duration))
+
+#define KITE_CATMULL_ROM(kite_ids, c1_x, c1_y, c2_x, c2_y, pos_x, pos_y, spline_easing, duration)                      \
+    tkbc_frame_generate(ACTION_KITE_CATMULL_ROM, (kite_ids),                                                           \
+                        ((Catmull_Rom_Action){.control_1 = {(c1_x), (c1_y)},                                           \
+                                              .control_2 = {(c2_x), (c2_y)},                                           \
+                                              .position = {(pos_x), (pos_y)},                                          \
+                                              .easing = (spline_easing)}),                                             \
+                        (duration))
+
 void tkbc_register_frames_array(Env *env, Frames *frames);
 
+// The block builder generates a complete block with one frame per kite in
+// bulk, the frames are constructed in place and registered at once.
+bool tkbc_block_begin(Env *env, size_t frames_count);
+Frame *tkbc__block_frame(Env *env, Action_Kind kind, Id kite_id, Action raw_action, float duration);
+#define tkbc_block_frame(kind, kite_id, raw_action, duration)                                                          \
+    tkbc__block_frame(env, kind, kite_id, (Action) raw_action, duration)
+bool tkbc_block_end(Env *env);
+
+#define BLOCK_KITE_MOVE(kite_id, pos_x, pos_y, duration)                                                               \
+    tkbc_block_frame(ACTION_KITE_MOVE, (kite_id), ((Move_Action){.position.x = (pos_x), .position.y = (pos_y)}),       \
+                     (duration))
+
+#define BLOCK_KITE_MOVE_ADD(kite_id, pos_x, pos_y, duration)                                                           \
+    tkbc_block_frame(ACTION_KITE_MOVE_ADD, (kite_id),                                                                  \
+                     ((Move_Add_Action){.position.x = (pos_x), .position.y = (pos_y)}), (duration))
+
+#define BLOCK_KITE_ROTATION(kite_id, new_angle, duration)                                                              \
+    tkbc_block_frame(ACTION_KITE_ROTATION, (kite_id), ((Rotation_Action){.angle = (new_angle)}), (duration))
+
+#define BLOCK_KITE_ROTATION_ADD(kite_id, new_angle, duration)                                                          \
+    tkbc_block_frame(ACTION_KITE_ROTATION_ADD, (kite_id), ((Rotation_Add_Action){.angle = (new_angle)}), (duration))
+
+#define BLOCK_KITE_ARC(kite_id, arc, duration) tkbc_block_frame(ACTION_KITE_ARC, (kite_id), (arc), (duration))
+
 Kite_Ids tkbc__indexs_append(Space *space, ...);
 #define tkbc_indexs_append(...) tkbc__indexs_append(&env->_id_space, __VA_ARGS__, UINT_MAX)
 #define ID(...) tkbc_indexs_append(__VA_ARGS__)
@@ -0,0 +1,589 @@
+#include "tkbc-script-baker.h"
+#include "../global/tkbc-types.h"
+#include "../global/tkbc-utils.h"
+#include "tkbc-collision.h"
+#include "tkbc-script-api.h"
+#include "tkbc-script-handler.h"
+#include "tkbc-script-store.h"
+#include "tkbc.h"
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// The additional simulated time a block gets after its longest frame duration
+// before it counts as never finishing.
+#define TKBC_BAKE_BLOCK_TIMEOUT_GRACE 1.0f
+
+typedef struct {
+    Env *env;               // The env that holds the scripts and the kites.
+    Bake_Reports *reports;  // The preallocated reports one per script.
+    float dt;               // The fixed delta time of the simulation.
+    atomic_size_t next;     // The index of the next script to bake.
+} Bake_Job;                 // The shared state of all bake workers.
+
+/**
+ * @brief The function computes the simulated time a block can take until it
+ * is considered as never finishing.
+ *
+ * @param frames The block of frames that is checked.
+ * @return The timeout in seconds.
+ */
+static float tkbc_bake_block_timeout(Frames *frames) {
+    float max_duration = 0;
+    for (size_t i = 0; i < frames->count; ++i) {
+        if (frames->elements[i].original_duration > max_duration) {
+            max_duration = frames->elements[i].original_duration;
+        }
+    }
+    return max_duration + TKBC_BAKE_BLOCK_TIMEOUT_GRACE;
+}
+
+/**
+ * @brief The function computes how far the body of the kite reaches outside of
+ * the window area. The leading edge is covered by the tips of the triangles.
+ *
+ * @param kite The kite that is checked, its geometry is materialized.
+ * @param width The width of the window area.
+ * @param height The height of the window area.
+ * @return The largest distance of a body point outside of the area in pixels or
+ * 0 if the kite is completely inside.
+ */
+static float tkbc_bake_kite_excess(Kite *kite, float width, float height) {
+    tkbc_kite_materialize_geometry(kite);
+    Vector2 points[] = {
+        kite->center,   kite->left.v1,  kite->left.v2,  kite->left.v3,
+        kite->right.v1, kite->right.v2, kite->right.v3,
+    };
+
+    float excess = 0;
+    for (size_t i = 0; i < sizeof(points) / sizeof(*points); ++i) {
+        excess = fmaxf(excess, -points[i].x);
+        excess = fmaxf(excess, points[i].x - width);
+        excess = fmaxf(excess, -points[i].y);
+        excess = fmaxf(excess, points[i].y - height);
+    }
+    return excess;
+}
+
+/**
+ * @brief The function records every active kite that is outside of the window
+ * area. A kite gets one event per block, that holds the first time it has left
+ * the area and the largest distance it was outside during the block.
+ *
+ * @param bake_env The env of the bake with the simulated kites.
+ * @param report The report where the events are added.
+ * @param block The block that is currently played.
+ * @param kite_events The event index of every kite in the current block or
+ * SIZE_MAX if the kite has not left the area in this block.
+ */
+static void tkbc_bake_check_bounds(Env *bake_env, Bake_Report *report, Index block, size_t *kite_events) {
+    if (bake_env->window_width == 0 || bake_env->window_height == 0) {
+        return;
+    }
+    for (size_t i = 0; i < bake_env->kite_array.count; ++i) {
+        Kite_State *kite_state = &bake_env->kite_array.elements[i];
+        if (!kite_state->is_active) {
+            continue;
+        }
+        float excess = tkbc_bake_kite_excess(kite_state->kite, bake_env->window_width, bake_env->window_height);
+        if (excess <= 0) {
+            continue;
+        }
+        if (kite_events[i] == SIZE_MAX) {
+            Bake_Bounds_Event event = {
+                .kite_id = kite_state->kite_id,
+                .block = block,
+                .time = report->duration,
+                .excess = excess,
+            };
+            kite_events[i] = report->out_of_bounds.count;
+            tkbc_dap(&report->out_of_bounds, event);
+        } else if (excess > report->out_of_bounds.elements[kite_events[i]].excess) {
+            report->out_of_bounds.elements[kite_events[i]].excess = excess;
+        }
+    }
+}
+
+/**
+ * @brief The function checks the spacing of all active kites. The closest pair
+ * of the block is kept in the timing and every pair of touching kites gets one
+ * contact per block, that holds the time of the first contact.
+ *
+ * @param bake_env The env of the bake with the simulated kites.
+ * @param report The report where the contacts are added.
+ * @param timing The timing of the current block.
+ * @param block_contacts The index of the first contact of the current block.
+ * @param grid The spatial hash that is reused between the steps.
+ * @param proximities The buffer for the close kites of one step.
+ */
+static void tkbc_bake_check_collisions(Env *bake_env, Bake_Report *report, Bake_Block *timing, size_t block_contacts,
+                                       Collision_Grid *grid, Kite_Proximities *proximities) {
+    tkbc_collision_check(grid, &bake_env->kite_array, TKBC_COLLISION_NEAR_DISTANCE, proximities);
+    for (size_t i = 0; i < proximities->count; ++i) {
+        Kite_Proximity *proximity = &proximities->elements[i];
+        if (proximity->separation < timing->min_separation) {
+            timing->min_separation = proximity->separation;
+            timing->closest_kite_id_a = proximity->kite_id_a;
+            timing->closest_kite_id_b = proximity->kite_id_b;
+        }
+        if (proximity->separation > 0) {
+            continue;
+        }
+
+        bool known = false;
+        for (size_t j = block_contacts; j < report->contacts.count && !known; ++j) {
+            Bake_Contact *contact = &report->contacts.elements[j];
+            known = contact->kite_id_a == proximity->kite_id_a && contact->kite_id_b == proximity->kite_id_b;
+        }
+        if (!known) {
+            Bake_Contact contact = {
+                .kite_id_a = proximity->kite_id_a,
+                .kite_id_b = proximity->kite_id_b,
+                .block = timing->block,
+                .time = report->duration,
+            };
+            tkbc_dap(&report->contacts, contact);
+        }
+    }
+}
+
+/**
+ * @brief The function simulates the given script headless with a fixed delta
+ * time until it has finished. The script and the kites are copied, so the env
+ * and the script stay untouched and the function can run in parallel for
+ * different scripts of the same env.
+ *
+ * @param env The global state of the application that holds the kites.
+ * @param script The script that should be baked.
+ * @param dt The fixed delta time of one simulation step in seconds.
+ * @param report The report that is filled with the results of the bake.
+ * @return True if every block of the script has finished on its own, otherwise
+ * false.
+ */
+bool tkbc_bake_script(Env *env, Script *script, float dt, Bake_Report *report) {
+    assert(dt > 0);
+    memset(report, 0, sizeof(*report));
+    report->script_id = script->script_id;
+    report->name = strdup(script->name ? script->name : "");
+    report->finished = true;
+
+    // An evicted script is read from its spill file without touching the env,
+    // the workers run in parallel.
+    Script source = *script;
+    Space spill_space = {0};
+    if (script->is_evicted) {
+        const char *path = tkbc_script_store_path(&spill_space, env, script->script_id);
+        if (!tkbc_script_store_read(path, &spill_space, &source)) {
+            space_free_space(&spill_space);
+            report->finished = false;
+            return false;
+        }
+    }
+    script = &source;
+
+    report->blocks_count = script->count;
+    if (script->count == 0) {
+        space_free_space(&spill_space);
+        return true;
+    }
+
+    tkbc_set_virtual_frame_time(dt);
+
+    Env bake_env = {0};
+    bake_env.window_width = env->window_width;
+    bake_env.window_height = env->window_height;
+    bake_env.fps = env->fps;
+    bake_env.script_finished = true;
+
+    for (size_t i = 0; i < env->kite_array.count; ++i) {
+        Kite_State kite_state = env->kite_array.elements[i];
+        kite_state.kite = malloc(sizeof(*kite_state.kite));
+        if (kite_state.kite == NULL) {
+            tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+            abort();
+        }
+        memcpy(kite_state.kite, env->kite_array.elements[i].kite, sizeof(*kite_state.kite));
+        // The interpolation starts from the old pose, that is normally set by
+        // the block switch in tkbc_script_update_frames().
+        kite_state.kite->old_center = kite_state.kite->center;
+        kite_state.kite->old_angle = kite_state.kite->angle;
+        tkbc_dap(&bake_env.kite_array, kite_state);
+    }
+
+    Space space = {0};
+    Script copy = tkbc_deep_copy_script(&space, script);
+    copy.space = space;
+    space_free_space(&spill_space);
+    tkbc_dap(&bake_env.scripts, copy);
+
+    if (!tkbc_load_script_id(&bake_env, copy.script_id, true)) {
+        report->finished = false;
+        goto defer;
+    }
+
+    size_t *kite_events = malloc((bake_env.kite_array.count + 1) * sizeof(*kite_events));
+    if (kite_events == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+        abort();
+    }
+    memset(kite_events, 0xff, (bake_env.kite_array.count + 1) * sizeof(*kite_events));
+
+    Collision_Grid grid = {0};
+    Kite_Proximities proximities = {0};
+    size_t block_contacts = 0;
+
+    Bake_Block timing = {.block = bake_env.frames->frames_index, .finished = true, .min_separation = INFINITY};
+    float block_timeout = tkbc_bake_block_timeout(bake_env.frames);
+    while (!tkbc_script_finished(&bake_env)) {
+        tkbc_script_update_frames(&bake_env);
+        report->duration += dt;
+        timing.duration += dt;
+        tkbc_bake_check_bounds(&bake_env, report, timing.block, kite_events);
+        tkbc_bake_check_collisions(&bake_env, report, &timing, block_contacts, &grid, &proximities);
+
+        if (bake_env.frames->frames_index != timing.block) {
+            tkbc_dap(&report->blocks, timing);
+            timing = (Bake_Block){.block = bake_env.frames->frames_index, .finished = true, .min_separation = INFINITY};
+            block_timeout = tkbc_bake_block_timeout(bake_env.frames);
+            block_contacts = report->contacts.count;
+            memset(kite_events, 0xff, (bake_env.kite_array.count + 1) * sizeof(*kite_events));
+            continue;
+        }
+
+        if (!tkbc_script_finished(&bake_env) && timing.duration > block_timeout) {
+            // Skip the block so the rest of the script can still be validated.
+            tkbc_dap(&report->unfinished_blocks, timing.block);
+            report->finished = false;
+            timing.finished = false;
+            for (size_t i = 0; i < bake_env.frames->count; ++i) {
+                bake_env.frames->elements[i].finished = true;
+            }
+        }
+    }
+    tkbc_dap(&report->blocks, timing);
+    free(kite_events);
+    tkbc_collision_grid_destroy(&grid);
+    free(proximities.elements);
+
+    for (size_t i = 0; i < bake_env.kite_array.count; ++i) {
+        Kite_State *kite_state = &bake_env.kite_array.elements[i];
+        if (!kite_state->is_active) {
+            continue;
+        }
+        Kite_Position pose = {
+            .kite_id = kite_state->kite_id,
+            .position = kite_state->kite->center,
+            .angle = kite_state->kite->angle,
+        };
+        tkbc_dap(&report->final_poses, pose);
+    }
+
+defer:
+    space_free_space(&bake_env.scripts.elements[0].space);
+    free(bake_env.scripts.elements);
+    tkbc_destroy_kite_array(&bake_env.kite_array);
+    free(bake_env.kite_id_map.slots);
+    tkbc_set_virtual_frame_time(0);
+    return report->finished;
+}
+
+/**
+ * @brief The function is the entry point of a bake worker thread. It takes
+ * scripts from the shared job until every script is baked.
+ *
+ * @param arg The shared Bake_Job.
+ * @return Always NULL.
+ */
+static void *tkbc_bake_worker(void *arg) {
+    Bake_Job *job = arg;
+    for (;;) {
+        size_t i = atomic_fetch_add(&job->next, 1);
+        if (i >= job->env->scripts.count) {
+            break;
+        }
+        tkbc_bake_script(job->env, &job->env->scripts.elements[i], job->dt, &job->reports->elements[i]);
+    }
+    return NULL;
+}
+
+/**
+ * @brief The function can be used to get a sensible amount of bake workers for
+ * the current machine.
+ *
+ * @return The amount of online processors or 1 if it is unknown.
+ */
+size_t tkbc_bake_default_workers(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > 0) {
+        return (size_t) n;
+    }
+#endif
+    return 1;
+}
+
+/**
+ * @brief The function bakes and validates every script of the env on a pool of
+ * worker threads. Every worker simulates one script at a time headless with its
+ * own copy of the kites, so the scripts are independent of each other.
+ *
+ * @param env The global state of the application that holds the scripts.
+ * @param workers The amount of worker threads, 0 uses the processor count.
+ * @param reports The reports that are filled in the order of env->scripts, the
+ * previous content is destroyed.
+ * @return True if every script has finished all of its blocks, otherwise
+ * false.
+ */
+bool tkbc_bake_scripts(Env *env, size_t workers, Bake_Reports *reports) {
+    tkbc_destroy_bake_reports(reports);
+    if (env->scripts.count == 0) {
+        return true;
+    }
+
+    reports->elements = calloc(env->scripts.count, sizeof(*reports->elements));
+    if (reports->elements == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+        return false;
+    }
+    reports->count = env->scripts.count;
+    reports->capacity = env->scripts.count;
+
+    if (workers == 0) {
+        workers = tkbc_bake_default_workers();
+    }
+    if (workers > env->scripts.count) {
+        workers = env->scripts.count;
+    }
+
+    Bake_Job job = {
+        .env = env,
+        .reports = reports,
+        .dt = TARGET_DT,
+    };
+    atomic_init(&job.next, 0);
+
+    pthread_t *threads = calloc(workers, sizeof(*threads));
+    if (threads == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+        return false;
+    }
+
+    size_t started = 0;
+    for (; started < workers; ++started) {
+        if (pthread_create(&threads[started], NULL, tkbc_bake_worker, &job) != 0) {
+            tkbc_fprintf(stderr, "WARNING", "Could only start %zu bake workers.\n", started);
+            break;
+        }
+    }
+
+    // If no thread could be started the work is done on the calling thread.
+    if (started == 0) {
+        tkbc_bake_worker(&job);
+    }
+    for (size_t i = 0; i < started; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+
+    bool ok = true;
+    for (size_t i = 0; i < reports->count; ++i) {
+        ok = ok && reports->elements[i].finished;
+    }
+    return ok;
+}
+
+/**
+ * @brief The function prints a human readable summary of the given reports.
+ *
+ * @param stream The stream where the reports should be printed to.
+ * @param reports The reports that should be printed.
+ */
+void tkbc_print_bake_reports(FILE *stream, Bake_Reports *reports) {
+    double total = 0;
+    for (size_t i = 0; i < reports->count; ++i) {
+        Bake_Report *report = &reports->elements[i];
+        total += report->duration;
+
+        fprintf(stream, "[%s] %s (id %zu): %.3fs, %zu blocks\n", report->finished ? "  OK  " : "FAILED", report->name,
+                report->script_id, report->duration, report->blocks_count);
+
+        if (report->unfinished_blocks.count) {
+            fprintf(stream, "    unfinished blocks:");
+            for (size_t j = 0; j < report->unfinished_blocks.count; ++j) {
+                fprintf(stream, " %zu", report->unfinished_blocks.elements[j]);
+            }
+            fprintf(stream, "\n");
+        }
+
+        for (size_t j = 0; j < report->out_of_bounds.count; ++j) {
+            Bake_Bounds_Event *event = &report->out_of_bounds.elements[j];
+            fprintf(stream, "    kite %zu left the window in block %zu at %.3fs by %Gpx\n", event->kite_id,
+                    event->block, event->time, event->excess);
+        }
+
+        for (size_t j = 0; j < report->contacts.count; ++j) {
+            Bake_Contact *contact = &report->contacts.elements[j];
+            fprintf(stream, "    kite %zu touched kite %zu in block %zu at %.3fs\n", contact->kite_id_a,
+                    contact->kite_id_b, contact->block, contact->time);
+        }
+
+        for (size_t j = 0; j < report->final_poses.count; ++j) {
+            Kite_Position *pose = &report->final_poses.elements[j];
+            fprintf(stream, "    kite %zu: (%G, %G) %G\n", pose->kite_id, pose->position.x, pose->position.y,
+                    pose->angle);
+        }
+    }
+    fprintf(stream, "Baked %zu scripts with a total duration of %.3fs.\n", reports->count, total);
+}
+
+/**
+ * @brief The function writes the given string as a quoted and escaped JSON
+ * string.
+ *
+ * @param stream The stream where the string should be written to.
+ * @param str The string that should be written.
+ */
+static void tkbc_json_write_string(FILE *stream, const char *str) {
+    fputc('"', stream);
+    for (const unsigned char *c = (const unsigned char *) str; *c; ++c) {
+        switch (*c) {
+        case '"':
+            fputs("\\\"", stream);
+            break;
+        case '\\':
+            fputs("\\\\", stream);
+            break;
+        case '\n':
+            fputs("\\n", stream);
+            break;
+        case '\t':
+            fputs("\\t", stream);
+            break;
+        default:
+            if (*c < 0x20) {
+                fprintf(stream, "\\u%04x", *c);
+            } else {
+                fputc(*c, stream);
+            }
+        }
+    }
+    fputc('"', stream);
+}
+
+/**
+ * @brief The function checks if the report has neither skipped blocks nor kites
+ * that have left the window area or have touched each other.
+ *
+ * @param report The report that is checked.
+ * @return True if the script has passed the bake, otherwise false.
+ */
+bool tkbc_bake_report_passed(Bake_Report *report) {
+    return report->finished && report->out_of_bounds.count == 0 && report->contacts.count == 0;
+}
+
+/**
+ * @brief The function writes the given reports as a JSON document, that can be
+ * consumed by other tools. The scripts are listed in the order of the reports.
+ *
+ * @param stream The stream where the JSON document should be written to.
+ * @param env The env that holds the window area the scripts are checked
+ * against.
+ * @param reports The reports that should be written.
+ * @return True if every script has passed the bake, otherwise false.
+ */
+bool tkbc_write_bake_reports_json(FILE *stream, Env *env, Bake_Reports *reports) {
+    double total = 0;
+    bool passed = true;
+    for (size_t i = 0; i < reports->count; ++i) {
+        total += reports->elements[i].duration;
+        passed = passed && tkbc_bake_report_passed(&reports->elements[i]);
+    }
+
+    fprintf(stream, "{\n");
+    fprintf(stream, "  \"passed\": %s,\n", passed ? "true" : "false");
+    fprintf(stream, "  \"window\": {\"width\": %zu, \"height\": %zu},\n", env->window_width, env->window_height);
+    fprintf(stream, "  \"dt\": %.9g,\n", TARGET_DT);
+    fprintf(stream, "  \"total_duration\": %.6f,\n", total);
+    fprintf(stream, "  \"scripts\": [");
+    for (size_t i = 0; i < reports->count; ++i) {
+        Bake_Report *report = &reports->elements[i];
+        fprintf(stream, "%s\n    {\n", i ? "," : "");
+        fprintf(stream, "      \"id\": %zu,\n", report->script_id);
+        fprintf(stream, "      \"name\": ");
+        tkbc_json_write_string(stream, report->name);
+        fprintf(stream, ",\n");
+        fprintf(stream, "      \"passed\": %s,\n", tkbc_bake_report_passed(report) ? "true" : "false");
+        fprintf(stream, "      \"finished\": %s,\n", report->finished ? "true" : "false");
+        fprintf(stream, "      \"duration\": %.6f,\n", report->duration);
+
+        fprintf(stream, "      \"blocks\": [");
+        for (size_t j = 0; j < report->blocks.count; ++j) {
+            Bake_Block *block = &report->blocks.elements[j];
+            fprintf(stream, "%s\n        {\"index\": %zu, \"duration\": %.6f, \"finished\": %s, ", j ? "," : "",
+                    block->block, block->duration, block->finished ? "true" : "false");
+            if (isinf(block->min_separation)) {
+                fprintf(stream, "\"min_separation\": null}");
+            } else {
+                fprintf(stream, "\"min_separation\": %.3f, \"closest_kites\": [%zu, %zu]}", block->min_separation,
+                        block->closest_kite_id_a, block->closest_kite_id_b);
+            }
+        }
+        fprintf(stream, "%s],\n", report->blocks.count ? "\n      " : "");
+
+        fprintf(stream, "      \"out_of_bounds\": [");
+        for (size_t j = 0; j < report->out_of_bounds.count; ++j) {
+            Bake_Bounds_Event *event = &report->out_of_bounds.elements[j];
+            fprintf(stream, "%s\n        {\"kite_id\": %zu, \"block\": %zu, \"time\": %.6f, \"excess\": %.3f}",
+                    j ? "," : "", event->kite_id, event->block, event->time, event->excess);
+        }
+        fprintf(stream, "%s],\n", report->out_of_bounds.count ? "\n      " : "");
+
+        fprintf(stream, "      \"contacts\": [");
+        for (size_t j = 0; j < report->contacts.count; ++j) {
+            Bake_Contact *contact = &report->contacts.elements[j];
+            fprintf(stream, "%s\n        {\"kite_ids\": [%zu, %zu], \"block\": %zu, \"time\": %.6f}", j ? "," : "",
+                    contact->kite_id_a, contact->kite_id_b, contact->block, contact->time);
+        }
+        fprintf(stream, "%s],\n", report->contacts.count ? "\n      " : "");
+
+        fprintf(stream, "      \"final_poses\": [");
+        for (size_t j = 0; j < report->final_poses.count; ++j) {
+            Kite_Position *pose = &report->final_poses.elements[j];
+            fprintf(stream, "%s\n        {\"kite_id\": %zu, \"x\": %.3f, \"y\": %.3f, \"angle\": %.3f}",
+                    j ? "," : "", pose->kite_id, pose->position.x, pose->position.y, pose->angle);
+        }
+        fprintf(stream, "%s]\n", report->final_poses.count ? "\n      " : "");
+        fprintf(stream, "    }");
+    }
+    fprintf(stream, "%s]\n", reports->count ? "\n  " : "");
+    fprintf(stream, "}\n");
+    return passed;
+}
+
+/**
+ * @brief The function frees all the memory that is held by the given reports.
+ *
+ * @param reports The reports that should be destroyed.
+ */
+void tkbc_destroy_bake_reports(Bake_Reports *reports) {
+    for (size_t i = 0; i < reports->count; ++i) {
+        Bake_Report *report = &reports->elements[i];
+        free(report->name);
+        free(report->unfinished_blocks.elements);
+        free(report->blocks.elements);
+        free(report->out_of_bounds.elements);
+        free(report->contacts.elements);
+        free(report->final_poses.elements);
+    }
+    free(reports->elements);
+    reports->elements = NULL;
+    reports->count = 0;
+    reports->capacity = 0;
+}
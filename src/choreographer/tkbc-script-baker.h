@@ -0,0 +1,19 @@
+#ifndef TKBC_SCRIPT_BAKER_H_
+#define TKBC_SCRIPT_BAKER_H_
+
+#include "../global/tkbc-types.h"
+#include <stdio.h>
+
+// ===========================================================================
+// ========================== Script Baker ===================================
+// ===========================================================================
+
+bool tkbc_bake_script(Env *env, Script *script, float dt, Bake_Report *report);
+bool tkbc_bake_scripts(Env *env, size_t workers, Bake_Reports *reports);
+size_t tkbc_bake_default_workers(void);
+void tkbc_print_bake_reports(FILE *stream, Bake_Reports *reports);
+bool tkbc_bake_report_passed(Bake_Report *report);
+bool tkbc_write_bake_reports_json(FILE *stream, Env *env, Bake_Reports *reports);
+void tkbc_destroy_bake_reports(Bake_Reports *reports);
+
+#endif  // TKBC_SCRIPT_BAKER_H_
@@ -2,33 +2,261 @@
 #include "../global/tkbc-types.h"
 #include "../global/tkbc-utils.h"
 #include "tkbc-script-handler.h"
+#include "tkbc-script-store.h"
 #include <assert.h>
 #include <errno.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+/**
+ * @brief The function adds the given id to the set, the table grows when it
+ * is half full.
+ *
+ * @param set The set of the ids.
+ * @param id The id that should be added.
+ * @return True if the id was not in the set before, otherwise false.
+ */
+bool tkbc_kite_id_set_insert(Kite_Id_Set *set, Id id) {
+    if (2 * (set->count + 1) > set->capacity) {
+        size_t capacity = set->capacity == 0 ? 16 : 2 * set->capacity;
+        Id *slots = malloc(capacity * sizeof(*slots));
+        if (slots == NULL) {
+            tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+            abort();
+        }
+        for (size_t i = 0; i < capacity; ++i) {
+            slots[i] = SIZE_MAX;
+        }
+        for (size_t i = 0; i < set->capacity; ++i) {
+            if (set->slots[i] == SIZE_MAX) {
+                continue;
+            }
+            size_t slot = (set->slots[i] * 11400714819323198485ULL) >> 32 & (capacity - 1);
+            while (slots[slot] != SIZE_MAX) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            slots[slot] = set->slots[i];
+        }
+        free(set->slots);
+        set->slots = slots;
+        set->capacity = capacity;
+    }
+
+    size_t slot = (id * 11400714819323198485ULL) >> 32 & (set->capacity - 1);
+    while (set->slots[slot] != SIZE_MAX) {
+        if (set->slots[slot] == id) {
+            return false;
+        }
+        slot = (slot + 1) & (set->capacity - 1);
+    }
+    set->slots[slot] = id;
+    set->count++;
+    return true;
+}
+
+/**
+ * @brief The function checks if the id is in the set.
+ *
+ * @param set The set that is searched.
+ * @param id The id that is looked up.
+ * @return True if the id is in the set, otherwise false.
+ */
+bool tkbc_kite_id_set_contains(const Kite_Id_Set *set, Id id) {
+    if (set->capacity == 0) {
+        return false;
+    }
+    size_t slot = (id * 11400714819323198485ULL) >> 32 & (set->capacity - 1);
+    while (set->slots[slot] != SIZE_MAX) {
+        if (set->slots[slot] == id) {
+            return true;
+        }
+        slot = (slot + 1) & (set->capacity - 1);
+    }
+    return false;
+}
+
+/**
+ * @brief The function frees the memory of the set.
+ *
+ * @param set The set that is destroyed.
+ */
+void tkbc_kite_id_set_destroy(Kite_Id_Set *set) {
+    free(set->slots);
+    memset(set, 0, sizeof(*set));
+}
+
+/**
+ * @brief The function formats the float the same way as the %G conversion of
+ * printf() does. Values between 1E-04 and 1E+06 are formatted directly, the
+ * magnitude times a power of ten up to 10^9 is an exact double for every
+ * float, so the rounding to 6 significant digits is exact. Every other value
+ * is handed to snprintf().
+ *
+ * @param buffer The buffer where the null terminated output is written to.
+ * @param size The size of the buffer, it should be TKBC_FLOAT_CSTR_SIZE.
+ * @param value The value that should be formatted.
+ * @return The length of the output without the null terminator.
+ */
+size_t tkbc_format_float(char *buffer, size_t size, float value) {
+    static const double powers_of_ten[] = {1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                           1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+    assert(size >= TKBC_FLOAT_CSTR_SIZE);
+    double magnitude = fabs((double)value);
+    if (magnitude == 0) {
+        return snprintf(buffer, size, "%s", signbit(value) ? "-0" : "0");
+    }
+
+    // The exponent of the value in the range of -4 to 5.
+    double scaled = magnitude * 1e9;
+    int exponent = -5;
+    while (exponent < 6 && scaled >= powers_of_ten[exponent + 10]) {
+        exponent++;
+    }
+    if (exponent < -4 || exponent > 5) {
+        return snprintf(buffer, size, "%G", value);
+    }
+
+    uint64_t digits = nearbyint(magnitude * powers_of_ten[5 - exponent]);
+    if (digits == 1000000) {
+        digits = 100000;
+        exponent++;
+        if (exponent > 5) {
+            return snprintf(buffer, size, "%G", value);
+        }
+    }
+
+    char significant[6];
+    for (int i = 5; i >= 0; --i) {
+        significant[i] = '0' + digits % 10;
+        digits /= 10;
+    }
+    int significant_count = 6;
+    while (significant_count > exponent + 1 && significant[significant_count - 1] == '0') {
+        significant_count--;
+    }
+
+    size_t count = 0;
+    if (value < 0) {
+        buffer[count++] = '-';
+    }
+    if (exponent < 0) {
+        buffer[count++] = '0';
+        buffer[count++] = '.';
+        for (int i = 0; i < -exponent - 1; ++i) {
+            buffer[count++] = '0';
+        }
+        memcpy(buffer + count, significant, significant_count);
+        count += significant_count;
+    } else {
+        memcpy(buffer + count, significant, exponent + 1);
+        count += exponent + 1;
+        if (significant_count > exponent + 1) {
+            buffer[count++] = '.';
+            memcpy(buffer + count, significant + exponent + 1, significant_count - exponent - 1);
+            count += significant_count - exponent - 1;
+        }
+    }
+    buffer[count] = '\0';
+    return count;
+}
+
+/**
+ * @brief The function writes the content of the writer buffer to its file.
+ *
+ * @param writer The writer that is flushed.
+ */
+static void tkbc_kite_writer_flush(Kite_Writer *writer) {
+    if (writer->count > 0 && !writer->failed) {
+        writer->failed = fwrite(writer->buffer, 1, writer->count, writer->file) != writer->count;
+    }
+    writer->count = 0;
+}
+
+/**
+ * @brief The function appends the given bytes to the writer and flushes the
+ * buffer to the file if it is full.
+ *
+ * @param writer The writer where the bytes are appended.
+ * @param data The bytes that should be written.
+ * @param size The amount of bytes.
+ */
+static void tkbc_kite_writer_write(Kite_Writer *writer, const char *data, size_t size) {
+    if (writer->count + size > sizeof(writer->buffer)) {
+        tkbc_kite_writer_flush(writer);
+        if (size > sizeof(writer->buffer)) {
+            writer->failed |= fwrite(data, 1, size, writer->file) != size;
+            return;
+        }
+    }
+    memcpy(writer->buffer + writer->count, data, size);
+    writer->count += size;
+}
+
+/**
+ * @brief The function appends the given null terminated string to the writer.
+ *
+ * @param writer The writer where the string is appended.
+ * @param cstr The string that should be written.
+ */
+static void tkbc_kite_writer_cstr(Kite_Writer *writer, const char *cstr) {
+    tkbc_kite_writer_write(writer, cstr, strlen(cstr));
+}
+
+/**
+ * @brief The function appends the decimal form of the given number to the
+ * writer.
+ *
+ * @param writer The writer where the number is appended.
+ * @param number The number that should be written.
+ */
+static void tkbc_kite_writer_size_t(Kite_Writer *writer, size_t number) {
+    char digits[24];
+    size_t i = sizeof(digits);
+    do {
+        digits[--i] = '0' + number % 10;
+        number /= 10;
+    } while (number > 0);
+    tkbc_kite_writer_write(writer, digits + i, sizeof(digits) - i);
+}
+
+/**
+ * @brief The function appends a space and the %G form of the given float to
+ * the writer.
+ *
+ * @param writer The writer where the number is appended.
+ * @param value The value that should be written.
+ */
+static void tkbc_kite_writer_float(Kite_Writer *writer, float value) {
+    char buffer[TKBC_FLOAT_CSTR_SIZE + 1] = {' '};
+    size_t count = tkbc_format_float(buffer + 1, TKBC_FLOAT_CSTR_SIZE, value);
+    tkbc_kite_writer_write(writer, buffer, count + 1);
+}
+
 /**
  * @brief The function prints the serialized form of the kite ids.
  *
- * @param file The file where to print the kites.
+ * @param writer The writer where to print the kites.
  * @param ids The kite ids that should be serialized.
  */
-void tkbc_print_kites(Content *buffer, Kite_Ids ids) {
-    if (ids.count > 0) {
-        tkbc_dapf(buffer, "(%zu", ids.elements[0]);
-        for (size_t id = 1; id < ids.count; ++id) {
-            tkbc_dapf(buffer, " %zu", ids.elements[id]);
+void tkbc_print_kites(Kite_Writer *writer, Kite_Ids ids) {
+    tkbc_kite_writer_cstr(writer, "(");
+    for (size_t id = 0; id < ids.count; ++id) {
+        if (id > 0) {
+            tkbc_kite_writer_cstr(writer, " ");
         }
-    } else {
-        tkbc_dapf(buffer, "(");
+        tkbc_kite_writer_size_t(writer, ids.elements[id]);
     }
-    tkbc_dapf(buffer, ")");
+    tkbc_kite_writer_cstr(writer, ")");
 }
 
 /**
  * @brief The function serializes the provided script in memory form to a .kite
- * file.
+ * file. The different kite ids for the KITES header are collected in a hash
+ * set first, afterwards the script is streamed through a buffered writer
+ * directly into the file.
  *
  * @param script A memory representation of a script.
  * @param filepath The file path where the script should be saved to.
@@ -37,110 +265,154 @@ void tkbc_print_kites(Content *buffer, Kite_Ids ids) {
  * failed.
  */
 int tkbc_export_script_to_dot_kite_file_from_mem(Script *script, const char *filepath) {
-    int ok = 0;
-    Kite_Ids ids = {0};
-    Content out = {0};
+    Kite_Id_Set ids = {0};
+    for (size_t frames = 0; frames < script->count; ++frames) {
+        for (size_t frame = 0; frame < script->elements[frames].count; ++frame) {
+            Frame *f = &script->elements[frames].elements[frame];
+            for (size_t i = 0; i < f->kite_id_array.count; ++i) {
+                tkbc_kite_id_set_insert(&ids, f->kite_id_array.elements[i]);
+            }
+        }
+    }
+    size_t kites_count = ids.count;
+    tkbc_kite_id_set_destroy(&ids);
 
-    tkbc_dapf(&out, "BEGIN\n");
+    FILE *file = fopen(filepath, "wb");
+    if (file == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "%s:%s\n", filepath, strerror(errno));
+        return 1;
+    }
+    Kite_Writer writer_state;
+    Kite_Writer *writer = &writer_state;
+    writer->file = file;
+    writer->count = 0;
+    writer->failed = false;
+
+    tkbc_kite_writer_cstr(writer, "KITES ");
+    tkbc_kite_writer_size_t(writer, kites_count);
+    tkbc_kite_writer_cstr(writer, "\nBEGIN\n");
     for (size_t frames = 0; frames < script->count; ++frames) {
 
         if (script->elements[frames].count > 1) {
-            tkbc_dapf(&out, "{\n");
+            tkbc_kite_writer_cstr(writer, "{\n");
         }
 
         for (size_t frame = 0; frame < script->elements[frames].count; ++frame) {
             Frame *f = &script->elements[frames].elements[frame];
 
-            // TODO: Use hash function for this.
-            for (size_t i = 0; i < f->kite_id_array.count; ++i) {
-                Id id = f->kite_id_array.elements[i];
-                if (!tkbc_contains_id(ids, id)) {
-                    tkbc_dap(&ids, id);
-                }
-            }
-
             switch (f->kind) {
             case ACTION_KITE_QUIT: {
-                tkbc_dapf(&out, "QUIT");
+                tkbc_kite_writer_cstr(writer, "QUIT");
             } break;
 
             case ACTION_KITE_WAIT: {
-                tkbc_dapf(&out, "WAIT");
+                tkbc_kite_writer_cstr(writer, "WAIT");
             } break;
 
             case ACTION_KITE_MOVE: {
                 Move_Action action = f->action.as_move;
-                tkbc_dapf(&out, "MOVE ");
-                tkbc_print_kites(&out, f->kite_id_array);
-                tkbc_dapf(&out, " %G %G", action.position.x, action.position.y);
+                tkbc_kite_writer_cstr(writer, "MOVE ");
+                tkbc_print_kites(writer, f->kite_id_array);
+                tkbc_kite_writer_float(writer, action.position.x);
+                tkbc_kite_writer_float(writer, action.position.y);
 
             } break;
 
             case ACTION_KITE_MOVE_ADD: {
                 Move_Add_Action action = f->action.as_move_add;
-                tkbc_dapf(&out, "MOVE_ADD ");
-                tkbc_print_kites(&out, f->kite_id_array);
-                tkbc_dapf(&out, " %G %G", action.position.x, action.position.y);
+                tkbc_kite_writer_cstr(writer, "MOVE_ADD ");
+                tkbc_print_kites(writer, f->kite_id_array);
+                tkbc_kite_writer_float(writer, action.position.x);
+                tkbc_kite_writer_float(writer, action.position.y);
 
             } break;
 
             case ACTION_KITE_ROTATION: {
                 Rotation_Action action = f->action.as_rotation;
-                tkbc_dapf(&out, "ROTATION ");
-                tkbc_print_kites(&out, f->kite_id_array);
-                tkbc_dapf(&out, " %G", action.angle);
+                tkbc_kite_writer_cstr(writer, "ROTATION ");
+                tkbc_print_kites(writer, f->kite_id_array);
+                tkbc_kite_writer_float(writer, action.angle);
 
             } break;
 
             case ACTION_KITE_ROTATION_ADD: {
                 Rotation_Add_Action action = f->action.as_rotation_add;
-                tkbc_dapf(&out, "ROTATION_ADD ");
-                tkbc_print_kites(&out, f->kite_id_array);
-                tkbc_dapf(&out, " %G", action.angle);
+                tkbc_kite_writer_cstr(writer, "ROTATION_ADD ");
+                tkbc_print_kites(writer, f->kite_id_array);
+                tkbc_kite_writer_float(writer, action.angle);
 
             } break;
 
             case ACTION_KITE_TIP_ROTATION: {
                 Tip_Rotation_Action action = f->action.as_tip_rotation;
-                tkbc_dapf(&out, "TIP_ROTATION ");
-                tkbc_print_kites(&out, f->kite_id_array);
-                tkbc_dapf(&out, " %G %s", action.angle, action.tip == LEFT_TIP ? "LEFT" : "RIGHT");
+                tkbc_kite_writer_cstr(writer, "TIP_ROTATION ");
+                tkbc_print_kites(writer, f->kite_id_array);
+                tkbc_kite_writer_float(writer, action.angle);
+                tkbc_kite_writer_cstr(writer, action.tip == LEFT_TIP ? " LEFT" : " RIGHT");
 
             } break;
 
             case ACTION_KITE_TIP_ROTATION_ADD: {
                 Tip_Rotation_Add_Action action = f->action.as_tip_rotation_add;
-                tkbc_dapf(&out, "TIP_ROTATION_ADD ");
-                tkbc_print_kites(&out, f->kite_id_array);
-                tkbc_dapf(&out, " %G %s", action.angle, action.tip == LEFT_TIP ? "LEFT" : "RIGHT");
+                tkbc_kite_writer_cstr(writer, "TIP_ROTATION_ADD ");
+                tkbc_print_kites(writer, f->kite_id_array);
+                tkbc_kite_writer_float(writer, action.angle);
+                tkbc_kite_writer_cstr(writer, action.tip == LEFT_TIP ? " LEFT" : " RIGHT");
+
+            } break;
+
+            case ACTION_KITE_ARC: {
+                Arc_Action action = f->action.as_arc;
+                tkbc_kite_writer_cstr(writer, "ARC ");
+                tkbc_print_kites(writer, f->kite_id_array);
+                tkbc_kite_writer_float(writer, action.radius);
+                tkbc_kite_writer_float(writer, action.begin_angle);
+                tkbc_kite_writer_float(writer, action.end_angle);
+                tkbc_kite_writer_float(writer, action.rotation);
+                tkbc_kite_writer_cstr(writer, " ");
+                tkbc_kite_writer_cstr(writer, tkbc_easing_to_cstr(action.easing));
+
+            } break;
+
+            case ACTION_KITE_BEZIER:
+            case ACTION_KITE_CATMULL_ROM: {
+                Spline_Action action = f->action.as_bezier;
+                tkbc_kite_writer_cstr(writer, f->kind == ACTION_KITE_BEZIER ? "BEZIER " : "CATMULL_ROM ");
+                tkbc_print_kites(writer, f->kite_id_array);
+                tkbc_kite_writer_float(writer, action.control_1.x);
+                tkbc_kite_writer_float(writer, action.control_1.y);
+                tkbc_kite_writer_float(writer, action.control_2.x);
+                tkbc_kite_writer_float(writer, action.control_2.y);
+                tkbc_kite_writer_float(writer, action.position.x);
+                tkbc_kite_writer_float(writer, action.position.y);
+                tkbc_kite_writer_cstr(writer, " ");
+                tkbc_kite_writer_cstr(writer, tkbc_easing_to_cstr(action.easing));
 
             } break;
 
             default: assert(0 && "UNREACHABLE tkbc_export_script_to_dot_kite_file_from_mem");
             }
 
-            tkbc_dapf(&out, " %G", f->duration);
-            tkbc_dapf(&out, "\n");
+            tkbc_kite_writer_float(writer, f->duration);
+            tkbc_kite_writer_cstr(writer, "\n");
         }
 
         if (script->elements[frames].count > 1) {
-            tkbc_dapf(&out, "}\n");
+            tkbc_kite_writer_cstr(writer, "}\n");
         }
     }
-    tkbc_dapf(&out, "END\n");
+    tkbc_kite_writer_cstr(writer, "END\n");
+    tkbc_kite_writer_flush(writer);
 
-    char buf[32];
-    snprintf(buf, sizeof(buf), "KITES %zu\n", ids.count);
-    int err = tkbc_write_file(filepath, buf, strlen(buf));
-    if (err) {
-        check_return(-err);
+    int ok = 0;
+    if (writer->failed) {
+        tkbc_fprintf(stderr, "ERROR", "%s: while writing the file.\n", filepath);
+        ok = -1;
+    }
+    if (fclose(file) == EOF) {
+        tkbc_fprintf(stderr, "ERROR", "%s:%s\n", filepath, strerror(errno));
+        ok = -1;
     }
-    err = tkbc_append_file(filepath, out.elements, out.count);
-    check_return(err);
-
-check:
-    free(out.elements);
-    free(ids.elements);
     return ok;
 }
 
@@ -167,7 +439,12 @@ int tkbc_export_all_scripts_to_dot_kite_file_from_mem(Env *env, const char *path
         assert(env->scripts.elements[i].name);
         space_reset_tspace();
         const char *buf = space_tprintf("%s%s.kite", path, env->scripts.elements[i].name);
-        err = tkbc_export_script_to_dot_kite_file_from_mem(&env->scripts.elements[i], buf);
+        // An evicted script is loaded back, it counts as a failing header.
+        if (!tkbc_script_store_ensure_loaded(env, &env->scripts.elements[i])) {
+            err = 1;
+        } else {
+            err = tkbc_export_script_to_dot_kite_file_from_mem(&env->scripts.elements[i], buf);
+        }
 
         if (err) {
             id = env->scripts.elements[i].script_id;
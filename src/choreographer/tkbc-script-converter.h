@@ -5,7 +5,26 @@
 #include "../global/tkbc-utils.h"
 #include <stdio.h>
 
-void tkbc_print_kites(Content *buffer, Kite_Ids ids);
+// The amount of bytes that are collected before they are written to the
+// exported .kite file.
+#define TKBC_KITE_WRITER_BUFFER_SIZE (16 * 1024)
+
+// The size of a buffer that can hold every float formatted by
+// tkbc_format_float().
+#define TKBC_FLOAT_CSTR_SIZE 32
+
+typedef struct {
+    FILE *file;                                 // The .kite file that is written.
+    size_t count;                               // The amount of bytes in the buffer.
+    bool failed;                                // True if a write to the file has failed.
+    char buffer[TKBC_KITE_WRITER_BUFFER_SIZE];  // The output that is not written yet.
+} Kite_Writer;                                  // A buffered writer for the .kite export.
+
+bool tkbc_kite_id_set_insert(Kite_Id_Set *set, Id id);
+bool tkbc_kite_id_set_contains(const Kite_Id_Set *set, Id id);
+void tkbc_kite_id_set_destroy(Kite_Id_Set *set);
+size_t tkbc_format_float(char *buffer, size_t size, float value);
+void tkbc_print_kites(Kite_Writer *writer, Kite_Ids ids);
 int tkbc_export_script_to_dot_kite_file_from_mem(Script *script, const char *filepath);
 int tkbc_export_all_scripts_to_dot_kite_file_from_mem(Env *env, const char *path);
 
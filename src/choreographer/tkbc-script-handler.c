@@ -1,6 +1,7 @@
 #include "raylib.h"
 #include <assert.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -9,10 +10,17 @@
 #include "../global/tkbc-utils.h"
 #include "tkbc-keymaps.h"
 #include "tkbc-script-handler.h"
+#include "tkbc-script-store.h"
 #include "tkbc.h"
 
 #include "raymath.h"
 
+// The smallest initial capacity of the space a new scratch script is built in.
+#define TKBC_SCRIPT_SPACE_MIN_CAPACITY (1024 * 1024)
+// The scratch space is moved into a stored script, if its capacity is at most
+// this many times the memory the script uses, otherwise the script is copied.
+#define TKBC_SCRIPT_SPACE_MOVE_RATIO 2
+
 // ========================== Script Handler =================================
 
 /**
@@ -101,6 +109,23 @@ bool tkbc_scripts_contains_id(Scripts scripts, Id script_id) {
     return false;
 }
 
+/**
+ * @brief The function searches the script with the given id in the scripts of
+ * the env.
+ *
+ * @param env The global state of the application.
+ * @param script_id The id of a script to search for.
+ * @return The script or NULL if there is no script with the id.
+ */
+Script *tkbc_get_script_by_id(Env *env, Id script_id) {
+    for (size_t i = 0; i < env->scripts.count; ++i) {
+        if (env->scripts.elements[i].script_id == script_id) {
+            return &env->scripts.elements[i];
+        }
+    }
+    return NULL;
+}
+
 /**
  * @brief The function can be used to check if the given id is located in the
  * kite_ids.
@@ -213,11 +238,128 @@ Frame tkbc_deep_copy_frame(Space *space, Frame *frame) {
     return f;
 }
 
+typedef struct {
+    const Id *ids;  // The first occurrence of the id set in the source script.
+    size_t count;   // The amount of ids in the set.
+    uint64_t hash;  // The hash of the id set.
+    size_t offset;  // The offset of the set in the id pool.
+} Id_Set_Entry;     // An entry of the interning table of id sets.
+
+/**
+ * @brief The function computes the FNV-1a hash of the given kite id set.
+ *
+ * @param ids The first id of the set.
+ * @param count The amount of ids in the set.
+ * @return The hash of the set.
+ */
+static uint64_t tkbc_hash_kite_ids(const Id *ids, size_t count) {
+    uint64_t hash = 14695981039346656037ULL;
+    const unsigned char *bytes = (const unsigned char *) ids;
+    for (size_t i = 0; i < count * sizeof(*ids); ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief The function interns all the kite id sets of the given script. Every
+ * distinct set is stored once in a single pool that is allocated in the given
+ * space and every frame of the new script points into the pool.
+ *
+ * @param space The space where the pool is allocated.
+ * @param script The source script that holds the id sets.
+ * @param new_script The copied script where the frames are already copied
+ * without ids, the frames get their ids and the script gets the pool.
+ */
+static void tkbc_intern_script_kite_ids(Space *space, Script *script, Script *new_script) {
+    size_t frames_count = 0;
+    for (size_t i = 0; i < script->count; ++i) {
+        frames_count += script->elements[i].count;
+    }
+    if (frames_count == 0) {
+        return;
+    }
+
+    size_t capacity = 16;
+    while (capacity < 2 * frames_count) {
+        capacity *= 2;
+    }
+    Id_Set_Entry *table = calloc(capacity, sizeof(*table));
+    size_t *offsets = malloc(frames_count * sizeof(*offsets));
+    if (table == NULL || offsets == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+        abort();
+    }
+
+    // First pass: Find the distinct sets and their offsets in the pool.
+    size_t pool_count = 0;
+    size_t f = 0;
+    for (size_t i = 0; i < script->count; ++i) {
+        for (size_t j = 0; j < script->elements[i].count; ++j, ++f) {
+            Kite_Ids *ids = &script->elements[i].elements[j].kite_id_array;
+            if (ids->count == 0) {
+                continue;
+            }
+
+            uint64_t hash = tkbc_hash_kite_ids(ids->elements, ids->count);
+            size_t slot = hash & (capacity - 1);
+            for (;;) {
+                Id_Set_Entry *entry = &table[slot];
+                if (entry->ids == NULL) {
+                    *entry = (Id_Set_Entry){.ids = ids->elements, .count = ids->count, .hash = hash, .offset = pool_count};
+                    pool_count += ids->count;
+                    break;
+                }
+                if (entry->hash == hash && entry->count == ids->count &&
+                    memcmp(entry->ids, ids->elements, ids->count * sizeof(*ids->elements)) == 0) {
+                    break;
+                }
+                slot = (slot + 1) & (capacity - 1);
+            }
+            offsets[f] = table[slot].offset;
+        }
+    }
+
+    if (pool_count > 0) {
+        new_script->id_pool.elements = space_malloc(space, pool_count * sizeof(*new_script->id_pool.elements));
+        assert(new_script->id_pool.elements != NULL);
+        new_script->id_pool.count = pool_count;
+        new_script->id_pool.capacity = pool_count;
+        for (size_t i = 0; i < capacity; ++i) {
+            if (table[i].ids != NULL) {
+                memcpy(&new_script->id_pool.elements[table[i].offset], table[i].ids,
+                       table[i].count * sizeof(*table[i].ids));
+            }
+        }
+    }
+
+    // Second pass: Let the frames point into the pool.
+    f = 0;
+    for (size_t i = 0; i < script->count; ++i) {
+        for (size_t j = 0; j < script->elements[i].count; ++j, ++f) {
+            Kite_Ids *ids = &script->elements[i].elements[j].kite_id_array;
+            if (ids->count == 0) {
+                continue;
+            }
+            Kite_Ids *new_ids = &new_script->elements[i].elements[j].kite_id_array;
+            new_ids->elements = &new_script->id_pool.elements[offsets[f]];
+            new_ids->count = ids->count;
+            new_ids->capacity = ids->count;
+            new_ids->script_id_append = ids->script_id_append;
+        }
+    }
+
+    free(offsets);
+    free(table);
+}
+
 /**
  * @brief The function copies every single value even the values that are just
  * represented by a pointer of the struct script to a new instance. It can
  * be used to move a creation of a temporary struct of type script to a
- * permanently stored one.
+ * permanently stored one. The kite id sets of the frames are interned in the
+ * id_pool of the new script, so identical sets are stored only once.
  *
  * @param space The space where the internal allocation should happen.
  * @param script The pointer that holds the values that should be copied.
@@ -232,12 +374,54 @@ Script tkbc_deep_copy_script(Space *space, Script *script) {
     new_script.name = space_strdup(space, script->name);
 
     for (size_t i = 0; i < script->count; ++i) {
-        Frames frames = tkbc_deep_copy_frames(space, &script->elements[i]);
-        space_dap(space, &new_script, frames);
+        Frames *frames = &script->elements[i];
+        Frames new_frames = {0};
+        new_frames.frames_index = frames->frames_index;
+        if (frames->kite_frame_positions.count) {
+            space_dapc(space, &new_frames.kite_frame_positions, frames->kite_frame_positions.elements,
+                       frames->kite_frame_positions.count);
+        }
+        if (frames->count) {
+            // The ids are interned afterwards, so just the plain frames are copied.
+            space_dapc(space, &new_frames, frames->elements, frames->count);
+            for (size_t j = 0; j < new_frames.count; ++j) {
+                new_frames.elements[j].kite_id_array = (Kite_Ids){0};
+            }
+        }
+        space_dap(space, &new_script, new_frames);
+    }
+    tkbc_intern_script_kite_ids(space, script, &new_script);
+    if (script->timeline.count) {
+        space_dapc(space, &new_script.timeline, script->timeline.elements, script->timeline.count);
     }
     return new_script;
 }
 
+/**
+ * @brief The function finalizes a script that was built in the given space
+ * without copying it. The frames stay where they are, the kite id sets are
+ * interned into the id_pool and the space is moved into the returned script,
+ * so the given space is empty afterwards.
+ *
+ * @param space The space that holds all the allocations of the script.
+ * @param script The script that should be finalized.
+ * @return The finalized script that owns the space.
+ */
+Script tkbc_move_script(Space *space, Script *script) {
+    Script new_script = *script;
+    new_script.id_pool = (Kite_Ids){0};
+    if (new_script.name && !space_find_planet_from_ptr(space, (void *) new_script.name)) {
+        new_script.name = space_strdup(space, new_script.name);
+    }
+    // The old id sets stay unused in the space, the interning reads them before
+    // the frames are pointed into the pool.
+    tkbc_intern_script_kite_ids(space, &new_script, &new_script);
+
+    new_script.space = *space;
+    memset(space, 0, sizeof(*space));
+    return new_script;
+}
+
 /**
  * @brief The function can be used to free all the elements and related memory
  * of the given frames. It recursevly handles all the internal saved values.
@@ -361,9 +545,7 @@ static Vector2 tkbc_combined_move_destination(Kite *kite, Frame *tip_frame, Vect
 
     // Provided the old position, because the kite center moves as a circle
     // around the old fixed position.
-    kite->center = kite->old_center;
-    kite->angle = kite->old_angle;
-    tkbc_kite_update_internal(kite);
+    tkbc_kite_set_pose(kite, &kite->old_center, kite->old_angle);
 
     float final_tip_angle =
         tip_frame->kind == ACTION_KITE_TIP_ROTATION_ADD ? kite->old_angle + tip_action->angle : tip_action->angle;
@@ -371,13 +553,30 @@ static Vector2 tkbc_combined_move_destination(Kite *kite, Frame *tip_frame, Vect
 
     Vector2 destination = Vector2Add(kite->center, offset);
 
-    kite->center = saved_center;
-    kite->angle = saved_angle;
-    tkbc_kite_update_internal(kite);
+    tkbc_kite_set_pose(kite, &saved_center, saved_angle);
 
     return destination;
 }
 
+/**
+ * @brief The function advances the time of a frame whose action is evaluated
+ * in closed form and computes the normalized time of it. The frame is marked as
+ * finished as soon as the full duration has passed.
+ *
+ * @param frame The frame that should be advanced.
+ * @return The normalized time of the frame in the range from 0 to 1.
+ */
+static float tkbc_frame_progress(Frame *frame) {
+    frame->duration -= tkbc_get_frame_time();
+    if (frame->duration > 0 && frame->original_duration > 0) {
+        return 1 - frame->duration / frame->original_duration;
+    }
+
+    frame->finished = true;
+    frame->duration = 0;
+    return 1;
+}
+
 /**
  * @brief The function supports all the action kinds that are defined. It can be
  * used to calculate the given frame and its action. For kite actions the new
@@ -393,7 +592,7 @@ void tkbc_render_frame(Env *env, Frame *frame) {
     Kite *kite = NULL;
     Frame *env_frame = &env->frames->elements[frame->index];
 
-    assert(ACTION_KIND_COUNT == 9 && "NOT ALL THE Action_Kinds ARE IMPLEMENTED");
+    assert(ACTION_KIND_COUNT == 12 && "NOT ALL THE Action_Kinds ARE IMPLEMENTED");
     switch (frame->kind) {
     case ACTION_KITE_QUIT: {
         if (env->frames->count == 1 && !env->global_quit.is_script_quit) {
@@ -614,10 +813,66 @@ void tkbc_render_frame(Env *env, Frame *frame) {
         }
     } break;
 
+    case ACTION_KITE_ARC: {
+        Arc_Action *action = &frame->action.as_arc;
+        float t = tkbc_frame_progress(frame);
+
+        for (size_t i = 0; i < env_frame->kite_id_array.count; ++i) {
+            Id id = env_frame->kite_id_array.elements[i];
+            kite = tkbc_get_kite_by_id_unwrap(env, id);
+            tkbc_script_arc(kite, action, t);
+        }
+    } break;
+
+    case ACTION_KITE_BEZIER:
+    case ACTION_KITE_CATMULL_ROM: {
+        Spline_Action *action = &frame->action.as_bezier;
+        float t = tkbc_frame_progress(frame);
+
+        for (size_t i = 0; i < env_frame->kite_id_array.count; ++i) {
+            Id id = env_frame->kite_id_array.elements[i];
+            kite = tkbc_get_kite_by_id_unwrap(env, id);
+            tkbc_script_spline(kite, frame->kind, action, t);
+        }
+    } break;
+
     default: assert(0 && "UNREACHABLE tkbc_render_frame()");
     }
 }
 
+/**
+ * @brief The function checks if the kite ids are an interned set inside the
+ * id_pool of the script. These sets are shared by the frames.
+ *
+ * @param script The script with the pool.
+ * @param ids The kite ids of a frame of the script.
+ * @return True if the ids point into the pool, otherwise false.
+ */
+bool tkbc_script_id_pool_contains(Script *script, Kite_Ids *ids) {
+    Id *pool = script->id_pool.elements;
+    return pool != NULL && ids->elements >= pool && ids->elements + ids->count <= pool + script->id_pool.count;
+}
+
+/**
+ * @brief The function replaces every id that is found in the from array with
+ * the id at the same index in the to array. Every id is replaced at most once.
+ *
+ * @param ids The ids that are remapped in place.
+ * @param count The amount of ids.
+ * @param from The current ids.
+ * @param to The new ids with the same order as the current ids.
+ */
+static void tkbc_remap_kite_ids(Id *ids, size_t count, Kite_Ids from, Kite_Ids to) {
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = 0; j < from.count; ++j) {
+            if (from.elements[j] == ids[i]) {
+                ids[i] = to.elements[j];
+                break;
+            }
+        }
+    }
+}
+
 /**
  * @brief The function sets the kite_ids in a given script to new values
  * provided in the kite_ids array passed into the function.
@@ -655,37 +910,30 @@ void tkbc_remap_script_kite_id_arrays_to_kite_ids(Script *script, Kite_Ids kite_
 
     assert(current_kite_ids.count == kite_ids.count);
 
+    // Every id is remapped once, so an id that is already remapped is not
+    // matched again. The interned sets are shared by many frames, so they are
+    // remapped once in the pool and not once for every frame.
+    tkbc_remap_kite_ids(script->id_pool.elements, script->id_pool.count, current_kite_ids, kite_ids);
     for (size_t i = 0; i < script->count; ++i) {
         assert(script->elements);
         Frames *frames = &script->elements[i];
 
-        for (size_t new_id = 0; new_id < current_kite_ids.count; ++new_id) {
-
-            assert(frames->elements);
-            for (size_t j = 0; j < frames->count; ++j) {
-                if (frames->elements[j].kind == ACTION_KITE_WAIT || frames->elements[j].kind == ACTION_KITE_QUIT) {
-                    continue;
-                }
-                Kite_Ids *ids = &frames->elements[j].kite_id_array;
-                assert(ids->elements);
-                for (size_t k = 0; k < ids->count; ++k) {
-                    Id *id = &ids->elements[k];
-
-                    if (current_kite_ids.elements[new_id] == *id) {
-                        *id = kite_ids.elements[new_id];
-                        break;
-                    }
-                }
+        assert(frames->elements);
+        for (size_t j = 0; j < frames->count; ++j) {
+            if (frames->elements[j].kind == ACTION_KITE_WAIT || frames->elements[j].kind == ACTION_KITE_QUIT) {
+                continue;
             }
-
-            for (size_t j = 0; j < frames->kite_frame_positions.count; ++j) {
-                Id *id = &frames->kite_frame_positions.elements[j].kite_id;
-
-                if (current_kite_ids.elements[new_id] == *id) {
-                    *id = kite_ids.elements[new_id];
-                    break;
-                }
+            Kite_Ids *ids = &frames->elements[j].kite_id_array;
+            assert(ids->elements);
+            if (tkbc_script_id_pool_contains(script, ids)) {
+                continue;
             }
+            tkbc_remap_kite_ids(ids->elements, ids->count, current_kite_ids, kite_ids);
+        }
+
+        for (size_t j = 0; j < frames->kite_frame_positions.count; ++j) {
+            Id *id = &frames->kite_frame_positions.elements[j].kite_id;
+            tkbc_remap_kite_ids(id, 1, current_kite_ids, kite_ids);
         }
     }
 
@@ -707,10 +955,86 @@ void tkbc_patch_script_kite_positions(Env *env, Script *script, Space *space) {
     }
 }
 
+/**
+ * @brief The function computes the slot where the lookup of the given kite id
+ * starts.
+ *
+ * @param map The map the slot belongs to.
+ * @param kite_id The id of the kite.
+ * @return The index of the first slot to probe.
+ */
+static size_t tkbc_kite_id_map_start(Kite_Id_Map *map, Id kite_id) {
+    return (kite_id * 11400714819323198485ULL) >> 32 & (map->capacity - 1);
+}
+
+/**
+ * @brief The function fills the kite id lookup of the env with the current
+ * kites of the kite_array. The table is reused between the calls. If a kite id
+ * is present more than once, the first kite is found like in
+ * tkbc_get_kite_by_id().
+ *
+ * @param env The global state of the application.
+ */
+void tkbc_kite_id_map_build(Env *env) {
+    Kite_Id_Map *map = &env->kite_id_map;
+    size_t capacity = 16;
+    while (capacity < 2 * env->kite_array.count) {
+        capacity *= 2;
+    }
+    if (map->capacity < capacity) {
+        free(map->slots);
+        map->slots = malloc(capacity * sizeof(*map->slots));
+        if (map->slots == NULL) {
+            tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+            abort();
+        }
+        map->capacity = capacity;
+    }
+    for (size_t i = 0; i < map->capacity; ++i) {
+        map->slots[i].kite_index = SIZE_MAX;
+    }
+
+    for (size_t i = 0; i < env->kite_array.count; ++i) {
+        Id kite_id = env->kite_array.elements[i].kite_id;
+        size_t slot = tkbc_kite_id_map_start(map, kite_id);
+        while (map->slots[slot].kite_index != SIZE_MAX && map->slots[slot].kite_id != kite_id) {
+            slot = (slot + 1) & (map->capacity - 1);
+        }
+        if (map->slots[slot].kite_index == SIZE_MAX) {
+            map->slots[slot] = (Kite_Id_Slot){.kite_id = kite_id, .kite_index = i, .position_index = SIZE_MAX};
+        }
+    }
+}
+
+/**
+ * @brief The function looks up the given kite id in the table that is filled
+ * by tkbc_kite_id_map_build().
+ *
+ * @param env The global state of the application.
+ * @param kite_id The id of the kite.
+ * @return The slot of the kite or NULL if the kite doesn't exist.
+ */
+Kite_Id_Slot *tkbc_kite_id_map_find(Env *env, Id kite_id) {
+    Kite_Id_Map *map = &env->kite_id_map;
+    if (map->capacity == 0) {
+        return NULL;
+    }
+    size_t slot = tkbc_kite_id_map_start(map, kite_id);
+    while (map->slots[slot].kite_index != SIZE_MAX) {
+        if (map->slots[slot].kite_id == kite_id) {
+            return &map->slots[slot];
+        }
+        slot = (slot + 1) & (map->capacity - 1);
+    }
+    return NULL;
+}
+
 /**
  * @brief The function can be used to backpatch current kite positions in
  * the frames array to be used later in the redrawing and calculation of a
- * script frame after the script has executed successfully.
+ * script frame after the script has executed successfully. Every kite gets
+ * one position, the lookup of the kites and their positions is hashed so the
+ * patch is linear in the amount of kite ids of the frames.
  *
  * @param env The global state of the application.
  * @param frames The frames where the kite positions should be updated to the
@@ -718,15 +1042,22 @@ void tkbc_patch_script_kite_positions(Env *env, Script *script, Space *space) {
  * @param space The space where the allocation should happen.
  */
 void tkbc_patch_frames_kite_positions(Env *env, Frames *frames, Space *space) {
-    for (size_t i = 0; i < frames->count; ++i) {
-        if (!frames->elements[i].kite_id_array.count) {
-            continue;
+    tkbc_kite_id_map_build(env);
+    Kite_Positions *positions = &frames->kite_frame_positions;
+    for (size_t k = 0; k < positions->count; ++k) {
+        Kite_Id_Slot *slot = tkbc_kite_id_map_find(env, positions->elements[k].kite_id);
+        if (slot && slot->position_index == SIZE_MAX) {
+            slot->position_index = k;
         }
+    }
 
-        for (size_t j = 0; j < frames->elements[i].kite_id_array.count; ++j) {
-            Index kite_id = frames->elements[i].kite_id_array.elements[j];
-            Kite *kite = tkbc_get_kite_by_id(env, kite_id);
-            assert(kite != NULL);
+    for (size_t i = 0; i < frames->count; ++i) {
+        Kite_Ids *kite_ids = &frames->elements[i].kite_id_array;
+        for (size_t j = 0; j < kite_ids->count; ++j) {
+            Index kite_id = kite_ids->elements[j];
+            Kite_Id_Slot *slot = tkbc_kite_id_map_find(env, kite_id);
+            assert(slot != NULL);
+            Kite *kite = env->kite_array.elements[slot->kite_index].kite;
 
             Kite_Position kite_position = {
                 .kite_id = kite_id,
@@ -734,21 +1065,14 @@ void tkbc_patch_frames_kite_positions(Env *env, Frames *frames, Space *space) {
                 .angle = kite->angle,
             };
 
-            bool contains = false;
-            for (size_t k = 0; k < frames->kite_frame_positions.count; ++k) {
-                if (frames->kite_frame_positions.elements[k].kite_id == kite_id) {
-                    contains = true;
-                    // NOTE: Patching angle in case the kite_position was already added by
-                    // just a move action, but later the corresponding angle action is
-                    // handled.
-                    frames->kite_frame_positions.elements[k].position = kite_position.position;
-                    frames->kite_frame_positions.elements[k].angle = kite_position.angle;
-                    break;
-                }
-            }
-
-            if (!contains) {
-                space_dap(space, &frames->kite_frame_positions, kite_position);
+            // NOTE: Patching angle in case the kite_position was already added by
+            // just a move action, but later the corresponding angle action is
+            // handled.
+            if (slot->position_index != SIZE_MAX) {
+                positions->elements[slot->position_index] = kite_position;
+            } else {
+                slot->position_index = positions->count;
+                space_dap(space, positions, kite_position);
             }
         }
     }
@@ -878,18 +1202,22 @@ void tkbc_load_next_script(Env *env) {
  * @return True if the script could be loaded successfully, otherwise false.
  */
 bool tkbc_load_script_id(Env *env, size_t script_id, bool fresh) {
-    bool found = false;
+    Script *script = NULL;
     for (size_t i = 0; i < env->scripts.count; ++i) {
         if (env->scripts.elements[i].script_id == script_id) {
-            env->script = &env->scripts.elements[i];
-            found = true;
+            script = &env->scripts.elements[i];
             break;
         }
     }
 
-    if (!found) {
+    if (script == NULL) {
+        return false;
+    }
+    // An evicted script is transparently loaded back from disk.
+    if (!tkbc_script_store_ensure_loaded(env, script)) {
         return false;
     }
+    env->script = script;
 
     env->frames = &env->script->elements[0];
     if (!fresh) {
@@ -928,9 +1256,42 @@ void tkbc_unload_script(Env *env) {
 }
 
 /**
- * @brief The function removes the script from the known scripts of the array.
- * It does not handle the actual memory deallocation, because is is stored in a
- * space allocator any way.
+ * @brief The function points the script and frames views of the env to the
+ * script with the given id after the scripts array has changed. The frames view
+ * is set to the block with the same frames index or to the last block if the
+ * script has become shorter.
+ *
+ * @param env The global state of the application.
+ * @param script_id The id of the executed script.
+ * @param is_frames If the frames view was set.
+ * @param frames_index The frames index of the previous frames view.
+ */
+static void tkbc_restore_script_view(Env *env, Id script_id, bool is_frames, Index frames_index) {
+    env->script = NULL;
+    for (size_t i = 0; i < env->scripts.count; ++i) {
+        if (env->scripts.elements[i].script_id == script_id) {
+            env->script = &env->scripts.elements[i];
+            break;
+        }
+    }
+    if (env->script == NULL || !is_frames || env->script->count == 0) {
+        env->frames = NULL;
+        return;
+    }
+
+    env->frames = &env->script->elements[env->script->count - 1];
+    for (size_t i = 0; i < env->script->count; ++i) {
+        if (env->script->elements[i].frames_index == frames_index) {
+            env->frames = &env->script->elements[i];
+            break;
+        }
+    }
+}
+
+/**
+ * @brief The function removes the script from the known scripts of the array
+ * and frees its memory and its spill file. The views of the env stay valid, if
+ * the removed script is executed it is unloaded.
  *
  * @param env The global state of the application.
  * @param script_id The id of the script that should be unloaded.
@@ -939,7 +1300,15 @@ void tkbc_unload_script(Env *env) {
 bool tkbc_unload_script_from_memory(Env *env, size_t script_id) {
     for (size_t i = 0; i < env->scripts.count; ++i) {
         if (script_id == env->scripts.elements[i].script_id) {
-            space_free_space(&env->scripts.elements[i].space);
+            Id active_id = env->script ? env->script->script_id : 0;
+            bool is_frames = env->frames != NULL;
+            Index frames_index = is_frames ? env->frames->frames_index : 0;
+            if (active_id == script_id) {
+                tkbc_unload_script(env);
+                active_id = 0;
+            }
+
+            tkbc_script_store_release(env, &env->scripts.elements[i]);
 
             if (i + 1 < env->scripts.count) {
                 memmove(&env->scripts.elements[i], &env->scripts.elements[i + 1],
@@ -947,12 +1316,65 @@ bool tkbc_unload_script_from_memory(Env *env, size_t script_id) {
             }
 
             env->scripts.count -= 1;
+            if (active_id) {
+                tkbc_restore_script_view(env, active_id, is_frames, frames_index);
+            }
             return true;
         }
     }
     return false;
 }
 
+/**
+ * @brief The function replaces a script with a newer version that is already
+ * added to the env. The new version takes over the id and the place of the old
+ * script in the array. If the old script is executed, the execution continues
+ * at the same block of the new version from the current kite positions.
+ *
+ * @param env The global state of the application.
+ * @param script_id The id of the script that is replaced.
+ * @param new_script_id The id of the added new version.
+ * @return True if the script was replaced, otherwise false.
+ */
+bool tkbc_replace_script(Env *env, Id script_id, Id new_script_id) {
+    size_t old_index = env->scripts.count;
+    size_t new_index = env->scripts.count;
+    for (size_t i = 0; i < env->scripts.count; ++i) {
+        if (env->scripts.elements[i].script_id == script_id) {
+            old_index = i;
+        } else if (env->scripts.elements[i].script_id == new_script_id) {
+            new_index = i;
+        }
+    }
+    if (old_index == env->scripts.count || new_index == env->scripts.count) {
+        return false;
+    }
+    // The spill file is named after the script id, so the new version has to be
+    // in memory before it gets the old id.
+    if (!tkbc_script_store_ensure_loaded(env, &env->scripts.elements[new_index])) {
+        return false;
+    }
+
+    Id active_id = env->script ? env->script->script_id : 0;
+    bool is_frames = env->frames != NULL;
+    Index frames_index = is_frames ? env->frames->frames_index : 0;
+
+    Script script = env->scripts.elements[new_index];
+    script.script_id = script_id;
+    tkbc_script_store_release(env, &env->scripts.elements[old_index]);
+    env->scripts.elements[old_index] = script;
+    if (new_index + 1 < env->scripts.count) {
+        memmove(&env->scripts.elements[new_index], &env->scripts.elements[new_index + 1],
+                sizeof(*env->scripts.elements) * (env->scripts.count - new_index - 1));
+    }
+    env->scripts.count -= 1;
+
+    if (active_id) {
+        tkbc_restore_script_view(env, active_id, is_frames, frames_index);
+    }
+    return true;
+}
+
 /**
  * @brief Calculates the size that the given frames currently take.
  *
@@ -1043,6 +1465,10 @@ size_t tkbc_calculate_script_byte_size_allocated(Script script) {
             result += frames->capacity * sizeof(Frame);
         }
 
+        // Interned ids are counted once with the pool.
+        if (script.id_pool.elements) {
+            continue;
+        }
         for (size_t j = 0; j < frames->count; ++j) {
 
             if (frames->elements[j].kite_id_array.count > 0) {
@@ -1050,10 +1476,163 @@ size_t tkbc_calculate_script_byte_size_allocated(Script script) {
             }
         }
     }
+    result += script.id_pool.capacity * sizeof(Id);
 
     return result;
 }
 
+/**
+ * @brief The function computes the time a block takes, if it is played without
+ * interruption. The frames of a block are executed at the same time, so it is
+ * the longest duration of its frames.
+ *
+ * @param frames The block of frames.
+ * @return The duration of the block in seconds.
+ */
+float tkbc_script_block_duration(Frames *frames) {
+    float duration = 0;
+    for (size_t i = 0; i < frames->count; ++i) {
+        if (frames->elements[i].original_duration > duration) {
+            duration = frames->elements[i].original_duration;
+        }
+    }
+    return duration;
+}
+
+/**
+ * @brief The function builds the timeline of the script out of the prefix sums
+ * of its block durations. The start time of a block and the block at a time
+ * are looked up in the timeline without summing up the blocks before. The
+ * timeline is allocated in the space of the script.
+ *
+ * @param script The script the timeline is built for.
+ */
+void tkbc_script_timeline_build(Script *script) {
+    Script_Timeline *timeline = &script->timeline;
+    timeline->count = script->count + 1;
+    timeline->capacity = timeline->count;
+    timeline->elements = space_malloc(&script->space, timeline->capacity * sizeof(*timeline->elements));
+
+    // The sum is kept in double precision, so long shows don't drift.
+    double time = 0;
+    timeline->elements[0] = 0;
+    for (size_t i = 0; i < script->count; ++i) {
+        time += tkbc_script_block_duration(&script->elements[i]);
+        timeline->elements[i + 1] = time;
+    }
+}
+
+/**
+ * @brief The function returns the duration of the script, if it is played
+ * without interruption.
+ *
+ * @param script The script with a built timeline.
+ * @return The duration in seconds or 0 if the script has no timeline.
+ */
+float tkbc_script_timeline_duration(Script *script) {
+    if (script->timeline.count == 0) {
+        return 0;
+    }
+    return script->timeline.elements[script->timeline.count - 1];
+}
+
+/**
+ * @brief The function searches the block that is executed at the given time
+ * into the script with a binary search over the timeline. Blocks without a
+ * duration are skipped, because they are finished immediately.
+ *
+ * @param script The script with a built timeline.
+ * @param time The time in seconds from the start of the script.
+ * @return The index of the block, times outside of the script are clamped to
+ * the first or the last block.
+ */
+size_t tkbc_script_timeline_block_at(Script *script, float time) {
+    if (script->timeline.count < 2) {
+        return 0;
+    }
+
+    // The block is in the range [low, high).
+    size_t low = 0;
+    size_t high = script->timeline.count - 1;
+    while (high - low > 1) {
+        size_t mid = low + (high - low) / 2;
+        if (script->timeline.elements[mid] <= time) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief The function computes the part of the timeline that is over at the
+ * end of the given block. The parts are proportional to the block durations.
+ * If the timeline is not known or the script has no duration, every block gets
+ * the same part.
+ *
+ * @param script The script of the blocks or NULL.
+ * @param block The index of the block.
+ * @param block_count The amount of blocks of the script.
+ * @return The part of the timeline between 0 and 1.
+ */
+float tkbc_script_timeline_block_end(Script *script, size_t block, size_t block_count) {
+    assert(block < block_count);
+    float duration = script ? tkbc_script_timeline_duration(script) : 0;
+    if (script == NULL || script->timeline.count != block_count + 1 || duration <= 0) {
+        return (block + 1) / (float) block_count;
+    }
+    return script->timeline.elements[block + 1] / duration;
+}
+
+/**
+ * @brief The function searches the block at the given part of the timeline,
+ * it is the inverse of tkbc_script_timeline_block_end().
+ *
+ * @param script The script of the blocks or NULL.
+ * @param part The part of the timeline, it is clamped between 0 and 1.
+ * @param block_count The amount of blocks of the script.
+ * @return The index of the block.
+ */
+size_t tkbc_script_timeline_block_at_part(Script *script, float part, size_t block_count) {
+    assert(block_count > 0);
+    part = Clamp(part, 0, 1);
+    float duration = script ? tkbc_script_timeline_duration(script) : 0;
+    if (script == NULL || script->timeline.count != block_count + 1 || duration <= 0) {
+        size_t block = part * block_count;
+        return block < block_count ? block : block_count - 1;
+    }
+    return tkbc_script_timeline_block_at(script, part * duration);
+}
+
+/**
+ * @brief The function computes the time into the executed script out of the
+ * start time of the current block and the progress of its frames.
+ *
+ * @param env The global state of the application.
+ * @return The time in seconds or 0 if no script is executed.
+ */
+float tkbc_script_elapsed_time(Env *env) {
+    if (env->script == NULL || env->frames == NULL || env->script->timeline.count == 0) {
+        return 0;
+    }
+
+    float block_time = 0;
+    for (size_t i = 0; i < env->frames->count; ++i) {
+        Frame *frame = &env->frames->elements[i];
+        float time = frame->finished ? frame->original_duration : frame->original_duration - frame->duration;
+        if (time > block_time) {
+            block_time = time;
+        }
+    }
+
+    size_t block = env->frames->frames_index;
+    if (block + 1 >= env->script->timeline.count) {
+        return tkbc_script_timeline_duration(env->script);
+    }
+    return env->script->timeline.elements[block] + block_time;
+}
+
 /**
  * @brief This function adds a script to the global array located in the env.
  * It is needed to achieve stability for the raw frames and script pointers in
@@ -1063,6 +1642,75 @@ size_t tkbc_calculate_script_byte_size_allocated(Script script) {
  * @param script The script to add.
  */
 void tkbc_add_script(Env *env, Script script) {
+    Script s_copy = {0};
+    Space_Report report = {0};
+    bool has_report = space_report_allocations(&env->scratch_buf_script.space, &report);
+    bool is_scratch = script.elements != NULL && script.elements == env->scratch_buf_script.elements;
+    if (is_scratch && has_report &&
+        report.allocated_capacity <= TKBC_SCRIPT_SPACE_MOVE_RATIO * report.allocated_count) {
+        // The scratch script fills most of its own space, so the space is moved
+        // into the stored script instead of copying it. The next scratch
+        // script gets a new space of a similar size.
+        s_copy = tkbc_move_script(&env->scratch_buf_script.space, &script);
+        size_t capacity = TKBC_SCRIPT_SPACE_MIN_CAPACITY;
+        if (has_report && report.allocated_count > capacity) {
+            capacity = report.allocated_count;
+        }
+        space_init_capacity(&env->scratch_buf_script.space, capacity);
+    } else {
+        // A small script in a large scratch space is copied into a space of its
+        // size, the copy stores the interned ids only once and the scratch
+        // space is reused for the next script.
+        Space space = {0};
+        if (has_report) {
+            space_init_capacity(&space, report.allocated_count);
+        }
+        s_copy = tkbc_deep_copy_script(&space, &script);
+        s_copy.space = space;
+    }
+
+    // Rest the scratch buffers they got invalidated by resetting the space.
+    memset(&env->scratch_buf_frames, 0, sizeof(env->scratch_buf_frames));
+    // Rest only the rest of the fields and not the space inside of the
+    // scratch_buf_script script to preserve memory for reuse.
+    {
+        env->scratch_buf_script.elements = NULL;
+        env->scratch_buf_script.count = 0;
+        env->scratch_buf_script.capacity = 0;
+        env->scratch_buf_script.script_id = 0;
+        env->scratch_buf_script.name = NULL;
+        space_reset_space(&env->scratch_buf_script.space);
+    }
+
+    tkbc_add_owned_script(env, s_copy);
+}
+
+/**
+ * @brief This function adds a finished script to the global array located in
+ * the env without copying it. The env takes the ownership of the script and
+ * its space. The views of the env are restored after the scripts array has
+ * grown.
+ *
+ * @param env The global state of the application.
+ * @param script The script to add, its frames have to be allocated in its
+ * space or in memory that outlives the env.
+ */
+void tkbc_add_owned_script(Env *env, Script script) {
+    tkbc_script_timeline_build(&script);
+    tkbc_add_built_script(env, script);
+}
+
+/**
+ * @brief This function adds a finished script with an already built timeline
+ * to the global array located in the env, like tkbc_add_owned_script(). A
+ * script that was added to another env, like the one of a parse worker, is
+ * handed over in this way, so its timeline is not allocated a second time.
+ *
+ * @param env The global state of the application.
+ * @param script The script to add, its timeline has to be built.
+ */
+void tkbc_add_built_script(Env *env, Script script) {
+    assert(script.timeline.count == script.count + 1);
     Index frames_index = 0;
     Id script_id = 0;
     bool is_frames = false;
@@ -1078,38 +1726,9 @@ void tkbc_add_script(Env *env, Script script) {
         script_id = env->script->script_id;
     }
 
-#define threshold_max_scripts_in_memory 10
-    if (env->scripts.count >= threshold_max_scripts_in_memory) {
-        Script *first_script = &env->scripts.elements[0];
-        // NOTE: this is actually slow because every other script just be moved
-        // over in the array.
-        tkbc_unload_script_from_memory(env, first_script->script_id);
-    }
-
-    // size_t bytes_count = tkbc_calculate_script_byte_size_allocated(script);
-
-    {
-        Script s_copy = {0};
-        Space_Report report = {0};
-        if (space_report_allocations(&env->scratch_buf_script.space, &report)) {
-            space_init_capacity(&s_copy.space, report.allocated_count);
-        }
-        s_copy = tkbc_deep_copy_script(&s_copy.space, &script);
-        space_dap(&env->_scripts_space, &env->scripts, s_copy);
-
-        // Rest the scratch buffers they got invalidated by resetting the space.
-        memset(&env->scratch_buf_frames, 0, sizeof(env->scratch_buf_frames));
-        // Rest only the rest of the fields and not the space inside of the
-        // scratch_buf_script script to preserve memory for reuse.
-        {
-            env->scratch_buf_script.elements = NULL;
-            env->scratch_buf_script.count = 0;
-            env->scratch_buf_script.capacity = 0;
-            env->scratch_buf_script.script_id = 0;
-            env->scratch_buf_script.name = NULL;
-            space_reset_space(&env->scratch_buf_script.space);
-        }
-    }
+    tkbc_script_store_account(env, &script);
+    tkbc_script_store_touch(env, &script);
+    space_dap(&env->_scripts_space, &env->scripts, script);
 
     if (is_script) {
         if (!tkbc_load_script_id(env, script_id, false)) {
@@ -1126,6 +1745,10 @@ void tkbc_add_script(Env *env, Script script) {
             }
         }
     }
+
+    // Scripts are evicted after the views are valid again, so the executed
+    // script is known and stays in memory.
+    tkbc_script_store_enforce_budget(env, script.script_id);
 }
 
 /**
@@ -1148,6 +1771,11 @@ void tkbc_input_handler_script(Env *env) {
         }
     }
 
+    // KEY_G
+    if (tkbc_check_keymaps_full(env->keymaps, KMH_TOGGLE_COLLISION_OVERLAY, KEY_MAP_CHECK_KEY_PRESSED)) {
+        env->collision_overlay = !env->collision_overlay;
+    }
+
     // This guard just prevent it for one frame.
     // But it can't be blocked for longer because the user may actually want to
     // scrub that fast.
@@ -1182,7 +1810,7 @@ void tkbc_set_kite_positions_from_kite_frames_positions(Env *env) {
         Vector2 position = env->frames->kite_frame_positions.elements[i].position;
         float angle = env->frames->kite_frame_positions.elements[i].angle;
 
-        tkbc_center_rotation(kite, &position, angle);
+        tkbc_kite_set_pose(kite, &position, angle);
 
         // For the correct recomputation of the action where the slider is set to.
         kite->old_angle = kite->angle;
@@ -1219,6 +1847,32 @@ void tkbc_execute_scrub_slide(Env *env, bool drag_left) {
     tkbc_set_kite_positions_from_kite_frames_positions(env);
 }
 
+/**
+ * @brief This function moves to the given frames of the script. The kite
+ * positions of the frames in between are set as well, so the kites end up
+ * where they would be after sliding over every frames.
+ *
+ * @param env The global state of the application.
+ * @param frames_index The index of the frames to move to, it is clamped to the
+ * last frames of the script.
+ */
+void tkbc_execute_scrub_to(Env *env, size_t frames_index) {
+    env->script_finished = true;
+    if (frames_index >= env->script->count) {
+        frames_index = env->script->count - 1;
+    }
+
+    while (env->frames->frames_index != frames_index) {
+        if (env->frames->frames_index < frames_index) {
+            env->frames = &env->script->elements[env->frames->frames_index + 1];
+        } else {
+            env->frames = &env->script->elements[env->frames->frames_index - 1];
+        }
+        tkbc_set_kite_positions_from_kite_frames_positions(env);
+    }
+    tkbc_restore_script_frame_states(env);
+}
+
 /**
  * @brief Restores all frame durations and finished flags across the entire
  * script so that a replay from the beginning uses the original timing.
@@ -1253,13 +1907,13 @@ void tkbc_scrub_frames(Env *env) {
         return;
     }
 
-    if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) && env->timeline_interaction) {
-        int mouse_x = GetMouseX();
-        float slider = env->timeline_front.x + env->timeline_front.width;
-        float c = mouse_x - slider;
-        bool drag_left = c <= 0;
-
-        tkbc_execute_scrub_slide(env, drag_left);
+    if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) && env->timeline_interaction && env->frames) {
+        // The slider jumps to the frames under the mouse.
+        float part = (GetMouseX() - env->timeline_base.x) / env->timeline_base.width;
+        size_t frames_index = tkbc_script_timeline_block_at_part(env->script, part, env->script->count);
+        if (frames_index != env->frames->frames_index) {
+            tkbc_execute_scrub_to(env, frames_index);
+        }
     }
 }
 
@@ -1279,14 +1933,14 @@ void tkbc_scrub_frames(Env *env) {
 Vector2 tkbc_script_move(Kite *kite, Vector2 position, float duration) {
     if (duration <= 0) {
         Vector2 result = Vector2Subtract(position, kite->center);
-        tkbc_kite_update_position(kite, &position);
+        tkbc_kite_set_pose(kite, &position, kite->angle);
         return result;
     }
 
     if (Vector2Equals(kite->center, position)) {
         // NOTE:This might be just (0,0), because the  precision is not needed?
         Vector2 result = Vector2Subtract(position, kite->center);
-        tkbc_kite_update_position(kite, &position);
+        tkbc_kite_set_pose(kite, &position, kite->angle);
         return result;
     }
 
@@ -1296,11 +1950,11 @@ Vector2 tkbc_script_move(Kite *kite, Vector2 position, float duration) {
     Vector2 dnormscale = Vector2Scale(dnorm, (Vector2Length(d) / duration * dt));
 
     if (Vector2Length(dnormscale) >= Vector2Length(Vector2Subtract(position, kite->center))) {
-        tkbc_kite_update_position(kite, &position);
+        tkbc_kite_set_pose(kite, &position, kite->angle);
         return Vector2Subtract(position, kite->center);
     } else {
         Vector2 it = Vector2Add(kite->center, dnormscale);
-        tkbc_kite_update_position(kite, &it);
+        tkbc_kite_set_pose(kite, &it, kite->angle);
         return dnormscale;
     }
 }
@@ -1326,9 +1980,9 @@ float tkbc_script_rotate(Kite *kite, float angle, float duration, bool adding) {
     // actual rotation direction is called instead.
     if (duration <= 0) {
         if (adding) {
-            tkbc_kite_update_angle(kite, kite->old_angle + angle);
+            tkbc_kite_set_pose(kite, NULL, kite->old_angle + angle);
         } else {
-            tkbc_kite_update_angle(kite, angle);
+            tkbc_kite_set_pose(kite, NULL, angle);
         }
         return fabsf(angle);
     }
@@ -1339,9 +1993,9 @@ float tkbc_script_rotate(Kite *kite, float angle, float duration, bool adding) {
 
     if (ds >= fabsf(kite->old_angle) + d) {
         if (adding) {
-            tkbc_kite_update_angle(kite, kite->old_angle + angle);
+            tkbc_kite_set_pose(kite, NULL, kite->old_angle + angle);
         } else {
-            tkbc_kite_update_angle(kite, angle);
+            tkbc_kite_set_pose(kite, NULL, angle);
         }
         return fabsf(ds);
     }
@@ -1349,9 +2003,9 @@ float tkbc_script_rotate(Kite *kite, float angle, float duration, bool adding) {
     // calculation at the correct point so the angle computation is not needed
     // her.
     if (signbit(angle) != 0) {
-        tkbc_kite_update_angle(kite, kite->angle - ds);
+        tkbc_kite_set_pose(kite, NULL, kite->angle - ds);
     } else {
-        tkbc_kite_update_angle(kite, kite->angle + ds);
+        tkbc_kite_set_pose(kite, NULL, kite->angle + ds);
     }
     return fabsf(ds);
 }
@@ -1410,6 +2064,159 @@ float tkbc_script_rotate_tip(Kite *kite, TIP tip, float angle, float duration, b
     return fabsf(ds);
 }
 
+/**
+ * @brief The function maps the normalized time of an action to its normalized
+ * progress with the given easing curve.
+ *
+ * @param easing The curve that should be applied.
+ * @param t The normalized time that is clamped to the range from 0 to 1.
+ * @return The normalized progress, it is 0 for t = 0 and 1 for t = 1.
+ */
+float tkbc_ease(Easing easing, float t) {
+    t = Clamp(t, 0, 1);
+
+    static_assert(EASING_COUNT == 7, "NOT ALL THE Easings ARE IMPLEMENTED");
+    switch (easing) {
+    case EASING_LINEAR: return t;
+    case EASING_CUBIC_IN: return t * t * t;
+    case EASING_CUBIC_OUT: {
+        float u = 1 - t;
+        return 1 - u * u * u;
+    }
+    case EASING_CUBIC_IN_OUT: {
+        if (t < 0.5f) {
+            return 4 * t * t * t;
+        }
+        float u = -2 * t + 2;
+        return 1 - u * u * u / 2;
+    }
+    case EASING_SINE_IN: return 1 - cosf(t * PI / 2);
+    case EASING_SINE_OUT: return sinf(t * PI / 2);
+    case EASING_SINE_IN_OUT: return -(cosf(PI * t) - 1) / 2;
+    default: assert(0 && "UNREACHABLE tkbc_ease()");
+    }
+    return t;
+}
+
+/**
+ * @brief The function can be used to get the name of the easing that is used in
+ * the .kite files.
+ *
+ * @param easing The easing the name is requested for.
+ * @return The name of the easing or NULL if the easing is unknown.
+ */
+const char *tkbc_easing_to_cstr(Easing easing) {
+    static_assert(EASING_COUNT == 7, "NOT ALL THE Easings ARE IMPLEMENTED");
+    static const char *names[EASING_COUNT] = {
+        [EASING_LINEAR] = "LINEAR",
+        [EASING_CUBIC_IN] = "CUBIC_IN",
+        [EASING_CUBIC_OUT] = "CUBIC_OUT",
+        [EASING_CUBIC_IN_OUT] = "CUBIC_IN_OUT",
+        [EASING_SINE_IN] = "SINE_IN",
+        [EASING_SINE_OUT] = "SINE_OUT",
+        [EASING_SINE_IN_OUT] = "SINE_IN_OUT",
+    };
+    if (easing < 0 || easing >= EASING_COUNT) {
+        return NULL;
+    }
+    return names[easing];
+}
+
+/**
+ * @brief The function looks up the easing that belongs to the given name.
+ *
+ * @param name The name of the easing, it does not have to be null terminated.
+ * @param size The length of the name.
+ * @param easing The out parameter that holds the easing if it was found.
+ * @return True if the name is a known easing, otherwise false.
+ */
+bool tkbc_easing_from_cstr(const char *name, size_t size, Easing *easing) {
+    for (Easing e = 0; e < EASING_COUNT; ++e) {
+        const char *cstr = tkbc_easing_to_cstr(e);
+        if (strlen(cstr) == size && strncmp(cstr, name, size) == 0) {
+            *easing = e;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief The function places the kite on the given curved path. The path is
+ * relative to the position of the kite at the begin of the block.
+ *
+ * @param kite The kite that should be placed on the path.
+ * @param kind Either ACTION_KITE_BEZIER or ACTION_KITE_CATMULL_ROM.
+ * @param action The path that the kite is flying.
+ * @param t The normalized time of the path in the range from 0 to 1, the
+ * easing of the action is applied to it.
+ */
+void tkbc_script_spline(Kite *kite, Action_Kind kind, Spline_Action *action, float t) {
+    t = tkbc_ease(action->easing, t);
+    Vector2 p0 = kite->old_center;
+    Vector2 p1 = Vector2Add(p0, action->control_1);
+    Vector2 p2 = Vector2Add(p0, action->control_2);
+    Vector2 p3 = Vector2Add(p0, action->position);
+    Vector2 position;
+
+    if (kind == ACTION_KITE_BEZIER) {
+        float u = 1 - t;
+        float b0 = u * u * u;
+        float b1 = 3 * u * u * t;
+        float b2 = 3 * u * t * t;
+        float b3 = t * t * t;
+        position = (Vector2){
+            .x = b0 * p0.x + b1 * p1.x + b2 * p2.x + b3 * p3.x,
+            .y = b0 * p0.y + b1 * p1.y + b2 * p2.y + b3 * p3.y,
+        };
+    } else {
+        assert(kind == ACTION_KITE_CATMULL_ROM);
+        // The path has three segments through all four points, the outer
+        // points are duplicated to get the missing tangents at the ends.
+        Vector2 points[] = {p0, p0, p1, p2, p3, p3};
+        float u = t * 3;
+        size_t segment = u >= 3 ? 2 : (size_t) u;
+        u -= segment;
+
+        Vector2 *p = &points[segment];
+        float u2 = u * u;
+        float u3 = u2 * u;
+        float c0 = -u3 + 2 * u2 - u;
+        float c1 = 3 * u3 - 5 * u2 + 2;
+        float c2 = -3 * u3 + 4 * u2 + u;
+        float c3 = u3 - u2;
+        position = (Vector2){
+            .x = (c0 * p[0].x + c1 * p[1].x + c2 * p[2].x + c3 * p[3].x) / 2,
+            .y = (c0 * p[0].y + c1 * p[1].y + c2 * p[2].y + c3 * p[3].y) / 2,
+        };
+    }
+    tkbc_kite_set_pose(kite, &position, kite->angle);
+}
+
+/**
+ * @brief The function places the kite on the circular path of the given arc
+ * action. The center of the circle is derived from the position of the kite at
+ * the begin of the block and the begin angle of the arc.
+ *
+ * @param kite The kite that should be placed on the arc.
+ * @param action The arc that the kite is flying.
+ * @param t The normalized time of the arc in the range from 0 to 1, the easing
+ * of the action is applied to it.
+ */
+void tkbc_script_arc(Kite *kite, Arc_Action *action, float t) {
+    t = tkbc_ease(action->easing, t);
+    float begin = action->begin_angle * DEG2RAD;
+    float phi = (action->begin_angle + (action->end_angle - action->begin_angle) * t) * DEG2RAD;
+
+    // The screen y-axis points down, so the anticlockwise angles are negated.
+    Vector2 position = {
+        .x = kite->old_center.x + action->radius * (cosf(phi) - cosf(begin)),
+        .y = kite->old_center.y - action->radius * (sinf(phi) - sinf(begin)),
+    };
+    float angle = action->rotation == 0 ? kite->angle : kite->old_angle + action->rotation * t;
+    tkbc_kite_set_pose(kite, &position, angle);
+}
+
 /**
  * @brief The function resolves a zero angle to a concrete rotation value. This
  * is needed to determine the actual rotation direction when a frame with a
@@ -12,18 +12,23 @@ Kite_State *tkbc_get_kite_state_by_id(Env *env, size_t id);
 Kite *tkbc_get_kite_by_id(Env *env, size_t id);
 Kite *tkbc_get_kite_by_id_unwrap(Env *env, size_t id);
 bool tkbc_scripts_contains_id(Scripts scripts, Id script_id);
+Script *tkbc_get_script_by_id(Env *env, Id script_id);
 bool tkbc_contains_id(Kite_Ids kite_ids, size_t id);
 bool tkbc_find_first_active_script_kite(Env *env, Id *id);
 size_t tkbc_get_active_kite_count(Kite_States *kite_states);
 Frame tkbc_deep_copy_frame(Space *space, Frame *frame);
 Frames tkbc_deep_copy_frames(Space *space, Frames *frames);
 Script tkbc_deep_copy_script(Space *space, Script *script);
+Script tkbc_move_script(Space *space, Script *script);
 void tkbc_destroy_frames_internal_data(Frames *frames);
 void tkbc_reset_frames_internal_data(Frames *frames);
 void tkbc_render_frame(Env *env, Frame *frame);
 
+bool tkbc_script_id_pool_contains(Script *script, Kite_Ids *ids);
 void tkbc_remap_script_kite_id_arrays_to_kite_ids(Script *script, Kite_Ids kite_ids);
 
+void tkbc_kite_id_map_build(Env *env);
+Kite_Id_Slot *tkbc_kite_id_map_find(Env *env, Id kite_id);
 void tkbc_patch_script_kite_positions(Env *env, Script *script, Space *space);
 void tkbc_patch_frames_kite_positions(Env *env, Frames *frames, Space *space);
 bool tkbc_check_finished_frames(Env *env);
@@ -36,16 +41,28 @@ void tkbc_load_next_script(Env *env);
 bool tkbc_load_script_id(Env *env, size_t script_id, bool fresh);
 void tkbc_unload_script(Env *env);
 bool tkbc_unload_script_from_memory(Env *env, size_t script_id);
+bool tkbc_replace_script(Env *env, Id script_id, Id new_script_id);
 
 size_t tkbc_calculate_frame_byte_size(Frame frame);
 size_t tkbc_calculate_frames_byte_size(Frames frames);
 size_t tkbc_calculate_script_byte_size(Script script);
 size_t tkbc_calculate_script_byte_size_allocated(Script script);
 
+float tkbc_script_block_duration(Frames *frames);
+void tkbc_script_timeline_build(Script *script);
+float tkbc_script_timeline_duration(Script *script);
+size_t tkbc_script_timeline_block_at(Script *script, float time);
+float tkbc_script_timeline_block_end(Script *script, size_t block, size_t block_count);
+size_t tkbc_script_timeline_block_at_part(Script *script, float part, size_t block_count);
+float tkbc_script_elapsed_time(Env *env);
+
 void tkbc_add_script(Env *env, Script script);
+void tkbc_add_owned_script(Env *env, Script script);
+void tkbc_add_built_script(Env *env, Script script);
 void tkbc_input_handler_script(Env *env);
 void tkbc_set_kite_positions_from_kite_frames_positions(Env *env);
 void tkbc_execute_scrub_slide(Env *env, bool drag_left);
+void tkbc_execute_scrub_to(Env *env, size_t frames_index);
 void tkbc_restore_script_frame_states(Env *env);
 void tkbc_scrub_frames(Env *env);
 
@@ -56,6 +73,11 @@ void tkbc_scrub_frames(Env *env);
 Vector2 tkbc_script_move(Kite *kite, Vector2 position, float duration);
 float tkbc_script_rotate(Kite *kite, float angle, float duration, bool adding);
 float tkbc_script_rotate_tip(Kite *kite, TIP tip, float angle, float duration, bool adding);
+float tkbc_ease(Easing easing, float t);
+const char *tkbc_easing_to_cstr(Easing easing);
+bool tkbc_easing_from_cstr(const char *name, size_t size, Easing *easing);
+void tkbc_script_spline(Kite *kite, Action_Kind kind, Spline_Action *action, float t);
+void tkbc_script_arc(Kite *kite, Arc_Action *action, float t);
 float tkbc_check_angle_zero(Kite *kite, Action_Kind kind, Action action, float duration);
 
 #endif  // TKBC_SCRIPT_HANDLER_H_
@@ -0,0 +1,630 @@
+#include "tkbc-script-kiteb.h"
+#include "../global/tkbc-types.h"
+#include "../global/tkbc-utils.h"
+#include "tkbc-script-api.h"
+#include "tkbc-script-handler.h"
+#include "tkbc-script-store.h"
+#include "tkbc.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A .kiteb file is little endian, every section starts 8 byte aligned and all
+// offsets are relative to the start of the file. The frames refer to their id
+// set by an index into the id section of their script, so the interned sets are
+// stored once and can be used in place after loading.
+#define TKBC_KITEB_MAGIC "TKBCKITB"
+
+typedef struct {
+    char magic[8];            // The TKBC_KITEB_MAGIC.
+    uint32_t version;         // The TKBC_KITEB_VERSION of the writer.
+    uint32_t header_size;     // The size of this header in bytes.
+    uint64_t file_size;       // The size of the complete file in bytes.
+    uint64_t kite_count;      // The amount of kites the scripts need.
+    uint64_t scripts_count;   // The amount of entries in the script table.
+    uint64_t scripts_offset;  // The start of the script table.
+    uint64_t strings_offset;  // The start of the string table.
+    uint64_t strings_size;    // The size of the string table in bytes.
+} Kiteb_Header;               // The header at the start of a .kiteb file.
+
+typedef struct {
+    uint64_t script_id;         // The id of the script at the export.
+    uint64_t name_offset;       // The offset of the name in the string table.
+    uint64_t blocks_count;      // The amount of blocks of the script.
+    uint64_t blocks_offset;     // The start of the Kiteb_Block section.
+    uint64_t frames_count;      // The amount of frames of all blocks.
+    uint64_t frames_offset;     // The start of the Kiteb_Frame section.
+    uint64_t ids_count;         // The amount of ids in the id section.
+    uint64_t ids_offset;        // The start of the id section.
+    uint64_t keyframes_count;   // The amount of keyframes of all blocks.
+    uint64_t keyframes_offset;  // The start of the Kiteb_Keyframe section.
+} Kiteb_Script;                 // An entry of the script table.
+
+typedef struct {
+    uint64_t frames_index;     // The index of the block in the script.
+    uint64_t first_frame;      // The first frame of the block in the frame section.
+    uint64_t frames_count;     // The amount of frames of the block.
+    uint64_t first_keyframe;   // The first keyframe of the block.
+    uint64_t keyframes_count;  // The amount of keyframes of the block.
+} Kiteb_Block;                 // The frames and keyframes of one block.
+
+typedef struct {
+    uint32_t kind;       // The Action_Kind of the frame.
+    float duration;      // The original duration of the frame.
+    uint64_t ids_index;  // The index of the id set in the id section.
+    uint64_t ids_count;  // The amount of ids of the set.
+    uint32_t action[8];  // The raw bytes of the Action.
+} Kiteb_Frame;           // A frame without its playback state.
+
+typedef struct {
+    uint64_t kite_id;   // The kite the position belongs to.
+    float x;            // The x coordinate of the kite center.
+    float y;            // The y coordinate of the kite center.
+    float angle;        // The angle of the kite in degrees.
+    uint32_t reserved;  // Padding that is always 0.
+} Kiteb_Keyframe;       // The start position of a kite in a block.
+
+static_assert(sizeof(Kiteb_Header) == 64, "The .kiteb header layout has changed");
+static_assert(sizeof(Kiteb_Script) == 80, "The .kiteb script layout has changed");
+static_assert(sizeof(Kiteb_Block) == 40, "The .kiteb block layout has changed");
+static_assert(sizeof(Kiteb_Frame) == 56, "The .kiteb frame layout has changed");
+static_assert(sizeof(Kiteb_Keyframe) == 24, "The .kiteb keyframe layout has changed");
+static_assert(sizeof(Action) <= sizeof(((Kiteb_Frame *) 0)->action), "The Action does not fit in a .kiteb frame");
+
+/**
+ * @brief The function appends the bytes 8 byte aligned to the buffer.
+ *
+ * @param out The buffer of the file.
+ * @param data The bytes that are appended or NULL to append zeros.
+ * @param size The amount of bytes.
+ * @return The offset of the appended bytes in the buffer.
+ */
+static uint64_t tkbc_kiteb_append(Content *out, const void *data, size_t size) {
+    static const char zeros[64] = {0};
+    while (out->count % 8 != 0) {
+        tkbc_dap(out, '\0');
+    }
+    uint64_t offset = out->count;
+    if (data == NULL) {
+        for (size_t n = size; n > 0;) {
+            size_t chunk = n < sizeof(zeros) ? n : sizeof(zeros);
+            tkbc_dapc(out, zeros, chunk);
+            n -= chunk;
+        }
+    } else {
+        tkbc_dapc(out, (const char *) data, size);
+    }
+    return offset;
+}
+
+/**
+ * @brief The function serializes the scripts from the given index on to the
+ * .kiteb layout in memory. Evicted scripts are loaded back for the export.
+ *
+ * @param env The global state of the application.
+ * @param first The index of the first script in the env that is written.
+ * @param out The empty buffer the .kiteb data is written to.
+ * @return 0 If the scripts are written, otherwise the positive "script_id" of
+ * a script that could not be loaded.
+ */
+int tkbc_kiteb_write_scripts(Env *env, size_t first, Content *out) {
+    int ok = 0;
+    Content strings = {0};
+    Kite_Ids ids = {0};
+    size_t count = first < env->scripts.count ? env->scripts.count - first : 0;
+
+    Kiteb_Header header = {0};
+    memcpy(header.magic, TKBC_KITEB_MAGIC, sizeof(header.magic));
+    header.version = TKBC_KITEB_VERSION;
+    header.header_size = sizeof(header);
+    header.scripts_count = count;
+    tkbc_kiteb_append(out, NULL, sizeof(header));
+    header.scripts_offset = tkbc_kiteb_append(out, NULL, count * sizeof(Kiteb_Script));
+    // The string table starts with the empty string for scripts without a name.
+    tkbc_dap(&strings, '\0');
+
+    for (size_t i = 0; i < count; ++i) {
+        Script *script = &env->scripts.elements[first + i];
+        if (!tkbc_script_store_ensure_loaded(env, script)) {
+            check_return((int) script->script_id);
+        }
+
+        Kiteb_Script entry = {.script_id = script->script_id, .blocks_count = script->count};
+        if (script->name) {
+            entry.name_offset = strings.count;
+            tkbc_dapc(&strings, script->name, strlen(script->name) + 1);
+        }
+
+        entry.blocks_offset = tkbc_kiteb_append(out, NULL, 0);
+        for (size_t b = 0; b < script->count; ++b) {
+            Frames *frames = &script->elements[b];
+            Kiteb_Block block = {
+                .frames_index = frames->frames_index,
+                .first_frame = entry.frames_count,
+                .frames_count = frames->count,
+                .first_keyframe = entry.keyframes_count,
+                .keyframes_count = frames->kite_frame_positions.count,
+            };
+            tkbc_kiteb_append(out, &block, sizeof(block));
+            entry.frames_count += frames->count;
+            entry.keyframes_count += frames->kite_frame_positions.count;
+        }
+
+        // The id section starts with the interned pool of the script, sets that
+        // are not part of the pool are appended.
+        ids.count = 0;
+        Id *pool = script->id_pool.elements;
+        if (pool) {
+            tkbc_dapc(&ids, pool, script->id_pool.count);
+        }
+
+        entry.frames_offset = tkbc_kiteb_append(out, NULL, 0);
+        for (size_t b = 0; b < script->count; ++b) {
+            for (size_t j = 0; j < script->elements[b].count; ++j) {
+                Frame *frame = &script->elements[b].elements[j];
+                Kiteb_Frame kiteb_frame = {
+                    .kind = frame->kind,
+                    .duration = frame->original_duration,
+                    .ids_count = frame->kite_id_array.count,
+                };
+                memcpy(kiteb_frame.action, &frame->action, sizeof(frame->action));
+
+                Kite_Ids *set = &frame->kite_id_array;
+                if (set->count > 0) {
+                    if (tkbc_script_id_pool_contains(script, set)) {
+                        kiteb_frame.ids_index = set->elements - pool;
+                    } else {
+                        kiteb_frame.ids_index = ids.count;
+                        tkbc_dapc(&ids, set->elements, set->count);
+                    }
+                }
+                tkbc_kiteb_append(out, &kiteb_frame, sizeof(kiteb_frame));
+            }
+        }
+
+        entry.ids_count = ids.count;
+        entry.ids_offset = tkbc_kiteb_append(out, NULL, 0);
+        for (size_t j = 0; j < ids.count; ++j) {
+            uint64_t id = ids.elements[j];
+            tkbc_kiteb_append(out, &id, sizeof(id));
+            if (id + 1 > header.kite_count) {
+                header.kite_count = id + 1;
+            }
+        }
+
+        entry.keyframes_offset = tkbc_kiteb_append(out, NULL, 0);
+        for (size_t b = 0; b < script->count; ++b) {
+            Kite_Positions *positions = &script->elements[b].kite_frame_positions;
+            for (size_t j = 0; j < positions->count; ++j) {
+                Kite_Position *position = &positions->elements[j];
+                Kiteb_Keyframe keyframe = {
+                    .kite_id = position->kite_id,
+                    .x = position->position.x,
+                    .y = position->position.y,
+                    .angle = position->angle,
+                };
+                tkbc_kiteb_append(out, &keyframe, sizeof(keyframe));
+                if (keyframe.kite_id + 1 > header.kite_count) {
+                    header.kite_count = keyframe.kite_id + 1;
+                }
+            }
+        }
+
+        memcpy(&out->elements[header.scripts_offset + i * sizeof(entry)], &entry, sizeof(entry));
+    }
+
+    header.strings_size = strings.count;
+    header.strings_offset = tkbc_kiteb_append(out, strings.elements, strings.count);
+    tkbc_kiteb_append(out, NULL, 0);
+    header.file_size = out->count;
+    memcpy(out->elements, &header, sizeof(header));
+
+check:
+    free(strings.elements);
+    free(ids.elements);
+    return ok;
+}
+
+/**
+ * @brief The function serializes all the scripts from memory to a single
+ * binary .kiteb file. Evicted scripts are loaded back for the export.
+ *
+ * @param env The global state of the application.
+ * @param filepath The file path of the .kiteb file.
+ * @return 0 If the file was written. The positive "script_id" of a script that
+ * could not be loaded or -1 if writing the file has failed.
+ */
+int tkbc_export_all_scripts_to_kiteb_file_from_mem(Env *env, const char *filepath) {
+    Content out = {0};
+    int ok = tkbc_kiteb_write_scripts(env, 0, &out);
+    if (ok == 0 && tkbc_write_file(filepath, out.elements, out.count) != 0) {
+        ok = -1;
+    }
+    free(out.elements);
+    return ok;
+}
+
+/**
+ * @brief The function maps the file read only into memory. The pages are
+ * private, so a client and a local server that load the same file share them
+ * until one of them modifies its copy.
+ *
+ * @param filepath The path of the file.
+ * @param mapping The mapping that is filled.
+ * @return True if the file is in memory, otherwise false.
+ */
+static bool tkbc_kiteb_map_file(const char *filepath, Kiteb_Mapping *mapping) {
+#ifdef _WIN32
+    Content content = {0};
+    if (tkbc_read_entire_file(filepath, &content) == -1) {
+        free(content.elements);
+        return false;
+    }
+    mapping->data = content.elements;
+    mapping->size = content.count;
+    mapping->is_mapped = false;
+    return true;
+#else
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0) {
+        tkbc_fprintf(stderr, "ERROR", "Could not open %s: %s\n", filepath, strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+        tkbc_fprintf(stderr, "ERROR", "Could not get the size of %s.\n", filepath);
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        tkbc_fprintf(stderr, "ERROR", "Could not map %s: %s\n", filepath, strerror(errno));
+        return false;
+    }
+    mapping->data = data;
+    mapping->size = st.st_size;
+    mapping->is_mapped = true;
+    return true;
+#endif
+}
+
+/**
+ * @brief The function releases the memory of a loaded .kiteb file.
+ *
+ * @param mapping The loaded file.
+ */
+static void tkbc_kiteb_unmap_file(Kiteb_Mapping *mapping) {
+#ifndef _WIN32
+    if (mapping->is_mapped) {
+        munmap(mapping->data, mapping->size);
+        mapping->data = NULL;
+        return;
+    }
+#endif
+    free(mapping->data);
+    mapping->data = NULL;
+}
+
+/**
+ * @brief The function checks if a section of the given amount of elements is
+ * completely inside of the file.
+ *
+ * @param offset The start of the section.
+ * @param count The amount of elements.
+ * @param size The size of one element.
+ * @param file_size The size of the file.
+ * @return True if the section is valid, otherwise false.
+ */
+static bool tkbc_kiteb_section_valid(uint64_t offset, uint64_t count, uint64_t size, uint64_t file_size) {
+    if (offset % 8 != 0 || offset > file_size) {
+        return false;
+    }
+    return count <= (file_size - offset) / size;
+}
+
+/**
+ * @brief The function validates a script entry and everything it refers to,
+ * so the script can be built without further checks.
+ *
+ * @param base The start of the file.
+ * @param header The validated header of the file.
+ * @param entry The script entry that is checked.
+ * @return True if the script is valid, otherwise false.
+ */
+static bool tkbc_kiteb_script_valid(const char *base, Kiteb_Header *header, Kiteb_Script *entry) {
+    uint64_t size = header->file_size;
+    if (entry->name_offset >= header->strings_size ||
+        !tkbc_kiteb_section_valid(entry->blocks_offset, entry->blocks_count, sizeof(Kiteb_Block), size) ||
+        !tkbc_kiteb_section_valid(entry->frames_offset, entry->frames_count, sizeof(Kiteb_Frame), size) ||
+        !tkbc_kiteb_section_valid(entry->ids_offset, entry->ids_count, sizeof(uint64_t), size) ||
+        !tkbc_kiteb_section_valid(entry->keyframes_offset, entry->keyframes_count, sizeof(Kiteb_Keyframe), size)) {
+        return false;
+    }
+
+    const Kiteb_Block *blocks = (const Kiteb_Block *) (base + entry->blocks_offset);
+    for (size_t i = 0; i < entry->blocks_count; ++i) {
+        const Kiteb_Block *block = &blocks[i];
+        if (block->first_frame > entry->frames_count || block->frames_count > entry->frames_count - block->first_frame) {
+            return false;
+        }
+        if (block->first_keyframe > entry->keyframes_count ||
+            block->keyframes_count > entry->keyframes_count - block->first_keyframe) {
+            return false;
+        }
+    }
+
+    const Kiteb_Frame *frames = (const Kiteb_Frame *) (base + entry->frames_offset);
+    for (size_t i = 0; i < entry->frames_count; ++i) {
+        const Kiteb_Frame *frame = &frames[i];
+        if (frame->kind >= ACTION_KIND_COUNT) {
+            return false;
+        }
+        if (frame->ids_index > entry->ids_count || frame->ids_count > entry->ids_count - frame->ids_index) {
+            return false;
+        }
+
+        Action action;
+        memcpy(&action, frame->action, sizeof(action));
+        Easing easing = EASING_LINEAR;
+        if (frame->kind == ACTION_KITE_ARC) {
+            easing = action.as_arc.easing;
+        } else if (frame->kind == ACTION_KITE_BEZIER || frame->kind == ACTION_KITE_CATMULL_ROM) {
+            easing = action.as_bezier.easing;
+        }
+        if ((unsigned) easing >= EASING_COUNT) {
+            return false;
+        }
+    }
+
+    const uint64_t *ids = (const uint64_t *) (base + entry->ids_offset);
+    for (size_t i = 0; i < entry->ids_count; ++i) {
+        if (ids[i] >= header->kite_count) {
+            return false;
+        }
+    }
+    const Kiteb_Keyframe *keyframes = (const Kiteb_Keyframe *) (base + entry->keyframes_offset);
+    for (size_t i = 0; i < entry->keyframes_count; ++i) {
+        if (keyframes[i].kite_id >= header->kite_count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief The function validates the .kiteb data in memory and everything the
+ * scripts refer to, so the scripts can be built without further checks.
+ *
+ * @param data The start of the .kiteb data, it has to be 8 byte aligned.
+ * @param size The size of the data in bytes.
+ * @return True if the data is valid, otherwise false.
+ */
+bool tkbc_kiteb_is_valid(const void *data, size_t size) {
+    const char *base = data;
+    const Kiteb_Header *header = data;
+    bool ok = size >= sizeof(*header);
+    ok = ok && memcmp(header->magic, TKBC_KITEB_MAGIC, sizeof(header->magic)) == 0;
+    if (ok && header->version != TKBC_KITEB_VERSION) {
+        tkbc_fprintf(stderr, "ERROR", "The .kiteb version %u is not supported.\n", header->version);
+        ok = false;
+    }
+    ok = ok && header->header_size == sizeof(*header) && header->file_size == size;
+    ok = ok && tkbc_kiteb_section_valid(header->scripts_offset, header->scripts_count, sizeof(Kiteb_Script),
+                                        header->file_size);
+    ok = ok && header->strings_size > 0 && tkbc_kiteb_section_valid(header->strings_offset, header->strings_size, 1,
+                                                                    header->file_size);
+    ok = ok && base[header->strings_offset + header->strings_size - 1] == '\0';
+
+    Kiteb_Script *entries = ok ? (Kiteb_Script *) (base + header->scripts_offset) : NULL;
+    for (size_t i = 0; ok && i < header->scripts_count; ++i) {
+        ok = tkbc_kiteb_script_valid(base, (Kiteb_Header *) header, &entries[i]);
+    }
+    return ok;
+}
+
+/**
+ * @brief The function returns the amount of scripts of validated .kiteb data.
+ *
+ * @param data The start of the .kiteb data.
+ * @return The amount of scripts.
+ */
+size_t tkbc_kiteb_scripts_count(const void *data) {
+    return ((const Kiteb_Header *) data)->scripts_count;
+}
+
+/**
+ * @brief The function copies a script of validated .kiteb data into the given
+ * script, so the data can be released afterwards. The script keeps the
+ * "script_id" of the export and every frame gets its own copy of the id set.
+ * The keyframes are not copied, the start positions are patched when the
+ * script is added.
+ *
+ * @param data The start of the .kiteb data.
+ * @param index The index of the script in the script table.
+ * @param space The space where the blocks, frames and ids are allocated.
+ * @param script The empty script that is filled.
+ */
+void tkbc_kiteb_copy_script(const void *data, size_t index, Space *space, Script *script) {
+    const char *base = data;
+    const Kiteb_Header *header = data;
+    const Kiteb_Script *entry = (const Kiteb_Script *) (base + header->scripts_offset) + index;
+    const Kiteb_Block *blocks = (const Kiteb_Block *) (base + entry->blocks_offset);
+    const Kiteb_Frame *kiteb_frames = (const Kiteb_Frame *) (base + entry->frames_offset);
+    const uint64_t *ids = (const uint64_t *) (base + entry->ids_offset);
+
+    script->script_id = entry->script_id;
+    for (size_t b = 0; b < entry->blocks_count; ++b) {
+        const Kiteb_Block *block = &blocks[b];
+        Frames frames = {.frames_index = block->frames_index};
+        for (size_t j = 0; j < block->frames_count; ++j) {
+            const Kiteb_Frame *kiteb_frame = &kiteb_frames[block->first_frame + j];
+            Frame frame = {
+                .kind = kiteb_frame->kind,
+                .index = j,
+                .duration = kiteb_frame->duration,
+                .original_duration = kiteb_frame->duration,
+            };
+            memcpy(&frame.action, kiteb_frame->action, sizeof(frame.action));
+            for (size_t k = 0; k < kiteb_frame->ids_count; ++k) {
+                space_dap(space, &frame.kite_id_array, (Id) ids[kiteb_frame->ids_index + k]);
+            }
+            space_dap(space, &frames, frame);
+        }
+        space_dap(space, script, frames);
+    }
+}
+
+/**
+ * @brief The function builds a script of a validated .kiteb entry and adds it
+ * to the env. The name and the interned id sets are used in place from the
+ * file, only the frames and keyframes that change during the playback are
+ * allocated in the space of the script.
+ *
+ * @param env The global state of the application.
+ * @param base The start of the file.
+ * @param header The validated header of the file.
+ * @param entry The validated script entry.
+ */
+static void tkbc_kiteb_add_script(Env *env, const char *base, Kiteb_Header *header, Kiteb_Script *entry) {
+    Space space = {0};
+    Script script = {0};
+    script.script_id = env->script_id_counter++ + 1;
+    script.name = base + header->strings_offset + entry->name_offset;
+
+    Id *ids = (Id *) (base + entry->ids_offset);
+    if (sizeof(Id) != sizeof(uint64_t) && entry->ids_count > 0) {
+        const uint64_t *file_ids = (const uint64_t *) (base + entry->ids_offset);
+        ids = space_malloc(&space, entry->ids_count * sizeof(*ids));
+        for (size_t i = 0; i < entry->ids_count; ++i) {
+            ids[i] = (Id) file_ids[i];
+        }
+    }
+    script.id_pool = (Kite_Ids){.elements = ids, .count = entry->ids_count, .capacity = entry->ids_count};
+
+    Frame *frames = NULL;
+    if (entry->frames_count > 0) {
+        frames = space_malloc(&space, entry->frames_count * sizeof(*frames));
+    }
+    if (entry->blocks_count > 0) {
+        script.elements = space_malloc(&space, entry->blocks_count * sizeof(*script.elements));
+        script.count = entry->blocks_count;
+        script.capacity = entry->blocks_count;
+    }
+
+    const Kiteb_Block *blocks = (const Kiteb_Block *) (base + entry->blocks_offset);
+    const Kiteb_Frame *kiteb_frames = (const Kiteb_Frame *) (base + entry->frames_offset);
+    const Kiteb_Keyframe *keyframes = (const Kiteb_Keyframe *) (base + entry->keyframes_offset);
+    for (size_t b = 0; b < entry->blocks_count; ++b) {
+        const Kiteb_Block *block = &blocks[b];
+        Frames *block_frames = &script.elements[b];
+        memset(block_frames, 0, sizeof(*block_frames));
+        block_frames->frames_index = block->frames_index;
+        block_frames->elements = frames ? &frames[block->first_frame] : NULL;
+        block_frames->count = block->frames_count;
+        block_frames->capacity = block->frames_count;
+
+        for (size_t j = 0; j < block->frames_count; ++j) {
+            const Kiteb_Frame *kiteb_frame = &kiteb_frames[block->first_frame + j];
+            Frame *frame = &block_frames->elements[j];
+            memset(frame, 0, sizeof(*frame));
+            frame->kind = kiteb_frame->kind;
+            frame->index = j;
+            frame->duration = kiteb_frame->duration;
+            frame->original_duration = kiteb_frame->duration;
+            memcpy(&frame->action, kiteb_frame->action, sizeof(frame->action));
+            if (kiteb_frame->ids_count > 0) {
+                frame->kite_id_array.elements = &ids[kiteb_frame->ids_index];
+                frame->kite_id_array.count = kiteb_frame->ids_count;
+                frame->kite_id_array.capacity = kiteb_frame->ids_count;
+            }
+        }
+
+        if (block->keyframes_count > 0) {
+            Kite_Positions *positions = &block_frames->kite_frame_positions;
+            positions->elements = space_malloc(&space, block->keyframes_count * sizeof(*positions->elements));
+            positions->count = block->keyframes_count;
+            positions->capacity = block->keyframes_count;
+            for (size_t j = 0; j < block->keyframes_count; ++j) {
+                const Kiteb_Keyframe *keyframe = &keyframes[block->first_keyframe + j];
+                positions->elements[j] = (Kite_Position){
+                    .kite_id = keyframe->kite_id,
+                    .position = {keyframe->x, keyframe->y},
+                    .angle = keyframe->angle,
+                };
+            }
+        }
+    }
+
+    script.space = space;
+    tkbc_add_owned_script(env, script);
+}
+
+/**
+ * @brief The function loads all scripts of a .kiteb file into the env. The file
+ * is memory mapped and stays loaded until the env is destroyed, because the
+ * scripts use the names and the id sets of the file in place. Missing kites
+ * are generated. The scripts get new script ids.
+ *
+ * @param env The global state of the application.
+ * @param filepath The path of the .kiteb file.
+ * @return True if the file was valid and all scripts are added, otherwise
+ * false and no script is added.
+ */
+bool tkbc_load_kiteb_file(Env *env, const char *filepath) {
+    Kiteb_Mapping mapping = {0};
+    if (!tkbc_kiteb_map_file(filepath, &mapping)) {
+        return false;
+    }
+
+    const char *base = mapping.data;
+    Kiteb_Header *header = mapping.data;
+    bool ok = tkbc_kiteb_is_valid(mapping.data, mapping.size);
+    ok = ok && header->kite_count <= CLIENT_BASE_ID;
+    if (!ok) {
+        tkbc_fprintf(stderr, "ERROR", "The file %s is not a valid .kiteb file.\n", filepath);
+        tkbc_kiteb_unmap_file(&mapping);
+        return false;
+    }
+
+    if (env->kite_array.count < header->kite_count) {
+        Kite_Ids kis = tkbc_kite_array_generate(env, header->kite_count - env->kite_array.count);
+        free(kis.elements);
+    }
+
+    Kiteb_Script *entries = (Kiteb_Script *) (base + header->scripts_offset);
+    for (size_t i = 0; i < header->scripts_count; ++i) {
+        tkbc_kiteb_add_script(env, base, header, &entries[i]);
+    }
+    tkbc_dap(&env->kiteb_files, mapping);
+    return true;
+}
+
+/**
+ * @brief The function releases all loaded .kiteb files. The scripts that are
+ * loaded from them have to be released before.
+ *
+ * @param env The global state of the application.
+ */
+void tkbc_unload_kiteb_files(Env *env) {
+    for (size_t i = 0; i < env->kiteb_files.count; ++i) {
+        tkbc_kiteb_unmap_file(&env->kiteb_files.elements[i]);
+    }
+    free(env->kiteb_files.elements);
+    env->kiteb_files.elements = NULL;
+    env->kiteb_files.count = 0;
+    env->kiteb_files.capacity = 0;
+}
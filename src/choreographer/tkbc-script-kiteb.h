@@ -0,0 +1,21 @@
+#ifndef TKBC_SCRIPT_KITEB_H_
+#define TKBC_SCRIPT_KITEB_H_
+
+#include "../global/tkbc-types.h"
+#include "../global/tkbc-utils.h"
+
+// ===========================================================================
+// ========================== Binary Script Format ===========================
+// ===========================================================================
+
+#define TKBC_KITEB_VERSION 1
+
+int tkbc_kiteb_write_scripts(Env *env, size_t first, Content *out);
+int tkbc_export_all_scripts_to_kiteb_file_from_mem(Env *env, const char *filepath);
+bool tkbc_kiteb_is_valid(const void *data, size_t size);
+size_t tkbc_kiteb_scripts_count(const void *data);
+void tkbc_kiteb_copy_script(const void *data, size_t index, Space *space, Script *script);
+bool tkbc_load_kiteb_file(Env *env, const char *filepath);
+void tkbc_unload_kiteb_files(Env *env);
+
+#endif  // TKBC_SCRIPT_KITEB_H_
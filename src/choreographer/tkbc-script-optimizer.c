@@ -0,0 +1,324 @@
+#include "tkbc-script-optimizer.h"
+#include "../global/tkbc-types.h"
+#include "../global/tkbc-utils.h"
+#include "tkbc-script-converter.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+// The pass only changes a script where the kites still reach the same poses at
+// the same times:
+// - A frame that does not change its kites is a WAIT, as long as the kites
+//   stay part of other frames and no tip rotation in the block depends on it.
+// - The WAITs of a block are combined into the longest one and a WAIT 0 next
+//   to other frames is removed.
+// - Blocks with just a WAIT 0 are removed and consecutive WAIT blocks are
+//   added up.
+// - Consecutive blocks that move or rotate the same kites in the same
+//   direction with the same speed are fused into one block, if the frames of
+//   each block end together.
+// Blocks with a QUIT are not changed, because the QUIT depends on the count of
+// the frames in its block. The first block holds the start poses and is kept.
+
+/**
+ * @brief The function checks if the frame is a move or rotation that does not
+ * change its kites.
+ *
+ * @param frame The frame that is checked.
+ * @return True if the frame just waits for its duration, otherwise false.
+ */
+static bool tkbc_frame_is_noop(Frame *frame) {
+    switch (frame->kind) {
+    case ACTION_KITE_MOVE_ADD:
+        return frame->action.as_move_add.position.x == 0 && frame->action.as_move_add.position.y == 0;
+    case ACTION_KITE_ROTATION_ADD: return frame->action.as_rotation_add.angle == 0;
+    case ACTION_KITE_TIP_ROTATION_ADD: return frame->action.as_tip_rotation_add.angle == 0;
+    default: return false;
+    }
+}
+
+/**
+ * @brief The function checks if the frame is a WAIT without kites.
+ *
+ * @param frame The frame that is checked.
+ * @return True if the frame is a plain WAIT, otherwise false.
+ */
+static bool tkbc_frame_is_wait(Frame *frame) {
+    return frame->kind == ACTION_KITE_WAIT && frame->kite_id_array.count == 0;
+}
+
+/**
+ * @brief The function checks if the block has a frame of the given kind.
+ *
+ * @param block The block that is searched.
+ * @param kind The kind of the frame.
+ * @return True if a frame of the kind is in the block, otherwise false.
+ */
+static bool tkbc_block_has_kind(Frames *block, Action_Kind kind) {
+    for (size_t i = 0; i < block->count; ++i) {
+        if (block->elements[i].kind == kind) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief The function simplifies the frames of a block. The no-op frames turn
+ * into WAITs and the WAITs are combined into the longest one at the place of
+ * the first WAIT.
+ *
+ * @param block The block that is simplified in place.
+ * @param changed_kites The kites that are changed by a frame of the script.
+ */
+static void tkbc_optimize_block(Frames *block, const Kite_Id_Set *changed_kites) {
+    if (tkbc_block_has_kind(block, ACTION_KITE_QUIT)) {
+        return;
+    }
+    // A move of a kite changes the pivot of its tip rotation in the same block.
+    bool has_tip_rotation = tkbc_block_has_kind(block, ACTION_KITE_TIP_ROTATION) ||
+                            tkbc_block_has_kind(block, ACTION_KITE_TIP_ROTATION_ADD);
+
+    size_t count = 0;
+    size_t wait_index = SIZE_MAX;
+    for (size_t i = 0; i < block->count; ++i) {
+        Frame frame = block->elements[i];
+        if (!has_tip_rotation && tkbc_frame_is_noop(&frame)) {
+            // The kites of a script are visible because of its frames.
+            bool is_visible = true;
+            for (size_t j = 0; j < frame.kite_id_array.count; ++j) {
+                is_visible = is_visible && tkbc_kite_id_set_contains(changed_kites, frame.kite_id_array.elements[j]);
+            }
+            if (is_visible) {
+                frame.kind = ACTION_KITE_WAIT;
+                frame.action = (Action){0};
+                frame.kite_id_array = (Kite_Ids){0};
+            }
+        }
+
+        if (tkbc_frame_is_wait(&frame) && wait_index != SIZE_MAX) {
+            Frame *wait = &block->elements[wait_index];
+            wait->duration = fmaxf(wait->duration, frame.duration);
+            wait->original_duration = wait->duration;
+            continue;
+        }
+        if (tkbc_frame_is_wait(&frame)) {
+            wait_index = count;
+        }
+        block->elements[count++] = frame;
+    }
+
+    if (wait_index != SIZE_MAX && count > 1 && block->elements[wait_index].duration <= 0) {
+        memmove(&block->elements[wait_index], &block->elements[wait_index + 1],
+                (count - wait_index - 1) * sizeof(*block->elements));
+        count--;
+    }
+    block->count = count;
+    for (size_t i = 0; i < block->count; ++i) {
+        block->elements[i].index = i;
+    }
+}
+
+/**
+ * @brief The function checks if two parts of a movement have the same speed.
+ *
+ * @param a The change of the first part.
+ * @param a_duration The duration of the first part.
+ * @param b The change of the second part.
+ * @param b_duration The duration of the second part.
+ * @return True if the rates are the same, otherwise false.
+ */
+static bool tkbc_same_rate(float a, float a_duration, float b, float b_duration) {
+    float a_rate = a / a_duration;
+    float b_rate = b / b_duration;
+    float scale = fmaxf(1.0f, fmaxf(fabsf(a_rate), fabsf(b_rate)));
+    return fabsf(a_rate - b_rate) <= TKBC_OPTIMIZE_RATE_EPSILON * scale;
+}
+
+/**
+ * @brief The function checks if the second frame continues the first one in
+ * the same way with the same speed, or if both are plain WAITs.
+ *
+ * @param a The frame of the previous block.
+ * @param b The frame of the next block.
+ * @return True if the frames can be fused, otherwise false.
+ */
+static bool tkbc_frames_can_fuse(Frame *a, Frame *b) {
+    if (a->kind != b->kind || a->kite_id_array.count != b->kite_id_array.count) {
+        return false;
+    }
+    if (a->kite_id_array.elements != b->kite_id_array.elements &&
+        memcmp(a->kite_id_array.elements, b->kite_id_array.elements,
+               a->kite_id_array.count * sizeof(*a->kite_id_array.elements)) != 0) {
+        return false;
+    }
+
+    switch (a->kind) {
+    case ACTION_KITE_WAIT: return tkbc_frame_is_wait(a);
+    case ACTION_KITE_MOVE_ADD: {
+        Vector2 pa = a->action.as_move_add.position;
+        Vector2 pb = b->action.as_move_add.position;
+        return tkbc_same_rate(pa.x, a->duration, pb.x, b->duration) &&
+               tkbc_same_rate(pa.y, a->duration, pb.y, b->duration);
+    }
+    case ACTION_KITE_ROTATION_ADD:
+        return tkbc_same_rate(a->action.as_rotation_add.angle, a->duration, b->action.as_rotation_add.angle,
+                              b->duration);
+    case ACTION_KITE_TIP_ROTATION_ADD:
+        return a->action.as_tip_rotation_add.tip == b->action.as_tip_rotation_add.tip &&
+               tkbc_same_rate(a->action.as_tip_rotation_add.angle, a->duration,
+                              b->action.as_tip_rotation_add.angle, b->duration);
+    default: return false;
+    }
+}
+
+/**
+ * @brief The function checks if every frame of the block has the same positive
+ * duration and no move changes the pivot of a tip rotation. Then the frames
+ * end together and can be continued frame by frame.
+ *
+ * @param block The block that is checked.
+ * @return True if the block can be part of a fusion, otherwise false.
+ */
+static bool tkbc_block_is_uniform(Frames *block) {
+    if (block->count == 0) {
+        return false;
+    }
+    bool has_tip_rotation = tkbc_block_has_kind(block, ACTION_KITE_TIP_ROTATION_ADD);
+    for (size_t i = 0; i < block->count; ++i) {
+        Frame *frame = &block->elements[i];
+        if (frame->duration != block->elements[0].duration) {
+            return false;
+        }
+        if (frame->kind != ACTION_KITE_WAIT && frame->duration <= 0) {
+            return false;
+        }
+        if (has_tip_rotation && frame->kind == ACTION_KITE_MOVE_ADD) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief The function fuses the next block into the previous one, if every
+ * frame of the next block continues the frame at the same place in the
+ * previous block and the frames of each block end together.
+ *
+ * @param prev The block that is extended.
+ * @param next The block that follows the previous one.
+ * @return True if the next block is part of the previous one now, otherwise
+ * false.
+ */
+static bool tkbc_fuse_blocks(Frames *prev, Frames *next) {
+    if (prev->count != next->count || !tkbc_block_is_uniform(prev) || !tkbc_block_is_uniform(next)) {
+        return false;
+    }
+    for (size_t i = 0; i < prev->count; ++i) {
+        if (!tkbc_frames_can_fuse(&prev->elements[i], &next->elements[i])) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < prev->count; ++i) {
+        Frame *a = &prev->elements[i];
+        Frame *b = &next->elements[i];
+        switch (a->kind) {
+        case ACTION_KITE_MOVE_ADD: {
+            a->action.as_move_add.position.x += b->action.as_move_add.position.x;
+            a->action.as_move_add.position.y += b->action.as_move_add.position.y;
+        } break;
+        case ACTION_KITE_ROTATION_ADD: a->action.as_rotation_add.angle += b->action.as_rotation_add.angle; break;
+        case ACTION_KITE_TIP_ROTATION_ADD:
+            a->action.as_tip_rotation_add.angle += b->action.as_tip_rotation_add.angle;
+            break;
+        default: break;
+        }
+        a->duration += b->duration;
+        a->original_duration = a->duration;
+    }
+    return true;
+}
+
+/**
+ * @brief The function counts the frames of all blocks of the script.
+ *
+ * @param script The script that is counted.
+ * @return The amount of frames.
+ */
+static size_t tkbc_script_frames_count(Script *script) {
+    size_t frames = 0;
+    for (size_t i = 0; i < script->count; ++i) {
+        frames += script->elements[i].count;
+    }
+    return frames;
+}
+
+/**
+ * @brief The function optimizes a finished script in place, before it is
+ * stored. The frames of the blocks are simplified, empty blocks are removed
+ * and consecutive parts of the same movement are fused, so the playback, the
+ * scrubbing and the transfer of the script handle fewer frames. The poses of
+ * the kites and the duration of the script stay the same.
+ *
+ * @param script The script that is optimized.
+ * @param optimization The counts before and after the pass are added to it.
+ */
+void tkbc_optimize_script(Script *script, Script_Optimization *optimization) {
+    optimization->scripts++;
+    optimization->blocks_before += script->count;
+    optimization->frames_before += tkbc_script_frames_count(script);
+
+    Kite_Id_Set changed_kites = {0};
+    for (size_t i = 0; i < script->count; ++i) {
+        for (size_t j = 0; j < script->elements[i].count; ++j) {
+            Frame *frame = &script->elements[i].elements[j];
+            if (tkbc_frame_is_noop(frame)) {
+                continue;
+            }
+            for (size_t k = 0; k < frame->kite_id_array.count; ++k) {
+                tkbc_kite_id_set_insert(&changed_kites, frame->kite_id_array.elements[k]);
+            }
+        }
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < script->count; ++i) {
+        Frames *block = &script->elements[i];
+        tkbc_optimize_block(block, &changed_kites);
+        if (i == 0) {
+            count++;
+            continue;
+        }
+        bool is_empty = block->count == 0 || (block->count == 1 && tkbc_frame_is_wait(&block->elements[0]) &&
+                                              block->elements[0].duration <= 0);
+        if (is_empty) {
+            continue;
+        }
+        if (count > 1 && tkbc_fuse_blocks(&script->elements[count - 1], block)) {
+            continue;
+        }
+        script->elements[count++] = *block;
+    }
+    script->count = count;
+    for (size_t i = 0; i < script->count; ++i) {
+        script->elements[i].frames_index = i;
+    }
+    tkbc_kite_id_set_destroy(&changed_kites);
+
+    optimization->blocks_after += script->count;
+    optimization->frames_after += tkbc_script_frames_count(script);
+}
+
+/**
+ * @brief The function prints the counts of the script optimization.
+ *
+ * @param stream The stream where the counts are printed to.
+ * @param optimization The counts of the optimized scripts.
+ */
+void tkbc_print_script_optimization(FILE *stream, Script_Optimization *optimization) {
+    tkbc_fprintf(stream, "INFO", "Optimized %zu scripts from %zu blocks with %zu frames to %zu blocks with %zu frames.\n",
+                 optimization->scripts, optimization->blocks_before, optimization->frames_before,
+                 optimization->blocks_after, optimization->frames_after);
+}
@@ -0,0 +1,18 @@
+#ifndef TKBC_SCRIPT_OPTIMIZER_H_
+#define TKBC_SCRIPT_OPTIMIZER_H_
+
+#include "../global/tkbc-types.h"
+#include <stdio.h>
+
+// ===========================================================================
+// ========================== Script Optimizer ===============================
+// ===========================================================================
+
+// The relative difference two speeds can have to count as the same, so the
+// rounding of the parsed numbers does not prevent the fusing of blocks.
+#define TKBC_OPTIMIZE_RATE_EPSILON 1e-5f
+
+void tkbc_optimize_script(Script *script, Script_Optimization *optimization);
+void tkbc_print_script_optimization(FILE *stream, Script_Optimization *optimization);
+
+#endif  // TKBC_SCRIPT_OPTIMIZER_H_
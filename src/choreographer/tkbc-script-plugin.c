@@ -0,0 +1,462 @@
+#include "tkbc-script-plugin.h"
+#include "../global/tkbc-types.h"
+#include "../global/tkbc-utils.h"
+#include "tkbc-script-handler.h"
+#include "tkbc.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <process.h>
+#define tkbc_getpid _getpid
+#else
+#include <dlfcn.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define tkbc_getpid getpid
+#endif
+
+// A plugin is a shared object that exports tkbc__script_input(). It is built
+// with the same headers and space configuration as the application, every
+// symbol it does not define itself is resolved against the executable, so the
+// application has to be linked with -rdynamic. -Bsymbolic keeps the calls
+// inside of the plugin to its own functions, otherwise the compiled in versions
+// of the scripts would shadow the reloaded ones.
+//
+// The build passes its own standard and raylib include path, the fallbacks
+// just follow the standard that this file was compiled with.
+#ifndef TKBC_PLUGIN_CC
+#define TKBC_PLUGIN_CC "gcc"
+#endif
+#ifndef TKBC_PLUGIN_STD
+#if __STDC_VERSION__ > 201710L
+#define TKBC_PLUGIN_STD "-std=gnu2x"
+#else
+#define TKBC_PLUGIN_STD "-std=gnu17"
+#endif
+#endif
+#ifndef TKBC_PLUGIN_RAYLIB_INCLUDE
+#define TKBC_PLUGIN_RAYLIB_INCLUDE "external/raylib-6.0_linux_amd64/include/"
+#endif
+
+typedef void (*Script_Input)(Env *env);
+
+#ifndef _WIN32
+/**
+ * @brief The function returns the repository root that the include paths of a
+ * plugin build are relative to. It is the configured TKBC_PLUGIN_ROOT or the
+ * parent of the directory of the executable, because every executable is
+ * built into build/.
+ *
+ * @return The root directory with a trailing slash.
+ */
+static const char *tkbc_plugin_root(void) {
+#ifdef TKBC_PLUGIN_ROOT
+    return TKBC_PLUGIN_ROOT;
+#else
+    return TextFormat("%s../", GetApplicationDirectory());
+#endif  // TKBC_PLUGIN_ROOT
+}
+
+/**
+ * @brief The function starts the compiler for the C source of a plugin. It
+ * returns immediately, the compiler process has to be waited for.
+ *
+ * @param source_path The C file that defines the tkbc_script_input.
+ * @param library_path The path of the shared object that is created.
+ * @param pid The process id of the compiler is written into it.
+ * @return True if the compiler was started, otherwise false.
+ */
+static bool tkbc_plugin_build_start(const char *source_path, const char *library_path, pid_t *pid) {
+    Space space = {0};
+    const char *root = space_strdup(&space, tkbc_plugin_root());
+    const char *cmd[] = {
+        TKBC_PLUGIN_CC,
+        "-shared",
+        "-fPIC",
+        TKBC_PLUGIN_STD,
+        "-O0",
+        "-g",
+        "-Wl,-Bsymbolic",
+        "-I",
+        space_printf(&space, "%ssrc/choreographer/", root),
+        "-I",
+        space_printf(&space, "%ssrc/global/", root),
+        "-I",
+        space_printf(&space, "%stkbc_scripts/", root),
+        "-I",
+        space_printf(&space, "%s%s", root, TKBC_PLUGIN_RAYLIB_INCLUDE),
+        "-DSPACEDECL=",
+        "-DSPACEDEF=inline",
+        "-DSPACE_ALLOC_METHOD=(SPACE_METHOD_MALLOC|SPACE_METHOD_MMAP)",
+        "-DSPACE_ALLOC_METHOD_DEFAULT=SPACE_METHOD_MMAP",
+        "-DSPACE_MEMORY_LAYOUT_METHOD_DEFAULT=SPACE_MEMORY_DYNAMIC_ARRAY",
+        "-o",
+        library_path,
+        source_path,
+        NULL,
+    };
+
+    *pid = fork();
+    if (*pid < 0) {
+        tkbc_fprintf(stderr, "ERROR", "The fork was not possible:%s\n", strerror(errno));
+        space_free_space(&space);
+        return false;
+    }
+    if (*pid == 0) {
+        execvp(cmd[0], (char *const *) cmd);
+        tkbc_fprintf(stderr, "ERROR", "The execvp has failed with:%s\n", strerror(errno));
+        _exit(EXIT_FAILURE);
+    }
+    space_free_space(&space);
+    return true;
+}
+
+/**
+ * @brief The function checks the exit status of a finished compiler process.
+ *
+ * @param source_path The C file that was compiled.
+ * @param status The status that is returned by the waitpid.
+ * @return True if the compilation was successful, otherwise false.
+ */
+static bool tkbc_plugin_build_status(const char *source_path, int status) {
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        tkbc_fprintf(stderr, "ERROR", "The plugin %s could not be compiled.\n", source_path);
+        return false;
+    }
+    return true;
+}
+#endif  // _WIN32
+
+/**
+ * @brief The function compiles the C source of a plugin into a shared object.
+ * The call blocks until the compiler has finished, the watch mode uses the non
+ * blocking build instead.
+ *
+ * @param source_path The C file that defines the tkbc_script_input.
+ * @param library_path The path of the shared object that is created.
+ * @return True if the compilation was successful, otherwise false.
+ */
+bool tkbc_plugin_build(const char *source_path, const char *library_path) {
+#ifdef _WIN32
+    (void) source_path;
+    (void) library_path;
+    tkbc_fprintf(stderr, "ERROR", "Script plugins are not supported on windows.\n");
+    return false;
+#else
+    pid_t pid = 0;
+    if (!tkbc_plugin_build_start(source_path, library_path, &pid)) {
+        return false;
+    }
+    int status = 0;
+    if (waitpid(pid, &status, 0) < 0) {
+        tkbc_fprintf(stderr, "ERROR", "Waiting for the compiler has failed:%s\n", strerror(errno));
+        return false;
+    }
+    return tkbc_plugin_build_status(source_path, status);
+#endif  // _WIN32
+}
+
+/**
+ * @brief The function removes the scripts and the kites that the last execution
+ * of the plugin has added. The kites are just removed if nothing else has added
+ * kites after the plugin.
+ *
+ * @param env The global state of the application.
+ */
+static void tkbc_plugin_remove_additions(Env *env) {
+    Script_Plugin *plugin = &env->plugin;
+
+    // The script ids are given out in order, so the plugin owns the range.
+    for (Id id = plugin->script_id_begin + 1; id <= plugin->script_id_end; ++id) {
+        tkbc_unload_script_from_memory(env, id);
+    }
+
+    if (env->kite_array.count == plugin->kites_end && env->kite_id_counter == plugin->kite_id_end) {
+        for (size_t i = plugin->kites_begin; i < plugin->kites_end; ++i) {
+            tkbc_destroy_kite(&env->kite_array.elements[i]);
+        }
+        env->kite_array.count = plugin->kites_begin;
+        env->kite_id_counter = plugin->kite_id_begin;
+    }
+
+    plugin->script_id_begin = plugin->script_id_end = 0;
+    plugin->kites_begin = plugin->kites_end = 0;
+    plugin->kite_id_begin = plugin->kite_id_end = 0;
+}
+
+/**
+ * @brief The function opens a shared object and executes its script input. The
+ * scripts and kites of the previously loaded version are replaced. If the new
+ * version can not be opened the old one stays loaded.
+ *
+ * @param env The global state of the application.
+ * @param library_path The path of the shared object.
+ * @param is_built If the shared object was built by the watch mode and should
+ * be removed when it is replaced.
+ * @return True if the plugin was executed, otherwise false.
+ */
+static bool tkbc_plugin_open(Env *env, const char *library_path, bool is_built) {
+#ifdef _WIN32
+    (void) env;
+    (void) library_path;
+    (void) is_built;
+    tkbc_fprintf(stderr, "ERROR", "Script plugins are not supported on windows.\n");
+    return false;
+#else
+    char *path = strdup(library_path);
+    if (path == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "The allocation has failed in: %s: %d: %s\n", __FILE__, __LINE__,
+                     strerror(errno));
+        return false;
+    }
+
+    void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (handle == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "The plugin %s could not be opened: %s\n", path, dlerror());
+        free(path);
+        return false;
+    }
+    Script_Input script_input;
+    *(void **) (&script_input) = dlsym(handle, TKBC_PLUGIN_ENTRY);
+    if (script_input == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "The plugin %s does not define %s().\n", path, TKBC_PLUGIN_ENTRY);
+        dlclose(handle);
+        free(path);
+        return false;
+    }
+
+    Script_Plugin *plugin = &env->plugin;
+    if (plugin->handle) {
+        tkbc_plugin_remove_additions(env);
+        dlclose(plugin->handle);
+        if (plugin->is_built) {
+            remove(plugin->library_path);
+        }
+    }
+    free(plugin->library_path);
+    plugin->library_path = path;
+    plugin->handle = handle;
+    plugin->is_built = is_built;
+
+    plugin->script_id_begin = env->script_id_counter;
+    plugin->kites_begin = env->kite_array.count;
+    plugin->kite_id_begin = env->kite_id_counter;
+    script_input(env);
+    env->scripts_parsed = true;
+    plugin->script_id_end = env->script_id_counter;
+    plugin->kites_end = env->kite_array.count;
+    plugin->kite_id_end = env->kite_id_counter;
+
+    tkbc_fprintf(stderr, "INFO", "The plugin %s has added %zu scripts.\n", path,
+                 plugin->script_id_end - plugin->script_id_begin);
+    return true;
+#endif  // _WIN32
+}
+
+/**
+ * @brief The function loads a prebuilt shared object as the script plugin. The
+ * watching of a plugin source is stopped.
+ *
+ * @param env The global state of the application.
+ * @param library_path The path of the shared object.
+ * @return True if the plugin was executed, otherwise false.
+ */
+bool tkbc_plugin_load(Env *env, const char *library_path) {
+    if (!tkbc_plugin_open(env, library_path, false)) {
+        return false;
+    }
+    free(env->plugin.source_path);
+    env->plugin.source_path = NULL;
+    return true;
+}
+
+/**
+ * @brief The function stops a running build of the plugin and removes its
+ * unfinished shared object.
+ *
+ * @param plugin The plugin state that holds the running build.
+ */
+static void tkbc_plugin_build_cancel(Script_Plugin *plugin) {
+#ifndef _WIN32
+    if (plugin->build_pid > 0) {
+        kill((pid_t) plugin->build_pid, SIGTERM);
+        waitpid((pid_t) plugin->build_pid, NULL, 0);
+    }
+#endif  // _WIN32
+    if (plugin->build_library_path) {
+        remove(plugin->build_library_path);
+    }
+    free(plugin->build_library_path);
+    plugin->build_library_path = NULL;
+    plugin->build_pid = 0;
+}
+
+/**
+ * @brief The function checks if the running build of the plugin has finished
+ * and loads the new shared object in that case.
+ *
+ * @param env The global state of the application.
+ * @param block If the call should wait for the compiler to finish.
+ * @return True if the build has finished and the plugin was executed, otherwise
+ * false.
+ */
+static bool tkbc_plugin_build_poll(Env *env, bool block) {
+    Script_Plugin *plugin = &env->plugin;
+    if (plugin->build_pid <= 0) {
+        return false;
+    }
+#ifdef _WIN32
+    (void) block;
+    return false;
+#else
+    int status = 0;
+    pid_t pid = waitpid((pid_t) plugin->build_pid, &status, block ? 0 : WNOHANG);
+    if (pid == 0) {
+        return false;
+    }
+    plugin->build_pid = 0;
+    if (pid < 0) {
+        tkbc_fprintf(stderr, "ERROR", "Waiting for the compiler has failed:%s\n", strerror(errno));
+    }
+
+    char *library = plugin->build_library_path;
+    plugin->build_library_path = NULL;
+    bool ok = pid > 0 && tkbc_plugin_build_status(plugin->source_path, status);
+    ok = ok && tkbc_plugin_open(env, library, true);
+    if (!ok) {
+        remove(library);
+    }
+    free(library);
+    return ok;
+#endif  // _WIN32
+}
+
+/**
+ * @brief The function starts the build of the given plugin source and watches
+ * the source for changes. The compiler runs in the background, the plugin is
+ * loaded by tkbc_plugin_watch() or tkbc_plugin_wait() once it has finished. The
+ * source stays watched even if the build fails, so fixing the error triggers
+ * the next build.
+ *
+ * @param env The global state of the application.
+ * @param source_path The C file that defines the tkbc_script_input.
+ * @return True if the build was started, otherwise false.
+ */
+bool tkbc_plugin_watch_source(Env *env, const char *source_path) {
+    Script_Plugin *plugin = &env->plugin;
+    int64_t mtime = 0;
+    if (!tkbc_get_file_mtime(source_path, &mtime)) {
+        return false;
+    }
+
+    // The source path can be the watched one, so it is copied before the old
+    // one is released.
+    char *source = strdup(source_path);
+    if (source == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "The allocation has failed in: %s: %d: %s\n", __FILE__, __LINE__,
+                     strerror(errno));
+        return false;
+    }
+    tkbc_plugin_build_cancel(plugin);
+    free(plugin->source_path);
+    plugin->source_path = source;
+    plugin->source_mtime = mtime;
+    plugin->last_check = tkbc_get_time();
+
+#ifdef _WIN32
+    tkbc_fprintf(stderr, "ERROR", "Script plugins are not supported on windows.\n");
+    return false;
+#else
+    // Every build gets a new name, because the loader would return the still
+    // opened old object for the same path.
+    Space path_space = {0};
+    const char *dir = space_printf(&path_space, "%splugins", env->tkbc_dir);
+    char *library = strdup(space_printf(&path_space, "%s/%s-%d-%zu.so", dir, GetFileNameWithoutExt(source),
+                                        (int) tkbc_getpid(), plugin->build_count++));
+    pid_t pid = 0;
+    bool ok = library != NULL;
+    ok = ok && tkbc_make_dir_recursive_if_not_existis(dir);
+    ok = ok && tkbc_plugin_build_start(source, library, &pid);
+    space_free_space(&path_space);
+    if (!ok) {
+        free(library);
+        return false;
+    }
+    plugin->build_pid = pid;
+    plugin->build_library_path = library;
+    return true;
+#endif  // _WIN32
+}
+
+/**
+ * @brief The function blocks until the running build of the plugin has
+ * finished and loads it. It is used where no frames have to be drawn meanwhile.
+ *
+ * @param env The global state of the application.
+ * @return True if the plugin was built and executed, otherwise false.
+ */
+bool tkbc_plugin_wait(Env *env) {
+    return tkbc_plugin_build_poll(env, true);
+}
+
+/**
+ * @brief The function loads a finished background build and checks the watched
+ * plugin source in a fixed interval. If the source has changed the next build
+ * is started.
+ *
+ * @param env The global state of the application.
+ */
+void tkbc_plugin_watch(Env *env) {
+    Script_Plugin *plugin = &env->plugin;
+    if (plugin->source_path == NULL) {
+        return;
+    }
+    if (plugin->build_pid > 0) {
+        // A change during the build is picked up after it, the mtime is
+        // compared against the one the build has started with.
+        tkbc_plugin_build_poll(env, false);
+        return;
+    }
+    double now = tkbc_get_time();
+    if (now - plugin->last_check < TKBC_PLUGIN_WATCH_INTERVAL) {
+        return;
+    }
+    plugin->last_check = now;
+
+    int64_t mtime = 0;
+    if (!tkbc_get_file_mtime(plugin->source_path, &mtime) || mtime == plugin->source_mtime) {
+        return;
+    }
+    tkbc_fprintf(stderr, "INFO", "The plugin source %s has changed.\n", plugin->source_path);
+    tkbc_plugin_watch_source(env, plugin->source_path);
+}
+
+/**
+ * @brief The function closes the plugin and stops the watching and a running
+ * build. The scripts that are added by the plugin stay loaded, they do not
+ * point into the plugin.
+ *
+ * @param env The global state of the application.
+ */
+void tkbc_plugin_unload(Env *env) {
+    Script_Plugin *plugin = &env->plugin;
+    tkbc_plugin_build_cancel(plugin);
+#ifndef _WIN32
+    if (plugin->handle) {
+        dlclose(plugin->handle);
+    }
+#endif  // _WIN32
+    if (plugin->is_built && plugin->library_path) {
+        remove(plugin->library_path);
+    }
+    free(plugin->library_path);
+    free(plugin->source_path);
+    memset(plugin, 0, sizeof(*plugin));
+}
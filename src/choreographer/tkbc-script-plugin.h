@@ -0,0 +1,20 @@
+#ifndef TKBC_SCRIPT_PLUGIN_H_
+#define TKBC_SCRIPT_PLUGIN_H_
+
+#include "../global/tkbc-types.h"
+
+// ===========================================================================
+// ========================== Script Plugins =================================
+// ===========================================================================
+
+#define TKBC_PLUGIN_ENTRY "tkbc__script_input"
+#define TKBC_PLUGIN_WATCH_INTERVAL 0.25
+
+bool tkbc_plugin_build(const char *source_path, const char *library_path);
+bool tkbc_plugin_load(Env *env, const char *library_path);
+bool tkbc_plugin_watch_source(Env *env, const char *source_path);
+bool tkbc_plugin_wait(Env *env);
+void tkbc_plugin_watch(Env *env);
+void tkbc_plugin_unload(Env *env);
+
+#endif  // TKBC_SCRIPT_PLUGIN_H_
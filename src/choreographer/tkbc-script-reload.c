@@ -0,0 +1,404 @@
+#include "tkbc-script-reload.h"
+#include "../global/tkbc-types.h"
+#include "../global/tkbc-utils.h"
+#include "tkbc-parser.h"
+#include "tkbc-script-handler.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif  // __linux__
+
+struct Kite_Load {
+    char *path;              // The .kite file that is loaded.
+    int64_t mtime;           // The modification time of the file when the load has started.
+    Kite_Stream stream;      // The chunked reader of the file.
+    Kite_Parser parser;      // The parser state between the sections.
+    Kite_Sections sections;  // The loaded sections that are handed to the watch.
+};
+
+// The directory of the file is watched instead of the file itself, because
+// most editors save by writing a new file and renaming it over the old one.
+// That replaces the inode and a watch on the file would be lost.
+
+/**
+ * @brief The function returns the file name part of the given path.
+ *
+ * @param path The path of the file.
+ * @return The start of the file name in the path.
+ */
+static const char *tkbc_kite_watch_base_name(const char *path) {
+    const char *base = strrchr(path, '/');
+#ifdef _WIN32
+    const char *win_base = strrchr(path, '\\');
+    if (win_base > base) {
+        base = win_base;
+    }
+#endif
+    return base ? base + 1 : path;
+}
+
+/**
+ * @brief The function closes the notification of the watched file and releases
+ * its state. The scripts that are parsed from the file stay loaded.
+ *
+ * @param env The global state of the application.
+ */
+void tkbc_kite_watch_destroy(Env *env) {
+    Kite_File_Watch *watch = &env->kite_watch;
+#ifdef __linux__
+    if (watch->fd >= 0) {
+        close(watch->fd);
+    }
+#endif  // __linux__
+    free(watch->path);
+    free(watch->sections.elements);
+    memset(watch, 0, sizeof(*watch));
+    watch->fd = -1;
+}
+
+/**
+ * @brief The function starts to watch the given file. On linux the directory of
+ * the file is watched with inotify, otherwise the modification time of the file
+ * is polled.
+ *
+ * @param env The global state of the application.
+ * @param path The .kite file that should be watched.
+ * @return True if the watch is started, otherwise false.
+ */
+static bool tkbc_kite_watch_start(Env *env, const char *path) {
+    tkbc_kite_watch_destroy(env);
+    Kite_File_Watch *watch = &env->kite_watch;
+    watch->path = strdup(path);
+    if (watch->path == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "The allocation has failed in: %s: %d: %s\n", __FILE__, __LINE__,
+                     strerror(errno));
+        return false;
+    }
+    tkbc_get_file_mtime(path, &watch->mtime);
+    watch->last_check = tkbc_get_time();
+
+#ifdef __linux__
+    watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->fd < 0) {
+        tkbc_fprintf(stderr, "WARNING", "The inotify is not available, %s is polled: %s\n", path, strerror(errno));
+        return true;
+    }
+
+    const char *base = tkbc_kite_watch_base_name(path);
+    char *dir = base == path ? strdup(".") : strndup(path, base - path);
+    if (dir == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "The allocation has failed in: %s: %d: %s\n", __FILE__, __LINE__,
+                     strerror(errno));
+        close(watch->fd);
+        watch->fd = -1;
+        return true;
+    }
+    watch->wd = inotify_add_watch(watch->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watch->wd < 0) {
+        tkbc_fprintf(stderr, "WARNING", "The directory %s can not be watched, %s is polled: %s\n", dir, path,
+                     strerror(errno));
+        close(watch->fd);
+        watch->fd = -1;
+    }
+    free(dir);
+#endif  // __linux__
+    return true;
+}
+
+/**
+ * @brief The function finds an old section with the same tokens that has not
+ * been taken by another section and whose script is still loaded. The section
+ * at the same place in the file is preferred.
+ *
+ * @param env The global state of the application.
+ * @param old The sections of the previous parse.
+ * @param used The old sections that are already taken.
+ * @param index The place of the new section in the file.
+ * @param hash The hash of the new section.
+ * @return The index of the old section or old->count if there is none.
+ */
+static size_t tkbc_find_unchanged_section(Env *env, Kite_Sections *old, bool *used, size_t index, uint64_t hash) {
+    if (index < old->count && !used[index] && old->elements[index].hash == hash &&
+        tkbc_scripts_contains_id(env->scripts, old->elements[index].script_id)) {
+        return index;
+    }
+    for (size_t j = 0; j < old->count; ++j) {
+        if (!used[j] && old->elements[j].hash == hash &&
+            tkbc_scripts_contains_id(env->scripts, old->elements[j].script_id)) {
+            return j;
+        }
+    }
+    return old->count;
+}
+
+/**
+ * @brief The function parses a .kite file incrementally. Just the BEGIN/END
+ * sections whose tokens have changed since the last parse are parsed again.
+ * A changed section replaces the script of the section at the same place in
+ * place, so the script id and the playback position are kept. Unchanged
+ * sections keep their scripts, new sections add scripts and the scripts of
+ * removed sections are unloaded. If the tokens outside of the sections change,
+ * every section is parsed again. A different file than the watched one is
+ * loaded completely with tkbc_kite_load_start() and watched from now on, the
+ * scripts of the previous file stay loaded.
+ *
+ * @param env The global state of the application.
+ * @param path The path of the .kite file.
+ * @return True if the file could be read, otherwise false.
+ */
+bool tkbc_reload_kite_file(Env *env, const char *path) {
+    // A load that is still running has to be done to know its sections.
+    while (tkbc_kite_load_poll(env, -1)) {
+    }
+
+    Kite_File_Watch *watch = &env->kite_watch;
+    if (watch->path == NULL || strcmp(watch->path, path) != 0) {
+        if (!tkbc_kite_load_start(env, path)) {
+            return false;
+        }
+        while (tkbc_kite_load_poll(env, -1)) {
+        }
+        return true;
+    }
+
+    Content content = {0};
+    if (tkbc_read_entire_file(path, &content) == -1) {
+        free(content.elements);
+        return false;
+    }
+
+    Kite_Sections sections = {0};
+    uint64_t prelude_hash = tkbc_scan_kite_sections(path, content.elements, content.count, &sections);
+    Kite_Sections *old = &watch->sections;
+    bool prelude_changed = prelude_hash != watch->prelude_hash;
+
+    bool *used = calloc(old->count + 1, sizeof(*used));
+    bool *selected = calloc(sections.count + 1, sizeof(*selected));
+    Id *replaced_ids = calloc(sections.count + 1, sizeof(*replaced_ids));
+    assert(used && selected && replaced_ids);
+
+    // The kites of the prelude can change every section, so in that case no
+    // script is kept.
+    size_t selected_count = 0;
+    for (size_t i = 0; i < sections.count; ++i) {
+        size_t j = old->count;
+        if (!prelude_changed) {
+            j = tkbc_find_unchanged_section(env, old, used, i, sections.elements[i].hash);
+        }
+        if (j < old->count) {
+            used[j] = true;
+            sections.elements[i].script_id = old->elements[j].script_id;
+        } else {
+            selected[i] = true;
+            selected_count++;
+        }
+    }
+    for (size_t i = 0; i < sections.count; ++i) {
+        if (selected[i] && i < old->count && !used[i] &&
+            tkbc_scripts_contains_id(env->scripts, old->elements[i].script_id)) {
+            used[i] = true;
+            replaced_ids[i] = old->elements[i].script_id;
+        }
+    }
+
+    if (selected_count > 0) {
+        Id first_new_id = env->script_id_counter + 1;
+        tkbc_script_parser_content(env, path, content.elements, content.count, selected, sections.count);
+        Id end_id = env->script_id_counter + 1;
+
+        // Every parsed section ends in exactly one new script in file order.
+        Id new_id = first_new_id;
+        for (size_t i = 0; i < sections.count && new_id < end_id; ++i) {
+            if (!selected[i]) {
+                continue;
+            }
+            sections.elements[i].script_id = new_id;
+            if (replaced_ids[i] && tkbc_replace_script(env, replaced_ids[i], new_id)) {
+                sections.elements[i].script_id = replaced_ids[i];
+            } else if (replaced_ids[i]) {
+                tkbc_unload_script_from_memory(env, replaced_ids[i]);
+            }
+            new_id++;
+        }
+    }
+
+    size_t removed = 0;
+    for (size_t j = 0; j < old->count; ++j) {
+        if (!used[j] && tkbc_unload_script_from_memory(env, old->elements[j].script_id)) {
+            removed++;
+        }
+    }
+
+    tkbc_fprintf(stderr, "INFO", "%s: %zu of %zu scripts parsed, %zu removed.\n", path, selected_count,
+                 sections.count, removed);
+
+    free(old->elements);
+    *old = sections;
+    watch->prelude_hash = prelude_hash;
+    free(replaced_ids);
+    free(selected);
+    free(used);
+    free(content.elements);
+    return true;
+}
+
+/**
+ * @brief The function stops a running load of a .kite file. The scripts that
+ * are already loaded stay loaded, the file is not watched.
+ *
+ * @param env The global state of the application.
+ */
+void tkbc_kite_load_destroy(Env *env) {
+    Kite_Load *load = env->kite_load;
+    if (load == NULL) {
+        return;
+    }
+    tkbc_kite_parser_finish(env, &load->parser);
+    tkbc_kite_stream_close(&load->stream);
+    free(load->sections.elements);
+    free(load->path);
+    free(load);
+    env->kite_load = NULL;
+}
+
+/**
+ * @brief The function starts to load a .kite file over several frames. The
+ * file is read in chunks by tkbc_kite_load_poll() and every BEGIN/END section
+ * is added as a script as soon as its END is read, so the first script can be
+ * played while the rest of the file is still loading. A load that is still
+ * running is completed first.
+ *
+ * @param env The global state of the application.
+ * @param path The path of the .kite file.
+ * @return True if the file could be opened, otherwise false.
+ */
+bool tkbc_kite_load_start(Env *env, const char *path) {
+    while (tkbc_kite_load_poll(env, -1)) {
+    }
+
+    Kite_Load *load = calloc(1, sizeof(*load));
+    char *load_path = strdup(path);
+    if (load == NULL || load_path == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "The allocation has failed in: %s: %d: %s\n", __FILE__, __LINE__,
+                     strerror(errno));
+        free(load_path);
+        free(load);
+        return false;
+    }
+    load->path = load_path;
+    // The stream keeps a view of the path, so it has to be owned by the load.
+    if (!tkbc_kite_stream_open(&load->stream, load->path, TKBC_KITE_STREAM_CHUNK)) {
+        free(load->path);
+        free(load);
+        return false;
+    }
+    tkbc_get_file_mtime(path, &load->mtime);
+    tkbc_kite_diagnostics_clear(&env->kite_diagnostics);
+    env->kite_load = load;
+    return true;
+}
+
+/**
+ * @brief The function continues the running load of a .kite file until the
+ * given time is used up. If the file is completely loaded it is watched for
+ * changes from now on.
+ *
+ * @param env The global state of the application.
+ * @param budget The seconds the load can take in this call or a negative value
+ * to load the rest of the file.
+ * @return True if the load is still running, otherwise false.
+ */
+bool tkbc_kite_load_poll(Env *env, double budget) {
+    Kite_Load *load = env->kite_load;
+    if (load == NULL) {
+        return false;
+    }
+
+    double start = tkbc_get_time();
+    char *piece = NULL;
+    size_t size = 0;
+    while (tkbc_kite_stream_next(&load->stream, &piece, &size)) {
+        Id id_before = env->script_id_counter;
+        tkbc_kite_parser_feed(env, &load->parser, load->path, piece, size, NULL, 0);
+        if (load->stream.section_ended) {
+            Id script_id = env->script_id_counter != id_before ? env->script_id_counter : 0;
+            tkbc_dap(&load->sections, ((Kite_Section){.hash = load->stream.section_hash, .script_id = script_id}));
+        }
+        if (budget >= 0 && tkbc_get_time() - start >= budget) {
+            return true;
+        }
+    }
+    tkbc_kite_parser_finish(env, &load->parser);
+
+    // The mtime of the start is kept, so a change during the load is reloaded.
+    if (tkbc_kite_watch_start(env, load->path)) {
+        Kite_File_Watch *watch = &env->kite_watch;
+        watch->mtime = load->mtime;
+        watch->prelude_hash = load->stream.prelude_hash;
+        watch->sections = load->sections;
+        load->sections = (Kite_Sections){0};
+    }
+    tkbc_fprintf(stderr, "INFO", "%s: %zu scripts loaded.\n", load->path, env->kite_watch.sections.count);
+    tkbc_kite_load_destroy(env);
+    return false;
+}
+
+/**
+ * @brief The function checks if the watched .kite file has changed and reloads
+ * it incrementally. It does not block.
+ *
+ * @param env The global state of the application.
+ */
+void tkbc_kite_watch_poll(Env *env) {
+    Kite_File_Watch *watch = &env->kite_watch;
+    if (watch->path == NULL) {
+        return;
+    }
+
+    bool changed = false;
+#ifdef __linux__
+    if (watch->fd >= 0) {
+        const char *base = tkbc_kite_watch_base_name(watch->path);
+        char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        for (;;) {
+            ssize_t n = read(watch->fd, buffer, sizeof(buffer));
+            if (n <= 0) {
+                break;
+            }
+            for (char *p = buffer; p < buffer + n;) {
+                struct inotify_event *event = (struct inotify_event *) p;
+                if (event->len > 0 && strcmp(event->name, base) == 0) {
+                    changed = true;
+                }
+                p += sizeof(*event) + event->len;
+            }
+        }
+        if (!changed) {
+            return;
+        }
+    }
+#endif  // __linux__
+
+    if (!changed) {
+        double now = tkbc_get_time();
+        if (now - watch->last_check < TKBC_KITE_WATCH_INTERVAL) {
+            return;
+        }
+        watch->last_check = now;
+    }
+
+    int64_t mtime = 0;
+    if (!tkbc_get_file_mtime(watch->path, &mtime) || (!changed && mtime == watch->mtime)) {
+        return;
+    }
+    watch->mtime = mtime;
+    tkbc_reload_kite_file(env, watch->path);
+}
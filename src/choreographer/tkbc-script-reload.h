@@ -0,0 +1,21 @@
+#ifndef TKBC_SCRIPT_RELOAD_H_
+#define TKBC_SCRIPT_RELOAD_H_
+
+#include "../global/tkbc-types.h"
+
+// ===========================================================================
+// ========================== Script Hot Reload ==============================
+// ===========================================================================
+
+#define TKBC_KITE_WATCH_INTERVAL 0.25
+// The seconds a .kite file is loaded per frame before the frame is drawn.
+#define TKBC_KITE_LOAD_BUDGET 0.004
+
+bool tkbc_reload_kite_file(Env *env, const char *path);
+bool tkbc_kite_load_start(Env *env, const char *path);
+bool tkbc_kite_load_poll(Env *env, double budget);
+void tkbc_kite_load_destroy(Env *env);
+void tkbc_kite_watch_poll(Env *env);
+void tkbc_kite_watch_destroy(Env *env);
+
+#endif  // TKBC_SCRIPT_RELOAD_H_
@@ -0,0 +1,399 @@
+#include "tkbc-script-store.h"
+#include "../global/tkbc-types.h"
+#include "../global/tkbc-utils.h"
+#include "tkbc-script-handler.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <process.h>
+#define tkbc_getpid _getpid
+#else
+#include <unistd.h>
+#define tkbc_getpid getpid
+#endif
+
+// The spill files are a private cache of the running process, they hold the raw
+// structs of this build and are not meant to be exchanged between machines.
+#define TKBC_SCRIPT_STORE_MAGIC "TKBCSPL1"
+#define TKBC_SCRIPT_STORE_NO_IDS UINT64_MAX
+
+/**
+ * @brief The function computes the path of the spill file of a script. The pid
+ * is part of the name, so a client and a server in the same directory do not
+ * share their files.
+ *
+ * @param space The space where the path is allocated in.
+ * @param env The global state of the application.
+ * @param script_id The id of the script.
+ * @return The path of the spill file.
+ */
+const char *tkbc_script_store_path(Space *space, Env *env, Id script_id) {
+#ifdef _WIN32
+    return space_printf(space, "%scache\\%d-%zu.tkbcs", env->tkbc_dir, (int)tkbc_getpid(), script_id);
+#else
+    return space_printf(space, "%scache/%d-%zu.tkbcs", env->tkbc_dir, (int)tkbc_getpid(), script_id);
+#endif
+}
+
+/**
+ * @brief The function writes the given amount of bytes to the file.
+ *
+ * @param file The file that is written to.
+ * @param data The start of the bytes.
+ * @param size The amount of bytes.
+ * @return True if every byte was written, otherwise false.
+ */
+static bool tkbc_script_store_fwrite(FILE *file, const void *data, size_t size) {
+    if (size == 0) {
+        return true;
+    }
+    return fwrite(data, 1, size, file) == size;
+}
+
+/**
+ * @brief The function reads the given amount of bytes from the file.
+ *
+ * @param file The file that is read from.
+ * @param data The destination of the bytes.
+ * @param size The amount of bytes.
+ * @return True if every byte was read, otherwise false.
+ */
+static bool tkbc_script_store_fread(FILE *file, void *data, size_t size) {
+    if (size == 0) {
+        return true;
+    }
+    return fread(data, 1, size, file) == size;
+}
+
+/**
+ * @brief The function writes the blocks of a stored script to a spill file.
+ * The kite id sets are written once as the id pool and every frame refers to
+ * its set by the offset into the pool.
+ *
+ * @param path The file path of the spill file.
+ * @param script The script that should be written, it has to be interned by
+ * tkbc_deep_copy_script().
+ * @return True if the file was written completely, otherwise false.
+ */
+bool tkbc_script_store_write(const char *path, Script *script) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "Could not open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    bool ok = true;
+    uint64_t header[3] = {script->script_id, script->count, script->id_pool.count};
+    ok = ok && tkbc_script_store_fwrite(file, TKBC_SCRIPT_STORE_MAGIC, 8);
+    ok = ok && tkbc_script_store_fwrite(file, header, sizeof(header));
+    ok = ok && tkbc_script_store_fwrite(file, script->id_pool.elements, script->id_pool.count * sizeof(Id));
+
+    for (size_t i = 0; ok && i < script->count; ++i) {
+        Frames *frames = &script->elements[i];
+        uint64_t block[3] = {frames->frames_index, frames->count, frames->kite_frame_positions.count};
+        ok = ok && tkbc_script_store_fwrite(file, block, sizeof(block));
+
+        for (size_t j = 0; ok && j < frames->count; ++j) {
+            Frame frame = frames->elements[j];
+            uint64_t offset = TKBC_SCRIPT_STORE_NO_IDS;
+            if (frame.kite_id_array.count > 0) {
+                if (!tkbc_script_id_pool_contains(script, &frame.kite_id_array)) {
+                    tkbc_fprintf(stderr, "ERROR", "The script %zu has ids outside of its id pool.\n",
+                                 script->script_id);
+                    ok = false;
+                    break;
+                }
+                offset = frame.kite_id_array.elements - script->id_pool.elements;
+            }
+            frame.kite_id_array.elements = NULL;
+            frame.kite_id_array.capacity = frame.kite_id_array.count;
+            ok = ok && tkbc_script_store_fwrite(file, &frame, sizeof(frame));
+            ok = ok && tkbc_script_store_fwrite(file, &offset, sizeof(offset));
+        }
+
+        ok = ok && tkbc_script_store_fwrite(file, frames->kite_frame_positions.elements,
+                                            frames->kite_frame_positions.count * sizeof(Kite_Position));
+    }
+
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        tkbc_fprintf(stderr, "ERROR", "Could not write the script %zu to %s.\n", script->script_id, path);
+        remove(path);
+    }
+    return ok;
+}
+
+/**
+ * @brief The function reads the blocks of a spill file into the given script.
+ * The name, the id and the other metadata of the script stay untouched. The
+ * function does not access the env, so it can be used in parallel.
+ *
+ * @param path The file path of the spill file.
+ * @param space The space where the blocks are allocated in.
+ * @param script The script that receives the blocks.
+ * @return True if the file could be read completely, otherwise false.
+ */
+bool tkbc_script_store_read(const char *path, Space *space, Script *script) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "Could not open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    bool ok = true;
+    char magic[8] = {0};
+    uint64_t header[3] = {0};
+    ok = ok && tkbc_script_store_fread(file, magic, sizeof(magic));
+    ok = ok && memcmp(magic, TKBC_SCRIPT_STORE_MAGIC, sizeof(magic)) == 0;
+    ok = ok && tkbc_script_store_fread(file, header, sizeof(header));
+    ok = ok && header[0] == script->script_id;
+    if (!ok) {
+        goto defer;
+    }
+
+    Kite_Ids pool = {0};
+    if (header[2] > 0) {
+        pool.elements = space_malloc(space, header[2] * sizeof(Id));
+        pool.count = header[2];
+        pool.capacity = header[2];
+        ok = ok && tkbc_script_store_fread(file, pool.elements, header[2] * sizeof(Id));
+    }
+
+    Frames *blocks = NULL;
+    if (header[1] > 0) {
+        blocks = space_malloc(space, header[1] * sizeof(*blocks));
+        memset(blocks, 0, header[1] * sizeof(*blocks));
+    }
+
+    for (size_t i = 0; ok && i < header[1]; ++i) {
+        uint64_t block[3] = {0};
+        ok = ok && tkbc_script_store_fread(file, block, sizeof(block));
+        if (!ok) {
+            break;
+        }
+
+        Frames *frames = &blocks[i];
+        frames->frames_index = block[0];
+        if (block[1] > 0) {
+            frames->elements = space_malloc(space, block[1] * sizeof(Frame));
+            frames->count = block[1];
+            frames->capacity = block[1];
+        }
+
+        for (size_t j = 0; ok && j < frames->count; ++j) {
+            Frame *frame = &frames->elements[j];
+            uint64_t offset = 0;
+            ok = ok && tkbc_script_store_fread(file, frame, sizeof(*frame));
+            ok = ok && tkbc_script_store_fread(file, &offset, sizeof(offset));
+            if (!ok) {
+                break;
+            }
+
+            if (offset == TKBC_SCRIPT_STORE_NO_IDS) {
+                frame->kite_id_array.elements = NULL;
+                frame->kite_id_array.count = 0;
+                frame->kite_id_array.capacity = 0;
+            } else if (offset + frame->kite_id_array.count <= pool.count) {
+                frame->kite_id_array.elements = pool.elements + offset;
+            } else {
+                ok = false;
+            }
+        }
+
+        if (ok && block[2] > 0) {
+            frames->kite_frame_positions.elements = space_malloc(space, block[2] * sizeof(Kite_Position));
+            frames->kite_frame_positions.count = block[2];
+            frames->kite_frame_positions.capacity = block[2];
+            ok = tkbc_script_store_fread(file, frames->kite_frame_positions.elements, block[2] * sizeof(Kite_Position));
+        }
+    }
+
+    if (ok) {
+        script->elements = blocks;
+        script->count = header[1];
+        script->capacity = header[1];
+        script->id_pool = pool;
+    }
+
+defer:
+    fclose(file);
+    if (!ok) {
+        tkbc_fprintf(stderr, "ERROR", "The spill file %s is corrupted.\n", path);
+    }
+    return ok;
+}
+
+/**
+ * @brief The function marks the script as the most recently used one.
+ *
+ * @param env The global state of the application.
+ * @param script The script that is used.
+ */
+void tkbc_script_store_touch(Env *env, Script *script) {
+    env->scripts_lru_clock += 1;
+    script->last_used = env->scripts_lru_clock;
+}
+
+/**
+ * @brief The function adds the current allocation size of a loaded script to
+ * the memory that is used by the scripts of the env.
+ *
+ * @param env The global state of the application.
+ * @param script The loaded script that should be accounted.
+ */
+void tkbc_script_store_account(Env *env, Script *script) {
+    assert(!script->is_evicted);
+    script->bytes = tkbc_calculate_script_byte_size_allocated(*script);
+    // The space is owned with its whole capacity, that includes the unused
+    // memory of a moved scratch space.
+    Space_Report report = {0};
+    if (space_report_allocations(&script->space, &report) && report.allocated_capacity > script->bytes) {
+        script->bytes = report.allocated_capacity;
+    }
+    env->scripts_memory_used += script->bytes;
+}
+
+/**
+ * @brief The function spills the blocks of the script to disk and frees its
+ * memory. The slot of the script stays in env->scripts, so the script id and
+ * the name are still valid and the script can be loaded again.
+ *
+ * @param env The global state of the application.
+ * @param script The loaded script that should be evicted.
+ * @return True if the script is evicted, otherwise false and the script stays
+ * in memory.
+ */
+bool tkbc_script_store_evict(Env *env, Script *script) {
+    if (script->is_evicted) {
+        return true;
+    }
+    assert(env->script != script);
+
+    // The temporary space is not used, because callers can hold paths in it.
+    Space path_space = {0};
+    const char *dir = space_printf(&path_space, "%scache", env->tkbc_dir);
+    bool ok = tkbc_make_dir_recursive_if_not_existis(dir);
+    if (ok) {
+        ok = tkbc_script_store_write(tkbc_script_store_path(&path_space, env, script->script_id), script);
+    }
+    space_free_space(&path_space);
+    if (!ok) {
+        return false;
+    }
+
+    // The name and the timeline are used by the UI while the script is evicted.
+    // They are copied once, later evictions find them in the evicted space.
+    if (space_find_planet_from_ptr(&script->space, (void *) script->name)) {
+        script->name = space_strdup(&script->evicted_space, script->name);
+    }
+    if (space_find_planet_from_ptr(&script->space, script->timeline.elements)) {
+        Script_Timeline timeline = {0};
+        space_dapc(&script->evicted_space, &timeline, script->timeline.elements, script->timeline.count);
+        script->timeline = timeline;
+    }
+    space_free_space(&script->space);
+    memset(&script->space, 0, sizeof(script->space));
+    script->elements = NULL;
+    script->count = 0;
+    script->capacity = 0;
+    memset(&script->id_pool, 0, sizeof(script->id_pool));
+
+    env->scripts_memory_used -= script->bytes;
+    script->bytes = 0;
+    script->is_evicted = true;
+    return true;
+}
+
+/**
+ * @brief The function loads the blocks of an evicted script back from disk.
+ * Other scripts can be evicted to stay in the memory budget of the env.
+ *
+ * @param env The global state of the application.
+ * @param script The script that should be in memory.
+ * @return True if the script is in memory, otherwise false.
+ */
+bool tkbc_script_store_ensure_loaded(Env *env, Script *script) {
+    tkbc_script_store_touch(env, script);
+    if (!script->is_evicted) {
+        return true;
+    }
+
+    Space path_space = {0};
+    const char *path = tkbc_script_store_path(&path_space, env, script->script_id);
+    bool ok = tkbc_script_store_read(path, &script->space, script);
+    if (ok) {
+        remove(path);
+    }
+    space_free_space(&path_space);
+    if (!ok) {
+        space_free_space(&script->space);
+        memset(&script->space, 0, sizeof(script->space));
+        return false;
+    }
+
+    script->is_evicted = false;
+    tkbc_script_store_account(env, script);
+    tkbc_script_store_enforce_budget(env, script->script_id);
+    return true;
+}
+
+/**
+ * @brief The function evicts the least recently used scripts until the loaded
+ * scripts fit into the memory budget of the env. The currently executed script
+ * is never evicted. A budget of 0 means that there is no limit.
+ *
+ * @param env The global state of the application.
+ * @param keep_script_id The id of a script that should stay in memory.
+ */
+void tkbc_script_store_enforce_budget(Env *env, Id keep_script_id) {
+    if (env->scripts_memory_budget == 0) {
+        return;
+    }
+
+    while (env->scripts_memory_used > env->scripts_memory_budget) {
+        Script *lru = NULL;
+        for (size_t i = 0; i < env->scripts.count; ++i) {
+            Script *script = &env->scripts.elements[i];
+            if (script->is_evicted || script == env->script || script->script_id == keep_script_id) {
+                continue;
+            }
+            if (lru == NULL || script->last_used < lru->last_used) {
+                lru = script;
+            }
+        }
+
+        if (lru == NULL || !tkbc_script_store_evict(env, lru)) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief The function frees the memory of the script and removes its spill
+ * file if it is evicted.
+ *
+ * @param env The global state of the application.
+ * @param script The script that should be released.
+ */
+void tkbc_script_store_release(Env *env, Script *script) {
+    if (script->is_evicted) {
+        Space path_space = {0};
+        remove(tkbc_script_store_path(&path_space, env, script->script_id));
+        space_free_space(&path_space);
+        script->is_evicted = false;
+    } else {
+        env->scripts_memory_used -= script->bytes;
+    }
+    script->bytes = 0;
+    space_free_space(&script->space);
+    memset(&script->space, 0, sizeof(script->space));
+    space_free_space(&script->evicted_space);
+    memset(&script->evicted_space, 0, sizeof(script->evicted_space));
+}
@@ -0,0 +1,21 @@
+#ifndef TKBC_SCRIPT_STORE_H_
+#define TKBC_SCRIPT_STORE_H_
+
+#include "../global/tkbc-types.h"
+
+// ===========================================================================
+// ========================== Script Store ===================================
+// ===========================================================================
+
+const char *tkbc_script_store_path(Space *space, Env *env, Id script_id);
+bool tkbc_script_store_write(const char *path, Script *script);
+bool tkbc_script_store_read(const char *path, Space *space, Script *script);
+
+void tkbc_script_store_touch(Env *env, Script *script);
+void tkbc_script_store_account(Env *env, Script *script);
+bool tkbc_script_store_evict(Env *env, Script *script);
+bool tkbc_script_store_ensure_loaded(Env *env, Script *script);
+void tkbc_script_store_enforce_budget(Env *env, Id keep_script_id);
+void tkbc_script_store_release(Env *env, Script *script);
+
+#endif  // TKBC_SCRIPT_STORE_H_
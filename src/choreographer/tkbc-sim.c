@@ -0,0 +1,220 @@
+#define SPACE_IMPLEMENTATION
+#include "../../external/space/space.h"
+#undef SPACE_IMPLEMENTATION
+
+#define TKBC_UTILS_IMPLEMENTATION
+#include "../global/tkbc-utils.h"
+#undef TKBC_UTILS_IMPLEMENTATION
+
+#include "tkbc-asset-handler.h"
+#include "tkbc-parser.h"
+#include "tkbc-script-baker.h"
+#include "tkbc-script-kiteb.h"
+#include "tkbc-script-optimizer.h"
+#include "tkbc-script-plugin.h"
+#include "tkbc.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The headless simulator bakes every script of the given files as fast as
+// possible and writes a JSON report. The exit code can be used to gate changes
+// to scripts: 0 if every script has passed, 1 if a script has skipped blocks
+// or has moved a kite out of the window area and 2 if the input could not be
+// loaded or a .kite file has errors.
+#define TKBC_SIM_EXIT_PASSED 0
+#define TKBC_SIM_EXIT_FAILED 1
+#define TKBC_SIM_EXIT_ERROR 2
+
+Assets assets = {0};
+Env *env = {0};
+
+/**
+ * @brief The function prints the usage of the simulator.
+ *
+ * @param stream The stream where the usage should be printed to.
+ * @param program_name The name of the executable.
+ */
+static void tkbc_sim_usage(FILE *stream, const char *program_name) {
+    fprintf(stream, "Usage:\n");
+    fprintf(stream, "       %s [options] <file.kite|file.kiteb|plugin.c|plugin.so>...\n", program_name);
+    fprintf(stream, "Options:\n");
+    fprintf(stream, "       -o <file>       The JSON report is written to the file instead of stdout.\n");
+    fprintf(stream, "       -j <workers>    The amount of parse and bake workers, 0 uses the processor count.\n");
+    fprintf(stream, "       -w <width>      The width of the window area, the default is 1920.\n");
+    fprintf(stream, "       -h <height>     The height of the window area, the default is 1080.\n");
+}
+
+/**
+ * @brief The function parses a positive number of a command line option.
+ *
+ * @param option The option the number belongs to.
+ * @param arg The argument that should hold the number.
+ * @param number The place where the number is stored.
+ * @return True if the argument is a valid number, otherwise false.
+ */
+static bool tkbc_sim_parse_number(const char *option, const char *arg, long *number) {
+    if (arg == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "The option %s needs a value.\n", option);
+        return false;
+    }
+    char *end = NULL;
+    errno = 0;
+    *number = strtol(arg, &end, 10);
+    if (errno != 0 || end == arg || *end != '\0' || *number < 0) {
+        tkbc_fprintf(stderr, "ERROR", "The value %s of the option %s is not a valid number.\n", arg, option);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief The function loads the scripts of the given file into the env in the
+ * same way as a drag and dropped file.
+ *
+ * @param env The global state of the application.
+ * @param path The .kite, .kiteb, plugin source or plugin object file.
+ * @param workers The amount of parse workers for a .kite file, 0 uses the
+ * processor count.
+ * @return True if the file could be loaded, otherwise false.
+ */
+static bool tkbc_sim_load_file(Env *env, const char *path, size_t workers) {
+    const char *extension = strrchr(path, '.');
+    if (extension == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "The file %s has no known extension.\n", path);
+        return false;
+    }
+
+    if (strcmp(extension, ".kite") == 0) {
+        if (!tkbc_script_parser_file(env, path, workers)) {
+            return false;
+        }
+        // A script with errors would be checked without its broken statements.
+        if (env->kite_diagnostics.count > 0) {
+            tkbc_fprintf(stderr, "ERROR", "The file %s has %zu errors.\n", path, env->kite_diagnostics.count);
+            return false;
+        }
+        return true;
+    }
+    if (strcmp(extension, ".kiteb") == 0) {
+        return tkbc_load_kiteb_file(env, path);
+    }
+    if (strcmp(extension, ".c") == 0) {
+        return tkbc_plugin_watch_source(env, path) && tkbc_plugin_wait(env);
+    }
+    if (strcmp(extension, ".so") == 0) {
+        return tkbc_plugin_load(env, path);
+    }
+
+    tkbc_fprintf(stderr, "ERROR", "The file %s has the unsupported extension %s.\n", path, extension);
+    return false;
+}
+
+/**
+ * @brief The entry point of the headless simulator.
+ *
+ * @return The exit code that indicates if every script has passed.
+ */
+int main(int argc, char *argv[]) {
+    char *program_name = tkbc_shift_args(&argc, &argv);
+    const char *output_path = NULL;
+    long workers = 0;
+    long width = 1920;
+    long height = 1080;
+
+    char **files = calloc(argc + 1, sizeof(*files));
+    if (files == NULL) {
+        tkbc_fprintf(stderr, "ERROR", "No more memory can be allocated.\n");
+        return TKBC_SIM_EXIT_ERROR;
+    }
+    size_t files_count = 0;
+    bool ok = true;
+    while (argc > 0 && ok) {
+        char *arg = tkbc_shift_args(&argc, &argv);
+        bool is_option = arg[0] == '-' && arg[1] != '\0' && arg[2] == '\0';
+        char *value = is_option && argc > 0 ? tkbc_shift_args(&argc, &argv) : NULL;
+        if (strcmp(arg, "-o") == 0) {
+            output_path = value;
+            ok = output_path != NULL;
+            if (!ok) {
+                tkbc_fprintf(stderr, "ERROR", "The option %s needs a value.\n", arg);
+            }
+        } else if (strcmp(arg, "-j") == 0) {
+            ok = tkbc_sim_parse_number(arg, value, &workers);
+        } else if (strcmp(arg, "-w") == 0) {
+            ok = tkbc_sim_parse_number(arg, value, &width);
+        } else if (strcmp(arg, "-h") == 0) {
+            ok = tkbc_sim_parse_number(arg, value, &height);
+        } else if (arg[0] == '-') {
+            tkbc_fprintf(stderr, "ERROR", "The option %s is unknown.\n", arg);
+            ok = false;
+        } else {
+            files[files_count++] = arg;
+        }
+    }
+    if (!ok || files_count == 0) {
+        tkbc_sim_usage(stderr, program_name);
+        free(files);
+        return TKBC_SIM_EXIT_ERROR;
+    }
+
+    append_assets();
+    env = tkbc_init_env();
+    if (!env) {
+        free(files);
+        return TKBC_SIM_EXIT_ERROR;
+    }
+    // The kites are generated relative to the window area, so it has to be
+    // known before the first file is loaded.
+    env->window_width = width;
+    env->window_height = height;
+
+    int exit_code = TKBC_SIM_EXIT_PASSED;
+    for (size_t i = 0; i < files_count; ++i) {
+        if (!tkbc_sim_load_file(env, files[i], workers)) {
+            tkbc_fprintf(stderr, "ERROR", "The file %s could not be loaded.\n", files[i]);
+            exit_code = TKBC_SIM_EXIT_ERROR;
+        }
+    }
+    env->scripts_parsed = true;
+    tkbc_print_script_optimization(stderr, &env->script_optimization);
+    if (exit_code == TKBC_SIM_EXIT_PASSED && env->scripts.count == 0) {
+        tkbc_fprintf(stderr, "ERROR", "No scripts were loaded.\n");
+        exit_code = TKBC_SIM_EXIT_ERROR;
+    }
+    if (exit_code != TKBC_SIM_EXIT_PASSED) {
+        goto defer;
+    }
+
+    double start = tkbc_get_time();
+    Bake_Reports reports = {0};
+    tkbc_bake_scripts(env, workers, &reports);
+    tkbc_fprintf(stderr, "INFO", "Simulated %zu scripts in %.3fs.\n", reports.count, tkbc_get_time() - start);
+
+    FILE *stream = stdout;
+    if (output_path) {
+        stream = fopen(output_path, "wb");
+        if (stream == NULL) {
+            tkbc_fprintf(stderr, "ERROR", "The report %s could not be opened: %s\n", output_path, strerror(errno));
+            tkbc_destroy_bake_reports(&reports);
+            exit_code = TKBC_SIM_EXIT_ERROR;
+            goto defer;
+        }
+    }
+    bool passed = tkbc_write_bake_reports_json(stream, env, &reports);
+    if (output_path) {
+        fclose(stream);
+    }
+    tkbc_destroy_bake_reports(&reports);
+    exit_code = passed ? TKBC_SIM_EXIT_PASSED : TKBC_SIM_EXIT_FAILED;
+
+defer:
+    tkbc_destroy_env(env);
+    tkbc_assets_destroy();
+    space_free_tspace();
+    free(files);
+    return exit_code;
+}
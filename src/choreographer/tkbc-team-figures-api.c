@@ -10,6 +10,56 @@
 #include "raymath.h"
 #include "tkbc-script-handler.h"
 
+/**
+ * @brief The function computes the arc that is equivalent to the old roll
+ * figures, that moved the kites one degree per block by the vector
+ * (sx * radius * cos(deg), sy * radius * sin(deg)). Those steps are the chords
+ * of a circle, so the arc goes through the same points and ends at the same
+ * position.
+ *
+ * @param radius The length of a single degree step.
+ * @param begin_angle The angle of the first step in degrees.
+ * @param end_angle The angle after the last step in degrees.
+ * @param sx The sign of the horizontal step component.
+ * @param sy The sign of the vertical step component.
+ * @param rotation The rotation of the kite per degree.
+ * @return The arc action that flies the complete roll.
+ */
+static Arc_Action tkbc_roll_arc(float radius, float begin_angle, float end_angle, float sx, float sy,
+                                float rotation) {
+    float span = end_angle - begin_angle;
+    float begin = (begin_angle - 0.5f) * PI / 180;
+    float arc_begin = atan2f(sy * cosf(begin), sx * sinf(begin)) * 180 / PI;
+
+    return (Arc_Action){
+        .radius = radius / (2 * sinf(PI / 360)),
+        .begin_angle = arc_begin,
+        .end_angle = arc_begin - sx * sy * span,
+        .rotation = rotation * span,
+    };
+}
+
+/**
+ * @brief The function registers a single block where every given kite flies
+ * the given arc.
+ *
+ * @param env The global state of the application.
+ * @param kite_index_array The kites represented by there kite_id.
+ * @param arc The arc the kites should fly.
+ * @param move_duration The time the complete arc should take in seconds.
+ * @return True if the internal frame actions could be created with no errors,
+ * otherwise false.
+ */
+static bool tkbc_script_team_roll(Env *env, Kite_Ids kite_index_array, Arc_Action arc, float move_duration) {
+    tkbc_reset_frames_internal_data(&env->scratch_buf_frames);
+    Frame *frame = KITE_ARC(kite_index_array, arc.radius, arc.begin_angle, arc.end_angle, arc.rotation,
+                            arc.easing, move_duration);
+    if (frame == NULL) return false;
+    space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
+    tkbc_register_frames_array(env, &env->scratch_buf_frames);
+    return true;
+}
+
 /**
  * @brief The function can be used to let the kites roll up but at a different
  * starting position.
@@ -47,48 +97,20 @@ bool tkbc_script_team_roll_two_diffrent_angle(Env *env, Kite_Ids kite_index_arra
     begin_angle_1 = fabsf(fmodf(begin_angle_1, 360));
     begin_angle_2 = fabsf(fmodf(begin_angle_2, 360));
 
-    const float duration_1 = move_duration_1 / first;
-    const float duration_2 = move_duration_2 / second;
-    Vector2 position;
-
     assert(first == second);
-    for (size_t deg = 0; deg < first; ++deg) {
-        tkbc_reset_frames_internal_data(&env->scratch_buf_frames);
-        position = (Vector2){
-            .x = radius * cosf(PI * (deg + begin_angle_1) / 180),
-            .y = -radius * sinf(PI * (deg + begin_angle_1) / 180),
-        };
-
-        {
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[0]), position.x, position.y, duration_1);
-            if (frame == NULL) return false;
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-        }
-        {
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[0]), 1, duration_1);
-            if (frame == NULL) return false;
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-        }
+    Arc_Action arc_1 = tkbc_roll_arc(radius, begin_angle_1, begin_angle_1 + first, 1, -1, 1);
+    Arc_Action arc_2 = tkbc_roll_arc(radius, begin_angle_2, begin_angle_2 + second, 1, -1, 1);
 
-        position = (Vector2){
-            .x = radius * cosf(PI * (deg + begin_angle_2) / 180),
-            .y = -radius * sinf(PI * (deg + begin_angle_2) / 180),
-        };
-
-        {
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[1]), position.x, position.y, duration_2);
-            if (frame == NULL) return false;
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-        }
-        {
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[1]), 1, duration_2);
-            if (frame == NULL) return false;
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-        }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+    if (!tkbc_block_begin(env, 2)) return false;
+    {
+        frame = BLOCK_KITE_ARC(kite_index_array.elements[0], arc_1, move_duration_1);
+        if (frame == NULL) return false;
     }
-
-    return true;
+    {
+        frame = BLOCK_KITE_ARC(kite_index_array.elements[1], arc_2, move_duration_2);
+        if (frame == NULL) return false;
+    }
+    return tkbc_block_end(env);
 }
 
 /**
@@ -113,45 +135,18 @@ bool tkbc_script_team_roll_two_diffrent_angle(Env *env, Kite_Ids kite_index_arra
 bool tkbc_script_team_roll_split_up(Env *env, Kite_Ids kite_index_array, ODD_EVEN odd_even, float radius,
                                     size_t begin_angle, size_t end_angle, float move_duration) {
     Frame *frame = NULL;
-    float duration = move_duration / (end_angle - begin_angle);
-    for (size_t deg = begin_angle; deg < end_angle; ++deg) {
-        tkbc_reset_frames_internal_data(&env->scratch_buf_frames);
-        for (size_t i = 0; i < kite_index_array.count; ++i) {
-            if (i % 2 == odd_even) {
-                Vector2 position = (Vector2){
-                    .x = radius * cosf(PI * deg / 180),
-                    .y = -radius * sinf(PI * deg / 180),
-                };
-                {
-                    frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i]), position.x, position.y, duration);
-                    if (frame == NULL) return false;
-                    space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-                }
-                {
-                    frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i]), 1, duration);
-                    if (frame == NULL) return false;
-                    space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-                }
-            } else {
-                Vector2 position = (Vector2){
-                    .x = -radius * cosf(PI * deg / 180),
-                    .y = -radius * sinf(PI * deg / 180),
-                };
-                {
-                    frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i]), position.x, position.y, duration);
-                    if (frame == NULL) return false;
-                    space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-                }
-                {
-                    frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i]), -1, duration);
-                    if (frame == NULL) return false;
-                    space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-                }
-            }
-        }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+    Arc_Action arcs[2] = {
+        [0] = tkbc_roll_arc(radius, begin_angle, end_angle, 1, -1, 1),
+        [1] = tkbc_roll_arc(radius, begin_angle, end_angle, -1, -1, -1),
+    };
+
+    if (!tkbc_block_begin(env, kite_index_array.count)) return false;
+    for (size_t i = 0; i < kite_index_array.count; ++i) {
+        Arc_Action *arc = &arcs[i % 2 == odd_even ? 0 : 1];
+        frame = BLOCK_KITE_ARC(kite_index_array.elements[i], *arc, move_duration);
+        if (frame == NULL) return false;
     }
-    return true;
+    return tkbc_block_end(env);
 }
 
 /**
@@ -176,31 +171,18 @@ bool tkbc_script_team_roll_split_up(Env *env, Kite_Ids kite_index_array, ODD_EVE
 bool tkbc_script_team_roll_split_down(Env *env, Kite_Ids kite_index_array, ODD_EVEN odd_even, float radius,
                                       size_t begin_angle, size_t end_angle, float move_duration) {
     Frame *frame = NULL;
-    float duration = move_duration / (end_angle - begin_angle);
-    int sign;
-
-    for (size_t deg = begin_angle; deg < end_angle; ++deg) {
-        tkbc_reset_frames_internal_data(&env->scratch_buf_frames);
-        for (size_t i = 0; i < kite_index_array.count; ++i) {
-            sign = i % 2 == odd_even ? -1 : 1;
-            Vector2 position = (Vector2){
-                .x = -sign * radius * cosf(PI * deg / 180),
-                .y = radius * sinf(PI * deg / 180),
-            };
-            {
-                frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i]), position.x, position.y, duration);
-                if (frame == NULL) return false;
-                space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-            }
-            {
-                frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i]), sign, duration);
-                if (frame == NULL) return false;
-                space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-            }
-        }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+    Arc_Action arcs[2] = {
+        [0] = tkbc_roll_arc(radius, begin_angle, end_angle, 1, 1, -1),
+        [1] = tkbc_roll_arc(radius, begin_angle, end_angle, -1, 1, 1),
+    };
+
+    if (!tkbc_block_begin(env, kite_index_array.count)) return false;
+    for (size_t i = 0; i < kite_index_array.count; ++i) {
+        Arc_Action *arc = &arcs[i % 2 == odd_even ? 0 : 1];
+        frame = BLOCK_KITE_ARC(kite_index_array.elements[i], *arc, move_duration);
+        if (frame == NULL) return false;
     }
-    return true;
+    return tkbc_block_end(env);
 }
 
 /**
@@ -221,29 +203,8 @@ bool tkbc_script_team_roll_split_down(Env *env, Kite_Ids kite_index_array, ODD_E
  */
 bool tkbc_script_team_roll_up_anti_clockwise(Env *env, Kite_Ids kite_index_array, float radius, size_t begin_angle,
                                              size_t end_angle, float move_duration) {
-    Frame *frame = NULL;
-    float duration = move_duration / (end_angle - begin_angle);
-    for (size_t deg = begin_angle; deg < end_angle; ++deg) {
-        tkbc_reset_frames_internal_data(&env->scratch_buf_frames);
-        Vector2 position = (Vector2){
-            .x = radius * cosf(PI * deg / 180),
-            .y = -radius * sinf(PI * deg / 180),
-        };
-        for (size_t i = 0; i < kite_index_array.count; ++i) {
-            {
-                frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i]), position.x, position.y, duration);
-                if (frame == NULL) return false;
-                space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-            }
-            {
-                frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i]), 1, duration);
-                if (frame == NULL) return false;
-                space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-            }
-        }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
-    }
-    return true;
+    return tkbc_script_team_roll(env, kite_index_array, tkbc_roll_arc(radius, begin_angle, end_angle, 1, -1, 1),
+                                 move_duration);
 }
 
 /**
@@ -264,29 +225,8 @@ bool tkbc_script_team_roll_up_anti_clockwise(Env *env, Kite_Ids kite_index_array
  */
 bool tkbc_script_team_roll_up_clockwise(Env *env, Kite_Ids kite_index_array, float radius, size_t begin_angle,
                                         size_t end_angle, float move_duration) {
-    Frame *frame = NULL;
-    float duration = move_duration / (end_angle - begin_angle);
-    for (size_t deg = begin_angle; deg < end_angle; ++deg) {
-        tkbc_reset_frames_internal_data(&env->scratch_buf_frames);
-        Vector2 position = (Vector2){
-            .x = -radius * cosf(PI * deg / 180),
-            .y = -radius * sinf(PI * deg / 180),
-        };
-        for (size_t i = 0; i < kite_index_array.count; ++i) {
-            {
-                frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i]), position.x, position.y, duration);
-                if (frame == NULL) return false;
-                space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-            }
-            {
-                frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i]), -1, duration);
-                if (frame == NULL) return false;
-                space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-            }
-        }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
-    }
-    return true;
+    return tkbc_script_team_roll(env, kite_index_array, tkbc_roll_arc(radius, begin_angle, end_angle, -1, -1, -1),
+                                 move_duration);
 }
 
 /**
@@ -307,29 +247,8 @@ bool tkbc_script_team_roll_up_clockwise(Env *env, Kite_Ids kite_index_array, flo
  */
 bool tkbc_script_team_roll_down_anti_clockwise(Env *env, Kite_Ids kite_index_array, float radius, size_t begin_angle,
                                                size_t end_angle, float move_duration) {
-    Frame *frame = NULL;
-    float duration = move_duration / (end_angle - begin_angle);
-    for (size_t deg = begin_angle; deg < end_angle; ++deg) {
-        tkbc_reset_frames_internal_data(&env->scratch_buf_frames);
-        Vector2 position = (Vector2){
-            .x = -radius * cosf(PI * deg / 180),
-            .y = radius * sinf(PI * deg / 180),
-        };
-        for (size_t i = 0; i < kite_index_array.count; ++i) {
-            {
-                frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i]), position.x, position.y, duration);
-                if (frame == NULL) return false;
-                space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-            }
-            {
-                frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i]), 1, duration);
-                if (frame == NULL) return false;
-                space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-            }
-        }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
-    }
-    return true;
+    return tkbc_script_team_roll(env, kite_index_array, tkbc_roll_arc(radius, begin_angle, end_angle, -1, 1, 1),
+                                 move_duration);
 }
 
 /**
@@ -350,29 +269,8 @@ bool tkbc_script_team_roll_down_anti_clockwise(Env *env, Kite_Ids kite_index_arr
  */
 bool tkbc_script_team_roll_down_clockwise(Env *env, Kite_Ids kite_index_array, float radius, size_t begin_angle,
                                           size_t end_angle, float move_duration) {
-    Frame *frame = NULL;
-    float duration = move_duration / (end_angle - begin_angle);
-    for (size_t deg = begin_angle; deg < end_angle; ++deg) {
-        tkbc_reset_frames_internal_data(&env->scratch_buf_frames);
-        Vector2 position = (Vector2){
-            .x = radius * cosf(PI * deg / 180),
-            .y = radius * sinf(PI * deg / 180),
-        };
-        for (size_t i = 0; i < kite_index_array.count; ++i) {
-            {
-                frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i]), position.x, position.y, duration);
-                if (frame == NULL) return false;
-                space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-            }
-            {
-                frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i]), -1, duration);
-                if (frame == NULL) return false;
-                space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
-            }
-        }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
-    }
-    return true;
+    return tkbc_script_team_roll(env, kite_index_array, tkbc_roll_arc(radius, begin_angle, end_angle, 1, 1, -1),
+                                 move_duration);
 }
 
 /**
@@ -404,7 +302,7 @@ bool tkbc_script_team_ball(Env *env, Kite_Ids kite_index_array, Vector2 position
     float deg_base_rotation = segments / 2.0 * segment_size;
     Frame *frame = NULL;
 
-    tkbc_reset_frames_internal_data(&env->scratch_buf_frames);
+    if (!tkbc_block_begin(env, 2 * kite_index_array.count)) return false;
     for (size_t i = 0; i < kite_index_array.count; ++i) {
 
         place.x += radius * cosf(PI * deg_base_rotation / 180);
@@ -413,19 +311,16 @@ bool tkbc_script_team_ball(Env *env, Kite_Ids kite_index_array, Vector2 position
         float deg_angle = (180 - (180 - (deg_base_rotation + 90))) + deg_base_rotation;
         deg_base_rotation += segment_size;
         {
-            frame = KITE_MOVE(ID(kite_index_array.elements[i]), place.x, place.y, move_duration);
+            frame = BLOCK_KITE_MOVE(kite_index_array.elements[i], place.x, place.y, move_duration);
             if (frame == NULL) return false;
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
         {
-            frame = KITE_ROTATION(ID(kite_index_array.elements[i]), deg_angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION(kite_index_array.elements[i], deg_angle, rotation_duration);
             if (frame == NULL) return false;
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
     }
 
-    tkbc_register_frames_array(env, &env->scratch_buf_frames);
-    return true;
+    return tkbc_block_end(env);
 }
 
 /**
@@ -465,22 +360,20 @@ bool tkbc_script_team_mountain(Env *env, Kite_Ids kite_index_array, Vector2 posi
     anchor = Vector2Add(anchor, offset);
     Frame *frame = NULL;
 
-    tkbc_reset_frames_internal_data(&env->scratch_buf_frames);
+    if (!tkbc_block_begin(env, 2 * kite_index_array.count)) return false;
     size_t row = rows;
     for (size_t i = 0, column = 0; column < columns; ++i, ++column) {
         if (kite_index_array.count <= i) {
             break;
         }
         {
-            frame = KITE_MOVE(ID(kite_index_array.elements[i]), anchor.x + x_space * column, anchor.y + y_space * row,
-                              move_duration);
+            frame = BLOCK_KITE_MOVE(kite_index_array.elements[i], anchor.x + x_space * column, anchor.y + y_space * row,
+                                    move_duration);
             if (frame == NULL) return false;
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
         {
-            frame = KITE_ROTATION(ID(kite_index_array.elements[i]), 0, rotation_duration);
+            frame = BLOCK_KITE_ROTATION(kite_index_array.elements[i], 0, rotation_duration);
             if (frame == NULL) return false;
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
 
         if (column + 1 == columns / 2.0) {
@@ -492,8 +385,7 @@ bool tkbc_script_team_mountain(Env *env, Kite_Ids kite_index_array, Vector2 posi
         }
     }
 
-    tkbc_register_frames_array(env, &env->scratch_buf_frames);
-    return true;
+    return tkbc_block_end(env);
 }
 
 /**
@@ -533,24 +425,20 @@ bool tkbc_script_team_valley(Env *env, Kite_Ids kite_index_array, Vector2 positi
     anchor = Vector2Add(anchor, offset);
     Frame *frame = NULL;
 
-    tkbc_reset_frames_internal_data(&env->scratch_buf_frames);
+    if (!tkbc_block_begin(env, 2 * kite_index_array.count)) return false;
     size_t row = 1;
     for (size_t i = 0, column = 0; column < columns; ++i, ++column) {
         if (kite_index_array.count <= i) {
             break;
         }
         {
-            frame = KITE_MOVE(ID(kite_index_array.elements[i]), anchor.x + x_space * column, anchor.y + y_space * row,
-                              move_duration);
+            frame = BLOCK_KITE_MOVE(kite_index_array.elements[i], anchor.x + x_space * column, anchor.y + y_space * row,
+                                    move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
         {
-            frame = KITE_ROTATION(ID(kite_index_array.elements[i]), 0, rotation_duration);
+            frame = BLOCK_KITE_ROTATION(kite_index_array.elements[i], 0, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
 
         if (column + 1 == columns / 2.0) {
@@ -562,8 +450,7 @@ bool tkbc_script_team_valley(Env *env, Kite_Ids kite_index_array, Vector2 positi
         }
     }
 
-    tkbc_register_frames_array(env, &env->scratch_buf_frames);
-    return true;
+    return tkbc_block_end(env);
 }
 
 /**
@@ -609,27 +496,23 @@ bool tkbc_script_team_arc(Env *env, Kite_Ids kite_index_array, Vector2 position,
     anchor = Vector2Add(anchor, offset);
     Frame *frame = NULL;
 
-    tkbc_reset_frames_internal_data(&env->scratch_buf_frames);
+    if (!tkbc_block_begin(env, 2 * kite_index_array.count)) return false;
     size_t row = rows;
     for (size_t i = 0, column = 0; column < columns; ++i, ++column) {
         if (kite_index_array.count <= i) {
             break;
         }
         {
-            frame = KITE_MOVE(ID(kite_index_array.elements[i]), anchor.x + x_space * column, anchor.y + y_space * row,
-                              move_duration);
+            frame = BLOCK_KITE_MOVE(kite_index_array.elements[i], anchor.x + x_space * column, anchor.y + y_space * row,
+                                    move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
         if (column + 1 == (columns + 1) / 2) {
             angle = 0;
         }
         {
-            frame = KITE_ROTATION(ID(kite_index_array.elements[i]), angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION(kite_index_array.elements[i], angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
 
         if (column + 1 == columns / 2.0) {
@@ -644,8 +527,7 @@ bool tkbc_script_team_arc(Env *env, Kite_Ids kite_index_array, Vector2 position,
         }
     }
 
-    tkbc_register_frames_array(env, &env->scratch_buf_frames);
-    return true;
+    return tkbc_block_end(env);
 }
 
 /**
@@ -692,27 +574,23 @@ bool tkbc_script_team_mouth(Env *env, Kite_Ids kite_index_array, Vector2 positio
     anchor = Vector2Add(anchor, offset);
     Frame *frame = NULL;
 
-    tkbc_reset_frames_internal_data(&env->scratch_buf_frames);
+    if (!tkbc_block_begin(env, 2 * kite_index_array.count)) return false;
     size_t row = 1;
     for (size_t i = 0, column = 0; column < columns; ++i, ++column) {
         if (kite_index_array.count <= i) {
             break;
         }
         {
-            frame = KITE_MOVE(ID(kite_index_array.elements[i]), anchor.x + x_space * column, anchor.y + y_space * row,
-                              move_duration);
+            frame = BLOCK_KITE_MOVE(kite_index_array.elements[i], anchor.x + x_space * column, anchor.y + y_space * row,
+                                    move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
         if (column + 1 == (columns + 1) / 2) {
             angle = 0;
         }
         {
-            frame = KITE_ROTATION(ID(kite_index_array.elements[i]), angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION(kite_index_array.elements[i], angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
 
         if (column + 1 == columns / 2.0) {
@@ -727,8 +605,7 @@ bool tkbc_script_team_mouth(Env *env, Kite_Ids kite_index_array, Vector2 positio
         }
     }
 
-    tkbc_register_frames_array(env, &env->scratch_buf_frames);
-    return true;
+    return tkbc_block_end(env);
 }
 
 /**
@@ -785,23 +662,20 @@ bool tkbc_script_team_grid(Env *env, Kite_Ids kite_index_array, Vector2 position
     anchor = Vector2Add(anchor, offset);
     Frame *frame = NULL;
 
-    tkbc_reset_frames_internal_data(&env->scratch_buf_frames);
+    if (!tkbc_block_begin(env, kite_index_array.count)) return false;
     size_t i = 0;
     for (size_t column = 0; column < columns; ++column) {
         for (size_t row = rows; row > 0; --row) {
             if (kite_index_array.count <= i) {
                 break;
             }
-            frame = KITE_MOVE(ID(kite_index_array.elements[i++]), anchor.x + x_space * column, anchor.y + y_space * row,
-                              move_duration);
+            frame = BLOCK_KITE_MOVE(kite_index_array.elements[i++], anchor.x + x_space * column,
+                                    anchor.y + y_space * row, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
     }
 
-    tkbc_register_frames_array(env, &env->scratch_buf_frames);
-    return true;
+    return tkbc_block_end(env);
 }
 
 /**
@@ -899,265 +773,218 @@ void tkbc_script_team_box_right(Env *env, Kite_Ids kite_index_array, float box_s
  */
 bool tkbc_script_team_split_box_up(Env *env, Kite_Ids kite_index_array, ODD_EVEN odd_even, float box_size,
                                    float move_duration, float rotation_duration) {
-    tkbc_reset_frames_internal_data(&env->scratch_buf_frames);
     Frame *frame = NULL;
 
     float angle = 90;
     switch (odd_even) {
     case ODD: {
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], angle, rotation_duration);
             if (frame == NULL) return false;
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
 
             if (i < 0) {
                 break;
             }
 
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), -angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], -angle, rotation_duration);
             if (frame == NULL) return false;
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
 
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), 0, -box_size, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], 0, -box_size, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
             if (i < 0) {
                 break;
             }
 
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), 0, box_size, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], 0, box_size, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
 
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
             if (i < 0) {
                 break;
             }
 
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), -angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], -angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
 
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), -box_size, 0, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], -box_size, 0, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
             if (i < 0) {
                 break;
             }
 
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), -box_size, 0, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], -box_size, 0, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
 
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
             if (i < 0) {
                 break;
             }
 
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), -angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], -angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
 
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), 0, box_size, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], 0, box_size, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
             if (i < 0) {
                 break;
             }
 
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), 0, -box_size, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], 0, -box_size, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
 
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
             if (i < 0) {
                 break;
             }
 
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), -angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], -angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
 
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), box_size, 0, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], box_size, 0, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
             if (i < 0) {
                 break;
             }
 
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), box_size, 0, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], box_size, 0, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
     } break;
     case EVEN: {
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), -angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], -angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
             if (i < 0) {
                 break;
             }
 
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
 
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), 0, box_size, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], 0, box_size, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
             if (i < 0) {
                 break;
             }
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), 0, -box_size, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], 0, -box_size, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
 
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), -angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], -angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
             if (i < 0) {
                 break;
             }
 
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
 
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), -box_size, 0, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], -box_size, 0, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
             if (i < 0) {
                 break;
             }
 
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), -box_size, 0, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], -box_size, 0, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
 
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), -angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], -angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
             if (i < 0) {
                 break;
             }
 
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
 
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), 0, -box_size, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], 0, -box_size, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
             if (i < 0) {
                 break;
             }
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), 0, box_size, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], 0, box_size, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
 
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), -angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], -angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
             if (i < 0) {
                 break;
             }
 
-            frame = KITE_ROTATION_ADD(ID(kite_index_array.elements[i--]), angle, rotation_duration);
+            frame = BLOCK_KITE_ROTATION_ADD(kite_index_array.elements[i--], angle, rotation_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
 
+        if (!tkbc_block_begin(env, kite_index_array.count)) return false;
         for (int i = kite_index_array.count - 1; i >= 0;) {
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), box_size, 0, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], box_size, 0, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
             if (i < 0) {
                 break;
             }
 
-            frame = KITE_MOVE_ADD(ID(kite_index_array.elements[i--]), box_size, 0, move_duration);
+            frame = BLOCK_KITE_MOVE_ADD(kite_index_array.elements[i--], box_size, 0, move_duration);
             if (frame == NULL) return false;
-
-            space_dap(&env->scratch_buf_script.space, &env->scratch_buf_frames, *frame);
         }
-        tkbc_register_frames_array(env, &env->scratch_buf_frames);
+        tkbc_block_end(env);
     } break;
     default: assert(0 && "UNREACHABLE");
     }
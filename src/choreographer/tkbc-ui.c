@@ -46,9 +46,12 @@ void tkbc_draw_ui(Env *env) {
             //
             // Marvin Frohwitter 10.08.2025
 
-            tkbc_ui_timeline(env, env->server_script_frames_index, env->server_script_frames_count);
+            // The client has sent the script to the server, so the timeline is
+            // known if the script was not started by another client.
+            tkbc_ui_timeline(env, tkbc_get_script_by_id(env, env->server_script_id), env->server_script_frames_index,
+                             env->server_script_frames_count);
         } else {
-            tkbc_ui_timeline(env, env->frames->frames_index, env->script->count);
+            tkbc_ui_timeline(env, env->script, env->frames->frames_index, env->script->count);
         }
     }
 
@@ -1460,14 +1463,17 @@ void tkbc_set_texture_for_selected_kites(Env *env, Kite_Texture *kite_texture, s
 
 /**
  * @brief The function provides the timeline UI slider to change the current
- * displayed frame of a script.
+ * displayed frame of a script. The segments of the frames are as wide as their
+ * part of the script duration and the time into the script and the remaining
+ * time are displayed, if the timeline of the script is known.
  *
  *
  * @param env The global state of the application.
+ * @param script The script that is displayed or NULL if it is not known.
  * @param frames_index The current frames frames_index.
  * @param frames_index_count The maximum frames that registered.
  */
-void tkbc_ui_timeline(Env *env, size_t frames_index, size_t frames_index_count) {
+void tkbc_ui_timeline(Env *env, Script *script, size_t frames_index, size_t frames_index_count) {
     if (env->script_setup) {
         return;
     }
@@ -1513,7 +1519,8 @@ void tkbc_ui_timeline(Env *env, size_t frames_index, size_t frames_index_count)
 
     env->timeline_segment_width = env->timeline_base.width / (float) frames_index_count;
 
-    env->timeline_segments_width = env->timeline_segment_width * env->timeline_segments;
+    env->timeline_segments_width =
+        env->timeline_base.width * tkbc_script_timeline_block_end(script, frames_index, frames_index_count);
 
     if ((mouse_pos.x >= env->timeline_base.x + env->timeline_base.width) ||
         (env->timeline_segments >= frames_index_count)) {
@@ -1537,6 +1544,31 @@ void tkbc_ui_timeline(Env *env, size_t frames_index, size_t frames_index_count)
         } else {
             DrawRectangleRec(env->timeline_front, TKBC_UI_TEAL);
         }
+
+        if (script && script->timeline.count == frames_index_count + 1) {
+            // The frame under the mouse is outlined.
+            float part = (mouse_pos.x - env->timeline_base.x) / env->timeline_base.width;
+            size_t block = tkbc_script_timeline_block_at_part(script, part, frames_index_count);
+            float start = block ? tkbc_script_timeline_block_end(script, block - 1, frames_index_count) : 0;
+            float end = tkbc_script_timeline_block_end(script, block, frames_index_count);
+            Rectangle segment = env->timeline_base;
+            segment.x += start * env->timeline_base.width;
+            segment.width = (end - start) * env->timeline_base.width;
+            DrawRectangleLinesEx(segment, 2, TKBC_UI_BLACK);
+
+            float duration = tkbc_script_timeline_duration(script);
+            float elapsed = script->timeline.elements[frames_index];
+            if (script == env->script) {
+                elapsed = tkbc_script_elapsed_time(env);
+            }
+            char buf[64] = {0};
+            snprintf(buf, sizeof(buf), "%.1f s / %.1f s, %.1f s left", elapsed, duration, duration - elapsed);
+            Vector2 p = {
+                .x = env->timeline_base.x,
+                .y = env->timeline_base.y - 24,
+            };
+            DrawTextEx(env->font, buf, p, 20, 2, TKBC_UI_TEAL);
+        }
     }
 }
 
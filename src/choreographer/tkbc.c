@@ -9,12 +9,23 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TKBC_X86_SIMD
+#endif
+
 #include "../global/tkbc-types.h"
 #include "../global/tkbc-utils.h"
 #include "tkbc-asset-handler.h"
+#include "tkbc-collision.h"
 #include "tkbc-keymaps.h"
 #include "tkbc-parser.h"
+#include "tkbc-script-baker.h"
 #include "tkbc-script-handler.h"
+#include "tkbc-script-kiteb.h"
+#include "tkbc-script-plugin.h"
+#include "tkbc-script-reload.h"
+#include "tkbc-script-store.h"
 #include "tkbc.h"
 
 extern Assets assets;
@@ -51,6 +62,7 @@ Env *tkbc_init_env(void) {
     env->window_height = tkbc_get_screen_height();
     env->script_finished = true;
     env->fps = TARGET_FPS;
+    env->kite_watch.fd = -1;
 
 #define TKBC_DIR "tkbc"
 #define KEYMAPS_FILE ".tkbc-keymaps"
@@ -100,6 +112,9 @@ Env *tkbc_init_env(void) {
 
     // space_init_capacity(&env->id_space, SCIRPT_CREATION_INIT_SIZE);
     space_init_capacity(&env->scratch_buf_script.space, SCIRPT_CREATION_INIT_SIZE * 30);
+
+#define SCRIPTS_MEMORY_BUDGET (256 * 1024 * 1024)
+    env->scripts_memory_budget = SCRIPTS_MEMORY_BUDGET;
     return env;
 }
 
@@ -159,10 +174,21 @@ void tkbc_destroy_env(Env *env) {
     free(env->vanilla_kite);
     env->vanilla_kite = NULL;
     tkbc_destroy_kite_array(&env->kite_array);
+    tkbc_kite_diagnostics_destroy(&env->kite_diagnostics);
 
     if (env->needs_font_free) {
         UnloadFont(env->font);
     }
+    for (size_t i = 0; i < env->scripts.count; ++i) {
+        tkbc_script_store_release(env, &env->scripts.elements[i]);
+    }
+    tkbc_unload_kiteb_files(env);
+    tkbc_plugin_unload(env);
+    tkbc_kite_load_destroy(env);
+    tkbc_kite_watch_destroy(env);
+    tkbc_collision_grid_destroy(&env->collision_grid);
+    free(env->collision_proximities.elements);
+    free(env->kite_id_map.slots);
     space_free_space(&env->_id_space);
     space_free_space(&env->scratch_buf_script.space);
     space_free_space(&env->_scripts_space);
@@ -257,7 +283,22 @@ void tkbc_kite_array_start_position(Kite_States *kite_states, size_t window_widt
 }
 
 /**
- * @brief The function handles the drag and dropped files.
+ * @brief The function validates every parsed script of the show in parallel
+ * and prints the results. The call blocks until every script is baked, so it
+ * is only done on request and not after every load.
+ *
+ * @param env The global state of the application.
+ */
+static void tkbc_validate_scripts(Env *env) {
+    Bake_Reports reports = {0};
+    tkbc_bake_scripts(env, 0, &reports);
+    tkbc_print_bake_reports(stderr, &reports);
+    tkbc_destroy_bake_reports(&reports);
+}
+
+/**
+ * @brief The function handles the drag and dropped files and reloads the
+ * watched script plugin and .kite file if they have changed.
  *
  * @param env The global state of the application.
  */
@@ -278,7 +319,7 @@ void tkbc_file_handler(Env *env) {
                 continue;
             }
 
-            if (strcmp(extension, ".kite") == 0) {
+            if (strcmp(extension, ".kite") == 0 || strcmp(extension, ".kiteb") == 0) {
                 if (env->script_file_name != NULL) {
                     free(env->script_file_name);
                     env->script_file_name = NULL;
@@ -288,7 +329,21 @@ void tkbc_file_handler(Env *env) {
                     tkbc_fprintf(stderr, "ERROR", "The allocation has failed in: %s: %d: %s\n", __FILE__, __LINE__,
                                  strerror(errno));
                 }
-                tkbc_script_parser(env);
+                if (strcmp(extension, ".kiteb") == 0) {
+                    tkbc_load_kiteb_file(env, file_path);
+                } else if (env->kite_watch.path && strcmp(env->kite_watch.path, file_path) == 0) {
+                    // Dropping the watched file again just parses the changed scripts.
+                    tkbc_reload_kite_file(env, file_path);
+                } else {
+                    // A new file is loaded over the next frames, so the first
+                    // scripts can be played while the rest is still parsed.
+                    tkbc_kite_load_start(env, file_path);
+                }
+            } else if (strcmp(extension, ".so") == 0) {
+                tkbc_plugin_load(env, file_path);
+            } else if (strcmp(extension, ".c") == 0) {
+                // The C script is rebuilt and reloaded every time it is saved.
+                tkbc_plugin_watch_source(env, file_path);
             } else {
                 if (IsSoundValid(env->sound)) {
                     StopSound(env->sound);
@@ -313,6 +368,18 @@ void tkbc_file_handler(Env *env) {
 
         UnloadDroppedFiles(file_path_list);
     }
+
+    tkbc_plugin_watch(env);
+    if (env->kite_load) {
+        tkbc_kite_load_poll(env, TKBC_KITE_LOAD_BUDGET);
+    } else {
+        tkbc_kite_watch_poll(env);
+    }
+
+    // KEY_I
+    if (!env->kite_load && tkbc_check_keymaps_full(env->keymaps, KMH_VALIDATE_SCRIPTS, KEY_MAP_CHECK_KEY_PRESSED)) {
+        tkbc_validate_scripts(env);
+    }
 }
 
 /**
@@ -488,59 +555,90 @@ void tkbc_kite_update_angle(Kite *kite, float center_deg_rotation) {
 }
 
 /**
- * @brief The function computes all the internal points for the kite and its
- * new position as well as the angle. This can be used in terms of positioning
- * the kite and rotating it or just for updating the (internal) geometric
- * values that are responsible for the kite shape.
+ * @brief The function sets the position and the angle of the kite without
+ * computing the geometric shape. The shape is just marked as stale and is
+ * computed by tkbc_kite_materialize_geometry() when it is actually needed, for
+ * example when the kite is drawn. This is the cheap variant for the simulation.
  *
  * @param kite The kite that is going to be modified.
  * @param position The new position for the kite at the center of the leading
- * edge or NULL for internal center position of the kite structure.
- * @param center_deg_rotation The rotation of the kite that is set to the
- * given rotation.
+ * edge or NULL to keep the current position.
+ * @param center_deg_rotation The new rotation of the kite in degrees.
  */
-void tkbc_center_rotation(Kite *kite, Vector2 *position, float center_deg_rotation) {
-    Vector2 pos = {0};
+void tkbc_kite_set_pose(Kite *kite, Vector2 *position, float center_deg_rotation) {
     if (position != NULL) {
-        pos.x = position->x;
-        pos.y = position->y;
-    } else {
-        pos.x = kite->center.x;
-        pos.y = kite->center.y;
+        kite->center = *position;
     }
+    kite->angle = center_deg_rotation;
+    kite->is_geometry_dirty = true;
+}
+
+/**
+ * @brief The function computes the geometric shape of the kite if the pose has
+ * changed since the last computation. It has to be called before the
+ * triangles or the leading edge of a kite are read.
+ *
+ * @param kite The kite that should have a valid geometric shape.
+ */
+void tkbc_kite_materialize_geometry(Kite *kite) {
+    if (kite->is_geometry_dirty) {
+        tkbc_center_rotation(kite, NULL, kite->angle);
+    }
+}
+
+// The difference between the angle 0 and the default downward interpolation
+// of the bottom tips is 42 degrees. That gives the constant offsets 312 degrees
+// for the left and 408 degrees for the right tip. Their sine and cosine are
+// precomputed, so the rotated tips follow from the angle sum identities with
+// the single sine and cosine of the kite angle.
+#define TKBC_COS_BL 0.66913060635885824f   // cos(312)
+#define TKBC_SIN_BL -0.74314482547739424f  // sin(312)
+#define TKBC_COS_BR 0.66913060635885824f   // cos(408)
+#define TKBC_SIN_BR 0.74314482547739424f   // sin(408)
 
+/**
+ * @brief The function computes all the internal points of the kite for the
+ * given position and the already computed sine and cosine of the angle.
+ *
+ * @param kite The kite that is going to be modified.
+ * @param pos The new position for the kite at the center of the leading edge.
+ * @param center_deg_rotation The rotation of the kite in degrees.
+ * @param cosphi The cosine of the rotation.
+ * @param sinphi The sine of the rotation.
+ */
+static inline void tkbc__kite_geometry(Kite *kite, Vector2 pos, float center_deg_rotation, float cosphi,
+                                       float sinphi) {
     kite->center.x = pos.x;
     kite->center.y = pos.y;
 
     kite->angle = center_deg_rotation;
+    kite->is_geometry_dirty = false;
     float cw = kite->width / 2.0f;
     float is = kite->inner_space;
     float o = kite->overlap;
     float_t length = cw + kite->spread;
     length = floorf(length);
 
-    // The difference between the angle 0 and the default downward interpolation
-    float angle = 42;
-    float bl_angle = (PI * (360 - (90 - angle)) / 180);
-    float br_angle = (PI * (360 + (90 - angle)) / 180);
-    float phi = (PI * (kite->angle) / 180);
-
-    float cosphi = cosf(phi);
-    float sinphi = sinf(phi);
+    // cos(phi - b) = cos(phi)cos(b) + sin(phi)sin(b)
+    // sin(phi - b) = sin(phi)cos(b) - cos(phi)sin(b)
+    float cos_phi_bl = cosphi * TKBC_COS_BL + sinphi * TKBC_SIN_BL;
+    float sin_phi_bl = sinphi * TKBC_COS_BL - cosphi * TKBC_SIN_BL;
+    float cos_phi_br = cosphi * TKBC_COS_BR + sinphi * TKBC_SIN_BR;
+    float sin_phi_br = sinphi * TKBC_COS_BR - cosphi * TKBC_SIN_BR;
 
     // LEFT Triangle
     kite->left.v1.x = pos.x - cw * cosphi;
     kite->left.v1.y = pos.y + cw * sinphi;
-    kite->left.v2.x = pos.x - is * cosf((phi - bl_angle));
-    kite->left.v2.y = pos.y + is * sinf((phi - bl_angle));
+    kite->left.v2.x = pos.x - is * cos_phi_bl;
+    kite->left.v2.y = pos.y + is * sin_phi_bl;
     kite->left.v3.x = pos.x + o * cosphi;
     kite->left.v3.y = pos.y - o * sinphi;
 
     // RIGHT Triangle
     kite->right.v1.x = pos.x - o * cosphi;
     kite->right.v1.y = pos.y + o * sinphi;
-    kite->right.v2.x = pos.x + is * cosf((phi - br_angle));
-    kite->right.v2.y = pos.y - is * sinf((phi - br_angle));
+    kite->right.v2.x = pos.x + is * cos_phi_br;
+    kite->right.v2.y = pos.y - is * sin_phi_br;
     kite->right.v3.x = pos.x + cw * cosphi;
     kite->right.v3.y = pos.y - cw * sinphi;
 
@@ -553,6 +651,191 @@ void tkbc_center_rotation(Kite *kite, Vector2 *position, float center_deg_rotati
     kite->rec.y = pos.y + length * sinphi;
 }
 
+/**
+ * @brief The function computes all the internal points for the kite and its
+ * new position as well as the angle. This can be used in terms of positioning
+ * the kite and rotating it or just for updating the (internal) geometric
+ * values that are responsible for the kite shape.
+ *
+ * @param kite The kite that is going to be modified.
+ * @param position The new position for the kite at the center of the leading
+ * edge or NULL for internal center position of the kite structure.
+ * @param center_deg_rotation The rotation of the kite that is set to the
+ * given rotation.
+ */
+void tkbc_center_rotation(Kite *kite, Vector2 *position, float center_deg_rotation) {
+    Vector2 pos = {0};
+    if (position != NULL) {
+        pos.x = position->x;
+        pos.y = position->y;
+    } else {
+        pos.x = kite->center.x;
+        pos.y = kite->center.y;
+    }
+
+    float phi = (PI * center_deg_rotation / 180);
+    tkbc__kite_geometry(kite, pos, center_deg_rotation, cosf(phi), sinf(phi));
+}
+
+// The minimax coefficients for sine and cosine on [-PI/4, PI/4].
+#define TKBC_SIN_C1 -1.6666654611e-1f
+#define TKBC_SIN_C2 8.3321608736e-3f
+#define TKBC_SIN_C3 -1.9515295891e-4f
+#define TKBC_COS_C1 4.166664568298827e-2f
+#define TKBC_COS_C2 -1.388731625493765e-3f
+#define TKBC_COS_C3 2.443315711809948e-5f
+// PI/2 split into three parts for an exact range reduction.
+#define TKBC_PIO2_1 1.5703125f
+#define TKBC_PIO2_2 4.837512969970703125e-4f
+#define TKBC_PIO2_3 7.54978995489188216e-8f
+
+#ifdef TKBC_X86_SIMD
+/**
+ * @brief The function computes the cosine and sine of 4 angles in degrees at
+ * once with SSE2.
+ *
+ * @param deg The angles in degrees.
+ * @param c The location where the cosine values are stored.
+ * @param s The location where the sine values are stored.
+ */
+static inline void tkbc__sincos_deg_sse2(const float *deg, float *c, float *s) {
+    __m128 d = _mm_loadu_ps(deg);
+    // Reduce to [-180, 180] in degrees first, so large accumulated angles keep
+    // their precision.
+    __m128 turns = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(d, _mm_set1_ps(1.0f / 360.0f))));
+    d = _mm_sub_ps(d, _mm_mul_ps(turns, _mm_set1_ps(360.0f)));
+    __m128 x = _mm_mul_ps(d, _mm_set1_ps(PI / 180.0f));
+
+    __m128i q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(2.0f / PI)));
+    __m128 qf = _mm_cvtepi32_ps(q);
+    x = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(TKBC_PIO2_1)));
+    x = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(TKBC_PIO2_2)));
+    x = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(TKBC_PIO2_3)));
+
+    __m128 z = _mm_mul_ps(x, x);
+    __m128 sp = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(TKBC_SIN_C3), z), _mm_set1_ps(TKBC_SIN_C2));
+    sp = _mm_add_ps(_mm_mul_ps(sp, z), _mm_set1_ps(TKBC_SIN_C1));
+    sp = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sp, z), x), x);
+    __m128 cp = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(TKBC_COS_C3), z), _mm_set1_ps(TKBC_COS_C2));
+    cp = _mm_add_ps(_mm_mul_ps(cp, z), _mm_set1_ps(TKBC_COS_C1));
+    cp = _mm_mul_ps(_mm_mul_ps(cp, z), z);
+    cp = _mm_add_ps(_mm_sub_ps(cp, _mm_mul_ps(z, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+    // Odd quadrants swap sine and cosine, the sign depends on the quadrant.
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+    __m128 sin_r = _mm_or_ps(_mm_and_ps(swap, cp), _mm_andnot_ps(swap, sp));
+    __m128 cos_r = _mm_or_ps(_mm_and_ps(swap, sp), _mm_andnot_ps(swap, cp));
+    __m128 sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30));
+    __m128 cos_sign =
+        _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+
+    _mm_storeu_ps(s, _mm_xor_ps(sin_r, sin_sign));
+    _mm_storeu_ps(c, _mm_xor_ps(cos_r, cos_sign));
+}
+
+/**
+ * @brief The function computes the cosine and sine of 8 angles in degrees at
+ * once with AVX2 and FMA. It must only be called if the CPU supports it.
+ *
+ * @param deg The angles in degrees.
+ * @param c The location where the cosine values are stored.
+ * @param s The location where the sine values are stored.
+ */
+__attribute__((target("avx2,fma"))) static void tkbc__sincos_deg_avx2(const float *deg, float *c, float *s) {
+    __m256 d = _mm256_loadu_ps(deg);
+    __m256 turns = _mm256_round_ps(_mm256_mul_ps(d, _mm256_set1_ps(1.0f / 360.0f)), _MM_FROUND_TO_NEAREST_INT);
+    d = _mm256_fnmadd_ps(turns, _mm256_set1_ps(360.0f), d);
+    __m256 x = _mm256_mul_ps(d, _mm256_set1_ps(PI / 180.0f));
+
+    __m256 qf = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(2.0f / PI)), _MM_FROUND_TO_NEAREST_INT);
+    __m256i q = _mm256_cvtps_epi32(qf);
+    x = _mm256_fnmadd_ps(qf, _mm256_set1_ps(TKBC_PIO2_1), x);
+    x = _mm256_fnmadd_ps(qf, _mm256_set1_ps(TKBC_PIO2_2), x);
+    x = _mm256_fnmadd_ps(qf, _mm256_set1_ps(TKBC_PIO2_3), x);
+
+    __m256 z = _mm256_mul_ps(x, x);
+    __m256 sp = _mm256_fmadd_ps(_mm256_set1_ps(TKBC_SIN_C3), z, _mm256_set1_ps(TKBC_SIN_C2));
+    sp = _mm256_fmadd_ps(sp, z, _mm256_set1_ps(TKBC_SIN_C1));
+    sp = _mm256_fmadd_ps(_mm256_mul_ps(sp, z), x, x);
+    __m256 cp = _mm256_fmadd_ps(_mm256_set1_ps(TKBC_COS_C3), z, _mm256_set1_ps(TKBC_COS_C2));
+    cp = _mm256_fmadd_ps(cp, z, _mm256_set1_ps(TKBC_COS_C1));
+    cp = _mm256_mul_ps(_mm256_mul_ps(cp, z), z);
+    cp = _mm256_add_ps(_mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), cp), _mm256_set1_ps(1.0f));
+
+    __m256 swap =
+        _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+    __m256 sin_r = _mm256_blendv_ps(sp, cp, swap);
+    __m256 cos_r = _mm256_blendv_ps(cp, sp, swap);
+    __m256 sin_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, _mm256_set1_epi32(2)), 30));
+    __m256 cos_sign = _mm256_castsi256_ps(
+        _mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+
+    _mm256_storeu_ps(s, _mm256_xor_ps(sin_r, sin_sign));
+    _mm256_storeu_ps(c, _mm256_xor_ps(cos_r, cos_sign));
+}
+#endif  // TKBC_X86_SIMD
+
+/**
+ * @brief The function computes the cosine and sine of all the given angles in
+ * degrees. It uses the widest available SIMD path and the scalar math library
+ * for the remaining elements.
+ *
+ * @param deg The angles in degrees.
+ * @param c The location where the cosine values are stored.
+ * @param s The location where the sine values are stored.
+ * @param n The amount of angles.
+ */
+static void tkbc__sincos_deg_many(const float *deg, float *c, float *s, size_t n) {
+    size_t i = 0;
+#ifdef TKBC_X86_SIMD
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        for (; i + 8 <= n; i += 8) {
+            tkbc__sincos_deg_avx2(&deg[i], &c[i], &s[i]);
+        }
+    }
+    for (; i + 4 <= n; i += 4) {
+        tkbc__sincos_deg_sse2(&deg[i], &c[i], &s[i]);
+    }
+#endif  // TKBC_X86_SIMD
+    for (; i < n; ++i) {
+        float phi = (PI * deg[i] / 180);
+        c[i] = cosf(phi);
+        s[i] = sinf(phi);
+    }
+}
+
+#define TKBC_CENTER_ROTATION_CHUNK 256
+
+/**
+ * @brief The function computes the internal points of all kites in one pass.
+ * It is the batched version of tkbc_center_rotation() with the positions and
+ * angles given as separate arrays. The sine and cosine of a whole chunk of
+ * kites are computed at once.
+ *
+ * @param kite_states The kites that are going to be modified.
+ * @param x The new x positions in the order of the kite_states.
+ * @param y The new y positions in the order of the kite_states.
+ * @param angle The new angles in degrees in the order of the kite_states.
+ */
+void tkbc_center_rotation_many(Kite_States *kite_states, const float *x, const float *y, const float *angle) {
+    float c[TKBC_CENTER_ROTATION_CHUNK];
+    float s[TKBC_CENTER_ROTATION_CHUNK];
+
+    for (size_t base = 0; base < kite_states->count; base += TKBC_CENTER_ROTATION_CHUNK) {
+        size_t n = kite_states->count - base;
+        if (n > TKBC_CENTER_ROTATION_CHUNK) {
+            n = TKBC_CENTER_ROTATION_CHUNK;
+        }
+
+        tkbc__sincos_deg_many(&angle[base], c, s, n);
+        for (size_t i = 0; i < n; ++i) {
+            Kite *kite = kite_states->elements[base + i].kite;
+            Vector2 pos = {x[base + i], y[base + i]};
+            tkbc__kite_geometry(kite, pos, angle[base + i], c[i], s[i]);
+        }
+    }
+}
+
 /**
  * @brief The function computes the new position of the kite and its
  * corresponding structure values with a tip rotation.
@@ -568,6 +851,9 @@ void tkbc_tip_rotation(Kite *kite, Vector2 *position, float tip_deg_rotation, TI
 
     if (position != NULL) {
         tkbc_kite_update_position(kite, position);
+    } else {
+        // The tips are read from the geometric shape.
+        tkbc_kite_materialize_geometry(kite);
     }
 
     float_t length = (kite->width / 2.f + kite->spread);
@@ -603,6 +889,50 @@ void tkbc_tip_rotation(Kite *kite, Vector2 *position, float tip_deg_rotation, TI
     tkbc_center_rotation(kite, &pos, tip_deg_rotation);
 }
 
+// ===========================================================================
+// ========================== KITE ARRAY GEOMETRY ============================
+// ===========================================================================
+
+/**
+ * @brief The function computes the geometric shape of every kite whose pose
+ * has changed since the last computation in one batch. The script frames just
+ * set the poses, so this is done once per tick before the kites are drawn. The
+ * sine and cosine of the angles are computed in chunks like in
+ * tkbc_center_rotation_many().
+ *
+ * @param kite_states The kites that should have a valid geometric shape.
+ */
+void tkbc_kite_array_materialize_geometry(Kite_States *kite_states) {
+    float angle[TKBC_CENTER_ROTATION_CHUNK];
+    float c[TKBC_CENTER_ROTATION_CHUNK];
+    float s[TKBC_CENTER_ROTATION_CHUNK];
+
+    for (size_t base = 0; base < kite_states->count; base += TKBC_CENTER_ROTATION_CHUNK) {
+        size_t n = kite_states->count - base;
+        if (n > TKBC_CENTER_ROTATION_CHUNK) {
+            n = TKBC_CENTER_ROTATION_CHUNK;
+        }
+
+        bool is_dirty = false;
+        for (size_t i = 0; i < n; ++i) {
+            Kite *kite = kite_states->elements[base + i].kite;
+            angle[i] = kite->angle;
+            is_dirty |= kite->is_geometry_dirty;
+        }
+        if (!is_dirty) {
+            continue;
+        }
+
+        tkbc__sincos_deg_many(angle, c, s, n);
+        for (size_t i = 0; i < n; ++i) {
+            Kite *kite = kite_states->elements[base + i].kite;
+            if (kite->is_geometry_dirty) {
+                tkbc__kite_geometry(kite, kite->center, angle[i], c[i], s[i]);
+            }
+        }
+    }
+}
+
 // ===========================================================================
 // ========================== KITE DISPLAY ===================================
 // ===========================================================================
@@ -622,9 +952,16 @@ void tkbc_draw_kite(Kite_State *state) {
             tkbc_get_screen_width() - window_padding,
             tkbc_get_screen_height() - window_padding,
         };
-        state->kite->center.y = tkbc_clamp(state->kite->center.y, window_padding, window.y);
-        state->kite->center.x = tkbc_clamp(state->kite->center.x, window_padding, window.x);
-        tkbc_kite_update_internal(state->kite);
+        Vector2 clamped = {
+            .x = tkbc_clamp(state->kite->center.x, window_padding, window.x),
+            .y = tkbc_clamp(state->kite->center.y, window_padding, window.y),
+        };
+        if (!Vector2Equals(clamped, state->kite->center)) {
+            tkbc_kite_set_pose(state->kite, &clamped, state->kite->angle);
+        }
+        // The simulation just marks the geometric shape as stale, it is
+        // computed here once per draw if the pose has changed.
+        tkbc_kite_materialize_geometry(state->kite);
     }
 
     if (ColorIsEqual(state->kite->body_color, BLANK)) {
@@ -705,15 +1042,30 @@ void tkbc_update_kites_for_resize_window(Env *env) {
         return;
     }
 
+    tkbc_scale_kites_to_window(env, width, height);
+}
+
+/**
+ * @brief The function moves all kites from the current window size of the env
+ * to the new one, so they keep their relative position in the view port. The
+ * geometry of all kites is computed afterwards in one batch.
+ *
+ * @param env The global state of the application.
+ * @param width The new width of the window.
+ * @param height The new height of the window.
+ */
+void tkbc_scale_kites_to_window(Env *env, size_t width, size_t height) {
     if (env->window_width != width || env->window_height != height) {
+        float sx = (float) width / (float) env->window_width;
+        float sy = (float) height / (float) env->window_height;
         for (size_t i = 0; i < env->kite_array.count; ++i) {
             Kite *kite = env->kite_array.elements[i].kite;
-            kite->center.x = kite->center.x / (float) env->window_width * (float) width;
-            kite->center.y = kite->center.y / (float) env->window_height * (float) height;
-            kite->old_center.x = kite->old_center.x / (float) env->window_width * (float) width;
-            kite->old_center.y = kite->old_center.y / (float) env->window_height * (float) height;
-            tkbc_kite_update_internal(kite);
+            Vector2 position = {kite->center.x * sx, kite->center.y * sy};
+            kite->old_center.x *= sx;
+            kite->old_center.y *= sy;
+            tkbc_kite_set_pose(kite, &position, kite->angle);
         }
+        tkbc_kite_array_materialize_geometry(&env->kite_array);
     }
     env->window_width = width;
     env->window_height = height;
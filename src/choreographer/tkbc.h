@@ -100,16 +100,25 @@ void tkbc_kite_update_internal(Kite *kite);
 void tkbc_kite_update_scale(Kite *kite, float scale);
 void tkbc_kite_update_position(Kite *kite, Vector2 *position);
 void tkbc_kite_update_angle(Kite *kite, float center_deg_rotation);
+void tkbc_kite_set_pose(Kite *kite, Vector2 *position, float center_deg_rotation);
+void tkbc_kite_materialize_geometry(Kite *kite);
 void tkbc_center_rotation(Kite *kite, Vector2 *position,
                           float center_deg_rotation);
+void tkbc_center_rotation_many(Kite_States *kite_states, const float *x,
+                               const float *y, const float *angle);
 void tkbc_tip_rotation(Kite *kite, Vector2 *position, float tip_deg_rotation,
                        TIP tip);
 
+// ========================== KITE ARRAY GEOMETRY ============================
+
+void tkbc_kite_array_materialize_geometry(Kite_States *kite_states);
+
 // ========================== KITE DISPLAY ===================================
 
 void tkbc_draw_kite(Kite_State *state);
 void tkbc_draw_kite_array(Kite_States kite_states);
 void tkbc_update_kites_for_resize_window(Env *env);
+void tkbc_scale_kites_to_window(Env *env, size_t width, size_t height);
 
 bool tkbc_set_kite_texture(Kite *kite, Kite_Texture *kite_texture);
 Color tkbc_get_random_color(void);
@@ -290,4 +290,15 @@ static Key_Map default_keymaps[] = {
         .key = 161,
         .hash = KMH_KEY_REVERS_MOUSE_FOLLOW,
     },
+
+    {
+        .description = "Shows the spacing and the collisions of the kites (toggle).",
+        .key = KEY_G,
+        .hash = KMH_TOGGLE_COLLISION_OVERLAY,
+    },
+    {
+        .description = "Bakes every loaded script and prints the unfinished blocks.",
+        .key = KEY_I,
+        .hash = KMH_VALIDATE_SCRIPTS,
+    },
 };
@@ -10,6 +10,7 @@
 #include "raylib.h"
 #include <assert.h>
 #include <stddef.h>
+#include <stdint.h>
 
 // ===========================================================================
 // ========================== TKBC KITE TYPES ================================
@@ -230,6 +231,9 @@ typedef enum {
 
     KMH_KEY_REVERS_MOUSE_FOLLOW,
 
+    KMH_TOGGLE_COLLISION_OVERLAY,
+    KMH_VALIDATE_SCRIPTS,
+
     KMH_COUNT,
 } Key_Map_Hash;
 
@@ -274,7 +278,9 @@ typedef struct {
     ssize_t texture_id;    // The number that identifies the kite texture in the
                            // global kite_textures.
 
-    bool is_texture_new;  // Indicates if the texture is currently newly created.
+    bool is_texture_new;     // Indicates if the texture is currently newly created.
+    bool is_geometry_dirty;  // Indicates that the pose has changed and the
+                             // triangles and the leading edge are stale.
 
     float old_angle;     // The rotation angle before the frame interpolation has
                          // stated.
@@ -375,6 +381,41 @@ typedef struct {
 typedef struct {
 } Wait_Action;  // The action that is responsible for blocking a certain time.
 
+typedef enum {
+    EASING_LINEAR,
+    EASING_CUBIC_IN,
+    EASING_CUBIC_OUT,
+    EASING_CUBIC_IN_OUT,
+    EASING_SINE_IN,
+    EASING_SINE_OUT,
+    EASING_SINE_IN_OUT,
+
+    EASING_COUNT,
+} Easing;  // The curves that map the normalized time of an action to its
+           // normalized progress.
+
+typedef struct {
+    float radius;       // The radius of the circle the kite flies on.
+    float begin_angle;  // The polar angle in degrees on the circle where the kite
+                        // starts, counted anticlockwise on the screen. The
+                        // center of the circle is derived from it and the start
+                        // position of every kite.
+    float end_angle;    // The polar angle in degrees on the circle where the kite
+                        // ends.
+    float rotation;     // The angle that is added to the kite rotation
+                        // proportional to the flown arc.
+    Easing easing;      // The curve that maps the time to the progress on the arc.
+} Arc_Action;           // The action that is responsible for flying the kite
+                        // along a circular path.
+
+typedef struct {
+    Vector2 control_1;  // The first control point relative to the start position.
+    Vector2 control_2;  // The second control point relative to the start position.
+    Vector2 position;   // The end of the path relative to the start position.
+    Easing easing;      // The curve that maps the time to the progress on the path.
+} Spline_Action;        // The action that is responsible for flying the kite
+                        // along a curved path.
+
 typedef Tip_Rotation_Action Tip_Rotation_Add_Action;  // The action that performs a addition to the
                                                       // current angle of the tip rotation.
 typedef Rotation_Action Rotation_Add_Action;          // The action that adds an angle to
@@ -382,6 +423,10 @@ typedef Rotation_Action Rotation_Add_Action;          // The action that adds an
 typedef Move_Action Move_Add_Action;                  // The action that adds a vector to the current position.
 typedef Wait_Action Quit_Action;                      // The action that is responsible for force
                                                       // quitting a frame after the specified time.
+typedef Spline_Action Bezier_Action;                  // The path is a cubic bezier curve from the start
+                                                      // over the two controls to the end.
+typedef Spline_Action Catmull_Rom_Action;             // The path is a catmull-rom spline that passes
+                                                      // through the start, the controls and the end.
 
 typedef union {  // The collection of all the possible actions that can be used
                  // in a script.
@@ -395,6 +440,10 @@ typedef union {  // The collection of all the possible actions that can be used
 
     Wait_Action as_wait;
     Quit_Action as_quit;
+
+    Arc_Action as_arc;
+    Bezier_Action as_bezier;
+    Catmull_Rom_Action as_catmull_rom;
 } Action;
 
 typedef enum {
@@ -407,6 +456,9 @@ typedef enum {
     ACTION_KITE_ROTATION_ADD,
     ACTION_KITE_TIP_ROTATION,
     ACTION_KITE_TIP_ROTATION_ADD,
+    ACTION_KITE_ARC,
+    ACTION_KITE_BEZIER,
+    ACTION_KITE_CATMULL_ROM,
 
     ACTION_KIND_COUNT,
 } Action_Kind;  // A named listing of all the available action kinds.
@@ -453,15 +505,33 @@ typedef struct {
 } Frames;                                 // A dynamic array collection that holds the type frame.
 
 typedef struct {
-    Frames *elements;  // The dynamic array collection for all combined frames as a
-                       // script.
-    size_t count;      // The amount of elements in the array.
-    size_t capacity;   // The complete allocated space for the array represented as
-                       // the number of collection elements of the array type.
-    Id script_id;      // The number of the loaded script starting from 1, 0 no script.
-    const char *name;  // The name of the script.
+    float *elements;  // The start time in seconds of every block of the script
+                      // followed by the duration of the whole script.
+    size_t count;     // The amount of elements in the array, one more than blocks.
+    size_t capacity;  // The complete allocated space for the array represented as
+                      // the number of collection elements of the array type.
+} Script_Timeline;    // The prefix sums of the block durations of a script.
+
+typedef struct {
+    Frames *elements;          // The dynamic array collection for all combined frames as a
+                               // script.
+    size_t count;              // The amount of elements in the array.
+    size_t capacity;           // The complete allocated space for the array represented as
+                               // the number of collection elements of the array type.
+    Id script_id;              // The number of the loaded script starting from 1, 0 no script.
+    const char *name;          // The name of the script.
+    Kite_Ids id_pool;          // The interned kite id sets of all frames. Frames of a
+                               // stored script point into this pool, identical sets are
+                               // stored once and are only modified through the pool.
+    Script_Timeline timeline;  // The start times of the blocks, built at the registration.
+
+    size_t bytes;      // The accounted memory of the script in the env budget.
+    size_t last_used;  // The env lru clock value of the last use of the script.
+    bool is_evicted;   // If the frames are spilled to disk and not in memory.
 
     Space space;
+    Space evicted_space;  // The name and the timeline that outlive the space,
+                          // after the script was evicted once.
 } Script;  // A dynamic array collection that combined multiple frames to a
            // single kite draw representation.
 
@@ -472,6 +542,211 @@ typedef struct {
                        // the number of collection elements of the array type.
 } Scripts;             // A dynamic array collection that combined multiple scripts.
 
+typedef struct {
+    void *data;      // The start of the loaded .kiteb file.
+    size_t size;     // The size of the file in bytes.
+    bool is_mapped;  // If the file is memory mapped, otherwise it is heap allocated.
+} Kiteb_Mapping;     // A loaded .kiteb file that scripts can point into.
+
+typedef struct {
+    Kiteb_Mapping *elements;  // The dynamic array collection for Kiteb_Mappings.
+    size_t count;             // The amount of elements in the array.
+    size_t capacity;          // The complete allocated space for the array represented as
+                              // the number of collection elements of the array type.
+} Kiteb_Mappings;             // A dynamic array collection of loaded .kiteb files.
+
+typedef struct {
+    void *handle;              // The handle of the loaded shared object or NULL.
+    char *library_path;        // The path of the loaded shared object.
+    char *source_path;         // The watched C source of the plugin or NULL.
+    int64_t source_mtime;      // The last seen modification time of the source.
+    double last_check;         // The time the source was checked the last time.
+    size_t build_count;        // The amount of builds, it keeps the library names unique.
+    bool is_built;             // If the library was built from the source and is owned.
+    int64_t build_pid;         // The process id of the running compiler or 0.
+    char *build_library_path;  // The shared object that the running compiler creates.
+
+    size_t script_id_begin;  // The script id counter before the plugin was executed.
+    size_t script_id_end;    // The script id counter after the plugin was executed.
+    size_t kites_begin;      // The kite count before the plugin was executed.
+    size_t kites_end;        // The kite count after the plugin was executed.
+    size_t kite_id_begin;    // The kite id counter before the plugin was executed.
+    size_t kite_id_end;      // The kite id counter after the plugin was executed.
+} Script_Plugin;             // A runtime loaded tkbc__script_input() and what it has added.
+
+typedef struct {
+    uint64_t hash;  // The hash of the tokens from BEGIN to END.
+    Id script_id;   // The script that is parsed from the section.
+} Kite_Section;     // A BEGIN/END section of a watched .kite file.
+
+typedef struct {
+    Kite_Section *elements;  // The dynamic array collection for Kite_Sections.
+    size_t count;            // The amount of elements in the array.
+    size_t capacity;         // The complete allocated space for the array represented as
+                             // the number of collection elements of the array type.
+} Kite_Sections;             // A dynamic array collection of the sections of a .kite file.
+
+typedef struct {
+    char *path;              // The watched .kite file or NULL.
+    int fd;                  // The inotify instance or -1 if the file is polled.
+    int wd;                  // The inotify watch of the directory of the file.
+    int64_t mtime;           // The last seen modification time of the file.
+    double last_check;       // The time the file was checked the last time.
+    uint64_t prelude_hash;   // The hash of the tokens outside of the sections.
+    Kite_Sections sections;  // The sections of the last parse in file order.
+} Kite_File_Watch;           // The state of the hot reload of a .kite file.
+
+typedef struct Kite_Load Kite_Load;
+
+typedef struct {
+    Index *elements;  // The dynamic array collection for frame block indices.
+    size_t count;     // The amount of elements in the array.
+    size_t capacity;  // The complete allocated space for the array represented as
+                      // the number of collection elements of the array type.
+} Block_Indices;      // A dynamic array that can hold frames_index values.
+
+typedef struct {
+    Id kite_id;             // The id of the kite in the slot.
+    size_t kite_index;      // The index of the kite in the kite_array or SIZE_MAX if the slot is empty.
+    size_t position_index;  // The index of the kite in the patched kite_frame_positions or SIZE_MAX.
+} Kite_Id_Slot;             // One entry of the kite id lookup.
+
+typedef struct {
+    Kite_Id_Slot *slots;  // The open addressing table of the kite ids.
+    size_t capacity;      // The amount of slots, a power of two.
+} Kite_Id_Map;            // A hash lookup from a kite id to its kite and its frame position.
+
+typedef struct {
+    Id *slots;        // The open addressing table of the ids, empty slots hold SIZE_MAX.
+    size_t count;     // The amount of different ids in the set.
+    size_t capacity;  // The amount of slots, a power of two.
+} Kite_Id_Set;        // A hash set that collects the different kite ids of a script.
+
+typedef struct {
+    size_t scripts;        // The amount of optimized scripts.
+    size_t blocks_before;  // The amount of frame blocks before the optimization.
+    size_t blocks_after;   // The amount of frame blocks after the optimization.
+    size_t frames_before;  // The amount of frames before the optimization.
+    size_t frames_after;   // The amount of frames after the optimization.
+} Script_Optimization;     // The counts of the script optimization pass.
+
+typedef struct {
+    char *message;              // The formatted message with the file, line and column.
+    unsigned long long line;    // The line of the error in the .kite file.
+    unsigned long long column;  // The column of the error in the .kite file.
+} Kite_Diagnostic;              // An error that the parser has found in a .kite file.
+
+typedef struct {
+    Kite_Diagnostic *elements;  // The dynamic array collection for Kite_Diagnostics.
+    size_t count;               // The amount of elements in the array.
+    size_t capacity;            // The complete allocated space for the array represented as
+                                // the number of collection elements of the array type.
+} Kite_Diagnostics;             // A dynamic array collection of the errors of a parsed .kite file.
+
+typedef struct {
+    Id *ids;              // The preallocated ids of the single kite frames of the block.
+    size_t ids_count;     // The amount of ids that are handed out.
+    size_t ids_capacity;  // The amount of ids that are preallocated.
+    bool is_open;         // If a block is currently built.
+} Block_Builder;          // The state of a block that is generated in bulk.
+
+typedef struct {
+    Triangle left;            // The left triangle of the kite body.
+    Triangle right;           // The right triangle of the kite body.
+    Vector2 leading_edge[4];  // The corners of the rotated leading edge.
+    Rectangle bounds;         // The axis aligned bounding box of the kite.
+    int cell_x;               // The grid cell of the kite center on the x-axis.
+    int cell_y;               // The grid cell of the kite center on the y-axis.
+} Kite_Shape;                 // The collision geometry of one kite.
+
+typedef struct {
+    float cell_size;     // The edge length of a grid cell in pixels.
+    size_t *heads;       // The first kite index of every hash bucket or SIZE_MAX.
+    size_t heads_count;  // The amount of hash buckets, a power of two.
+    size_t *next;        // The next kite index in the same bucket per kite.
+    Kite_Shape *shapes;  // The collision geometry per kite of the kite_array.
+    size_t capacity;     // The amount of kites the per kite arrays can hold.
+} Collision_Grid;        // A uniform grid spatial hash over the kite centers.
+
+typedef struct {
+    Id kite_id_a;      // The kite with the lower index in the kite_array.
+    Id kite_id_b;      // The kite with the higher index in the kite_array.
+    float separation;  // The smallest distance between the bodies, 0 on contact.
+} Kite_Proximity;      // Two kites that are closer than the checked distance.
+
+typedef struct {
+    Kite_Proximity *elements;  // The dynamic array collection for kite proximities.
+    size_t count;              // The amount of elements in the array.
+    size_t capacity;           // The complete allocated space for the array represented as
+                               // the number of collection elements of the array type.
+} Kite_Proximities;            // A dynamic array that holds the result of a collision check.
+
+typedef struct {
+    Index block;           // The frames_index of the block in the script.
+    double duration;       // The simulated time the block has taken in seconds.
+    bool finished;         // If the block has finished on its own.
+    float min_separation;  // The smallest distance between two kites in the
+                           // block or INFINITY if no kites came near.
+    Id closest_kite_id_a;  // The first kite of the closest pair.
+    Id closest_kite_id_b;  // The second kite of the closest pair.
+} Bake_Block;              // The timing and spacing of one simulated frame block.
+
+typedef struct {
+    Bake_Block *elements;  // The dynamic array collection for block timings.
+    size_t count;          // The amount of elements in the array.
+    size_t capacity;       // The complete allocated space for the array represented as
+                           // the number of collection elements of the array type.
+} Bake_Blocks;             // A dynamic array that holds the timings in playback order.
+
+typedef struct {
+    Id kite_id;       // The kite that has left the window area.
+    Index block;      // The block that has moved the kite out of the area.
+    double time;      // The simulated script time the kite has left the area.
+    float excess;     // The largest distance in pixels the kite was outside.
+} Bake_Bounds_Event;  // A kite that has left the window area during a block.
+
+typedef struct {
+    Bake_Bounds_Event *elements;  // The dynamic array collection for bounds events.
+    size_t count;                 // The amount of elements in the array.
+    size_t capacity;              // The complete allocated space for the array represented as
+                                  // the number of collection elements of the array type.
+} Bake_Bounds_Events;             // A dynamic array that holds one event per kite and block.
+
+typedef struct {
+    Id kite_id_a;  // The first kite of the touching pair.
+    Id kite_id_b;  // The second kite of the touching pair.
+    Index block;   // The block in which the kites have touched.
+    double time;   // The simulated script time of the first contact.
+} Bake_Contact;    // Two kites that have touched during a block.
+
+typedef struct {
+    Bake_Contact *elements;  // The dynamic array collection for kite contacts.
+    size_t count;            // The amount of elements in the array.
+    size_t capacity;         // The complete allocated space for the array represented as
+                             // the number of collection elements of the array type.
+} Bake_Contacts;             // A dynamic array that holds one contact per kite pair and block.
+
+typedef struct {
+    Id script_id;                      // The id of the script that was baked.
+    char *name;                        // The name of the script that was baked.
+    double duration;                   // The simulated playback time in seconds.
+    size_t blocks_count;               // The amount of frame blocks in the script.
+    Block_Indices unfinished_blocks;   // The blocks that have not finished in time
+                                       // and were skipped by the bake.
+    Bake_Blocks blocks;                // The duration of every played block.
+    Bake_Bounds_Events out_of_bounds;  // The kites that have left the window area.
+    Bake_Contacts contacts;            // The kites that have touched each other.
+    Kite_Positions final_poses;        // The kite positions after the last block.
+    bool finished;                     // If every block has finished on its own.
+} Bake_Report;                         // The result of a headless script simulation.
+
+typedef struct {
+    Bake_Report *elements;  // The dynamic array collection for all bake reports.
+    size_t count;           // The amount of elements in the array.
+    size_t capacity;        // The complete allocated space for the array represented as
+                            // the number of collection elements of the array type.
+} Bake_Reports;             // A dynamic array collection of script bake reports.
+
 typedef struct Process Process;
 
 typedef struct {
@@ -505,6 +780,19 @@ typedef struct {
     Scripts scripts;       // The collection of all the parsed scripts.
     Space _scripts_space;  // The final allocation place for all scripts.
 
+    size_t scripts_memory_budget;  // The max bytes the loaded scripts can use
+                                   // before the least recently used are evicted.
+    size_t scripts_memory_used;    // The bytes the loaded scripts currently use.
+    size_t scripts_lru_clock;      // The counter that orders the script uses.
+    Kiteb_Mappings kiteb_files;    // The loaded .kiteb files the scripts point into.
+    Script_Plugin plugin;          // The runtime loaded script plugin.
+    Kite_File_Watch kite_watch;    // The hot reloaded .kite file.
+    Kite_Load *kite_load;          // The .kite file that is loaded over several frames or NULL.
+
+    bool collision_overlay;                  // If the kite spacing is drawn over the kites.
+    Collision_Grid collision_grid;           // The spatial hash of the overlay check.
+    Kite_Proximities collision_proximities;  // The close kites of the last overlay check.
+
     size_t script_id_counter;  // This is a counter that keeps track of the
                                // script id/names that are generated if there is
                                // no name provided.
@@ -545,6 +833,11 @@ typedef struct {
     Frames scratch_buf_frames;  // A buffer that can be used to construct frames.
     Script scratch_buf_script;  // A buffer that can be used to
                                 // construct a script.
+    Block_Builder block_builder;  // The block that is currently generated in bulk.
+    Kite_Id_Map kite_id_map;      // The reused kite id lookup of the frame patching.
+    Script_Optimization script_optimization;  // The frame counts of all scripts before and
+                                              // after they were optimized.
+    Kite_Diagnostics kite_diagnostics;  // The errors of the last parsed .kite file.
 
     // -------FFMPEG-------
     Sound sound;            // The current loaded sound.
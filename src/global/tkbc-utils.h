@@ -199,6 +199,7 @@ int tkbc_get_screen_width(void);
 char *tkbc_generate_file_name_with_time_stamp(const char *prefix, const char *postfix);
 double tkbc_get_time(void);
 void tkbc_make_frame_time(double target_dt);
+void tkbc_set_virtual_frame_time(double dt);
 float tkbc_get_frame_time(void);
 #ifdef INCLUDE_RAYLIB
 bool is_mouse_double_click(int mouse_button);
@@ -215,6 +216,12 @@ Vector2 tkbc_reduce_str_to_fit_box(Font font, const char *str, int *font_size, f
 float tkbc_clamp(float z, float a, float b);
 bool tkbc_float_equals_epsilon(float x, float y, float epsilon);
 int tkbc_max(int x, int y);
+bool tkbc_span_to_uint64_t(const char *span, size_t size, uint64_t *number);
+bool tkbc_span_to_int64_t(const char *span, size_t size, int64_t *number);
+bool tkbc_span_to_size_t(const char *span, size_t size, size_t *number);
+bool tkbc_span_to_int(const char *span, size_t size, int *number);
+bool tkbc_span_to_double(const char *span, size_t size, double *number);
+bool tkbc_span_to_float(const char *span, size_t size, float *number);
 char *tkbc_strtolower(char *str);
 char *tkbc_strtoupper(char *str);
 
@@ -227,6 +234,7 @@ bool tkbc__make_dir_if_not_existis_internal(const char *path, bool report_err, b
 bool tkbc_make_dir_recursive_if_not_existis(const char *path);
 bool tkbc__make_dir_recursive_if_not_existis_internal(const char *path, bool report_err);
 char tkbc_get_file_type(const char *file_path);
+bool tkbc_get_file_mtime(const char *path, int64_t *mtime);
 bool tkbc_remove(const char *path);
 bool tkbc_remove_recursive(const char *path);
 
@@ -239,6 +247,7 @@ bool tkbc_remove_recursive(const char *path);
 // ========================== KITE UTILS =====================================
 
 #include <errno.h>
+#include <float.h>
 #include <math.h>
 
 /**
@@ -737,6 +746,19 @@ void tkbc_make_frame_time(double target_dt) {
     tkbc_last_frame_time = current_time;
 }
 
+static thread_local double tkbc_virtual_dt = 0;
+/**
+ * @brief The function sets a fixed delta time for the calling thread. As long
+ * as it is set, tkbc_get_frame_time() returns this value instead of the real
+ * frame time, so scripts can be simulated headless and faster than real time.
+ * Every thread has its own virtual clock.
+ *
+ * @param dt The fixed delta time in seconds, 0 disables the virtual clock.
+ */
+void tkbc_set_virtual_frame_time(double dt) {
+    tkbc_virtual_dt = dt;
+}
+
 /**
  * @brief The function is a wrapper for the GetFrameTime() that is not available
  * in the server computation.
@@ -744,6 +766,9 @@ void tkbc_make_frame_time(double target_dt) {
  * @return The delta time off a computation cycle.
  */
 float tkbc_get_frame_time(void) {
+    if (tkbc_virtual_dt > 0) {
+        return (float) tkbc_virtual_dt;
+    }
 #ifdef TKBC_SERVER
     return (float) tkbc_dt;
 #else
@@ -1043,6 +1068,342 @@ int tkbc_max(int x, int y) {
     return x > y ? x : y;
 }
 
+/**
+ * @brief The function parses an unsigned decimal integer directly out of the
+ * given span without copying it. The whole span has to be the number, only a
+ * leading plus sign is allowed.
+ *
+ * @param span The characters of the number, they don't have to be null
+ * terminated.
+ * @param size The amount of characters of the number.
+ * @param number The variable that holds the parsed value if the function has
+ * succeeded.
+ * @return True if the span is a decimal integer that fits into 64 bits,
+ * otherwise false and the number stays untouched.
+ */
+bool tkbc_span_to_uint64_t(const char *span, size_t size, uint64_t *number) {
+    size_t i = 0;
+    if (i < size && span[i] == '+') {
+        i++;
+    }
+    if (i == size) {
+        return false;
+    }
+
+    uint64_t value = 0;
+    for (; i < size; ++i) {
+        uint64_t digit = (unsigned char)span[i] - (unsigned char)'0';
+        if (digit > 9 || value > (UINT64_MAX - digit) / 10) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+    *number = value;
+    return true;
+}
+
+/**
+ * @brief The function parses a signed decimal integer directly out of the
+ * given span without copying it. The whole span has to be the number with an
+ * optional leading sign.
+ *
+ * @param span The characters of the number, they don't have to be null
+ * terminated.
+ * @param size The amount of characters of the number.
+ * @param number The variable that holds the parsed value if the function has
+ * succeeded.
+ * @return True if the span is a decimal integer that fits into an int64_t,
+ * otherwise false and the number stays untouched.
+ */
+bool tkbc_span_to_int64_t(const char *span, size_t size, int64_t *number) {
+    bool negative = size > 0 && span[0] == '-';
+    uint64_t magnitude = 0;
+    if (!tkbc_span_to_uint64_t(span + negative, size - negative, &magnitude)) {
+        return false;
+    }
+    if (magnitude > (uint64_t)INT64_MAX + negative) {
+        return false;
+    }
+    *number = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+    return true;
+}
+
+/**
+ * @brief The function parses a decimal integer that can be represented by the
+ * size_t type directly out of the given span.
+ *
+ * @param span The characters of the number, they don't have to be null
+ * terminated.
+ * @param size The amount of characters of the number.
+ * @param number The variable that holds the parsed value if the function has
+ * succeeded.
+ * @return True if the span is a decimal integer that fits into a size_t,
+ * otherwise false and the number stays untouched.
+ */
+bool tkbc_span_to_size_t(const char *span, size_t size, size_t *number) {
+    uint64_t value = 0;
+    if (!tkbc_span_to_uint64_t(span, size, &value) || value > SIZE_MAX) {
+        return false;
+    }
+    *number = (size_t)value;
+    return true;
+}
+
+/**
+ * @brief The function parses a decimal integer that can be represented by the
+ * int type directly out of the given span.
+ *
+ * @param span The characters of the number, they don't have to be null
+ * terminated.
+ * @param size The amount of characters of the number.
+ * @param number The variable that holds the parsed value if the function has
+ * succeeded.
+ * @return True if the span is a decimal integer that fits into an int,
+ * otherwise false and the number stays untouched.
+ */
+bool tkbc_span_to_int(const char *span, size_t size, int *number) {
+    int64_t value = 0;
+    if (!tkbc_span_to_int64_t(span, size, &value) || value < INT_MIN || value > INT_MAX) {
+        return false;
+    }
+    *number = (int)value;
+    return true;
+}
+
+// The powers of ten that are exactly representable as a double.
+static const double tkbc_exact_powers_of_ten[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/**
+ * @brief The function splits a plain decimal floating point number like the
+ * ones of the %f and %G printers into its sign, its significant digits and
+ * the power of ten. Only the first 19 significant digits are kept, so they
+ * always fit into the mantissa.
+ *
+ * @param span The characters of the number.
+ * @param size The amount of characters of the number.
+ * @param negative Is set to true if the number has a leading minus.
+ * @param mantissa The significant digits of the number as an integer.
+ * @param exponent The power of ten the mantissa has to be scaled with.
+ * @param truncated Is set to true if a non zero digit did not fit into the
+ * mantissa, so the value of mantissa and exponent is not exact.
+ * @return True if the whole span is a plain decimal number, otherwise false.
+ */
+static bool tkbc__span_to_decimal(const char *span, size_t size, bool *negative, uint64_t *mantissa,
+                                  int64_t *exponent, bool *truncated) {
+    size_t i = 0;
+    *negative = false;
+    *mantissa = 0;
+    *exponent = 0;
+    *truncated = false;
+    if (i < size && (span[i] == '-' || span[i] == '+')) {
+        *negative = span[i] == '-';
+        i++;
+    }
+
+    size_t significant_digits = 0;
+    bool has_digits = false;
+    bool is_fraction = false;
+    for (; i < size; ++i) {
+        if (span[i] == '.' && !is_fraction) {
+            is_fraction = true;
+            continue;
+        }
+        uint64_t digit = (unsigned char)span[i] - (unsigned char)'0';
+        if (digit > 9) {
+            break;
+        }
+        has_digits = true;
+        if (significant_digits < 19) {
+            *mantissa = *mantissa * 10 + digit;
+            significant_digits += *mantissa != 0;
+            *exponent -= is_fraction;
+        } else {
+            *exponent += !is_fraction;
+            *truncated |= digit != 0;
+        }
+    }
+    if (!has_digits) {
+        return false;
+    }
+
+    if (i < size && (span[i] == 'e' || span[i] == 'E')) {
+        i++;
+        bool negative_exponent = false;
+        if (i < size && (span[i] == '-' || span[i] == '+')) {
+            negative_exponent = span[i] == '-';
+            i++;
+        }
+        if (i == size || (unsigned char)span[i] - (unsigned char)'0' > 9) {
+            return false;
+        }
+        int64_t power = 0;
+        for (; i < size && (unsigned char)span[i] - (unsigned char)'0' <= 9; ++i) {
+            // Bigger exponents are out of range for every floating point type anyway.
+            if (power < 100000) {
+                power = power * 10 + (span[i] - '0');
+            }
+        }
+        *exponent += negative_exponent ? -power : power;
+    }
+
+    // The floating point suffixes of the C lexer.
+    if (i < size && (span[i] == 'f' || span[i] == 'F' || span[i] == 'l' || span[i] == 'L')) {
+        i++;
+    }
+    return i == size;
+}
+
+/**
+ * @brief The function computes the decimal number with Clinger's fast path.
+ * If the mantissa and the power of ten are both exact doubles a single
+ * multiplication or division is correctly rounded.
+ *
+ * @param mantissa The significant digits of the number.
+ * @param exponent The power of ten the mantissa has to be scaled with.
+ * @param value The correctly rounded value of the number.
+ * @return True if the fast path could be used, otherwise false.
+ */
+static bool tkbc__decimal_to_double_fast(uint64_t mantissa, int64_t exponent, double *value) {
+    if (mantissa > (1ULL << 53) || exponent < -22 || exponent > 22) {
+        return false;
+    }
+    double result = (double)mantissa;
+    if (exponent < 0) {
+        result /= tkbc_exact_powers_of_ten[-exponent];
+    } else {
+        result *= tkbc_exact_powers_of_ten[exponent];
+    }
+    *value = result;
+    return true;
+}
+
+/**
+ * @brief The function is the slow path of the floating point span parsers. It
+ * copies the span into a buffer on the stack and parses it with the C library.
+ * Only numbers that are longer than the stack buffer are copied to the heap.
+ *
+ * @param span The characters of the number.
+ * @param size The amount of characters of the number.
+ * @param number_double The variable that holds the parsed double or NULL.
+ * @param number_float The variable that holds the parsed float if number_double
+ * is NULL.
+ * @return True if the whole span is a number, otherwise false.
+ */
+static bool tkbc__span_to_floating_slow(const char *span, size_t size, double *number_double, float *number_float) {
+    char stack_buffer[128];
+    char *buffer = stack_buffer;
+    if (size >= sizeof(stack_buffer)) {
+        buffer = malloc(size + 1);
+        if (buffer == NULL) {
+            return false;
+        }
+    }
+    memcpy(buffer, span, size);
+    buffer[size] = '\0';
+
+    char *end = NULL;
+    double value_double = 0;
+    float value_float = 0;
+    if (number_double != NULL) {
+        value_double = strtod(buffer, &end);
+    } else {
+        value_float = strtof(buffer, &end);
+    }
+
+    size_t consumed = end - buffer;
+    if (consumed < size && (buffer[consumed] == 'f' || buffer[consumed] == 'F' || buffer[consumed] == 'l' ||
+                            buffer[consumed] == 'L')) {
+        consumed++;
+    }
+    bool ok = size > 0 && !isspace((unsigned char)buffer[0]) && end != buffer && consumed == size;
+
+    if (buffer != stack_buffer) {
+        free(buffer);
+    }
+    if (!ok) {
+        return false;
+    }
+    if (number_double != NULL) {
+        *number_double = value_double;
+    } else {
+        *number_float = value_float;
+    }
+    return true;
+}
+
+/**
+ * @brief The function parses a floating point number directly out of the
+ * given span. Decimal numbers whose digits fit into 53 bits and that have a
+ * small exponent, like the output of the %f and %G printers, are computed
+ * without a copy. Every other number is handed to strtod(), so the result is always the
+ * correctly rounded value.
+ *
+ * @param span The characters of the number, they don't have to be null
+ * terminated.
+ * @param size The amount of characters of the number.
+ * @param number The variable that holds the parsed value if the function has
+ * succeeded.
+ * @return True if the whole span is a number, otherwise false and the number
+ * stays untouched.
+ */
+bool tkbc_span_to_double(const char *span, size_t size, double *number) {
+    bool negative = false;
+    bool truncated = false;
+    uint64_t mantissa = 0;
+    int64_t exponent = 0;
+    if (tkbc__span_to_decimal(span, size, &negative, &mantissa, &exponent, &truncated) && !truncated) {
+        double value = 0;
+        if (mantissa == 0 || tkbc__decimal_to_double_fast(mantissa, exponent, &value)) {
+            *number = negative ? -value : value;
+            return true;
+        }
+    }
+    return tkbc__span_to_floating_slow(span, size, number, NULL);
+}
+
+/**
+ * @brief The function parses a floating point number directly out of the
+ * given span into a float. The value is computed as a correctly rounded double
+ * first. The conversion to float is exact as long as the double does not lie
+ * directly between two floats, in that case and for every number the fast
+ * path can't handle strtof() is used.
+ *
+ * @param span The characters of the number, they don't have to be null
+ * terminated.
+ * @param size The amount of characters of the number.
+ * @param number The variable that holds the parsed value if the function has
+ * succeeded.
+ * @return True if the whole span is a number, otherwise false and the number
+ * stays untouched.
+ */
+bool tkbc_span_to_float(const char *span, size_t size, float *number) {
+    bool negative = false;
+    bool truncated = false;
+    uint64_t mantissa = 0;
+    int64_t exponent = 0;
+    if (tkbc__span_to_decimal(span, size, &negative, &mantissa, &exponent, &truncated) && !truncated) {
+        double value = 0;
+        if (mantissa == 0) {
+            *number = negative ? -0.0f : 0.0f;
+            return true;
+        }
+        if (tkbc__decimal_to_double_fast(mantissa, exponent, &value) && value >= FLT_MIN && value <= FLT_MAX) {
+            uint64_t bits = 0;
+            memcpy(&bits, &value, sizeof(bits));
+            // The 29 mantissa bits that a float drops are exactly the half of a float step.
+            if ((bits & 0x1FFFFFFF) != 0x10000000) {
+                float result = (float)value;
+                *number = negative ? -result : result;
+                return true;
+            }
+        }
+    }
+    return tkbc__span_to_floating_slow(span, size, NULL, number);
+}
+
 /**
  * @brief This function lowercase the given string in place if a char in the
  * string can't be lowercase or it has no lowercase equivalent that it stays the
@@ -1471,6 +1832,28 @@ char tkbc_get_file_type(const char *file_path) {
     return TKBC_DT_UNKNOWN;
 }
 
+/**
+ * @brief The function reads the modification time of the given file. The time
+ * has nanosecond precision where the platform provides it.
+ *
+ * @param path The path of the file.
+ * @param mtime The place where the modification time is written to.
+ * @return True if the time could be read, otherwise false.
+ */
+bool tkbc_get_file_mtime(const char *path, int64_t *mtime) {
+    struct stat st;
+    if (stat(path, &st) < 0) {
+        tkbc_fprintf(stderr, "ERROR", "Failed to get file information for %s: %s\n", path, strerror(errno));
+        return false;
+    }
+#ifdef __linux__
+    *mtime = (int64_t) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#else
+    *mtime = (int64_t) st.st_mtime;
+#endif
+    return true;
+}
+
 /**
  * @brief The function removes a file or an empty directory.
  *
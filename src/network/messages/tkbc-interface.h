@@ -33,6 +33,10 @@ typedef enum {
     MESSAGE_GET_TEXTURE,
     MESSAGE_SEND_TEXTURE,
 
+    MESSAGE_LOCAL_TRANSPORT,  // The client offers shared memory segments to a
+                              // server on the same host.
+    MESSAGE_SCRIPT_LOCAL,     // The scripts are in a shared memory segment.
+
     MESSAGE_COUNT,
 } Message_Kind;  // Messages that are supported in the current PROTOCOL_VERSION.
 
@@ -173,7 +177,7 @@ typedef enum {
  * MESSAGE_SCRIPT_SCRUB:
  *
  *****
- * MESSAGE_SCRIPT_SCRUB:drag_left:\r\n
+ * MESSAGE_SCRIPT_SCRUB:frames_index:\r\n
  *****
  */
 
@@ -223,4 +227,27 @@ typedef enum {
  *****
  */
 
+/**
+ *
+ * MESSAGE_LOCAL_TRANSPORT: The client sends its process id after the HELLO,
+ * the server opens the kite ring of the client if the client is connected over
+ * the loopback address and answers if it writes the kites to the ring.
+ *
+ *****
+ * MESSAGE_LOCAL_TRANSPORT:pid:\r\n
+ * MESSAGE_LOCAL_TRANSPORT:accepted:\r\n
+ *****
+ */
+
+/**
+ *
+ * MESSAGE_SCRIPT_LOCAL: Replaces MESSAGE_SCRIPT_AMOUNT and MESSAGE_SCRIPT when
+ * the local transport is accepted. The scripts are in the .kiteb layout in the
+ * script segment with the given number.
+ *
+ *****
+ * MESSAGE_SCRIPT_LOCAL:segment_number:\r\n
+ *****
+ */
+
 #endif  // TKBC_INTERFACE_H
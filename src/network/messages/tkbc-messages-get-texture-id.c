@@ -3,6 +3,7 @@
 #include "../../choreographer/tkbc-script-handler.h"
 #include "../../global/tkbc-types.h"
 #include "../tkbc-servers-common.h"
+#include "../tkbc-network-common.h"
 #include "tkbc-messages.h"
 
 #include <stdbool.h>
@@ -20,11 +21,10 @@ bool tkbc_messages_get_texture_id(Lexer *lexer, Client *client) {
     // The client can request a texture id for a kite;
     Token token;
 
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    size_t kite_id;
+    if (!tkbc_parse_message_size_t(lexer, &kite_id)) {
         return false;
     }
-    size_t kite_id = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         return false;
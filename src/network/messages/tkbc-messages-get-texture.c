@@ -3,6 +3,7 @@
 #include "../../choreographer/tkbc-asset-handler.h"
 #include "../../global/tkbc-types.h"
 #include "../tkbc-servers-common.h"
+#include "../tkbc-network-common.h"
 #include "tkbc-interface.h"
 
 #include "tkbc-messages.h"
@@ -20,11 +21,10 @@
  */
 bool tkbc_messages_get_texture(Lexer *lexer, Client *client) {
     Token token;
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    ssize_t texture_id;
+    if (!tkbc_parse_message_ssize_t(lexer, &texture_id)) {
         return false;
     }
-    ssize_t texture_id = atoll(lexer_token_to_cstr(lexer, &token));
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         return false;
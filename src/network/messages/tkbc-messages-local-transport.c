@@ -0,0 +1,40 @@
+#include "../../../external/lexer/tkbc-lexer.h"
+#include "../../../external/space/space.h"
+#include "../../global/tkbc-types.h"
+#include "../tkbc-local-transport.h"
+#include "../tkbc-network-common.h"
+#include "../tkbc-servers-common.h"
+#include "tkbc-messages.h"
+
+#include <stdbool.h>
+
+/**
+ * @brief Handles a LOCAL_TRANSPORT message of a client by opening the kite ring
+ * of the client. The ring is only used for clients that are connected over the
+ * loopback address, the answer tells the client if the server writes to it.
+ *
+ * @param lexer The lexer positioned at the message content.
+ * @param client The client that offers the local transport.
+ * @return True if the message was parsed, otherwise false.
+ */
+bool tkbc_messages_local_transport(Lexer *lexer, Client *client) {
+    Token token;
+    size_t pid;
+    if (!tkbc_parse_message_size_t(lexer, &pid)) {
+        return false;
+    }
+    token = lexer_next(lexer);
+    if (token.kind != PUNCT_COLON) {
+        return false;
+    }
+
+    // A client on another host can not share the memory of the server.
+    bool is_loopback = (ntohl(client->client_address.sin_addr.s_addr) >> 24) == 127;
+    Local_Transport *transport = &client->local_transport;
+    tkbc_local_segment_close(&transport->ring);
+    transport->is_active = is_loopback && tkbc_local_ring_open(transport, pid);
+
+    space_dapf(&client->send_msg_buffer_space, &client->send_msg_buffer, "%d:%d:\r\n", MESSAGE_LOCAL_TRANSPORT,
+               transport->is_active);
+    return true;
+}
@@ -0,0 +1,85 @@
+#include "../../../external/lexer/tkbc-lexer.h"
+#include "../../../external/space/space.h"
+#include "../../choreographer/tkbc-script-handler.h"
+#include "../../choreographer/tkbc-script-kiteb.h"
+#include "../../global/tkbc-types.h"
+#include "../poll-server.h"
+#include "../tkbc-local-transport.h"
+#include "../tkbc-network-common.h"
+#include "../tkbc-servers-common.h"
+#include "tkbc-messages.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/**
+ * @brief Handles a SCRIPT_LOCAL message by copying the script segment of the
+ * client. The scripts are added like the ones of the SCRIPT messages, but
+ * nothing has to be lexed. The segment is removed after it is copied.
+ *
+ * @param env The global state of the application.
+ * @param lexer The lexer positioned at the message content.
+ * @param client The client that sent the scripts.
+ * @return True if the scripts are added, otherwise false.
+ */
+bool tkbc_messages_script_local(Env *env, Lexer *lexer, Client *client) {
+    Token token;
+    size_t number;
+    if (!tkbc_parse_message_size_t(lexer, &number)) {
+        return false;
+    }
+    token = lexer_next(lexer);
+    if (token.kind != PUNCT_COLON) {
+        return false;
+    }
+    if (!client->local_transport.is_active) {
+        return false;
+    }
+
+    Content scripts = {0};
+    if (!tkbc_local_scripts_read(client->local_transport.pid, number, &scripts)) {
+        free(scripts.elements);
+        return false;
+    }
+
+    Script *scb_script = &env->scratch_buf_script;
+    size_t count = tkbc_kiteb_scripts_count(scripts.elements);
+    for (size_t i = 0; i < count; ++i) {
+        tkbc_kiteb_copy_script(scripts.elements, i, &scb_script->space, scb_script);
+        if (tkbc_scripts_contains_id(env->scripts, scb_script->script_id)) {
+            // The script is already known, so the copy is dropped.
+            scb_script->elements = NULL;
+            scb_script->count = 0;
+            scb_script->capacity = 0;
+            scb_script->script_id = 0;
+            space_reset_space(&scb_script->space);
+            continue;
+        }
+
+        Kite_Ids possible_new_kis = {0};
+        for (size_t j = 0; j < scb_script->count; ++j) {
+            Frames *frames = &scb_script->elements[j];
+            for (size_t k = 0; k < frames->count; ++k) {
+                Kite_Ids *ids = &frames->elements[k].kite_id_array;
+                for (size_t id = 0; id < ids->count; ++id) {
+                    if (!tkbc_contains_id(possible_new_kis, ids->elements[id])) {
+                        tkbc_dap(&possible_new_kis, ids->elements[id]);
+                    }
+                }
+            }
+        }
+        tkbc_messages_script_add(env, possible_new_kis);
+        free(possible_new_kis.elements);
+    }
+    free(scripts.elements);
+
+    client->script_amount = 0;
+    space_dapf(&client->send_msg_buffer_space, &client->send_msg_buffer, "%d:\r\n", MESSAGE_SCRIPT_PARSED);
+
+    // This parsing function is just used in the server but liked in the client as
+    // well so just a simple guard for compilation.
+#ifdef TKBC_SERVER
+    tkbc_message_clientkites_write_to_send_msg_buffer(client, true);
+#endif
+    return true;
+}
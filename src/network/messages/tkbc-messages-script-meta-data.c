@@ -2,6 +2,7 @@
 #include "../../../external/space/space.h"
 #include "../../global/tkbc-types.h"
 #include "../tkbc-servers-common.h"
+#include "../tkbc-network-common.h"
 #include "tkbc-messages.h"
 
 #include "../../choreographer/tkbc-script-handler.h"
@@ -19,35 +20,26 @@ extern Client client;
  */
 bool tkbc_messages_script_meta_data(Lexer *lexer) {
     Token token;
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    if (!tkbc_parse_message_size_t(lexer, &env->server_script_id)) {
         return false;
     }
 
-    env->server_script_id = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
-
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         return false;
     }
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    if (!tkbc_parse_message_size_t(lexer, &env->server_script_frames_count)) {
         return false;
     }
 
-    env->server_script_frames_count = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
-
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         return false;
     }
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    if (!tkbc_parse_message_size_t(lexer, &env->server_script_frames_index)) {
         return false;
     }
 
-    env->server_script_frames_index = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
-
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         return false;
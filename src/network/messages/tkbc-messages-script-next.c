@@ -5,6 +5,7 @@
 #include "../../global/tkbc-types.h"
 #include "../poll-server.h"
 #include "../tkbc-servers-common.h"
+#include "../tkbc-network-common.h"
 #include "tkbc-messages.h"
 
 #include <stdbool.h>
@@ -18,11 +19,10 @@
  */
 bool tkbc_messages_script_next(Lexer *lexer) {
     Token token;
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    ssize_t script_id;
+    if (!tkbc_parse_message_ssize_t(lexer, &script_id)) {
         return false;
     }
-    ssize_t script_id = strtoll(lexer_token_to_cstr(lexer, &token), NULL, 10);
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         return false;
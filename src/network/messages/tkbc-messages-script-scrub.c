@@ -4,24 +4,25 @@
 #include "../../global/tkbc-types.h"
 #include "../poll-server.h"
 #include "../tkbc-servers-common.h"
+#include "../tkbc-network-common.h"
 #include "tkbc-messages.h"
 
 #include <stdbool.h>
 
 /**
- * @brief Handles a SCRIPT_SCRUB message by scrubbing through the current script
- * timeline.
+ * @brief Handles a SCRIPT_SCRUB message by jumping to the requested block of
+ * the current script timeline. The target is absolute, so a repeated or late
+ * message can not move the script past the position under the mouse.
  *
  * @param lexer The lexer positioned at the message content.
  * @return True if the scrub was executed successfully, otherwise false.
  */
 bool tkbc_messages_script_scrub(Lexer *lexer) {
     Token token;
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    size_t frames_index;
+    if (!tkbc_parse_message_size_t(lexer, &frames_index)) {
         return false;
     }
-    bool drag_left = !!atoi(lexer_token_to_cstr(lexer, &token));
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         return false;
@@ -40,7 +41,7 @@ bool tkbc_messages_script_scrub(Lexer *lexer) {
 
         // TODO: map the kite_ids before setting this inside the positions are
         // recalculated..
-        tkbc_execute_scrub_slide(env, drag_left);
+        tkbc_execute_scrub_to(env, frames_index);
     }
 
     // This parsing function is just used in the server but liked in the client as
@@ -5,10 +5,60 @@
 #include "../../global/tkbc-types.h"
 #include "../poll-server.h"
 #include "../tkbc-servers-common.h"
+#include "../tkbc-network-common.h"
 #include "tkbc-messages.h"
 
 #include <stdbool.h>
 
+/**
+ * @brief The function finishes a script of a client in the scratch buffer. New
+ * kites are generated for the kite ids of the client, the frames are mapped to
+ * them and the script is added to the env.
+ *
+ * @param env The global state of the application.
+ * @param possible_new_kis The kite ids of the client in the order they are
+ * used in the script.
+ */
+void tkbc_messages_script_add(Env *env, Kite_Ids possible_new_kis) {
+    Space *scb_space = &env->scratch_buf_script.space;
+    Script *scb_script = &env->scratch_buf_script;
+    size_t kite_count = possible_new_kis.count;
+    size_t prev_count = env->kite_array.count;
+    // A script that just waits has no kites to map.
+    if (kite_count > 0) {
+        Kite_Ids kite_ids = tkbc_kite_array_generate(env, kite_count);
+
+        for (size_t i = prev_count; i < env->kite_array.count; ++i) {
+            env->kite_array.elements[i].is_active = false;
+            env->kite_array.elements[i].is_script_kite = true;
+        }
+
+        tkbc_remap_script_kite_id_arrays_to_kite_ids(scb_script, kite_ids);
+        free(kite_ids.elements);
+        kite_ids.elements = NULL;
+    }
+
+    // Set the first kite positions
+    tkbc_patch_script_kite_positions(env, scb_script, scb_space);
+
+    //
+    //
+    // TODO: @Cleanup @Memory Holding all the scripts in memory is to much
+    // even an DOS attac could happen, by providing a large amount of
+    // scripts that doesn't fit into memory.
+    //
+    // Think about storing them on disk and loading them on demand or
+    // reducing the memory storage size of a script.
+    //
+    // Marvin Frohwitter 22.06.2025
+    tkbc_add_script(env, *scb_script);
+
+    // This is just to be explicit is already happen in the script adding.
+    //
+    // For continues parsing this does not happen in an error case.
+    scb_script->count = 0;
+}
+
 /**
  * @brief Handles a SCRIPT message by parsing and registering a script from the
  * client.
@@ -23,7 +73,6 @@
  */
 bool tkbc_messages_script(Env *env, Lexer *lexer, Client *client, bool *script_alleady_there_parsing_skip) {
     Token token;
-    Content tmp_buffer = {0};
     bool script_parse_fail = false;
     Space *scb_space = &env->scratch_buf_script.space;
     Script *scb_script = &env->scratch_buf_script;
@@ -31,12 +80,10 @@ bool tkbc_messages_script(Env *env, Lexer *lexer, Client *client, bool *script_a
     Frame frame = {0};
     Kite_Ids possible_new_kis = {0};
 
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    if (!tkbc_parse_message_size_t(lexer, &scb_script->script_id)) {
         script_parse_fail = true;
         goto script_err;
     }
-    scb_script->script_id = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
     //
     // This just fast forward a script that is already known and it reduces
     // the parsing afford.
@@ -51,12 +98,11 @@ bool tkbc_messages_script(Env *env, Lexer *lexer, Client *client, bool *script_a
         script_parse_fail = true;
         goto script_err;
     }
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    size_t script_count;
+    if (!tkbc_parse_message_size_t(lexer, &script_count)) {
         script_parse_fail = true;
         goto script_err;
     }
-    size_t script_count = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         script_parse_fail = true;
@@ -64,24 +110,21 @@ bool tkbc_messages_script(Env *env, Lexer *lexer, Client *client, bool *script_a
     }
 
     for (size_t i = 0; i < script_count; ++i) {
-        token = lexer_next(lexer);
-        if (token.kind != NUMBER) {
+        if (!tkbc_parse_message_size_t(lexer, &scb_frames->frames_index)) {
             script_parse_fail = true;
             goto script_err;
         }
-        scb_frames->frames_index = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
         token = lexer_next(lexer);
         if (token.kind != PUNCT_COLON) {
             script_parse_fail = true;
             goto script_err;
         }
 
-        token = lexer_next(lexer);
-        if (token.kind != NUMBER) {
+        size_t frames_count;
+        if (!tkbc_parse_message_size_t(lexer, &frames_count)) {
             script_parse_fail = true;
             goto script_err;
         }
-        size_t frames_count = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
         token = lexer_next(lexer);
         if (token.kind != PUNCT_COLON) {
             script_parse_fail = true;
@@ -89,43 +132,38 @@ bool tkbc_messages_script(Env *env, Lexer *lexer, Client *client, bool *script_a
         }
 
         for (size_t j = 0; j < frames_count; ++j) {
-            token = lexer_next(lexer);
-            if (token.kind != NUMBER) {
+            if (!tkbc_parse_message_size_t(lexer, &frame.index)) {
                 script_parse_fail = true;
                 goto script_err;
             }
-            frame.index = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
             token = lexer_next(lexer);
             if (token.kind != PUNCT_COLON) {
                 script_parse_fail = true;
                 goto script_err;
             }
-            token = lexer_next(lexer);
-            if (token.kind != NUMBER) {
+            if (!tkbc_parse_message_bool(lexer, &frame.finished)) {
                 script_parse_fail = true;
                 goto script_err;
             }
-            frame.finished = !!atoi(lexer_token_to_cstr(lexer, &token));
             token = lexer_next(lexer);
             if (token.kind != PUNCT_COLON) {
                 script_parse_fail = true;
                 goto script_err;
             }
-            token = lexer_next(lexer);
-            if (token.kind != NUMBER) {
+            int kind;
+            if (!tkbc_parse_message_int(lexer, &kind)) {
                 script_parse_fail = true;
                 goto script_err;
             }
-            frame.kind = atoi(lexer_token_to_cstr(lexer, &token));
+            frame.kind = kind;
             token = lexer_next(lexer);
             if (token.kind != PUNCT_COLON) {
                 script_parse_fail = true;
                 goto script_err;
             }
 
-            char sign = '+';
             Action action = {0};
-            static_assert(ACTION_KIND_COUNT == 9, "NOT ALL THE Action_Kinds ARE IMPLEMENTED");
+            static_assert(ACTION_KIND_COUNT == 12, "NOT ALL THE Action_Kinds ARE IMPLEMENTED");
             switch (frame.kind) {
             case ACTION_KITE_QUIT:
             case ACTION_KITE_WAIT: {
@@ -133,20 +171,10 @@ bool tkbc_messages_script(Env *env, Lexer *lexer, Client *client, bool *script_a
 
             case ACTION_KITE_MOVE:
             case ACTION_KITE_MOVE_ADD: {
-                token = lexer_next(lexer);
-                if (token.kind != NUMBER && token.kind != PUNCT_SUB) {
+                if (!tkbc_parse_message_float(lexer, &action.as_move.position.x)) {
                     script_parse_fail = true;
                     goto script_err;
                 }
-                if (token.kind == PUNCT_SUB) {
-                    sign = *(char *) token.content;
-                    tkbc_dap(&tmp_buffer, sign);
-                    token = lexer_next(lexer);
-                }
-                tkbc_dapc(&tmp_buffer, token.content, token.size);
-                tkbc_dap(&tmp_buffer, 0);
-                action.as_move.position.x = atof(tmp_buffer.elements);
-                tmp_buffer.count = 0;
 
                 token = lexer_next(lexer);
                 if (token.kind != PUNCT_COLON) {
@@ -154,48 +182,28 @@ bool tkbc_messages_script(Env *env, Lexer *lexer, Client *client, bool *script_a
                     goto script_err;
                 }
 
-                token = lexer_next(lexer);
-                if (token.kind != NUMBER && token.kind != PUNCT_SUB) {
+                if (!tkbc_parse_message_float(lexer, &action.as_move.position.y)) {
                     script_parse_fail = true;
                     goto script_err;
                 }
-                if (token.kind == PUNCT_SUB) {
-                    sign = *(char *) token.content;
-                    tkbc_dap(&tmp_buffer, sign);
-                    token = lexer_next(lexer);
-                }
-                tkbc_dapc(&tmp_buffer, token.content, token.size);
-                tkbc_dap(&tmp_buffer, 0);
-                action.as_move.position.y = atof(tmp_buffer.elements);
-                tmp_buffer.count = 0;
             } break;
 
             case ACTION_KITE_ROTATION:
             case ACTION_KITE_ROTATION_ADD: {
-                token = lexer_next(lexer);
-                if (token.kind != NUMBER && token.kind != PUNCT_SUB) {
+                if (!tkbc_parse_message_float(lexer, &action.as_rotation.angle)) {
                     script_parse_fail = true;
                     goto script_err;
                 }
-                if (token.kind == PUNCT_SUB) {
-                    sign = *(char *) token.content;
-                    tkbc_dap(&tmp_buffer, sign);
-                    token = lexer_next(lexer);
-                }
-                tkbc_dapc(&tmp_buffer, token.content, token.size);
-                tkbc_dap(&tmp_buffer, 0);
-                action.as_rotation.angle = atof(tmp_buffer.elements);
-                tmp_buffer.count = 0;
             } break;
 
             case ACTION_KITE_TIP_ROTATION:
             case ACTION_KITE_TIP_ROTATION_ADD: {
-                token = lexer_next(lexer);
-                if (token.kind != NUMBER) {
+                int tip;
+                if (!tkbc_parse_message_int(lexer, &tip)) {
                     script_parse_fail = true;
                     goto script_err;
                 }
-                action.as_tip_rotation.tip = atoi(lexer_token_to_cstr(lexer, &token));
+                action.as_tip_rotation.tip = tip;
 
                 token = lexer_next(lexer);
                 if (token.kind != PUNCT_COLON) {
@@ -203,20 +211,60 @@ bool tkbc_messages_script(Env *env, Lexer *lexer, Client *client, bool *script_a
                     goto script_err;
                 }
 
+                if (!tkbc_parse_message_float(lexer, &action.as_tip_rotation.angle)) {
+                    script_parse_fail = true;
+                    goto script_err;
+                }
+            } break;
+
+            case ACTION_KITE_ARC:
+            case ACTION_KITE_BEZIER:
+            case ACTION_KITE_CATMULL_ROM: {
+                float *arc_values[] = {
+                    &action.as_arc.radius,
+                    &action.as_arc.begin_angle,
+                    &action.as_arc.end_angle,
+                    &action.as_arc.rotation,
+                };
+                float *spline_values[] = {
+                    &action.as_bezier.control_1.x, &action.as_bezier.control_1.y, &action.as_bezier.control_2.x,
+                    &action.as_bezier.control_2.y, &action.as_bezier.position.x,  &action.as_bezier.position.y,
+                };
+                bool isarc = frame.kind == ACTION_KITE_ARC;
+                float **values = isarc ? arc_values : spline_values;
+                size_t values_count = isarc ? ARRAY_LENGTH(arc_values) : ARRAY_LENGTH(spline_values);
+                Easing *easing = isarc ? &action.as_arc.easing : &action.as_bezier.easing;
+
+                for (size_t v = 0; v < values_count; ++v) {
+                    if (v > 0) {
+                        token = lexer_next(lexer);
+                        if (token.kind != PUNCT_COLON) {
+                            script_parse_fail = true;
+                            goto script_err;
+                        }
+                    }
+
+                    if (!tkbc_parse_message_float(lexer, values[v])) {
+                        script_parse_fail = true;
+                        goto script_err;
+                    }
+                }
+
                 token = lexer_next(lexer);
-                if (token.kind != NUMBER && token.kind != PUNCT_SUB) {
+                if (token.kind != PUNCT_COLON) {
                     script_parse_fail = true;
                     goto script_err;
                 }
-                if (token.kind == PUNCT_SUB) {
-                    sign = *(char *) token.content;
-                    tkbc_dap(&tmp_buffer, sign);
-                    token = lexer_next(lexer);
+                int easing_number;
+                if (!tkbc_parse_message_int(lexer, &easing_number)) {
+                    script_parse_fail = true;
+                    goto script_err;
+                }
+                if (easing_number < 0 || easing_number >= EASING_COUNT) {
+                    script_parse_fail = true;
+                    goto script_err;
                 }
-                tkbc_dapc(&tmp_buffer, token.content, token.size);
-                tkbc_dap(&tmp_buffer, 0);
-                action.as_tip_rotation.angle = atof(tmp_buffer.elements);
-                tmp_buffer.count = 0;
+                *easing = easing_number;
             } break;
 
             default:
@@ -232,12 +280,10 @@ bool tkbc_messages_script(Env *env, Lexer *lexer, Client *client, bool *script_a
                 goto script_err;
             }
 
-            token = lexer_next(lexer);
-            if (token.kind != NUMBER) {
+            if (!tkbc_parse_message_float(lexer, &frame.duration)) {
                 script_parse_fail = true;
                 goto script_err;
             }
-            frame.duration = atof(lexer_token_to_cstr(lexer, &token));
             frame.original_duration = frame.duration;
 
             // These tow have no kites attached.
@@ -247,12 +293,11 @@ bool tkbc_messages_script(Env *env, Lexer *lexer, Client *client, bool *script_a
                     script_parse_fail = true;
                     goto script_err;
                 }
-                token = lexer_next(lexer);
-                if (token.kind != NUMBER) {
+                size_t kite_ids_count;
+                if (!tkbc_parse_message_size_t(lexer, &kite_ids_count)) {
                     script_parse_fail = true;
                     goto script_err;
                 }
-                size_t kite_ids_count = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
                 token = lexer_next(lexer);
                 if (token.kind != PUNCT_COLON) {
                     script_parse_fail = true;
@@ -264,13 +309,11 @@ bool tkbc_messages_script(Env *env, Lexer *lexer, Client *client, bool *script_a
                     goto script_err;
                 }
                 for (size_t k = 1; k <= kite_ids_count; ++k) {
-                    token = lexer_next(lexer);
-                    if (token.kind != NUMBER) {
+                    size_t kite_id;
+                    if (!tkbc_parse_message_size_t(lexer, &kite_id)) {
                         script_parse_fail = true;
                         goto script_err;
                     }
-
-                    size_t kite_id = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
                     bool contains = false;
                     space_dap(scb_space, &frame.kite_id_array, kite_id);
                     for (size_t id = 0; id < possible_new_kis.count; ++id) {
@@ -323,48 +366,13 @@ bool tkbc_messages_script(Env *env, Lexer *lexer, Client *client, bool *script_a
     }
 
     // Post parsing
-    size_t kite_count = possible_new_kis.count;
-    size_t prev_count = env->kite_array.count;
-    Kite_Ids kite_ids = tkbc_kite_array_generate(env, kite_count);
-
-    for (size_t i = prev_count; i < env->kite_array.count; ++i) {
-        env->kite_array.elements[i].is_active = false;
-        env->kite_array.elements[i].is_script_kite = true;
-    }
-
-    tkbc_remap_script_kite_id_arrays_to_kite_ids(scb_script, kite_ids);
-    free(kite_ids.elements);
-    kite_ids.elements = NULL;
-
-    // Set the first kite positions
-    tkbc_patch_script_kite_positions(env, scb_script, scb_space);
-
-    //
-    //
-    // TODO: @Cleanup @Memory Holding all the scripts in memory is to much
-    // even an DOS attac could happen, by providing a large amount of
-    // scripts that doesn't fit into memory.
-    //
-    // Think about storing them on disk and loading them on demand or
-    // reducing the memory storage size of a script.
-    //
-    // Marvin Frohwitter 22.06.2025
-    tkbc_add_script(env, *scb_script);
-
-    // This is just to be explicit is already happen in the script adding.
-    //
-    // For continues parsing this does not happen in an error case.
-    scb_script->count = 0;
+    tkbc_messages_script_add(env, possible_new_kis);
 
 script_err:
     if (possible_new_kis.elements) {
         free(possible_new_kis.elements);
         possible_new_kis.elements = NULL;
     }
-    if (tmp_buffer.elements) {
-        free(tmp_buffer.elements);
-        tmp_buffer.elements = NULL;
-    }
     if (script_parse_fail) {
         if (*script_alleady_there_parsing_skip) {
             goto parsing_skip;
@@ -4,6 +4,7 @@
 #include "../../choreographer/tkbc-script-handler.h"
 #include "../../global/tkbc-types.h"
 #include "../tkbc-servers-common.h"
+#include "../tkbc-network-common.h"
 #include "tkbc-messages.h"
 
 #include <stdbool.h>
@@ -19,23 +20,21 @@
  */
 bool tkbc_messages_send_texture_id(Env *env, Lexer *lexer, Client *client) {
     Token token;
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    size_t kite_id;
+    if (!tkbc_parse_message_size_t(lexer, &kite_id)) {
         return false;
     }
-    size_t kite_id = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         return false;
     }
 
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
-        return false;
-    }
     // Negative values should not be send by the server. The serer should
     // always send a valid texture_id.
-    ssize_t texture_id = atoll(lexer_token_to_cstr(lexer, &token));
+    ssize_t texture_id;
+    if (!tkbc_parse_message_ssize_t(lexer, &texture_id)) {
+        return false;
+    }
     assert(texture_id != -1);
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
@@ -12,10 +12,13 @@ bool tkbc_messages_send_texture(Lexer *lexer);
 bool tkbc_messages_send_texture_id(Env *env, Lexer *lexer, Client *client);
 bool tkbc_messages_get_texture_id(Lexer *lexer, Client *client);
 bool tkbc_messages_script_meta_data(Lexer *lexer);
+bool tkbc_messages_local_transport(Lexer *lexer, Client *client);
 
 bool tkbc_messages_single_kite_add(Env *env, Lexer *lexer, Client *client, Kite *client_kite);
 
+void tkbc_messages_script_add(Env *env, Kite_Ids possible_new_kis);
 bool tkbc_messages_script(Env *env, Lexer *lexer, Client *client, bool *script_alleady_there_parsing_skip);
+bool tkbc_messages_script_local(Env *env, Lexer *lexer, Client *client);
 bool tkbc_messages_script_next(Lexer *lexer);
 bool tkbc_messages_script_scrub(Lexer *lexer);
 
@@ -186,6 +186,7 @@ bool tkbc_remove_client_by_fd(int fd) {
             Client client_tmp = clients.elements[i];
             space_free_space(&client_tmp.send_msg_buffer_space);
             space_free_space(&client_tmp.recv_msg_buffer_space);
+            tkbc_local_transport_destroy(&client_tmp.local_transport);
 
             client_tmp.recv_msg_buffer.elements = NULL;
             client_tmp.send_msg_buffer.elements = NULL;
@@ -743,6 +744,38 @@ void tkbc_message_clientkites_write_to_all_send_msg_buffers(bool overwrite_is_ac
     tkbc_reset_space_and_null_message(space_get_tspace(), &t_message);
 }
 
+/**
+ * @brief The function sends the active kites of the current tick to all
+ * clients. A client with a local transport gets them as a snapshot in its kite
+ * ring, the other clients get the message CLIENTKITES. If the kites don't fit
+ * into a snapshot, every client gets the message.
+ */
+void tkbc_message_clientkites_write_to_all_send_msg_buffers_or_rings(void) {
+    bool fit = tkbc_local_kites_fit(&env->kite_array);
+    bool has_message = false;
+    for (size_t i = 0; i < clients.count; ++i) {
+        if (!fit || !clients.elements[i].local_transport.is_active) {
+            has_message = true;
+        }
+    }
+    if (has_message) {
+        tkbc_message_clientkites(&t_message, false);
+    }
+
+    for (size_t i = 0; i < clients.count; ++i) {
+        Client *client = &clients.elements[i];
+        if (fit && client->local_transport.is_active) {
+            tkbc_local_ring_write(&client->local_transport, &env->kite_array);
+        } else {
+            tkbc_write_to_send_msg_buffer(client, t_message);
+        }
+    }
+
+    if (has_message) {
+        tkbc_reset_space_and_null_message(space_get_tspace(), &t_message);
+    }
+}
+
 /**
  * @brief The function constructs all the scripts that specified in a block
  * frame.
@@ -820,11 +853,10 @@ bool tkbc_received_message_handler(Client *client) {
             goto err;
         }
 
-        if (token.kind != NUMBER) {
+        int kind;
+        if (token.kind != NUMBER || !tkbc_span_to_int(token.content, token.size, &kind)) {
             goto err;
         }
-
-        int kind = atoi(lexer_token_to_cstr(lexer, &token));
         size_t digits_count_of_kind = token.size;
         token = lexer_next(lexer);
         if (token.kind != PUNCT_COLON) {
@@ -836,7 +868,7 @@ bool tkbc_received_message_handler(Client *client) {
         }
 
         message->i = lexer->position - digits_count_of_kind - 1;
-        static_assert(MESSAGE_COUNT == 20, "NEW MESSAGE_COUNT WAS INTRODUCED");
+        static_assert(MESSAGE_COUNT == 22, "NEW MESSAGE_COUNT WAS INTRODUCED");
         switch (kind) {
         case MESSAGE_HELLO: {
             if (!tkbc_messages_hello_verification(lexer, "\"Hello server from client!" PROTOCOL_VERSION "\"")) {
@@ -939,13 +971,24 @@ bool tkbc_received_message_handler(Client *client) {
                 goto err;
             }
         } break;
-        case MESSAGE_SCRIPT_AMOUNT: {
-            token = lexer_next(lexer);
-            if (token.kind != NUMBER) {
+        case MESSAGE_SCRIPT_LOCAL: {
+            if (!tkbc_messages_script_local(env, lexer, client)) {
                 goto err;
             }
 
-            client->script_amount = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
+            tkbc_fprintf(stderr, "MESSAGEHANDLER", "SCRIPT_LOCAL\n");
+        } break;
+        case MESSAGE_LOCAL_TRANSPORT: {
+            if (!tkbc_messages_local_transport(lexer, client)) {
+                goto err;
+            }
+
+            tkbc_fprintf(stderr, "MESSAGEHANDLER", "LOCAL_TRANSPORT\n");
+        } break;
+        case MESSAGE_SCRIPT_AMOUNT: {
+            if (!tkbc_parse_message_size_t(lexer, &client->script_amount)) {
+                goto err;
+            }
             token = lexer_next(lexer);
             if (token.kind != PUNCT_COLON) {
                 goto err;
@@ -1198,7 +1241,7 @@ bool tkbc_base_execution(void) {
                                                                         bindex);
         }
 
-        tkbc_message_clientkites_write_to_all_send_msg_buffers(false);
+        tkbc_message_clientkites_write_to_all_send_msg_buffers_or_rings();
 
         if (tkbc_script_finished(env)) {
             space_tdapf(&t_message, "%d:\r\n", MESSAGE_SCRIPT_FINISHED);
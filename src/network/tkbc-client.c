@@ -1,5 +1,4 @@
 // name of the program caller
-// TODO check for atoi, atol, atoll for 0 as failure. Maybe use strtol instead.
 //
 #define WINDOW_SCALE 120
 #define SCREEN_WIDTH 16 * WINDOW_SCALE
@@ -26,11 +25,13 @@
 #include "raymath.h"
 
 #include "../choreographer/tkbc-asset-handler.h"
+#include "../choreographer/tkbc-collision.h"
 #include "../choreographer/tkbc-ffmpeg.h"
 #include "../choreographer/tkbc-input-handler.h"
 #include "../choreographer/tkbc-keymaps.h"
 #include "../choreographer/tkbc-script-api.h"
 #include "../choreographer/tkbc-script-handler.h"
+#include "../choreographer/tkbc-script-store.h"
 #include "../choreographer/tkbc-sound-handler.h"
 #include "../choreographer/tkbc-ui.h"
 #include "../choreographer/tkbc.h"
@@ -79,6 +80,7 @@ static Popup connection = {0};
 static Popup loading = {0};
 static Popup disconnect = {0};
 static bool sending_receiving = true;
+static bool local_transport_requested = false;
 
 /**
  * @brief The function prints the way the program should be called.
@@ -87,7 +89,8 @@ static bool sending_receiving = true;
  */
 void tkbc_client_usage(const char *program_name) {
     tkbc_fprintf(stderr, "INFO", "Usage:\n");
-    tkbc_fprintf(stderr, "INFO", "      %s <HOST> <PORT> \n", program_name);
+    tkbc_fprintf(stderr, "INFO", "      %s [--local] <HOST> <PORT> \n", program_name);
+    tkbc_fprintf(stderr, "INFO", "      --local: Share the scripts and kites in memory with a server on this host.\n");
 }
 
 /**
@@ -402,11 +405,10 @@ bool received_message_handler(Message *message) {
             goto err;
         }
 
-        if (token.kind != NUMBER) {
+        int kind;
+        if (token.kind != NUMBER || !tkbc_span_to_int(token.content, token.size, &kind)) {
             goto err;
         }
-
-        int kind = atoi(lexer_token_to_cstr(lexer, &token));
         size_t digits_count_of_kind = token.size;
         token = lexer_next(lexer);
         if (token.kind != PUNCT_COLON) {
@@ -425,7 +427,7 @@ bool received_message_handler(Message *message) {
         }
 
         message->i = lexer->position - digits_count_of_kind - 1;
-        static_assert(MESSAGE_COUNT == 20, "NEW MESSAGE_COUNT WAS INTRODUCED");
+        static_assert(MESSAGE_COUNT == 22, "NEW MESSAGE_COUNT WAS INTRODUCED");
         switch (kind) {
         case MESSAGE_HELLO: {
             if (!tkbc_messages_hello_verification(lexer, "\"Hello client from server!" PROTOCOL_VERSION "\"")) {
@@ -437,6 +439,9 @@ bool received_message_handler(Message *message) {
                 space_dapf(&client.send_msg_buffer_space, &client.send_msg_buffer, "%d:%c%s" PROTOCOL_VERSION "%c:\r\n",
                            MESSAGE_HELLO, quote, "Hello server from client!", quote);
             }
+            if (local_transport_requested) {
+                tkbc_message_local_transport();
+            }
 
             received_hello = true;
             tkbc_fprintf(stderr, "MESSAGEHANDLER", "HELLO\n");
@@ -511,12 +516,10 @@ bool received_message_handler(Message *message) {
             tkbc_fprintf(stderr, "MESSAGEHANDLER", "SCRIPT_META_DATA\n");
         } break;
         case MESSAGE_CLIENTKITES: {
-            token = lexer_next(lexer);
-            if (token.kind != NUMBER) {
+            size_t amount;
+            if (!tkbc_parse_message_size_t(lexer, &amount)) {
                 goto err;
             }
-
-            size_t amount = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
             token = lexer_next(lexer);
             if (token.kind != PUNCT_COLON) {
                 goto err;
@@ -603,6 +606,27 @@ bool received_message_handler(Message *message) {
 
             tkbc_fprintf(stderr, "MESSAGEHANDLER", "CLIENTKITES\n");
         } break;
+        case MESSAGE_LOCAL_TRANSPORT: {
+            bool accepted;
+            if (!tkbc_parse_message_bool(lexer, &accepted)) {
+                goto err;
+            }
+            token = lexer_next(lexer);
+            if (token.kind != PUNCT_COLON) {
+                goto err;
+            }
+
+            // The server has mapped the ring or will not use it, so the name
+            // is not needed anymore.
+            tkbc_local_segment_unlink(&client.local_transport.ring);
+            if (!accepted) {
+                tkbc_local_segment_close(&client.local_transport.ring);
+                tkbc_fprintf(stderr, "INFO", "The server has declined the local transport.\n");
+            }
+            client.local_transport.is_active = accepted;
+
+            tkbc_fprintf(stderr, "MESSAGEHANDLER", "LOCAL_TRANSPORT\n");
+        } break;
         case MESSAGE_SCRIPT_PARSED: {
             env->scripts_parsed = true;
             tkbc_fprintf(stderr, "MESSAGEHANDLER", "SCRIPT_PARSED\n");
@@ -614,12 +638,10 @@ bool received_message_handler(Message *message) {
             tkbc_fprintf(stderr, "MESSAGEHANDLER", "SCRIPT_FINISHED\n");
         } break;
         case MESSAGE_CLIENT_DISCONNECT: {
-            token = lexer_next(lexer);
-            if (token.kind != NUMBER) {
+            size_t kite_id;
+            if (!tkbc_parse_message_size_t(lexer, &kite_id)) {
                 check_return(false);
             }
-
-            size_t kite_id = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
             token = lexer_next(lexer);
             if (token.kind != PUNCT_COLON) {
                 check_return(false);
@@ -740,6 +762,53 @@ bool message_queue_handler() {
     return true;
 }
 
+/**
+ * @brief The function offers the local transport to the server. The kite ring
+ * is created before, so the server can open it when the message is handled.
+ */
+void tkbc_message_local_transport(void) {
+    uint64_t pid = getpid();
+    if (!tkbc_local_ring_create(&client.local_transport, pid)) {
+        tkbc_fprintf(stderr, "WARNING", "The local transport is not available.\n");
+        return;
+    }
+    space_dapf(&client.send_msg_buffer_space, &client.send_msg_buffer, "%d:%zu:\r\n", MESSAGE_LOCAL_TRANSPORT,
+               (size_t) pid);
+}
+
+/**
+ * @brief The function applies the newest kite snapshot of the local transport.
+ * The snapshots replace the message CLIENTKITES during a running script.
+ */
+void tkbc_local_transport_kites_handler(void) {
+    static Local_Snapshot snapshot;
+    if (!client.local_transport.is_active || !tkbc_local_ring_read(&client.local_transport, &snapshot)) {
+        return;
+    }
+
+    for (size_t i = 0; i < snapshot.count; ++i) {
+        Local_Kite *kite = &snapshot.kites[i];
+        ssize_t texture_id = kite->texture_id;
+        if (!tkbc_find_asset_from_id(texture_id)) {
+            space_dapf(&client.send_msg_buffer_space, &client.send_msg_buffer, "%d:%zu:\r\n", MESSAGE_GET_TEXTURE,
+                       texture_id);
+            space_dapf(&client.send_msg_buffer_space, &client.send_msg_buffer, "%d:%zu:\r\n",
+                       MESSAGE_GET_TEXTURE_ID, (size_t) kite->kite_id);
+            texture_id = _tkbc_get_asset_kite_design(KITE_COLORIZER).id;
+        }
+
+        Color color = tkbc_uint32_t_to_color(kite->color);
+        Kite_State *state = tkbc_get_kite_state_by_id(env, kite->kite_id);
+        if (state == NULL) {
+            tkbc_register_kite_from_values(kite->kite_id, kite->x, kite->y, kite->angle, color, texture_id,
+                                           kite->is_reversed, kite->is_active, kite->is_script_kite);
+        } else {
+            tkbc_assign_values_to_kitestate(state, kite->x, kite->y, kite->angle, color, texture_id,
+                                            kite->is_reversed, kite->is_active, kite->is_script_kite);
+        }
+    }
+}
+
 /**
  * @brief Processes input handling for a kite state and sends a
  * SINGLE_KITE_UPDATE message if the kite position or angle changed
@@ -849,6 +918,9 @@ bool tkbc_message_append_script(size_t script_id) {
             continue;
         }
         Script *script = &env->scripts.elements[i];
+        if (!tkbc_script_store_ensure_loaded(env, script)) {
+            return false;
+        }
         space_dapf(&client.send_msg_buffer_space, &client.send_msg_buffer, "%zu:%zu:", script_id, script->count);
 
         for (size_t j = 0; j < script->count; ++j) {
@@ -861,7 +933,7 @@ bool tkbc_message_append_script(size_t script_id) {
                            "%zu:%d:%d:", frames->elements[k].index, frames->elements[k].finished,
                            frames->elements[k].kind);
 
-                static_assert(ACTION_KIND_COUNT == 9, "NOT ALL THE Action_Kinds ARE IMPLEMENTED");
+                static_assert(ACTION_KIND_COUNT == 12, "NOT ALL THE Action_Kinds ARE IMPLEMENTED");
                 switch (frames->elements[k].kind) {
                 case ACTION_KITE_QUIT:
                 case ACTION_KITE_WAIT: {
@@ -883,6 +955,18 @@ bool tkbc_message_append_script(size_t script_id) {
                     space_dapf(&client.send_msg_buffer_space, &client.send_msg_buffer, "%d:%f", action.tip,
                                action.angle);
                 } break;
+                case ACTION_KITE_ARC: {
+                    Arc_Action action = frames->elements[k].action.as_arc;
+                    space_dapf(&client.send_msg_buffer_space, &client.send_msg_buffer, "%f:%f:%f:%f:%d", action.radius,
+                               action.begin_angle, action.end_angle, action.rotation, action.easing);
+                } break;
+                case ACTION_KITE_BEZIER:
+                case ACTION_KITE_CATMULL_ROM: {
+                    Spline_Action action = frames->elements[k].action.as_bezier;
+                    space_dapf(&client.send_msg_buffer_space, &client.send_msg_buffer, "%f:%f:%f:%f:%f:%f:%d",
+                               action.control_1.x, action.control_1.y, action.control_2.x, action.control_2.y,
+                               action.position.x, action.position.y, action.easing);
+                } break;
                 default:
                     space_dapf(&client.send_msg_buffer_space, &client.send_msg_buffer, ":UNKNOWN ACTION");
                     assert(0 && "UNREACHABLE tkbc_message_append_script()");
@@ -917,6 +1001,14 @@ bool tkbc_message_append_script(size_t script_id) {
  */
 bool tkbc_message_script(void) {
     bool ok = true;
+    if (client.local_transport.is_active && env->send_scripts < env->scripts.count &&
+        tkbc_local_scripts_write(&client.local_transport, env, env->send_scripts)) {
+        space_dapf(&client.send_msg_buffer_space, &client.send_msg_buffer, "%d:%zu:\r\n", MESSAGE_SCRIPT_LOCAL,
+                   (size_t) client.local_transport.scripts_counter);
+        env->send_scripts = env->scripts.count;
+        return ok;
+    }
+
     space_dapf(&client.send_msg_buffer_space, &client.send_msg_buffer, "%d:%zu:\r\n", MESSAGE_SCRIPT_AMOUNT,
                env->scripts.count);
 
@@ -1002,14 +1094,21 @@ void tkbc_client_input_handler_script(void) {
         env->new_script_selected = false;
     }
 
-    if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) && env->timeline_interaction) {
-        int mouse_x = GetMouseX();
-        float slider = env->timeline_front.x + env->timeline_front.width;
-        float c = mouse_x - slider;
-        bool drag_left = c <= 0;
-
-        space_dapf(&client.send_msg_buffer_space, &client.send_msg_buffer, "%d:%d:\r\n", MESSAGE_SCRIPT_SCRUB,
-                   drag_left);
+    // The last block that was requested, so a target is just sent once while
+    // the server has not answered with its new position yet.
+    static size_t scrub_target = SIZE_MAX;
+    if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) && env->timeline_interaction && env->server_script_frames_count > 0) {
+        // The server jumps directly to the frames under the mouse.
+        Script *script = tkbc_get_script_by_id(env, env->server_script_id);
+        float part = (GetMouseX() - env->timeline_base.x) / env->timeline_base.width;
+        size_t frames_index = tkbc_script_timeline_block_at_part(script, part, env->server_script_frames_count);
+        if (frames_index != env->server_script_frames_index && frames_index != scrub_target) {
+            space_dapf(&client.send_msg_buffer_space, &client.send_msg_buffer, "%d:%zu:\r\n", MESSAGE_SCRIPT_SCRUB,
+                       frames_index);
+            scrub_target = frames_index;
+        }
+    } else {
+        scrub_target = SIZE_MAX;
     }
 }
 
@@ -1041,6 +1140,10 @@ int main(int argc, char *argv[]) {
     port = strcpy(port, "8080");
     host = strcpy(host, "127.0.0.1");
     char *program_name = tkbc_shift_args(&argc, &argv);
+    if (argc > 0 && strcmp(argv[0], "--local") == 0) {
+        tkbc_shift_args(&argc, &argv);
+        local_transport_requested = true;
+    }
     if (tkbc_client_commandline_check(argc, program_name)) {
         host = strcpy(host, tkbc_shift_args(&argc, &argv));
         port = strcpy(port, tkbc_shift_args(&argc, &argv));
@@ -1160,6 +1263,7 @@ int main(int argc, char *argv[]) {
 #endif
     }
 
+    tkbc_local_transport_destroy(&client.local_transport);
     tkbc_sound_destroy(env->sound);
     tkbc_destroy_env(env);
     tkbc_assets_destroy();
@@ -1177,6 +1281,7 @@ bool tkbc_run(Env *env) {
             disconnect.active = true;
         }
         sending_receiving = send_message_send_handler();
+        tkbc_local_transport_kites_handler();
     }
 
     if (tkbc_check_popup_interaction(&loading)) {
@@ -1225,7 +1330,11 @@ bool tkbc_run(Env *env) {
         }
 
         tkbc_update_kites_for_resize_window(env);
+        tkbc_kite_array_materialize_geometry(&env->kite_array);
         tkbc_draw_kite_array(env->kite_array);
+        if (env->collision_overlay) {
+            tkbc_draw_collision_overlay(env);
+        }
         tkbc_draw_ui(env);
     }
 
@@ -15,6 +15,8 @@ void sending_script_handler(void);
 bool send_message_handler(void);
 bool received_message_handler(Message *message);
 bool message_queue_handler();
+void tkbc_message_local_transport(void);
+void tkbc_local_transport_kites_handler(void);
 void tkbc_client_input_handler_kite(void);
 bool tkbc_message_append_script(size_t script_id);
 bool tkbc_message_script(void);
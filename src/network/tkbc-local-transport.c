@@ -0,0 +1,366 @@
+#include "tkbc-local-transport.h"
+#include "../choreographer/tkbc-script-kiteb.h"
+#include "../global/tkbc-types.h"
+#include "../global/tkbc-utils.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// The client creates every segment and names it after its process id, the
+// server opens it by that name:
+// - "/tkbc-<pid>-kites" holds the Local_Ring. The server writes a snapshot of
+//   the active kites every tick and the client reads the newest one. A slot is
+//   guarded by its sequence like a seqlock, so the server never waits for the
+//   client and the client drops a snapshot that was overwritten while reading.
+// - "/tkbc-<pid>-scripts-<n>" holds scripts in the .kiteb layout. The server
+//   copies them into its own memory and removes the segment afterwards.
+
+/**
+ * @brief The function creates a new shared memory segment with the name of the
+ * segment and maps it. An old segment with the same name is replaced.
+ *
+ * @param segment The segment with the name that is created.
+ * @param size The size of the segment in bytes.
+ * @return True if the segment is mapped, otherwise false.
+ */
+bool tkbc_local_segment_create(Local_Segment *segment, size_t size) {
+#ifdef _WIN32
+    (void) segment;
+    (void) size;
+    return false;
+#else
+    // A segment of a crashed process with the same id is not used anymore.
+    shm_unlink(segment->name);
+    int fd = shm_open(segment->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        tkbc_fprintf(stderr, "ERROR", "Could not create the shared memory %s: %s\n", segment->name, strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, size) < 0) {
+        tkbc_fprintf(stderr, "ERROR", "Could not resize the shared memory %s: %s\n", segment->name, strerror(errno));
+        close(fd);
+        shm_unlink(segment->name);
+        return false;
+    }
+
+    void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        tkbc_fprintf(stderr, "ERROR", "Could not map the shared memory %s: %s\n", segment->name, strerror(errno));
+        shm_unlink(segment->name);
+        return false;
+    }
+    segment->data = data;
+    segment->size = size;
+    return true;
+#endif  // _WIN32
+}
+
+/**
+ * @brief The function maps the existing shared memory segment with the name of
+ * the segment.
+ *
+ * @param segment The segment with the name that is opened.
+ * @return True if the segment is mapped, otherwise false.
+ */
+bool tkbc_local_segment_open(Local_Segment *segment) {
+#ifdef _WIN32
+    (void) segment;
+    return false;
+#else
+    int fd = shm_open(segment->name, O_RDWR, 0);
+    if (fd < 0) {
+        tkbc_fprintf(stderr, "ERROR", "Could not open the shared memory %s: %s\n", segment->name, strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+        tkbc_fprintf(stderr, "ERROR", "Could not get the size of the shared memory %s.\n", segment->name);
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        tkbc_fprintf(stderr, "ERROR", "Could not map the shared memory %s: %s\n", segment->name, strerror(errno));
+        return false;
+    }
+    segment->data = data;
+    segment->size = st.st_size;
+    return true;
+#endif  // _WIN32
+}
+
+/**
+ * @brief The function unmaps the segment. The shared memory object stays
+ * available under its name.
+ *
+ * @param segment The segment that is closed.
+ */
+void tkbc_local_segment_close(Local_Segment *segment) {
+#ifndef _WIN32
+    if (segment->data) {
+        munmap(segment->data, segment->size);
+    }
+#endif  // _WIN32
+    segment->data = NULL;
+    segment->size = 0;
+}
+
+/**
+ * @brief The function removes the name of the segment, the memory is released
+ * when every mapping of it is closed.
+ *
+ * @param segment The segment that is removed.
+ */
+void tkbc_local_segment_unlink(Local_Segment *segment) {
+#ifndef _WIN32
+    if (segment->name[0] != '\0') {
+        shm_unlink(segment->name);
+    }
+#endif  // _WIN32
+    segment->name[0] = '\0';
+}
+
+/**
+ * @brief The function creates the empty ring of kite snapshots of the client.
+ *
+ * @param transport The transport of the client.
+ * @param pid The process id of the client.
+ * @return True if the ring is mapped, otherwise false.
+ */
+bool tkbc_local_ring_create(Local_Transport *transport, uint64_t pid) {
+    transport->pid = pid;
+    transport->read_head = 0;
+    snprintf(transport->ring.name, sizeof(transport->ring.name), "/tkbc-%llu-kites", (unsigned long long) pid);
+    if (!tkbc_local_segment_create(&transport->ring, sizeof(Local_Ring))) {
+        transport->ring.name[0] = '\0';
+        return false;
+    }
+
+    Local_Ring *ring = (Local_Ring *) transport->ring.data;
+    ring->magic = TKBC_LOCAL_MAGIC;
+    ring->version = TKBC_LOCAL_VERSION;
+    atomic_store_explicit(&ring->head, 0, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief The function opens the ring of kite snapshots that the client with
+ * the given process id has created.
+ *
+ * @param transport The transport of the client on the server.
+ * @param pid The process id of the client.
+ * @return True if the ring is mapped and valid, otherwise false.
+ */
+bool tkbc_local_ring_open(Local_Transport *transport, uint64_t pid) {
+    transport->pid = pid;
+    snprintf(transport->ring.name, sizeof(transport->ring.name), "/tkbc-%llu-kites", (unsigned long long) pid);
+    if (!tkbc_local_segment_open(&transport->ring)) {
+        return false;
+    }
+
+    Local_Ring *ring = (Local_Ring *) transport->ring.data;
+    if (transport->ring.size < sizeof(*ring) || ring->magic != TKBC_LOCAL_MAGIC ||
+        ring->version != TKBC_LOCAL_VERSION) {
+        tkbc_fprintf(stderr, "ERROR", "The shared memory %s is not a valid kite ring.\n", transport->ring.name);
+        tkbc_local_segment_close(&transport->ring);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief The function checks if the active kites fit into a snapshot. Kites
+ * with a new texture need the image data of the message CLIENTKITES.
+ *
+ * @param kite_array The kites of the server.
+ * @return True if a snapshot can hold the active kites, otherwise false.
+ */
+bool tkbc_local_kites_fit(Kite_States *kite_array) {
+    size_t count = 0;
+    for (size_t i = 0; i < kite_array->count; ++i) {
+        Kite_State *kite_state = &kite_array->elements[i];
+        if (!kite_state->is_active) {
+            continue;
+        }
+        if (kite_state->kite->texture_id == -1 || kite_state->kite->is_texture_new) {
+            return false;
+        }
+        count++;
+    }
+    return count <= TKBC_LOCAL_RING_KITES;
+}
+
+/**
+ * @brief The function writes the active kites as the next snapshot to the ring
+ * of the client. The kites have to fit, see tkbc_local_kites_fit().
+ *
+ * @param transport The transport of the client on the server.
+ * @param kite_array The kites of the server.
+ */
+void tkbc_local_ring_write(Local_Transport *transport, Kite_States *kite_array) {
+    Local_Ring *ring = (Local_Ring *) transport->ring.data;
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    Local_Snapshot *slot = &ring->slots[head % TKBC_LOCAL_RING_SLOTS];
+
+    atomic_store_explicit(&slot->sequence, 2 * head + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    size_t count = 0;
+    for (size_t i = 0; i < kite_array->count && count < TKBC_LOCAL_RING_KITES; ++i) {
+        Kite_State *kite_state = &kite_array->elements[i];
+        if (!kite_state->is_active) {
+            continue;
+        }
+        slot->kites[count++] = (Local_Kite){
+            .kite_id = kite_state->kite_id,
+            .x = kite_state->kite->center.x,
+            .y = kite_state->kite->center.y,
+            .angle = fmodf(kite_state->kite->angle, 360),
+            .color = tkbc_color_to_uint32_t(kite_state->kite->body_color),
+            .texture_id = kite_state->kite->texture_id,
+            .is_reversed = kite_state->is_kite_reversed,
+            .is_active = kite_state->is_active,
+            .is_script_kite = kite_state->is_script_kite,
+        };
+    }
+    slot->count = count;
+
+    atomic_store_explicit(&slot->sequence, 2 * head + 2, memory_order_release);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+/**
+ * @brief The function copies the newest snapshot of the ring, if the server
+ * has written one since the last read. Older snapshots are skipped, because
+ * every snapshot holds the complete state of the active kites.
+ *
+ * @param transport The transport of the client.
+ * @param snapshot The snapshot the kites are copied to.
+ * @return True if a new snapshot is copied, otherwise false.
+ */
+bool tkbc_local_ring_read(Local_Transport *transport, Local_Snapshot *snapshot) {
+    Local_Ring *ring = (Local_Ring *) transport->ring.data;
+    for (size_t attempt = 0; attempt < TKBC_LOCAL_READ_ATTEMPTS; ++attempt) {
+        uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (head == transport->read_head) {
+            return false;
+        }
+
+        uint64_t number = head - 1;
+        Local_Snapshot *slot = &ring->slots[number % TKBC_LOCAL_RING_SLOTS];
+        uint64_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (sequence != 2 * number + 2) {
+            // The server already writes a newer snapshot into the slot.
+            continue;
+        }
+        uint64_t count = slot->count;
+        if (count > TKBC_LOCAL_RING_KITES) {
+            continue;
+        }
+        memcpy(snapshot->kites, slot->kites, count * sizeof(*slot->kites));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->sequence, memory_order_relaxed) != sequence) {
+            continue;
+        }
+
+        snapshot->count = count;
+        transport->read_head = head;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief The function writes the scripts from the given index on in the .kiteb
+ * layout to a new segment of the client. The segment is not mapped afterwards
+ * and the server removes it when the scripts are copied.
+ *
+ * @param transport The transport of the client.
+ * @param env The global state of the application.
+ * @param first The index of the first script in the env that is written.
+ * @return True if the segment is written, otherwise false and the scripts have
+ * to be sent in the message SCRIPT.
+ */
+bool tkbc_local_scripts_write(Local_Transport *transport, Env *env, size_t first) {
+    bool ok = true;
+    Content out = {0};
+    if (tkbc_kiteb_write_scripts(env, first, &out) != 0) {
+        check_return(false);
+    }
+
+    Local_Segment *segment = &transport->scripts;
+    snprintf(segment->name, sizeof(segment->name), "/tkbc-%llu-scripts-%llu", (unsigned long long) transport->pid,
+             (unsigned long long) transport->scripts_counter + 1);
+    if (!tkbc_local_segment_create(segment, out.count)) {
+        segment->name[0] = '\0';
+        check_return(false);
+    }
+    memcpy(segment->data, out.elements, out.count);
+    tkbc_local_segment_close(segment);
+    transport->scripts_counter++;
+
+check:
+    free(out.elements);
+    return ok;
+}
+
+/**
+ * @brief The function copies the script segment with the given number of the
+ * client into the memory of the server and removes the segment. The scripts
+ * are validated and decoded from the copy, because the client can still write
+ * to the segment.
+ *
+ * @param pid The process id of the client.
+ * @param number The number of the script segment of the client.
+ * @param scripts The content the segment is copied to.
+ * @return True if the copy holds valid scripts, otherwise false.
+ */
+bool tkbc_local_scripts_read(uint64_t pid, uint64_t number, Content *scripts) {
+    Local_Segment segment = {0};
+    snprintf(segment.name, sizeof(segment.name), "/tkbc-%llu-scripts-%llu", (unsigned long long) pid,
+             (unsigned long long) number);
+    if (!tkbc_local_segment_open(&segment)) {
+        return false;
+    }
+    scripts->count = 0;
+    tkbc_dapc(scripts, (char *) segment.data, segment.size);
+    tkbc_local_segment_close(&segment);
+
+    // The name is cleared by the unlink, so the error is reported before.
+    bool ok = tkbc_kiteb_is_valid(scripts->elements, scripts->count);
+    if (!ok) {
+        tkbc_fprintf(stderr, "ERROR", "The shared memory %s holds no valid scripts.\n", segment.name);
+    }
+    tkbc_local_segment_unlink(&segment);
+    return ok;
+}
+
+/**
+ * @brief The function closes the segments of the transport and removes the
+ * names that the client has created.
+ *
+ * @param transport The transport that is destroyed.
+ */
+void tkbc_local_transport_destroy(Local_Transport *transport) {
+    tkbc_local_segment_close(&transport->ring);
+    tkbc_local_segment_close(&transport->scripts);
+    tkbc_local_segment_unlink(&transport->ring);
+    tkbc_local_segment_unlink(&transport->scripts);
+    transport->is_active = false;
+}
@@ -0,0 +1,77 @@
+#ifndef TKBC_LOCAL_TRANSPORT_H
+#define TKBC_LOCAL_TRANSPORT_H
+
+#include "../global/tkbc-types.h"
+#include "../global/tkbc-utils.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ===========================================================================
+// ========================== Local Transport ================================
+// ===========================================================================
+
+#define TKBC_LOCAL_MAGIC 0x4c43424b  // "KBCL" the start of every ring segment.
+#define TKBC_LOCAL_VERSION 1
+#define TKBC_LOCAL_RING_SLOTS 4
+#define TKBC_LOCAL_RING_KITES 1024
+#define TKBC_LOCAL_READ_ATTEMPTS 4
+#define TKBC_LOCAL_NAME_CAPACITY 64
+
+typedef struct {
+    char name[TKBC_LOCAL_NAME_CAPACITY];  // The name of the shared memory object.
+    unsigned char *data;                  // The mapping of the segment.
+    size_t size;                          // The size of the mapping in bytes.
+} Local_Segment;                          // A shared memory segment of the client and a local server.
+
+typedef struct {
+    uint64_t kite_id;        // The id of the kite.
+    float x;                 // The x coordinate of the kite center.
+    float y;                 // The y coordinate of the kite center.
+    float angle;             // The angle of the kite in degrees.
+    uint32_t color;          // The body color of the kite.
+    int64_t texture_id;      // The id of the texture of the kite.
+    uint8_t is_reversed;     // If the kite flies reversed.
+    uint8_t is_active;       // If the kite is displayed.
+    uint8_t is_script_kite;  // If the kite belongs to a script.
+} Local_Kite;                // The state of a kite in a snapshot.
+
+typedef struct {
+    _Atomic uint64_t sequence;                // Two times the snapshot number plus one while the slot is written.
+    uint64_t count;                           // The amount of kites in the snapshot.
+    Local_Kite kites[TKBC_LOCAL_RING_KITES];  // The active kites of the tick.
+} Local_Snapshot;                             // The kites the server sends for one tick.
+
+typedef struct {
+    uint32_t magic;                                // The TKBC_LOCAL_MAGIC.
+    uint32_t version;                              // The TKBC_LOCAL_VERSION of the client.
+    _Atomic uint64_t head;                         // The amount of written snapshots.
+    Local_Snapshot slots[TKBC_LOCAL_RING_SLOTS];  // The last written snapshots.
+} Local_Ring;                                      // The lock-free ring of snapshots from the server to a client.
+
+typedef struct {
+    Local_Segment ring;        // The ring of kite snapshots from the server to the client.
+    Local_Segment scripts;     // The scripts of the client that the server has not parsed yet.
+    uint64_t pid;              // The process id of the client, that is part of the segment names.
+    uint64_t scripts_counter;  // The amount of script segments the client has created.
+    uint64_t read_head;        // The head of the ring when the client has read the last snapshot.
+    bool is_active;            // If both ends use the shared segments.
+} Local_Transport;             // The shared memory transport of a client and a server on the same host.
+
+bool tkbc_local_segment_create(Local_Segment *segment, size_t size);
+bool tkbc_local_segment_open(Local_Segment *segment);
+void tkbc_local_segment_close(Local_Segment *segment);
+void tkbc_local_segment_unlink(Local_Segment *segment);
+
+bool tkbc_local_ring_create(Local_Transport *transport, uint64_t pid);
+bool tkbc_local_ring_open(Local_Transport *transport, uint64_t pid);
+bool tkbc_local_kites_fit(Kite_States *kite_array);
+void tkbc_local_ring_write(Local_Transport *transport, Kite_States *kite_array);
+bool tkbc_local_ring_read(Local_Transport *transport, Local_Snapshot *snapshot);
+
+bool tkbc_local_scripts_write(Local_Transport *transport, Env *env, size_t first);
+bool tkbc_local_scripts_read(uint64_t pid, uint64_t number, Content *scripts);
+void tkbc_local_transport_destroy(Local_Transport *transport);
+
+#endif  // TKBC_LOCAL_TRANSPORT_H
@@ -29,6 +29,101 @@ void tkbc_reset_space_and_null_message(Space *space, Message *message) {
     space_reset_space(space);
 }
 
+/**
+ * @brief The function parses the next number of a message as a size_t
+ * directly out of the token without copying it.
+ *
+ * @param lexer The current state and data of the string to parse.
+ * @param number The variable the parsed value is assigned to.
+ * @return True if the next token is a number that fits into a size_t,
+ * otherwise false.
+ */
+bool tkbc_parse_message_size_t(Lexer *lexer, size_t *number) {
+    Token token = lexer_next(lexer);
+    return token.kind == NUMBER && tkbc_span_to_size_t(token.content, token.size, number);
+}
+
+/**
+ * @brief The function parses the next number of a message with an optional
+ * minus sign as a ssize_t directly out of the token without copying it.
+ *
+ * @param lexer The current state and data of the string to parse.
+ * @param number The variable the parsed value is assigned to.
+ * @return True if the next tokens are a number that fits into a ssize_t,
+ * otherwise false.
+ */
+bool tkbc_parse_message_ssize_t(Lexer *lexer, ssize_t *number) {
+    Token token = lexer_next(lexer);
+    bool negative = token.kind == PUNCT_SUB;
+    if (negative) {
+        token = lexer_next(lexer);
+    }
+    int64_t value = 0;
+    if (token.kind != NUMBER || !tkbc_span_to_int64_t(token.content, token.size, &value) || value > SSIZE_MAX) {
+        return false;
+    }
+    *number = negative ? -value : value;
+    return true;
+}
+
+/**
+ * @brief The function parses the next number of a message with an optional
+ * minus sign as an int directly out of the token without copying it.
+ *
+ * @param lexer The current state and data of the string to parse.
+ * @param number The variable the parsed value is assigned to.
+ * @return True if the next tokens are a number that fits into an int,
+ * otherwise false.
+ */
+bool tkbc_parse_message_int(Lexer *lexer, int *number) {
+    ssize_t value = 0;
+    if (!tkbc_parse_message_ssize_t(lexer, &value) || value < INT_MIN || value > INT_MAX) {
+        return false;
+    }
+    *number = value;
+    return true;
+}
+
+/**
+ * @brief The function parses the next number of a message as a flag, every
+ * value that is not 0 is true.
+ *
+ * @param lexer The current state and data of the string to parse.
+ * @param flag The variable the parsed value is assigned to.
+ * @return True if the next token is a number, otherwise false.
+ */
+bool tkbc_parse_message_bool(Lexer *lexer, bool *flag) {
+    size_t value = 0;
+    if (!tkbc_parse_message_size_t(lexer, &value)) {
+        return false;
+    }
+    *flag = !!value;
+    return true;
+}
+
+/**
+ * @brief The function parses the next floating point number of a message with
+ * an optional minus sign directly out of the token without copying it. The
+ * value is the same that strtof() computes for the %f output of the sender.
+ *
+ * @param lexer The current state and data of the string to parse.
+ * @param number The variable the parsed value is assigned to.
+ * @return True if the next tokens are a number, otherwise false.
+ */
+bool tkbc_parse_message_float(Lexer *lexer, float *number) {
+    Token token = lexer_next(lexer);
+    bool negative = token.kind == PUNCT_SUB;
+    if (negative) {
+        token = lexer_next(lexer);
+    }
+    float value = 0;
+    if (token.kind != NUMBER || !tkbc_span_to_float(token.content, token.size, &value)) {
+        return false;
+    }
+    *number = negative ? -value : value;
+    return true;
+}
+
 /**
  * @brief The function assigns the given values to the passed state.
  *
@@ -170,41 +265,33 @@ bool tkbc_parse_image(Lexer *lexer, Space *data_space, unsigned char **data, siz
     bool ok = true;
     Token token;
 
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    if (!tkbc_parse_message_size_t(lexer, texture_id)) {
         return false;
     }
-    *texture_id = atoll(lexer_token_to_cstr(lexer, &token));
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         return false;
     }
 
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    if (!tkbc_parse_message_size_t(lexer, width)) {
         return false;
     }
-    *width = atoll(lexer_token_to_cstr(lexer, &token));
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         return false;
     }
 
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    if (!tkbc_parse_message_size_t(lexer, height)) {
         return false;
     }
-    *height = atoll(lexer_token_to_cstr(lexer, &token));
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         return false;
     }
 
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    if (!tkbc_parse_message_size_t(lexer, format)) {
         return false;
     }
-    *format = atoll(lexer_token_to_cstr(lexer, &token));
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         return false;
@@ -227,12 +314,12 @@ bool tkbc_parse_image(Lexer *lexer, Space *data_space, unsigned char **data, siz
     size_t offset = 0;
     for (size_t y = 0; y < *height; y++) {
         for (size_t x = 0; x < *width; x++) {
-            token = lexer_next(lexer);
-            if (token.kind != NUMBER) {
+            size_t color_value;
+            if (!tkbc_parse_message_size_t(lexer, &color_value)) {
                 check_return(false);
             }
 
-            uint32_t color_number = strtoull(lexer_token_to_cstr(lexer, &token), NULL, 10);
+            uint32_t color_number = color_value;
             memcpy(*data + offset, &color_number, sizeof(color_number));
 
             token = lexer_next(lexer);
@@ -278,15 +365,11 @@ bool tkbc_parse_message_kite_value(Lexer *lexer, size_t *kite_id, float *x, floa
                                    ssize_t *texture_id, size_t *texture_width, size_t *texture_height,
                                    size_t *texture_format, Space *data_space, unsigned char **texture_data,
                                    bool *is_reversed, bool *is_active, bool *is_script_kite) {
-    Content buffer = {0};
     Token token;
     bool ok = true;
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    if (!tkbc_parse_message_size_t(lexer, kite_id)) {
         check_return(false);
     }
-
-    *kite_id = strtoul(lexer_token_to_cstr(lexer, &token), NULL, 10);
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         check_return(false);
@@ -296,41 +379,17 @@ bool tkbc_parse_message_kite_value(Lexer *lexer, size_t *kite_id, float *x, floa
         check_return(false);
     }
 
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER && token.kind != PUNCT_SUB) {
+    if (!tkbc_parse_message_float(lexer, x)) {
         check_return(false);
     }
-    if (token.kind == PUNCT_SUB) {
-        tkbc_dapc(&buffer, token.content, token.size);
-        token = lexer_next(lexer);
-        if (token.kind != NUMBER) {
-            check_return(false);
-        }
-    }
-    tkbc_dapc(&buffer, token.content, token.size);
-    tkbc_dap(&buffer, 0);
-    *x = atof(buffer.elements);
-    buffer.count = 0;
 
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COMMA) {
         check_return(false);
     }
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER && token.kind != PUNCT_SUB) {
+    if (!tkbc_parse_message_float(lexer, y)) {
         check_return(false);
     }
-    if (token.kind == PUNCT_SUB) {
-        tkbc_dapc(&buffer, token.content, token.size);
-        token = lexer_next(lexer);
-        if (token.kind != NUMBER) {
-            check_return(false);
-        }
-    }
-    tkbc_dapc(&buffer, token.content, token.size);
-    tkbc_dap(&buffer, 0);
-    *y = atof(buffer.elements);
-    buffer.count = 0;
 
     token = lexer_next(lexer);
     if (token.kind != PUNCT_RPAREN) {
@@ -341,32 +400,19 @@ bool tkbc_parse_message_kite_value(Lexer *lexer, size_t *kite_id, float *x, floa
         check_return(false);
     }
 
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER && token.kind != PUNCT_SUB) {
+    if (!tkbc_parse_message_float(lexer, angle)) {
         check_return(false);
     }
-    if (token.kind == PUNCT_SUB) {
-        tkbc_dapc(&buffer, token.content, token.size);
-        token = lexer_next(lexer);
-        if (token.kind != NUMBER) {
-            check_return(false);
-        }
-    }
-    tkbc_dapc(&buffer, token.content, token.size);
-    tkbc_dap(&buffer, 0);
-    *angle = atof(buffer.elements);
-    buffer.count = 0;
 
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         check_return(false);
     }
 
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    size_t color_number;
+    if (!tkbc_parse_message_size_t(lexer, &color_number)) {
         check_return(false);
     }
-    uint32_t color_number = atoll(lexer_token_to_cstr(lexer, &token));
     *color = tkbc_uint32_t_to_color(color_number);
 
     token = lexer_next(lexer);
@@ -376,21 +422,9 @@ bool tkbc_parse_message_kite_value(Lexer *lexer, size_t *kite_id, float *x, floa
 
     {
 
-        token = lexer_next(lexer);
-        if (token.kind != NUMBER && token.kind != PUNCT_SUB) {
+        if (!tkbc_parse_message_ssize_t(lexer, texture_id)) {
             check_return(false);
         }
-        if (token.kind == PUNCT_SUB) {
-            tkbc_dapc(&buffer, token.content, token.size);
-            token = lexer_next(lexer);
-            if (token.kind != NUMBER) {
-                check_return(false);
-            }
-        }
-        tkbc_dapc(&buffer, token.content, token.size);
-        tkbc_dap(&buffer, 0);
-        *texture_id = atoll(buffer.elements);
-        buffer.count = 0;
 
         token = lexer_next(lexer);
         if (token.kind != PUNCT_COLON) {
@@ -405,33 +439,27 @@ bool tkbc_parse_message_kite_value(Lexer *lexer, size_t *kite_id, float *x, floa
         }
     }
 
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    if (!tkbc_parse_message_bool(lexer, is_reversed)) {
         check_return(false);
     }
-    *is_reversed = !!atoi(lexer_token_to_cstr(lexer, &token));
 
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         check_return(false);
     }
 
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    if (!tkbc_parse_message_bool(lexer, is_active)) {
         check_return(false);
     }
-    *is_active = !!atoi(lexer_token_to_cstr(lexer, &token));
 
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
         check_return(false);
     }
 
-    token = lexer_next(lexer);
-    if (token.kind != NUMBER) {
+    if (!tkbc_parse_message_bool(lexer, is_script_kite)) {
         check_return(false);
     }
-    *is_script_kite = !!atoi(lexer_token_to_cstr(lexer, &token));
 
     token = lexer_next(lexer);
     if (token.kind != PUNCT_COLON) {
@@ -439,10 +467,6 @@ bool tkbc_parse_message_kite_value(Lexer *lexer, size_t *kite_id, float *x, floa
     }
 
 check:
-    if (buffer.elements) {
-        free(buffer.elements);
-        buffer.elements = NULL;
-    }
     return ok;
 }
 
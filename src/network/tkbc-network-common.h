@@ -12,6 +12,11 @@
 #include <stdio.h>
 
 void tkbc_reset_space_and_null_message(Space *space, Message *message);
+bool tkbc_parse_message_size_t(Lexer *lexer, size_t *number);
+bool tkbc_parse_message_ssize_t(Lexer *lexer, ssize_t *number);
+bool tkbc_parse_message_int(Lexer *lexer, int *number);
+bool tkbc_parse_message_bool(Lexer *lexer, bool *flag);
+bool tkbc_parse_message_float(Lexer *lexer, float *number);
 
 void tkbc_assign_values_to_kitestate(Kite_State *state, float x, float y, float angle, Color color, ssize_t texture_id,
                                      bool is_reversed, bool is_active, bool is_script_kite);
@@ -2,7 +2,7 @@
 #define TKBC_SERVERS_COMMON_H
 
 //////////////////////////////////////////////////////////////////////////////
-#define PROTOCOL_VERSION "0.3.026"
+#define PROTOCOL_VERSION "0.3.028"
 #define SERVER_CONNETCTIONS 64
 
 #define TKBC_LOGGING
@@ -46,6 +46,7 @@ typedef socklen_t SOCKLEN;
 #endif  //_WIN32
 
 #include "messages/tkbc-interface.h"
+#include "tkbc-local-transport.h"
 
 typedef struct {
     char *elements;
@@ -67,6 +68,7 @@ typedef struct {
 
     size_t script_amount;
     bool handshake_passed;
+    Local_Transport local_transport;
 } Client;
 
 typedef struct {
@@ -203,6 +203,95 @@ Test center_rotation(void) {
     return test;
 }
 
+Test center_rotation_many(void) {
+    Test test = cassert_init_test("tkbc_center_rotation_many()");
+
+    // An odd amount so the SIMD paths and the scalar tail are both used.
+#define kites_count 21
+    const size_t n = kites_count;
+    float x[kites_count], y[kites_count], angle[kites_count];
+    Kite_States kite_states = {0};
+    Kite_States expected = {0};
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = 37.5f * i;
+        y[i] = 900 - 13.0f * i;
+        angle[i] = -1080 + 117.3f * i;
+        Kite_State kite_state = tkbc_init_kite();
+        tkbc_dap(&kite_states, kite_state);
+        kite_state = tkbc_init_kite();
+        Vector2 position = {x[i], y[i]};
+        tkbc_center_rotation(kite_state.kite, &position, angle[i]);
+        tkbc_dap(&expected, kite_state);
+    }
+
+    tkbc_center_rotation_many(&kite_states, x, y, angle);
+
+    for (size_t i = 0; i < n; ++i) {
+        Kite *kite = kite_states.elements[i].kite;
+        Kite *e = expected.elements[i].kite;
+        cassert_float_eq(kite->center.x, e->center.x);
+        cassert_float_eq(kite->center.y, e->center.y);
+        cassert_float_eq(kite->angle, e->angle);
+        cassert_float_eq_epsilon(kite->left.v1.x, e->left.v1.x);
+        cassert_float_eq_epsilon(kite->left.v1.y, e->left.v1.y);
+        cassert_float_eq_epsilon(kite->left.v2.x, e->left.v2.x);
+        cassert_float_eq_epsilon(kite->left.v2.y, e->left.v2.y);
+        cassert_float_eq_epsilon(kite->left.v3.x, e->left.v3.x);
+        cassert_float_eq_epsilon(kite->left.v3.y, e->left.v3.y);
+        cassert_float_eq_epsilon(kite->right.v1.x, e->right.v1.x);
+        cassert_float_eq_epsilon(kite->right.v1.y, e->right.v1.y);
+        cassert_float_eq_epsilon(kite->right.v2.x, e->right.v2.x);
+        cassert_float_eq_epsilon(kite->right.v2.y, e->right.v2.y);
+        cassert_float_eq_epsilon(kite->right.v3.x, e->right.v3.x);
+        cassert_float_eq_epsilon(kite->right.v3.y, e->right.v3.y);
+        cassert_float_eq_epsilon(kite->rec.x, e->rec.x);
+        cassert_float_eq_epsilon(kite->rec.y, e->rec.y);
+        cassert_float_eq(kite->rec.width, e->rec.width);
+        cassert_float_eq(kite->rec.height, e->rec.height);
+    }
+
+    tkbc_destroy_kite_array(&kite_states);
+    tkbc_destroy_kite_array(&expected);
+    return test;
+}
+
+Test kite_array_materialize_geometry(void) {
+    Test test = cassert_init_test("tkbc_kite_array_materialize_geometry()");
+
+    Kite_States kite_states = {0};
+    for (size_t i = 0; i < 9; ++i) {
+        Kite_State kite_state = tkbc_init_kite();
+        kite_state.kite_id = i;
+        tkbc_dap(&kite_states, kite_state);
+    }
+    // The even kites are moved by a frame, the odd ones keep their shape.
+    for (size_t i = 0; i < kite_states.count; i += 2) {
+        Vector2 position = {50.0f * i, 300};
+        tkbc_kite_set_pose(kite_states.elements[i].kite, &position, 33.0f * i - 100);
+    }
+    Kite clean = *kite_states.elements[1].kite;
+
+    tkbc_kite_array_materialize_geometry(&kite_states);
+
+    for (size_t i = 0; i < kite_states.count; i += 2) {
+        Kite *kite = kite_states.elements[i].kite;
+        Kite expected = *kite;
+        tkbc_center_rotation(&expected, NULL, expected.angle);
+        cassert_bool_eq(kite->is_geometry_dirty, false);
+        cassert_float_eq(kite->center.x, 50.0f * i);
+        cassert_float_eq_epsilon(kite->left.v2.x, expected.left.v2.x);
+        cassert_float_eq_epsilon(kite->left.v2.y, expected.left.v2.y);
+        cassert_float_eq_epsilon(kite->right.v3.x, expected.right.v3.x);
+        cassert_float_eq_epsilon(kite->rec.y, expected.rec.y);
+    }
+    Kite *kite = kite_states.elements[1].kite;
+    cassert_float_eq(kite->left.v2.x, clean.left.v2.x);
+    cassert_float_eq(kite->rec.x, clean.rec.x);
+
+    tkbc_destroy_kite_array(&kite_states);
+    return test;
+}
+
 Test tip_rotation_left(void) {
     Test test = cassert_init_test("tkbc_tip_rotation(LEFT)");
 
@@ -303,6 +392,81 @@ Test tip_rotation_right(void) {
     return test;
 }
 
+Test scale_kites_to_window(void) {
+    Test test = cassert_init_test("tkbc_scale_kites_to_window()");
+
+    Env *env = tkbc_init_env();
+    for (size_t i = 0; i < 3; ++i) {
+        Kite_State kite_state = tkbc_init_kite();
+        kite_state.kite_id = i;
+        Vector2 position = {100.0f * (i + 1), 50};
+        tkbc_center_rotation(kite_state.kite, &position, 90);
+        kite_state.kite->old_center = position;
+        tkbc_dap(&env->kite_array, kite_state);
+    }
+    env->window_width = 800;
+    env->window_height = 600;
+
+    tkbc_scale_kites_to_window(env, 1600, 300);
+    cassert_size_t_eq(env->window_width, 1600);
+    cassert_size_t_eq(env->window_height, 300);
+
+    Kite expected = *env->kite_array.elements[1].kite;
+    Vector2 position = {400, 25};
+    tkbc_center_rotation(&expected, &position, 90);
+
+    Kite *kite = env->kite_array.elements[1].kite;
+    cassert_float_eq(kite->center.x, 400);
+    cassert_float_eq(kite->center.y, 25);
+    cassert_float_eq(kite->old_center.x, 400);
+    cassert_float_eq(kite->old_center.y, 25);
+    cassert_float_eq(kite->angle, 90);
+    cassert_float_eq(kite->left.v2.x, expected.left.v2.x);
+    cassert_float_eq(kite->right.v2.y, expected.right.v2.y);
+    cassert_float_eq(kite->rec.x, expected.rec.x);
+
+    // The same window size keeps the kites where they are.
+    tkbc_scale_kites_to_window(env, 1600, 300);
+    cassert_float_eq(kite->center.x, 400);
+    cassert_float_eq(kite->center.y, 25);
+
+    tkbc_destroy_env(env);
+    return test;
+}
+
+Test kite_set_pose(void) {
+    Test test = cassert_init_test("tkbc_kite_set_pose()");
+
+    Kite_State kite_state = tkbc_init_kite();
+    Kite kite = *kite_state.kite;
+    free(kite_state.kite);
+    cassert_bool_eq(kite.is_geometry_dirty, false);
+
+    Triangle left = kite.left;
+    Vector2 position = {200, 100};
+    tkbc_kite_set_pose(&kite, &position, 90);
+
+    cassert_bool_eq(kite.is_geometry_dirty, true);
+    cassert_float_eq(kite.center.x, position.x);
+    cassert_float_eq(kite.center.y, position.y);
+    cassert_float_eq(kite.angle, 90);
+    cassert_float_eq(kite.left.v1.x, left.v1.x);
+    cassert_set_last_cassert_description(&test, "The geometry should not be computed by setting the pose.");
+
+    Kite expected = kite;
+    tkbc_center_rotation(&expected, &position, 90);
+    tkbc_kite_materialize_geometry(&kite);
+
+    cassert_bool_eq(kite.is_geometry_dirty, false);
+    cassert_float_eq(kite.left.v1.x, expected.left.v1.x);
+    cassert_float_eq(kite.left.v2.y, expected.left.v2.y);
+    cassert_float_eq(kite.right.v3.x, expected.right.v3.x);
+    cassert_float_eq(kite.rec.x, expected.rec.x);
+    cassert_float_eq(kite.rec.y, expected.rec.y);
+
+    return test;
+}
+
 /**
  * @brief Run all geometric unit tests.
  *
@@ -310,9 +474,13 @@ Test tip_rotation_right(void) {
  */
 void tkbc_test_geometrics(Tests *tests) {
     cassert_dap(tests, center_rotation());
+    cassert_dap(tests, center_rotation_many());
+    cassert_dap(tests, kite_array_materialize_geometry());
     cassert_dap(tests, tip_rotation_left());
     cassert_dap(tests, tip_rotation_right());
     cassert_dap(tests, kite_update_internal());
     cassert_dap(tests, kite_update_position());
     cassert_dap(tests, kite_update_angle());
+    cassert_dap(tests, scale_kites_to_window());
+    cassert_dap(tests, kite_set_pose());
 }
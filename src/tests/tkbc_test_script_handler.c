@@ -1,12 +1,24 @@
 #include "../../external/cassert/cassert.h"
 
+#include "../choreographer/tkbc-collision.h"
+#include "../choreographer/tkbc-parser.h"
 #include "../choreographer/tkbc-script-api.h"
+#include "../choreographer/tkbc-script-baker.h"
+#include "../choreographer/tkbc-script-converter.h"
 #include "../choreographer/tkbc-script-handler.h"
+#include "../choreographer/tkbc-script-kiteb.h"
+#include "../choreographer/tkbc-script-plugin.h"
+#include "../choreographer/tkbc-script-reload.h"
+#include "../choreographer/tkbc-script-store.h"
+#include "../choreographer/tkbc-team-figures-api.h"
 #include "../choreographer/tkbc.h"
 #include "../global/tkbc-types.h"
 #include "../global/tkbc-utils.h"
+#include "../network/tkbc-local-transport.h"
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "../../external/space/space.h"
 #include "../global/tkbc-utils.h"
@@ -291,6 +303,47 @@ Test deep_copy_script(void) {
     return test;
 }
 
+Test deep_copy_script_interns_ids(void) {
+    Test test = cassert_init_test("tkbc_deep_copy_script() interns ids");
+    Script script = {0};
+    Frames first = {0};
+    Frames second = {0};
+    Frame frame = {0};
+
+    frame.kind = ACTION_KITE_WAIT;
+    frame.kite_id_array = tkbc_indexs_range(0, 3);
+    cassert_dap(&first, frame);
+    frame.kite_id_array = tkbc_indexs_range(3, 4);
+    cassert_dap(&first, frame);
+    frame.kite_id_array = tkbc_indexs_range(0, 3);
+    cassert_dap(&second, frame);
+    cassert_dap(&script, first);
+    cassert_dap(&script, second);
+
+    Space space = {0};
+    Script new_script = tkbc_deep_copy_script(&space, &script);
+    Kite_Ids *a = &new_script.elements[0].elements[0].kite_id_array;
+    Kite_Ids *b = &new_script.elements[0].elements[1].kite_id_array;
+    Kite_Ids *c = &new_script.elements[1].elements[0].kite_id_array;
+
+    // The set {0, 1, 2} and the set {3} are stored once.
+    cassert_size_t_eq(new_script.id_pool.count, 4);
+    cassert_ptr_eq(a->elements, c->elements);
+    cassert_ptr_neq(a->elements, b->elements);
+    cassert_size_t_eq(a->count, 3);
+    cassert_size_t_eq(b->count, 1);
+    cassert_size_t_eq(c->count, 3);
+    cassert_size_t_eq(a->elements[2], 2);
+    cassert_size_t_eq(b->elements[0], 3);
+
+    for (size_t i = 0; i < script.count; ++i) {
+        tkbc_destroy_frames_internal_data(&script.elements[i]);
+    }
+    free(script.elements);
+    space_free_space(&space);
+    return test;
+}
+
 Test destroy_frames_internal_data(void) {
     Test test = cassert_init_test("tkbc_destroy_frames_internal_data()");
     Frames frames = {0};
@@ -405,6 +458,1300 @@ Test calculate_script_byte_size_allocated(void) {
     return test;
 }
 
+Test script_arc(void) {
+    Test test = cassert_init_test("tkbc_script_arc()");
+    Kite_State kite_state = tkbc_init_kite();
+    Kite *kite = kite_state.kite;
+    kite->old_center = (Vector2){.x = 100, .y = 100};
+    kite->old_angle = 0;
+    Arc_Action arc = {.radius = 50, .begin_angle = 0, .end_angle = 90, .rotation = 90};
+
+    tkbc_script_arc(kite, &arc, 0);
+    cassert_float_eq_epsilon(kite->center.x, 100);
+    cassert_float_eq_epsilon(kite->center.y, 100);
+    cassert_float_eq(kite->angle, 0);
+
+    // Anticlockwise on the screen means up, because the y-axis points down.
+    tkbc_script_arc(kite, &arc, 0.5);
+    cassert_float_eq_epsilon(kite->center.x, 100 + 50 * (cosf(PI / 4) - 1));
+    cassert_float_eq_epsilon(kite->center.y, 100 - 50 * sinf(PI / 4));
+    cassert_float_eq(kite->angle, 45);
+
+    tkbc_script_arc(kite, &arc, 2);
+    cassert_float_eq_epsilon(kite->center.x, 50);
+    cassert_float_eq_epsilon(kite->center.y, 50);
+    cassert_float_eq(kite->angle, 90);
+
+    free(kite_state.kite);
+    return test;
+}
+
+Test script_spline(void) {
+    Test test = cassert_init_test("tkbc_script_spline()");
+    Kite_State kite_state = tkbc_init_kite();
+    Kite *kite = kite_state.kite;
+    kite->old_center = (Vector2){.x = 10, .y = 20};
+    Spline_Action spline = {
+        .control_1 = {.x = 0, .y = 100},
+        .control_2 = {.x = 100, .y = 100},
+        .position = {.x = 100, .y = 0},
+    };
+
+    tkbc_script_spline(kite, ACTION_KITE_BEZIER, &spline, 0);
+    cassert_float_eq_epsilon(kite->center.x, 10);
+    cassert_float_eq_epsilon(kite->center.y, 20);
+    tkbc_script_spline(kite, ACTION_KITE_BEZIER, &spline, 0.5);
+    cassert_float_eq_epsilon(kite->center.x, 10 + 50);
+    cassert_float_eq_epsilon(kite->center.y, 20 + 75);
+    tkbc_script_spline(kite, ACTION_KITE_BEZIER, &spline, 1);
+    cassert_float_eq_epsilon(kite->center.x, 10 + 100);
+    cassert_float_eq_epsilon(kite->center.y, 20);
+
+    // The catmull-rom path passes through the control points.
+    tkbc_script_spline(kite, ACTION_KITE_CATMULL_ROM, &spline, 1.0f / 3);
+    cassert_float_eq_epsilon(kite->center.x, 10);
+    cassert_float_eq_epsilon(kite->center.y, 20 + 100);
+    tkbc_script_spline(kite, ACTION_KITE_CATMULL_ROM, &spline, 2.0f / 3);
+    cassert_float_eq_epsilon(kite->center.x, 10 + 100);
+    cassert_float_eq_epsilon(kite->center.y, 20 + 100);
+    tkbc_script_spline(kite, ACTION_KITE_CATMULL_ROM, &spline, 1);
+    cassert_float_eq_epsilon(kite->center.x, 10 + 100);
+    cassert_float_eq_epsilon(kite->center.y, 20);
+
+    for (Easing easing = 0; easing < EASING_COUNT; ++easing) {
+        cassert_float_eq_epsilon(tkbc_ease(easing, 0), 0);
+        cassert_float_eq_epsilon(tkbc_ease(easing, 1), 1);
+        Easing parsed = EASING_COUNT;
+        const char *name = tkbc_easing_to_cstr(easing);
+        cassert_bool_eq(tkbc_easing_from_cstr(name, strlen(name), &parsed), true);
+        cassert_int_eq(parsed, easing);
+    }
+    cassert_float_eq_epsilon(tkbc_ease(EASING_CUBIC_IN, 0.5), 0.125);
+    cassert_float_eq_epsilon(tkbc_ease(EASING_CUBIC_OUT, 0.5), 0.875);
+    cassert_float_eq_epsilon(tkbc_ease(EASING_CUBIC_IN_OUT, 0.5), 0.5);
+    cassert_float_eq_epsilon(tkbc_ease(EASING_SINE_IN_OUT, 0.5), 0.5);
+    cassert_float_eq_epsilon(tkbc_ease(EASING_LINEAR, 2), 1);
+
+    free(kite_state.kite);
+    return test;
+}
+
+Test add_script_moves_scratch_script(void) {
+    Test test = cassert_init_test("tkbc_add_script() moves the scratch script");
+    Env *env = tkbc_init_env();
+    Kite_State kite_state = tkbc_init_kite();
+    kite_state.kite_id = 0;
+    tkbc_dap(&env->kite_array, kite_state);
+
+    // A small script is copied out of the large scratch space.
+    Space_Report scratch = {0};
+    space_report_allocations(&env->scratch_buf_script.space, &scratch);
+    tkbc_script_begin("copied");
+    SET(KITE_MOVE(ID(0), 100, 200, 1), KITE_ROTATION(ID(0), 90, 1));
+    Frame *frames = env->scratch_buf_script.elements[1].elements;
+    tkbc_script_end();
+
+    cassert_size_t_eq(env->scripts.count, 1);
+    Script *script = &env->scripts.elements[0];
+    cassert_ptr_neq(script->elements[1].elements, frames);
+    cassert_size_t_eq(script->elements[1].count, 2);
+    cassert_float_eq(script->elements[1].elements[0].action.as_move.position.x, 100);
+    cassert_size_t_eq(script->id_pool.count, 1);
+    cassert_ptr_eq(script->elements[1].elements[0].kite_id_array.elements, script->id_pool.elements);
+    cassert_ptr_eq(script->elements[1].elements[1].kite_id_array.elements, script->id_pool.elements);
+    Space_Report report = {0};
+    space_report_allocations(&script->space, &report);
+    bool is_small = report.allocated_capacity < scratch.allocated_capacity / 2;
+    cassert_bool_eq(is_small, true);
+    cassert_size_t_eq(script->bytes, report.allocated_capacity);
+
+    // The scratch space is reused for the next script.
+    Space_Report reused = {0};
+    space_report_allocations(&env->scratch_buf_script.space, &reused);
+    cassert_size_t_eq(reused.allocated_capacity, scratch.allocated_capacity);
+    cassert_size_t_eq(reused.allocated_count, 0);
+    cassert_ptr_eq(env->scratch_buf_script.elements, NULL);
+    cassert_size_t_eq(env->scratch_buf_frames.count, 0);
+
+    // A script that fills the scratch space is moved with the space.
+    space_free_space(&env->scratch_buf_script.space);
+    memset(&env->scratch_buf_script.space, 0, sizeof(env->scratch_buf_script.space));
+    space_init_capacity(&env->scratch_buf_script.space, 4096);
+    tkbc_script_begin("moved");
+    for (size_t i = 0; i < 64; ++i) {
+        SET(KITE_MOVE(ID(0), 100, i, 1), KITE_ROTATION(ID(0), i, 1));
+    }
+    frames = env->scratch_buf_script.elements[1].elements;
+    tkbc_script_end();
+
+    cassert_size_t_eq(env->scripts.count, 2);
+    script = &env->scripts.elements[1];
+    cassert_ptr_eq(script->elements[1].elements, frames);
+    bool name_kept = strcmp(script->name, "moved") == 0;
+    cassert_bool_eq(name_kept, true);
+    report = (Space_Report){0};
+    space_report_allocations(&script->space, &report);
+    cassert_size_t_eq(script->bytes, report.allocated_capacity);
+    cassert_ptr_eq(env->scratch_buf_script.elements, NULL);
+
+    tkbc_destroy_env(env);
+    return test;
+}
+
+Test remap_script_kite_ids_with_shared_sets(void) {
+    Test test = cassert_init_test("tkbc_remap_script_kite_id_arrays_to_kite_ids()");
+    Env *env = tkbc_init_env();
+    for (size_t i = 0; i < 2; ++i) {
+        Kite_State kite_state = tkbc_init_kite();
+        kite_state.kite_id = i;
+        tkbc_dap(&env->kite_array, kite_state);
+    }
+
+    tkbc_script_begin("shared");
+    SET(KITE_MOVE(ID(0, 1), 100, 200, 1), KITE_ROTATION(ID(0, 1), 90, 1));
+    SET(KITE_MOVE(ID(0, 1), 300, 200, 1));
+    tkbc_script_end();
+    Script *script = &env->scripts.elements[0];
+    cassert_size_t_eq(script->id_pool.count, 2);
+
+    // The frames share one set, the swap of the ids is applied only once.
+    Kite_Ids kite_ids = {0};
+    tkbc_dap(&kite_ids, 1);
+    tkbc_dap(&kite_ids, 0);
+    tkbc_remap_script_kite_id_arrays_to_kite_ids(script, kite_ids);
+    free(kite_ids.elements);
+
+    bool swapped = true;
+    for (size_t i = 1; i < script->count; ++i) {
+        for (size_t j = 0; j < script->elements[i].count; ++j) {
+            Kite_Ids *ids = &script->elements[i].elements[j].kite_id_array;
+            bool is_pool = tkbc_script_id_pool_contains(script, ids);
+            swapped = swapped && is_pool && ids->count == 2 && ids->elements[0] == 1 && ids->elements[1] == 0;
+        }
+    }
+    cassert_bool_eq(swapped, true);
+
+    tkbc_destroy_env(env);
+    return test;
+}
+
+Test script_store_evict_and_reload(void) {
+    Test test = cassert_init_test("tkbc_script_store_evict() and reload");
+    Env *env = tkbc_init_env();
+    env->tkbc_dir = "build/tkbc-test/";
+    Kite_State kite_state = tkbc_init_kite();
+    kite_state.kite_id = 0;
+    tkbc_dap(&env->kite_array, kite_state);
+
+    Frames frames = {0};
+    Frame move = {.kind = ACTION_KITE_MOVE, .duration = 0.25, .original_duration = 0.25, .index = 0};
+    move.kite_id_array = tkbc_indexs_range(0, 1);
+    move.action.as_move.position = (Vector2){.x = 100, .y = 200};
+    cassert_dap(&frames, move);
+    Script script = {.script_id = 1, .name = "first"};
+    cassert_dap(&script, frames);
+
+    tkbc_add_script(env, script);
+    size_t script_bytes = env->scripts_memory_used;
+    cassert_size_t_neq(script_bytes, 0);
+    // Room for two scripts, the names can differ in length.
+    env->scripts_memory_budget = 2 * script_bytes + script_bytes / 2;
+
+    script.script_id = 2;
+    script.name = "second";
+    tkbc_add_script(env, script);
+    script.script_id = 3;
+    script.name = "third";
+    tkbc_add_script(env, script);
+
+    // The least recently used script is spilled, its slot and name stay.
+    cassert_size_t_eq(env->scripts.count, 3);
+    cassert_bool_eq(env->scripts.elements[0].is_evicted, true);
+    cassert_size_t_eq(env->scripts.elements[0].count, 0);
+    bool name_kept = strcmp(env->scripts.elements[0].name, "first") == 0;
+    cassert_bool_eq(name_kept, true);
+    cassert_float_eq(tkbc_script_timeline_duration(&env->scripts.elements[0]), 0.25);
+    cassert_bool_eq(env->scripts.elements[1].is_evicted, false);
+    cassert_bool_eq(env->scripts.elements[2].is_evicted, false);
+
+    cassert_bool_eq(tkbc_load_script_id(env, 1, true), true);
+    Script *first = &env->scripts.elements[0];
+    cassert_ptr_eq(env->script, first);
+    cassert_bool_eq(first->is_evicted, false);
+    cassert_size_t_eq(first->count, 1);
+    cassert_size_t_eq(first->elements[0].count, 1);
+    cassert_size_t_eq(first->elements[0].elements[0].kind, ACTION_KITE_MOVE);
+    cassert_float_eq(first->elements[0].elements[0].action.as_move.position.y, 200);
+    cassert_size_t_eq(first->elements[0].elements[0].kite_id_array.count, 1);
+    cassert_size_t_eq(first->elements[0].elements[0].kite_id_array.elements[0], 0);
+    cassert_ptr_eq(first->elements[0].elements[0].kite_id_array.elements, first->id_pool.elements);
+
+    bool in_budget = env->scripts_memory_used <= env->scripts_memory_budget;
+    cassert_bool_eq(in_budget, true);
+
+    // The name of a script that was evicted before is not copied again.
+    const char *evicted_name = first->name;
+    tkbc_unload_script(env);
+    cassert_bool_eq(tkbc_script_store_evict(env, first), true);
+    cassert_ptr_eq(first->name, evicted_name);
+    cassert_bool_eq(tkbc_load_script_id(env, 1, true), true);
+
+    // Loading the second script evicts the third one, the executed first
+    // script is never evicted.
+    cassert_bool_eq(tkbc_script_store_evict(env, &env->scripts.elements[1]), true);
+    env->scripts_memory_budget = first->bytes + env->scripts.elements[2].bytes - 1;
+    cassert_bool_eq(tkbc_load_script_id(env, 2, true), true);
+    cassert_bool_eq(env->scripts.elements[0].is_evicted, false);
+    cassert_bool_eq(env->scripts.elements[1].is_evicted, false);
+    cassert_bool_eq(env->scripts.elements[2].is_evicted, true);
+
+    free(move.kite_id_array.elements);
+    free(frames.elements);
+    free(script.elements);
+    tkbc_destroy_env(env);
+    return test;
+}
+
+Test kiteb_export_and_load(void) {
+    Test test = cassert_init_test("tkbc_load_kiteb_file()");
+    const char *path = "build/tkbc-test/scripts.kiteb";
+    tkbc_make_dir_recursive_if_not_existis("build/tkbc-test");
+
+    Env *env = tkbc_init_env();
+    Kite_State kite_state = tkbc_init_kite();
+    kite_state.kite_id = 0;
+    tkbc_dap(&env->kite_array, kite_state);
+    env->kite_id_counter = 1;
+
+    tkbc_script_begin("binary");
+    SET(KITE_MOVE(ID(0), 100, 200, 1), KITE_ARC(ID(0), 50, 90, 0, 0, EASING_SINE_IN, 2));
+    SET(KITE_WAIT(0.5));
+    tkbc_script_end();
+    bool exported = tkbc_export_all_scripts_to_kiteb_file_from_mem(env, path) == 0;
+    cassert_bool_eq(exported, true);
+    tkbc_destroy_env(env);
+
+    env = tkbc_init_env();
+    bool loaded = tkbc_load_kiteb_file(env, path);
+    cassert_bool_eq(loaded, true);
+    cassert_size_t_eq(env->kite_array.count, 1);
+    cassert_size_t_eq(env->scripts.count, 1);
+    cassert_size_t_eq(env->kiteb_files.count, 1);
+
+    Script *script = &env->scripts.elements[0];
+    bool name_kept = strcmp(script->name, "binary") == 0;
+    cassert_bool_eq(name_kept, true);
+    cassert_size_t_eq(script->count, 3);
+    cassert_size_t_eq(script->elements[1].count, 2);
+    cassert_size_t_eq(script->elements[1].frames_index, 1);
+    cassert_size_t_eq(script->elements[1].kite_frame_positions.count, 1);
+    Frame *arc = &script->elements[1].elements[1];
+    cassert_size_t_eq(arc->kind, ACTION_KITE_ARC);
+    cassert_size_t_eq(arc->index, 1);
+    cassert_float_eq(arc->original_duration, 2);
+    cassert_float_eq(arc->action.as_arc.radius, 50);
+    cassert_size_t_eq(arc->action.as_arc.easing, EASING_SINE_IN);
+    cassert_float_eq(script->elements[2].elements[0].duration, 0.5);
+
+    // The interned id set is used in place from the loaded file.
+    char *file = env->kiteb_files.elements[0].data;
+    char *ids = (char *) arc->kite_id_array.elements;
+    cassert_size_t_eq(arc->kite_id_array.count, 1);
+    cassert_size_t_eq(arc->kite_id_array.elements[0], 0);
+    cassert_ptr_eq(arc->kite_id_array.elements, script->elements[1].elements[0].kite_id_array.elements);
+    bool in_file = ids >= file && ids < file + env->kiteb_files.elements[0].size;
+    cassert_bool_eq(in_file, true);
+    tkbc_destroy_env(env);
+
+    // A truncated file is rejected without adding scripts.
+    Content content = {0};
+    tkbc_read_entire_file(path, &content);
+    tkbc_write_file(path, content.elements, content.count / 2);
+    free(content.elements);
+    env = tkbc_init_env();
+    loaded = tkbc_load_kiteb_file(env, path);
+    cassert_bool_eq(loaded, false);
+    cassert_size_t_eq(env->scripts.count, 0);
+    tkbc_destroy_env(env);
+    remove(path);
+    return test;
+}
+
+Test bake_script(void) {
+    Test test = cassert_init_test("tkbc_bake_script()");
+    Env *env = tkbc_init_env();
+    Kite_State kite_state = tkbc_init_kite();
+    kite_state.kite_id = 0;
+    tkbc_dap(&env->kite_array, kite_state);
+
+    Frames frames = {0};
+    Frame wait = {.kind = ACTION_KITE_WAIT, .duration = 0.5, .original_duration = 0.5, .index = 0};
+    Frame move = {.kind = ACTION_KITE_MOVE, .duration = 0.25, .original_duration = 0.25, .index = 1};
+    move.kite_id_array = tkbc_indexs_range(0, 1);
+    move.action.as_move.position = (Vector2){.x = 100, .y = 200};
+    cassert_dap(&frames, wait);
+    cassert_dap(&frames, move);
+
+    Script script = {.script_id = 1, .name = "bake"};
+    cassert_dap(&script, frames);
+
+    Vector2 start = kite_state.kite->center;
+    Bake_Report report = {0};
+    bool finished = tkbc_bake_script(env, &script, TARGET_DT, &report);
+    cassert_bool_eq(finished, true);
+    cassert_bool_eq(report.finished, true);
+    cassert_size_t_eq(report.script_id, 1);
+    cassert_size_t_eq(report.blocks_count, 1);
+    cassert_size_t_eq(report.unfinished_blocks.count, 0);
+    // The wait needs one extra step to detect that its duration has run out.
+    cassert_float_eq_epsilon(report.duration, 0.5 + TARGET_DT);
+    cassert_size_t_eq(report.final_poses.count, 1);
+    cassert_float_eq(report.final_poses.elements[0].position.x, 100);
+    cassert_float_eq(report.final_poses.elements[0].position.y, 200);
+
+    // The bake works on a copy so the kites in the env are not moved.
+    cassert_float_eq(kite_state.kite->center.x, start.x);
+    cassert_float_eq(kite_state.kite->center.y, start.y);
+    cassert_float_eq(script.elements[0].elements[1].duration, 0.25);
+
+    tkbc_dap(&env->scripts, script);
+    script.script_id = 2;
+    tkbc_dap(&env->scripts, script);
+
+    Bake_Reports reports = {.count = 1, .elements = calloc(1, sizeof(Bake_Report))};
+    reports.elements[0] = report;
+    finished = tkbc_bake_scripts(env, 2, &reports);
+    cassert_bool_eq(finished, true);
+    cassert_size_t_eq(reports.count, 2);
+    cassert_size_t_eq(reports.elements[0].script_id, 1);
+    cassert_size_t_eq(reports.elements[1].script_id, 2);
+    cassert_float_eq(reports.elements[0].duration, reports.elements[1].duration);
+    cassert_float_eq(reports.elements[1].final_poses.elements[0].position.x, 100);
+    tkbc_destroy_bake_reports(&reports);
+
+    free(env->scripts.elements);
+    env->scripts.elements = NULL;
+    env->scripts.count = 0;
+    free(move.kite_id_array.elements);
+    free(frames.elements);
+    free(script.elements);
+    tkbc_destroy_env(env);
+    return test;
+}
+
+Test bake_script_reports_blocks_and_bounds(void) {
+    Test test = cassert_init_test("tkbc_write_bake_reports_json()");
+    Env *env = tkbc_init_env();
+    env->window_width = 400;
+    env->window_height = 300;
+    Kite_State kite_state = tkbc_init_kite();
+    kite_state.kite_id = 0;
+    Vector2 start = {.x = 200, .y = 150};
+    tkbc_center_rotation(kite_state.kite, &start, 0);
+    tkbc_dap(&env->kite_array, kite_state);
+
+    Frames inside = {0};
+    Frame stay = {.kind = ACTION_KITE_MOVE, .duration = 0.25, .original_duration = 0.25, .index = 0};
+    stay.kite_id_array = tkbc_indexs_range(0, 1);
+    stay.action.as_move.position = start;
+    cassert_dap(&inside, stay);
+
+    Frames outside = {.frames_index = 1};
+    Frame leave = stay;
+    leave.duration = leave.original_duration = 0.5;
+    leave.action.as_move.position = (Vector2){.x = 1000, .y = 150};
+    cassert_dap(&outside, leave);
+
+    Script script = {.script_id = 1, .name = "bounds \"check\""};
+    cassert_dap(&script, inside);
+    cassert_dap(&script, outside);
+
+    Bake_Report report = {0};
+    bool finished = tkbc_bake_script(env, &script, TARGET_DT, &report);
+    cassert_bool_eq(finished, true);
+    cassert_size_t_eq(report.blocks.count, 2);
+    cassert_size_t_eq(report.blocks.elements[0].block, 0);
+    cassert_size_t_eq(report.blocks.elements[1].block, 1);
+    cassert_bool_eq(report.blocks.elements[1].finished, true);
+    double blocks_duration = report.blocks.elements[0].duration + report.blocks.elements[1].duration;
+    cassert_float_eq_epsilon(blocks_duration, report.duration);
+    cassert_size_t_eq(report.out_of_bounds.count, 1);
+    cassert_size_t_eq(report.out_of_bounds.elements[0].kite_id, 0);
+    cassert_size_t_eq(report.out_of_bounds.elements[0].block, 1);
+    bool after_first_block = report.out_of_bounds.elements[0].time > report.blocks.elements[0].duration;
+    cassert_bool_eq(after_first_block, true);
+    bool far_outside = report.out_of_bounds.elements[0].excess > 600 - 1;
+    cassert_bool_eq(far_outside, true);
+    bool passed = tkbc_bake_report_passed(&report);
+    cassert_bool_eq(passed, false);
+
+    Bake_Reports reports = {0};
+    tkbc_dap(&reports, report);
+    char *json = NULL;
+    size_t json_size = 0;
+    FILE *stream = open_memstream(&json, &json_size);
+    passed = tkbc_write_bake_reports_json(stream, env, &reports);
+    fclose(stream);
+    cassert_bool_eq(passed, false);
+    bool has_passed = strstr(json, "\"passed\": false") != NULL;
+    cassert_bool_eq(has_passed, true);
+    bool has_name = strstr(json, "\"name\": \"bounds \\\"check\\\"\"") != NULL;
+    cassert_bool_eq(has_name, true);
+    bool has_window = strstr(json, "\"window\": {\"width\": 400, \"height\": 300}") != NULL;
+    cassert_bool_eq(has_window, true);
+    free(json);
+    tkbc_destroy_bake_reports(&reports);
+
+    free(stay.kite_id_array.elements);
+    free(inside.elements);
+    free(outside.elements);
+    free(script.elements);
+    tkbc_destroy_env(env);
+    return test;
+}
+
+Test collision_check_finds_close_kites(void) {
+    Test test = cassert_init_test("tkbc_collision_check()");
+    Env *env = tkbc_init_env();
+    env->window_width = 1920;
+    env->window_height = 1080;
+
+    // A grid check has to find exactly the pairs of the check of all pairs.
+    srand(42);
+    for (size_t i = 0; i < 150; ++i) {
+        Kite_State kite_state = tkbc_init_kite();
+        kite_state.kite_id = i;
+        Vector2 position = {.x = rand() % 1920, .y = rand() % 1080};
+        tkbc_center_rotation(kite_state.kite, &position, rand() % 360);
+        tkbc_dap(&env->kite_array, kite_state);
+    }
+    Collision_Grid grid = {0};
+    Kite_Proximities proximities = {0};
+    tkbc_collision_check(&grid, &env->kite_array, TKBC_COLLISION_NEAR_DISTANCE, &proximities);
+
+    size_t expected = 0;
+    for (size_t i = 0; i < env->kite_array.count; ++i) {
+        for (size_t j = i + 1; j < env->kite_array.count; ++j) {
+            Kite_Shape a, b;
+            tkbc_kite_shape(env->kite_array.elements[i].kite, &a);
+            tkbc_kite_shape(env->kite_array.elements[j].kite, &b);
+            if (tkbc_kite_shape_separation(&a, &b) <= TKBC_COLLISION_NEAR_DISTANCE) {
+                expected++;
+            }
+        }
+    }
+    cassert_size_t_eq(proximities.count, expected);
+    bool has_pairs = expected > 0;
+    cassert_bool_eq(has_pairs, true);
+
+    // Kites on top of each other touch, kites far away are not reported.
+    tkbc_destroy_kite_array(&env->kite_array);
+    env->kite_array.count = 0;
+    env->kite_array.capacity = 0;
+    Vector2 positions[] = {{.x = 100, .y = 100}, {.x = 100, .y = 100}, {.x = 1000, .y = 1000}};
+    for (size_t i = 0; i < 3; ++i) {
+        Kite_State kite_state = tkbc_init_kite();
+        kite_state.kite_id = i;
+        tkbc_center_rotation(kite_state.kite, &positions[i], 0);
+        tkbc_dap(&env->kite_array, kite_state);
+    }
+    tkbc_collision_check(&grid, &env->kite_array, TKBC_COLLISION_NEAR_DISTANCE, &proximities);
+    cassert_size_t_eq(proximities.count, 1);
+    cassert_size_t_eq(proximities.elements[0].kite_id_a, 0);
+    cassert_size_t_eq(proximities.elements[0].kite_id_b, 1);
+    cassert_float_eq(proximities.elements[0].separation, 0);
+
+    // Side by side with a gap of 10 pixels between the bounding boxes.
+    Kite_Shape shape;
+    tkbc_kite_shape(env->kite_array.elements[0].kite, &shape);
+    Vector2 beside = {.x = 100 + shape.bounds.width + 10, .y = 100};
+    tkbc_center_rotation(env->kite_array.elements[1].kite, &beside, 0);
+    tkbc_collision_check(&grid, &env->kite_array, TKBC_COLLISION_NEAR_DISTANCE, &proximities);
+    cassert_size_t_eq(proximities.count, 1);
+    bool is_spaced = proximities.elements[0].separation >= 10 - 0.01 && proximities.elements[0].separation < 11;
+    cassert_bool_eq(is_spaced, true);
+
+    // The bake reports the first contact of a block when kite 1 flies into kite 0.
+    Frames frames = {0};
+    Frame move = {.kind = ACTION_KITE_MOVE, .duration = 1, .original_duration = 1, .index = 0};
+    move.kite_id_array = tkbc_indexs_range(1, 2);
+    move.action.as_move.position = positions[0];
+    cassert_dap(&frames, move);
+    Frame stay = move;
+    stay.index = 1;
+    stay.kite_id_array = tkbc_indexs_range(0, 1);
+    cassert_dap(&frames, stay);
+    Script script = {.script_id = 1, .name = "collision"};
+    cassert_dap(&script, frames);
+
+    Bake_Report report = {0};
+    tkbc_bake_script(env, &script, TARGET_DT, &report);
+    cassert_size_t_eq(report.contacts.count, 1);
+    cassert_size_t_eq(report.contacts.elements[0].kite_id_a, 0);
+    cassert_size_t_eq(report.contacts.elements[0].kite_id_b, 1);
+    bool contact_during_move = report.contacts.elements[0].time > 0 && report.contacts.elements[0].time < 1;
+    cassert_bool_eq(contact_during_move, true);
+    cassert_size_t_eq(report.blocks.count, 1);
+    cassert_float_eq(report.blocks.elements[0].min_separation, 0);
+    bool passed = tkbc_bake_report_passed(&report);
+    cassert_bool_eq(passed, false);
+
+    Bake_Reports reports = {0};
+    tkbc_dap(&reports, report);
+    tkbc_destroy_bake_reports(&reports);
+    free(move.kite_id_array.elements);
+    free(stay.kite_id_array.elements);
+    free(frames.elements);
+    free(script.elements);
+    free(proximities.elements);
+    tkbc_collision_grid_destroy(&grid);
+    tkbc_destroy_env(env);
+    return test;
+}
+
+Test team_figures_generate_blocks_in_bulk(void) {
+    Test test = cassert_init_test("tkbc_block_begin()");
+    Env *env = tkbc_init_env();
+    env->window_width = 1920;
+    env->window_height = 1080;
+    Kite_Ids ids = tkbc_kite_array_generate(env, 100);
+
+    tkbc_script_begin("formation");
+    bool ok = tkbc_script_team_grid(env, ids, (Vector2){.x = 960, .y = 540}, (Vector2){0}, 10, 10, 10, 10, 2);
+    cassert_bool_eq(ok, true);
+    ok = tkbc_script_team_ball(env, ids, (Vector2){.x = 960, .y = 540}, (Vector2){0}, 400, 2, 1);
+    cassert_bool_eq(ok, true);
+
+    // Every kite has its own frame and exactly one start position.
+    Script *script = &env->scratch_buf_script;
+    cassert_size_t_eq(script->count, 3);
+    Frames *grid = &script->elements[1];
+    cassert_size_t_eq(grid->frames_index, 1);
+    cassert_size_t_eq(grid->count, 100);
+    cassert_size_t_eq(grid->kite_frame_positions.count, 100);
+    bool frames_match = true;
+    for (size_t i = 0; i < grid->count; ++i) {
+        Frame *frame = &grid->elements[i];
+        Kite_Position *position = &grid->kite_frame_positions.elements[i];
+        Kite *kite = tkbc_get_kite_by_id(env, ids.elements[i]);
+        frames_match = frames_match && frame->index == i && frame->kind == ACTION_KITE_MOVE &&
+                       frame->kite_id_array.count == 1 && frame->kite_id_array.elements[0] == ids.elements[i] &&
+                       position->kite_id == ids.elements[i] && position->position.x == kite->center.x &&
+                       position->position.y == kite->center.y;
+    }
+    cassert_bool_eq(frames_match, true);
+
+    // The move and the rotation of the same kite share one start position.
+    Frames *ball = &script->elements[2];
+    cassert_size_t_eq(ball->count, 200);
+    cassert_size_t_eq(ball->kite_frame_positions.count, 100);
+    cassert_size_t_eq(ball->elements[199].kite_id_array.elements[0], ids.elements[99]);
+    cassert_size_t_eq(ball->kite_frame_positions.elements[99].kite_id, ids.elements[99]);
+
+    // Outside of a block no frame is generated.
+    Frame *outside = tkbc__block_frame(env, ACTION_KITE_WAIT, 0, (Action){0}, 1);
+    cassert_ptr_eq(outside, NULL);
+
+    tkbc_script_end();
+    cassert_size_t_eq(env->scripts.count, 1);
+    cassert_size_t_eq(env->scripts.elements[0].elements[2].count, 200);
+
+    free(ids.elements);
+    tkbc_destroy_env(env);
+    return test;
+}
+
+Test plugin_reload_replaces_scripts(void) {
+    Test test = cassert_init_test("tkbc_plugin_watch_source()");
+    const char *path = "build/tkbc-test/plugin.c";
+    tkbc_make_dir_recursive_if_not_existis("build/tkbc-test");
+    const char *first = "#include \"tkbc-script-api.h\"\n"
+                        "tkbc_script_input {\n"
+                        "    Kite_Ids ki = tkbc_kite_array_generate(env, 2);\n"
+                        "    tkbc_script_begin(\"plugin\");\n"
+                        "    SET(KITE_MOVE(ID(ki.elements[0]), 100, 100, 1));\n"
+                        "    tkbc_script_end();\n"
+                        "    free(ki.elements);\n"
+                        "}\n";
+    const char *second = "#include \"tkbc-script-api.h\"\n"
+                         "tkbc_script_input {\n"
+                         "    Kite_Ids ki = tkbc_kite_array_generate(env, 3);\n"
+                         "    tkbc_script_begin(\"first\");\n"
+                         "    SET(KITE_WAIT(1));\n"
+                         "    tkbc_script_end();\n"
+                         "    tkbc_script_begin(\"second\");\n"
+                         "    SET(KITE_MOVE(ID(ki.elements[2]), 100, 100, 1));\n"
+                         "    tkbc_script_end();\n"
+                         "    free(ki.elements);\n"
+                         "}\n";
+
+    Env *env = tkbc_init_env();
+    tkbc_write_file(path, first, strlen(first));
+    bool started = tkbc_plugin_watch_source(env, path);
+    cassert_bool_eq(started, true);
+    // The compiler runs in the background, nothing is loaded before it ends.
+    bool is_building = env->plugin.build_pid > 0;
+    cassert_bool_eq(is_building, true);
+    cassert_size_t_eq(env->scripts.count, 0);
+    bool loaded = tkbc_plugin_wait(env);
+    cassert_bool_eq(loaded, true);
+    cassert_size_t_eq(env->scripts.count, 1);
+    cassert_size_t_eq(env->kite_array.count, 2);
+    bool name_kept = strcmp(env->scripts.elements[0].name, "plugin") == 0;
+    cassert_bool_eq(name_kept, true);
+
+    // The new version replaces the scripts and the kites of the old one.
+    tkbc_write_file(path, second, strlen(second));
+    started = tkbc_plugin_watch_source(env, path);
+    loaded = started && tkbc_plugin_wait(env);
+    cassert_bool_eq(loaded, true);
+    cassert_size_t_eq(env->scripts.count, 2);
+    cassert_size_t_eq(env->kite_array.count, 3);
+    cassert_size_t_eq(env->kite_id_counter, 3);
+    cassert_size_t_eq(env->scripts.elements[1].elements[1].elements[0].kite_id_array.elements[0], 2);
+
+    // A broken version keeps the loaded one.
+    tkbc_write_file(path, "broken", strlen("broken"));
+    started = tkbc_plugin_watch_source(env, path);
+    cassert_bool_eq(started, true);
+    loaded = tkbc_plugin_wait(env);
+    cassert_bool_eq(loaded, false);
+    is_building = env->plugin.build_pid > 0;
+    cassert_bool_eq(is_building, false);
+    cassert_size_t_eq(env->scripts.count, 2);
+    cassert_ptr_neq(env->plugin.source_path, NULL);
+
+    tkbc_destroy_env(env);
+    remove(path);
+    return test;
+}
+
+Test reload_kite_file_parses_changed_sections(void) {
+    Test test = cassert_init_test("tkbc_reload_kite_file()");
+    const char *path = "build/tkbc-test/reload.kite";
+    tkbc_make_dir_recursive_if_not_existis("build/tkbc-test");
+    const char *first = "KITES 2\n"
+                        "BEGIN\n  MOVE KITES 0 100 1\nEND\n"
+                        "BEGIN\n  ROTATION KITES 90 1\n  WAIT 1\nEND\n"
+                        "BEGIN\n  WAIT 2\nEND\n";
+    // The first section only changes a comment, the second one changes its
+    // actions and the third one is removed.
+    const char *second = "KITES 2\n"
+                         "BEGIN\n  // Moves up.\n  MOVE KITES 0 100 1\nEND\n"
+                         "BEGIN\n  ROTATION KITES 180 1\nEND\n";
+
+    Env *env = tkbc_init_env();
+    tkbc_write_file(path, first, strlen(first));
+    bool loaded = tkbc_reload_kite_file(env, path);
+    cassert_bool_eq(loaded, true);
+    cassert_size_t_eq(env->scripts.count, 3);
+    cassert_size_t_eq(env->kite_watch.sections.count, 3);
+    Script *unchanged = &env->scripts.elements[0];
+    Space unchanged_space = unchanged->space;
+
+    // The second script is executed at its second block.
+    cassert_bool_eq(tkbc_load_script_id(env, 2, true), true);
+    env->frames = &env->script->elements[2];
+
+    tkbc_write_file(path, second, strlen(second));
+    loaded = tkbc_reload_kite_file(env, path);
+    cassert_bool_eq(loaded, true);
+    cassert_size_t_eq(env->scripts.count, 2);
+    cassert_size_t_eq(env->scripts.elements[0].script_id, 1);
+    cassert_size_t_eq(env->scripts.elements[1].script_id, 2);
+    bool kept = memcmp(&env->scripts.elements[0].space, &unchanged_space, sizeof(unchanged_space)) == 0;
+    cassert_bool_eq(kept, true);
+
+    // The replaced script keeps its id and continues at the last block it has.
+    cassert_ptr_eq(env->script, &env->scripts.elements[1]);
+    cassert_ptr_eq(env->frames, &env->script->elements[env->script->count - 1]);
+    cassert_float_eq(env->script->elements[1].elements[0].action.as_rotation.angle, 180);
+
+    tkbc_destroy_env(env);
+    remove(path);
+    return test;
+}
+
+Test stream_kite_file_loads_scripts_progressively(void) {
+    Test test = cassert_init_test("tkbc_kite_load_poll()");
+    const char *path = "build/tkbc-test/stream.kite";
+    tkbc_make_dir_recursive_if_not_existis("build/tkbc-test");
+    const char *content = "KITES 2\n"
+                          "BEGIN\n  MOVE KITES 0 100 1\nEND\n"
+                          "// The END in here is just a comment.\n"
+                          "BEGIN\n  ROTATION KITES 90 1\n  WAIT 1\nEND\n"
+                          "BEGIN\n  WAIT 2\nEND\n";
+    tkbc_write_file(path, content, strlen(content));
+
+    // The tiny chunks cut the tokens, but every piece still ends after an END.
+    Kite_Sections sections = {0};
+    uint64_t prelude_hash = tkbc_scan_kite_sections(path, (char *)content, strlen(content), &sections);
+    Kite_Stream stream = {0};
+    bool opened = tkbc_kite_stream_open(&stream, path, 3);
+    cassert_bool_eq(opened, true);
+    char *piece = NULL;
+    size_t size = 0;
+    size_t pieces = 0;
+    while (tkbc_kite_stream_next(&stream, &piece, &size)) {
+        bool ends_with_end = size >= 3 && strncmp(piece + size - 3, "END", 3) == 0;
+        cassert_bool_eq(ends_with_end, true);
+        cassert_bool_eq(stream.section_ended, true);
+        if (pieces < sections.count) {
+            cassert_uint64_t_eq(stream.section_hash, sections.elements[pieces].hash);
+        }
+        pieces++;
+    }
+    cassert_size_t_eq(pieces, 3);
+    cassert_uint64_t_eq(stream.prelude_hash, prelude_hash);
+    tkbc_kite_stream_close(&stream);
+    free(sections.elements);
+
+    // A budget of 0 loads one section per poll.
+    Env *env = tkbc_init_env();
+    bool started = tkbc_kite_load_start(env, path);
+    cassert_bool_eq(started, true);
+    bool running = tkbc_kite_load_poll(env, 0);
+    cassert_bool_eq(running, true);
+    cassert_size_t_eq(env->scripts.count, 1);
+    cassert_ptr_eq(env->kite_watch.path, NULL);
+    while (tkbc_kite_load_poll(env, 0)) {
+    }
+    cassert_size_t_eq(env->scripts.count, 3);
+    cassert_ptr_eq(env->kite_load, NULL);
+    cassert_size_t_eq(env->kite_watch.sections.count, 3);
+    cassert_size_t_eq(env->kite_watch.sections.elements[2].script_id, 3);
+    cassert_size_t_eq(env->scripts.elements[1].count, 3);
+
+    tkbc_destroy_env(env);
+    remove(path);
+    return test;
+}
+
+Test kite_keywords_and_team_figures_use_perfect_hash(void) {
+    Test test = cassert_init_test("tkbc_kite_keyword()");
+    Kite_Keyword keyword = tkbc_kite_keyword("MOVE_ADD", strlen("MOVE_ADD"));
+    cassert_int_eq(keyword, KITE_KEYWORD_MOVE_ADD);
+    keyword = tkbc_kite_keyword("TIP_ROTATION", strlen("TIP_ROTATION"));
+    cassert_int_eq(keyword, KITE_KEYWORD_TIP_ROTATION);
+    // A keyword has to match completely and not just as a prefix.
+    keyword = tkbc_kite_keyword("MOVE_ADD", strlen("MOVE_AD"));
+    cassert_int_eq(keyword, KITE_KEYWORD_NONE);
+    keyword = tkbc_kite_keyword("MOV", strlen("MOV"));
+    cassert_int_eq(keyword, KITE_KEYWORD_NONE);
+
+    const Team_Figure_Schema *schema = tkbc_team_figure_schema("TEAM_GRID", strlen("TEAM_GRID"));
+    cassert_ptr_neq(schema, NULL);
+    cassert_size_t_eq(schema->arity, 9);
+    cassert_int_eq(schema->kinds[6], FIGURE_ARG_SIZE_T);
+    schema = tkbc_team_figure_schema("TEAM_NONE", strlen("TEAM_NONE"));
+    cassert_ptr_eq(schema, NULL);
+
+    // The schema parses the arguments of every kind.
+    Env *env = tkbc_init_env();
+    env->window_width = 1920;
+    env->window_height = 1080;
+    char content[] = "KITES 4\n"
+                     "BEGIN\n"
+                     "EXTERN TEAM_ROLL_SPLIT_UP KITES ODD 100 0 90 1\n"
+                     "EXTERN TEAM_BOX KITES LEFT -90 100 1 1\n"
+                     "EXTERN TEAM_BALL KITES 900 500 0 0 200 1 1\n"
+                     "END\n";
+    tkbc_script_parser_content(env, "figures.kite", content, strlen(content), NULL, 0);
+    cassert_size_t_eq(env->scripts.count, 1);
+    bool has_frames = env->scripts.count == 1 && env->scripts.elements[0].count > 3;
+    cassert_bool_eq(has_frames, true);
+
+    tkbc_destroy_env(env);
+    return test;
+}
+
+Test parse_numbers_from_token_spans(void) {
+    Test test = cassert_init_test("tkbc_span_to_float()");
+    // The span does not have to be null terminated.
+    const char *span = "123.5:42:-7:18446744073709551616";
+    float f = 0;
+    bool ok = tkbc_span_to_float(span, 5, &f);
+    cassert_bool_eq(ok, true);
+    cassert_float_eq(f, 123.5f);
+    size_t size = 0;
+    ok = tkbc_span_to_size_t(span + 6, 2, &size);
+    cassert_bool_eq(ok, true);
+    cassert_size_t_eq(size, 42);
+    int number = 0;
+    ok = tkbc_span_to_int(span + 9, 2, &number);
+    bool is_negative = ok && number == -7;
+    cassert_bool_eq(is_negative, true);
+    uint64_t too_big = 0;
+    ok = tkbc_span_to_uint64_t(span + 12, strlen(span + 12), &too_big);
+    cassert_bool_eq(ok, false);
+    ok = tkbc_span_to_size_t("4.5", 3, &size);
+    cassert_bool_eq(ok, false);
+    ok = tkbc_span_to_float("1.5.", 4, &f);
+    cassert_bool_eq(ok, false);
+    ok = tkbc_span_to_float("", 0, &f);
+    cassert_bool_eq(ok, false);
+
+    // Every value of the %f and %G printers is parsed to the same bits as
+    // strtof() and strtod() would do.
+    srand(7);
+    size_t mismatches = 0;
+    const char *formats[] = {"%f", "%G", "%.9G", "%.17G", "%.3f", "%e"};
+    for (size_t i = 0; i < 20000; ++i) {
+        double value = ((double)rand() / RAND_MAX - 0.5) * pow(10, rand() % 24 - 8);
+        for (size_t j = 0; j < ARRAY_LENGTH(formats); ++j) {
+            char buffer[512];
+            int n = snprintf(buffer, sizeof(buffer), formats[j], value);
+            float span_float = 0;
+            double span_double = 0;
+            bool parsed = tkbc_span_to_float(buffer, n, &span_float) && tkbc_span_to_double(buffer, n, &span_double);
+            float libc_float = strtof(buffer, NULL);
+            double libc_double = strtod(buffer, NULL);
+            if (!parsed || memcmp(&span_float, &libc_float, sizeof(float)) != 0 ||
+                memcmp(&span_double, &libc_double, sizeof(double)) != 0) {
+                mismatches++;
+            }
+        }
+    }
+    cassert_size_t_eq(mismatches, 0);
+    return test;
+}
+
+Test export_kite_file_with_id_set_and_float_format(void) {
+    Test test = cassert_init_test("tkbc_export_script_to_dot_kite_file_from_mem()");
+    Kite_Id_Set set = {0};
+    for (Id id = 0; id < 100; ++id) {
+        tkbc_kite_id_set_insert(&set, id % 40);
+    }
+    cassert_size_t_eq(set.count, 40);
+    bool inserted = tkbc_kite_id_set_insert(&set, 7);
+    cassert_bool_eq(inserted, false);
+    tkbc_kite_id_set_destroy(&set);
+
+    // The float format is the same as the one of %G.
+    srand(11);
+    size_t mismatches = 0;
+    float specials[] = {0.0f, -0.0f, 0.5f, 0.0001f, 2.5e-5f, 999999.5f, 1e6f, 123456.5f, 0.125f, -1.5e10f};
+    for (size_t i = 0; i < 20000 + ARRAY_LENGTH(specials); ++i) {
+        float value = i < ARRAY_LENGTH(specials) ? specials[i]
+                                                 : ((float)rand() / RAND_MAX - 0.5f) * powf(10, rand() % 16 - 6);
+        char expected[TKBC_FLOAT_CSTR_SIZE];
+        char actual[TKBC_FLOAT_CSTR_SIZE];
+        snprintf(expected, sizeof(expected), "%G", value);
+        tkbc_format_float(actual, sizeof(actual), value);
+        mismatches += strcmp(expected, actual) != 0;
+    }
+    cassert_size_t_eq(mismatches, 0);
+
+    Env *env = tkbc_init_env();
+    char content[] = "KITES 3\n"
+                     "BEGIN\n"
+                     "MOVE (0 2) -12.5 300 1.5\n"
+                     "{ ROTATION (2) 45 1 TIP_ROTATION (0) 90 LEFT 2 }\n"
+                     "END\n";
+    tkbc_script_parser_content(env, "export.kite", content, strlen(content), NULL, 0);
+    cassert_size_t_eq(env->scripts.count, 1);
+    const char *path = "build/tkbc-test/export.kite";
+    tkbc_make_dir_recursive_if_not_existis("build/tkbc-test");
+    int err = env->scripts.count == 1 ? tkbc_export_script_to_dot_kite_file_from_mem(&env->scripts.elements[0], path)
+                                      : 1;
+    bool exported_ok = err == 0;
+    cassert_bool_eq(exported_ok, true);
+    Content exported = {0};
+    tkbc_read_file(path, &exported);
+    tkbc_dap(&exported, 0);
+    // The parser starts every script with a WAIT block.
+    const char *expected = "KITES 2\n"
+                           "BEGIN\n"
+                           "WAIT 0\n"
+                           "MOVE (0 2) -12.5 300 1.5\n"
+                           "{\n"
+                           "ROTATION (2) 45 1\n"
+                           "TIP_ROTATION (0) 90 LEFT 2\n"
+                           "}\n"
+                           "END\n";
+    bool is_expected = strcmp(exported.elements, expected) == 0;
+    cassert_bool_eq(is_expected, true);
+    free(exported.elements);
+
+    tkbc_destroy_env(env);
+    return test;
+}
+
+Test parse_kite_file_sections_in_parallel(void) {
+    Test test = cassert_init_test("tkbc_kite_batch_parse()");
+    const char *path = "build/tkbc-test/parallel.kite";
+    tkbc_make_dir_recursive_if_not_existis("build/tkbc-test");
+    Content content = {0};
+    tkbc_dapc(&content, "KITES 3\n", strlen("KITES 3\n"));
+    for (size_t i = 0; i < 40; ++i) {
+        char section[128];
+        int n = snprintf(section, sizeof(section), "BEGIN\n  MOVE KITES %zu 100 1\n  { ROTATION (0 1) %zu 1 }\nEND\n",
+                         i * 10, i);
+        tkbc_dapc(&content, section, n);
+    }
+    tkbc_write_file(path, content.elements, content.count);
+    free(content.elements);
+
+    // The parallel parse ends in the same scripts as the sequential one.
+    Env *sequential = tkbc_init_env();
+    sequential->window_width = 1920;
+    sequential->window_height = 1080;
+    bool parsed = tkbc_script_parser_file(sequential, path, 1);
+    cassert_bool_eq(parsed, true);
+    Env *parallel = tkbc_init_env();
+    parallel->window_width = 1920;
+    parallel->window_height = 1080;
+    parsed = tkbc_script_parser_file(parallel, path, 4);
+    cassert_bool_eq(parsed, true);
+
+    cassert_size_t_eq(sequential->scripts.count, 40);
+    cassert_size_t_eq(parallel->scripts.count, 40);
+    cassert_size_t_eq(parallel->script_id_counter, sequential->script_id_counter);
+    bool same = true;
+    for (size_t i = 0; i < 40 && parallel->scripts.count == 40; ++i) {
+        Script *a = &sequential->scripts.elements[i];
+        Script *b = &parallel->scripts.elements[i];
+        same = same && a->script_id == b->script_id && strcmp(a->name, b->name) == 0 && a->count == b->count;
+        Frame *frame = &b->elements[b->count - 1].elements[0];
+        same = same && frame->action.as_rotation.angle == (float)i;
+        same = same && frame->kite_id_array.count == 2;
+    }
+    cassert_bool_eq(same, true);
+    // A script of a worker env is handed over without a second timeline.
+    Script handed = sequential->scripts.elements[--sequential->scripts.count];
+    Env *receiver = tkbc_init_env();
+    tkbc_add_built_script(receiver, handed);
+    bool same_timeline = receiver->scripts.count == 1 &&
+                         receiver->scripts.elements[0].timeline.elements == handed.timeline.elements;
+    cassert_bool_eq(same_timeline, true);
+    cassert_size_t_eq(receiver->scripts_memory_used, handed.bytes);
+    tkbc_destroy_env(receiver);
+    bool is_script_kite = parallel->kite_array.count == 3 && parallel->kite_array.elements[2].is_script_kite;
+    cassert_bool_eq(is_script_kite, true);
+
+    tkbc_destroy_env(sequential);
+    tkbc_destroy_env(parallel);
+    remove(path);
+    return test;
+}
+
+Test expand_repeat_for_and_define_blocks(void) {
+    Test test = cassert_init_test("tkbc_parse_expansion()");
+    const char *path = "build/tkbc-test/macros.kite";
+    tkbc_make_dir_recursive_if_not_existis("build/tkbc-test");
+    const char *macros = "KITES 3\n"
+                         "DEFINE SWING(angle duration)\n"
+                         "{ ROTATION (0) angle duration TIP_ROTATION (1) angle LEFT duration }\n"
+                         "END\n"
+                         "BEGIN\n"
+                         "REPEAT 2 {\n"
+                         "    MOVE KITES 10 -20 1\n"
+                         "    SWING(-45 0.5)\n"
+                         "}\n"
+                         "FOR k IN (0 2) { MOVE (k) k 100 1 }\n"
+                         "END\n";
+    tkbc_write_file(path, macros, strlen(macros));
+    char expanded[] = "KITES 3\n"
+                      "BEGIN\n"
+                      "MOVE KITES 10 -20 1\n"
+                      "{ ROTATION (0) -45 0.5 TIP_ROTATION (1) -45 LEFT 0.5 }\n"
+                      "MOVE KITES 10 -20 1\n"
+                      "{ ROTATION (0) -45 0.5 TIP_ROTATION (1) -45 LEFT 0.5 }\n"
+                      "MOVE (0) 0 100 1\n"
+                      "MOVE (2) 2 100 1\n"
+                      "END\n";
+
+    // The expansions end in the same frames as the written out script, also
+    // if the section is parsed on a worker thread.
+    Env *env = tkbc_init_env();
+    tkbc_script_parser_content(env, "expanded.kite", expanded, strlen(expanded), NULL, 0);
+    bool parsed = tkbc_script_parser_file(env, path, 2);
+    cassert_bool_eq(parsed, true);
+    cassert_size_t_eq(env->scripts.count, 2);
+    bool same = env->scripts.count == 2;
+    if (same) {
+        const char *paths[] = {"build/tkbc-test/expanded.kite", "build/tkbc-test/macros-export.kite"};
+        Content exported[2] = {0};
+        for (size_t i = 0; i < 2; ++i) {
+            tkbc_export_script_to_dot_kite_file_from_mem(&env->scripts.elements[i], paths[i]);
+            tkbc_read_file(paths[i], &exported[i]);
+            remove(paths[i]);
+        }
+        same = exported[0].count > 0 && exported[0].count == exported[1].count &&
+               memcmp(exported[0].elements, exported[1].elements, exported[0].count) == 0;
+        free(exported[0].elements);
+        free(exported[1].elements);
+        cassert_size_t_eq(env->scripts.elements[1].count, 7);
+    }
+    cassert_bool_eq(same, true);
+    tkbc_destroy_env(env);
+
+    // A macro that calls itself is stopped at the maximum depth.
+    env = tkbc_init_env();
+    char recursive[] = "KITES 1\n"
+                       "DEFINE LOOP() MOVE KITES 1 1 0 LOOP() END\n"
+                       "BEGIN LOOP() END\n";
+    tkbc_script_parser_content(env, "recursive.kite", recursive, strlen(recursive), NULL, 0);
+    cassert_size_t_eq(env->scripts.count, 1);
+    bool is_limited = env->scripts.count == 1 && env->scripts.elements[0].count == TKBC_KITE_EXPANSION_DEPTH_MAX + 1;
+    cassert_bool_eq(is_limited, true);
+    tkbc_destroy_env(env);
+    remove(path);
+    return test;
+}
+
+Test optimize_script_fuses_and_removes_frames(void) {
+    Test test = cassert_init_test("tkbc_optimize_script()");
+    Env *env = tkbc_init_env();
+    char content[] = "KITES 2\n"
+                     "BEGIN\n"
+                     "MOVE_ADD KITES 100 0 1\n"
+                     "MOVE_ADD KITES 100 0 1\n"
+                     "MOVE_ADD KITES 50 0 0.5\n"
+                     "WAIT 0\n"
+                     "ROTATION_ADD (0) 45 1\n"
+                     "ROTATION_ADD (0) 90 2\n"
+                     "{ MOVE_ADD (0) 0 0 1 MOVE_ADD (1) 0 10 1 }\n"
+                     "WAIT 1\n"
+                     "WAIT 2\n"
+                     "MOVE_ADD KITES 10 0 1\n"
+                     "MOVE_ADD KITES 10 0 2\n"
+                     "END\n";
+    tkbc_script_parser_content(env, "optimize.kite", content, strlen(content), NULL, 0);
+    cassert_size_t_eq(env->scripts.count, 1);
+    cassert_size_t_eq(env->script_optimization.scripts, 1);
+    cassert_size_t_eq(env->script_optimization.blocks_before, 12);
+    cassert_size_t_eq(env->script_optimization.frames_before, 13);
+    cassert_size_t_eq(env->script_optimization.blocks_after, 7);
+    cassert_size_t_eq(env->script_optimization.frames_after, 8);
+
+    if (env->scripts.count == 1 && env->scripts.elements[0].count == 7) {
+        Script *script = &env->scripts.elements[0];
+        // The moves with the same speed are one block, the slower one is not.
+        Frame *move = &script->elements[1].elements[0];
+        cassert_float_eq(move->action.as_move_add.position.x, 250);
+        cassert_float_eq(move->duration, 2.5);
+        Frame *rotation = &script->elements[2].elements[0];
+        cassert_float_eq(rotation->action.as_rotation_add.angle, 135);
+        cassert_float_eq(rotation->duration, 3);
+        // The no-op move is a WAIT that keeps the block as long as before.
+        bool is_wait = script->elements[3].count == 2 && script->elements[3].elements[0].kind == ACTION_KITE_WAIT;
+        cassert_bool_eq(is_wait, true);
+        cassert_float_eq(script->elements[4].elements[0].duration, 3);
+        cassert_float_eq(script->elements[6].elements[0].duration, 2);
+
+        // The optimized script still ends at the same poses.
+        Kite *kite = env->kite_array.elements[0].kite;
+        Vector2 start = kite->center;
+        float angle = kite->angle;
+        Bake_Report report = {0};
+        bool finished = tkbc_bake_script(env, script, TARGET_DT, &report);
+        cassert_bool_eq(finished, true);
+        cassert_float_eq_epsilon(report.final_poses.elements[0].position.x, start.x + 270);
+        cassert_float_eq_epsilon(report.final_poses.elements[0].position.y, start.y);
+        cassert_float_eq_epsilon(report.final_poses.elements[0].angle, angle + 135);
+        Bake_Reports reports = {0};
+        tkbc_dap(&reports, report);
+        tkbc_destroy_bake_reports(&reports);
+    }
+    cassert_size_t_eq(env->scripts.elements[0].count, 7);
+
+    tkbc_destroy_env(env);
+    return test;
+}
+
+Test parse_kite_file_collects_diagnostics(void) {
+    Test test = cassert_init_test("tkbc_kite_diagnostic()");
+    Env *env = tkbc_init_env();
+    char content[] = "KITES 2\n"
+                     "BEGIN\n"
+                     "MOVE (0 7 9) 10 10 1\n"
+                     "MOVE (0) 10 10 1\n"
+                     "WAIT x\n"
+                     "{ MOVE (1) 5 5 1\n"
+                     "BEGIN\n"
+                     "EXTERN UNKNOWN_FIGURE KITES 1\n"
+                     "ROTATION (1) 45 1\n"
+                     "END\n"
+                     "END\n"
+                     "BEGIN\n"
+                     "MOVE (0) 1 1 1\n";
+    tkbc_script_parser_content(env, "diagnostics.kite", content, strlen(content), NULL, 0);
+
+    // Every error is reported and the valid statements after it are parsed.
+    cassert_size_t_eq(env->kite_diagnostics.count, 6);
+    cassert_size_t_eq(env->scripts.count, 3);
+    if (env->kite_diagnostics.count == 6) {
+        Kite_Diagnostic *diagnostics = env->kite_diagnostics.elements;
+        bool names_ids = strstr(diagnostics[0].message, "kites 7 9 in the listing") != NULL;
+        cassert_bool_eq(names_ids, true);
+        bool is_line = diagnostics[0].line == 3 && diagnostics[1].line == 5 && diagnostics[2].line == 7;
+        cassert_bool_eq(is_line, true);
+        bool is_unknown = strstr(diagnostics[3].message, "UNKNOWN_FIGURE") != NULL;
+        cassert_bool_eq(is_unknown, true);
+    }
+    if (env->scripts.count == 3) {
+        cassert_size_t_eq(env->scripts.elements[0].count, 3);
+        cassert_size_t_eq(env->scripts.elements[1].count, 2);
+        cassert_size_t_eq(env->scripts.elements[2].count, 2);
+    }
+
+    // The token that breaks a statement is reported at its location and a
+    // second error in the skipped tokens is reported as well.
+    char skipped[] = "KITES 2\n"
+                     "BEGIN\n"
+                     "ROTATION KITES 0 x 1 $\n"
+                     "MOVE KITES 0 abc 1\n"
+                     "END\n";
+    tkbc_script_parser_content(env, "skipped.kite", skipped, strlen(skipped), NULL, 0);
+    cassert_size_t_eq(env->kite_diagnostics.count, 3);
+    if (env->kite_diagnostics.count == 3) {
+        Kite_Diagnostic *diagnostics = env->kite_diagnostics.elements;
+        bool names_token = strstr(diagnostics[0].message, "ROTATION: x") != NULL;
+        cassert_bool_eq(names_token, true);
+        bool is_location = diagnostics[0].line == 3 && diagnostics[0].column == 18;
+        cassert_bool_eq(is_location, true);
+        bool is_skipped = strstr(diagnostics[1].message, "$") != NULL && diagnostics[1].line == 3;
+        cassert_bool_eq(is_skipped, true);
+        bool is_next = strstr(diagnostics[2].message, "MOVE: abc") != NULL && diagnostics[2].line == 4;
+        cassert_bool_eq(is_next, true);
+    }
+
+    // The errors of the next file replace the ones of the last file.
+    char valid[] = "KITES 1\nBEGIN MOVE (0) 1 1 1 END\n";
+    tkbc_script_parser_content(env, "valid.kite", valid, strlen(valid), NULL, 0);
+    cassert_size_t_eq(env->kite_diagnostics.count, 0);
+    tkbc_destroy_env(env);
+    return test;
+}
+
+Test local_transport_shares_scripts_and_kites(void) {
+    Test test = cassert_init_test("tkbc_local_ring_read()");
+    static Local_Snapshot snapshot = {0};
+
+    Env *env = tkbc_init_env();
+    Kite_State kite_state = tkbc_init_kite();
+    kite_state.kite_id = 0;
+    kite_state.kite->center = (Vector2){10, 20};
+    tkbc_dap(&env->kite_array, kite_state);
+    env->kite_id_counter = 1;
+
+    Local_Transport client = {0};
+    Local_Transport server = {0};
+    bool created = tkbc_local_ring_create(&client, getpid());
+    cassert_bool_eq(created, true);
+    bool opened = tkbc_local_ring_open(&server, getpid());
+    cassert_bool_eq(opened, true);
+    bool read = tkbc_local_ring_read(&client, &snapshot);
+    cassert_bool_eq(read, false);
+    bool fit = tkbc_local_kites_fit(&env->kite_array);
+    cassert_bool_eq(fit, true);
+
+    // More snapshots than slots are written, the client only reads the newest.
+    for (size_t i = 0; i <= TKBC_LOCAL_RING_SLOTS; ++i) {
+        env->kite_array.elements[0].kite->center.x = 10 + i;
+        tkbc_local_ring_write(&server, &env->kite_array);
+    }
+    read = tkbc_local_ring_read(&client, &snapshot);
+    cassert_bool_eq(read, true);
+    cassert_size_t_eq(snapshot.count, 1);
+    cassert_size_t_eq(snapshot.kites[0].kite_id, 0);
+    cassert_float_eq(snapshot.kites[0].x, 10 + TKBC_LOCAL_RING_SLOTS);
+    cassert_float_eq(snapshot.kites[0].y, 20);
+    read = tkbc_local_ring_read(&client, &snapshot);
+    cassert_bool_eq(read, false);
+
+    tkbc_script_begin("local");
+    SET(KITE_MOVE(ID(0), 100, 200, 1), KITE_ARC(ID(0), 50, 90, 0, 0, EASING_SINE_IN, 2));
+    SET(KITE_WAIT(0.5));
+    tkbc_script_end();
+    bool written = tkbc_local_scripts_write(&client, env, 0);
+    cassert_bool_eq(written, true);
+    // The server decodes its own copy, the segment is removed when it is read.
+    Content scripts = {0};
+    bool read_scripts = tkbc_local_scripts_read(getpid(), client.scripts_counter, &scripts);
+    cassert_bool_eq(read_scripts, true);
+
+    if (read_scripts) {
+        cassert_size_t_eq(tkbc_kiteb_scripts_count(scripts.elements), 1);
+        Space space = {0};
+        Script script = {0};
+        tkbc_kiteb_copy_script(scripts.elements, 0, &space, &script);
+        cassert_size_t_eq(script.script_id, env->scripts.elements[0].script_id);
+        cassert_size_t_eq(script.count, 3);
+        cassert_size_t_eq(script.elements[1].count, 2);
+        Frame *arc = &script.elements[1].elements[1];
+        cassert_size_t_eq(arc->kind, ACTION_KITE_ARC);
+        cassert_float_eq(arc->action.as_arc.radius, 50);
+        // Every frame owns its ids, so the server can map them to its kites.
+        cassert_size_t_eq(arc->kite_id_array.elements[0], 0);
+        cassert_ptr_neq(arc->kite_id_array.elements, script.elements[1].elements[0].kite_id_array.elements);
+        space_free_space(&space);
+    }
+    read_scripts = tkbc_local_scripts_read(getpid(), client.scripts_counter, &scripts);
+    cassert_bool_eq(read_scripts, false);
+    free(scripts.elements);
+
+    tkbc_local_transport_destroy(&server);
+    tkbc_local_transport_destroy(&client);
+    opened = tkbc_local_ring_open(&server, getpid());
+    cassert_bool_eq(opened, false);
+    tkbc_destroy_env(env);
+    return test;
+}
+
+Test script_timeline_maps_time_to_blocks(void) {
+    Test test = cassert_init_test("tkbc_script_timeline_block_at()");
+    Env *env = tkbc_init_env();
+    for (size_t i = 0; i < 2; ++i) {
+        Kite_State kite_state = tkbc_init_kite();
+        kite_state.kite_id = i;
+        tkbc_dap(&env->kite_array, kite_state);
+    }
+    env->kite_id_counter = 2;
+
+    tkbc_script_begin("timeline");
+    SET(KITE_MOVE(ID(0), 100, 100, 1));
+    SET(KITE_MOVE(ID(0), 200, 200, 2), KITE_ROTATION(ID(1), 90, 0.5));
+    SET(KITE_WAIT(0.5));
+    tkbc_script_end();
+
+    // The script starts with the block of the start positions without a duration.
+    Script *script = &env->scripts.elements[0];
+    cassert_size_t_eq(script->count, 4);
+    cassert_size_t_eq(script->timeline.count, script->count + 1);
+    cassert_float_eq(tkbc_script_timeline_duration(script), 3.5);
+    cassert_float_eq(script->timeline.elements[2], 1);
+    cassert_float_eq(script->timeline.elements[3], 3);
+
+    cassert_size_t_eq(tkbc_script_timeline_block_at(script, -1), 0);
+    cassert_size_t_eq(tkbc_script_timeline_block_at(script, 0), 1);
+    cassert_size_t_eq(tkbc_script_timeline_block_at(script, 0.5), 1);
+    cassert_size_t_eq(tkbc_script_timeline_block_at(script, 1), 2);
+    cassert_size_t_eq(tkbc_script_timeline_block_at(script, 2.9), 2);
+    cassert_size_t_eq(tkbc_script_timeline_block_at(script, 3.2), 3);
+    cassert_size_t_eq(tkbc_script_timeline_block_at(script, 100), 3);
+
+    // The timeline parts are proportional to the durations.
+    cassert_float_eq(tkbc_script_timeline_block_end(script, 2, script->count), 3 / 3.5f);
+    cassert_size_t_eq(tkbc_script_timeline_block_at_part(script, 0.5, script->count), 2);
+    // Without a timeline every block gets the same part.
+    cassert_float_eq(tkbc_script_timeline_block_end(NULL, 1, 4), 0.5);
+    cassert_size_t_eq(tkbc_script_timeline_block_at_part(NULL, 0.5, 4), 2);
+    cassert_size_t_eq(tkbc_script_timeline_block_at_part(NULL, 1, 4), 3);
+
+    cassert_bool_eq(tkbc_load_script_id(env, script->script_id, true), true);
+    tkbc_execute_scrub_to(env, 2);
+    cassert_size_t_eq(env->frames->frames_index, 2);
+    env->frames->elements[0].duration = 1.5;
+    env->frames->elements[1].duration = 0;
+    env->frames->elements[1].finished = true;
+    cassert_float_eq(tkbc_script_elapsed_time(env), 1.5);
+
+    tkbc_destroy_env(env);
+    return test;
+}
+
 /**
  * @brief Run all script handler unit tests.
  *
@@ -418,7 +1765,30 @@ void tkbc_test_script_handler(Tests *tests) {
     cassert_dap(tests, deep_copy_frame());
     cassert_dap(tests, deep_copy_frames());
     cassert_dap(tests, deep_copy_script());
+    cassert_dap(tests, deep_copy_script_interns_ids());
     cassert_dap(tests, destroy_frames_internal_data());
     cassert_dap(tests, reset_frames_internal_data());
     cassert_dap(tests, calculate_script_byte_size_allocated());
+    cassert_dap(tests, script_arc());
+    cassert_dap(tests, script_spline());
+    cassert_dap(tests, add_script_moves_scratch_script());
+    cassert_dap(tests, remap_script_kite_ids_with_shared_sets());
+    cassert_dap(tests, script_store_evict_and_reload());
+    cassert_dap(tests, kiteb_export_and_load());
+    cassert_dap(tests, plugin_reload_replaces_scripts());
+    cassert_dap(tests, reload_kite_file_parses_changed_sections());
+    cassert_dap(tests, stream_kite_file_loads_scripts_progressively());
+    cassert_dap(tests, kite_keywords_and_team_figures_use_perfect_hash());
+    cassert_dap(tests, parse_kite_file_sections_in_parallel());
+    cassert_dap(tests, parse_numbers_from_token_spans());
+    cassert_dap(tests, export_kite_file_with_id_set_and_float_format());
+    cassert_dap(tests, expand_repeat_for_and_define_blocks());
+    cassert_dap(tests, optimize_script_fuses_and_removes_frames());
+    cassert_dap(tests, parse_kite_file_collects_diagnostics());
+    cassert_dap(tests, local_transport_shares_scripts_and_kites());
+    cassert_dap(tests, script_timeline_maps_time_to_blocks());
+    cassert_dap(tests, bake_script());
+    cassert_dap(tests, bake_script_reports_blocks_and_bounds());
+    cassert_dap(tests, collision_check_finds_close_kites());
+    cassert_dap(tests, team_figures_generate_blocks_in_bulk());
 }